@@ -82,6 +82,64 @@ grt::ObjectRef CatalogTreeView::ObjectNodeData::get_object_ref() {
   return _ref;
 }
 
+//--------------------------------------------------------------------------------------------------
+
+class CatalogTreeView::GroupNodeData : public mforms::TreeNodeData {
+public:
+  db_SchemaRef schema;
+  ObjectType type;
+  bool loaded; // Set once the child nodes exist. Until then the group has at most a placeholder child.
+
+  GroupNodeData(db_SchemaRef schema, ObjectType type) : mforms::TreeNodeData(), schema(schema), type(type) {
+    loaded = objects().count() == 0;
+  }
+
+  grt::ListRef<db_DatabaseObject> objects() const {
+    switch (type) {
+      case ObjTable:
+        return grt::ListRef<db_DatabaseObject>::cast_from(schema->tables());
+      case ObjView:
+        return grt::ListRef<db_DatabaseObject>::cast_from(schema->views());
+      default:
+        return grt::ListRef<db_DatabaseObject>::cast_from(schema->routineGroups());
+    }
+  }
+
+  NodeIcons object_icon() const {
+    switch (type) {
+      case ObjTable:
+        return IconTable;
+      case ObjView:
+        return IconView;
+      default:
+        return IconRoutineGroup;
+    }
+  }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the db objects which have a figure on the given diagram.
+ */
+static std::unordered_set<grt::internal::Value *> objects_on_diagram(const model_DiagramRef &diagram) {
+  std::unordered_set<grt::internal::Value *> uset;
+  grt::ListRef<model_Figure> figures(diagram->figures());
+  for (size_t c = figures.count(), i = 0; i < c; i++) {
+    model_FigureRef f(figures[i]);
+
+    if (f.has_member("table"))
+      uset.insert(f.get_member("table").valueptr());
+    else if (f.has_member("view"))
+      uset.insert(f.get_member("view").valueptr());
+    else if (f.has_member("routine"))
+      uset.insert(f.get_member("routine").valueptr());
+    else if (f.has_member("routineGroup"))
+      uset.insert(f.get_member("routineGroup").valueptr());
+  }
+  return uset;
+}
+
 bool CatalogTreeView::get_drag_data(mforms::DragDetails &details, void **data, std::string &format) {
   std::list<mforms::TreeNodeRef> selection = get_selection();
 
@@ -121,19 +179,20 @@ mforms::TreeNodeRef CatalogTreeView::create_new_node(const ObjectType &otype, mf
   if (parent.is_valid()) {
     std::string icon_path;
     switch (otype) {
-      case ObjTable: {
-        new_node = parent->get_child(0)->add_child();
-        icon_path = get_node_icon_path(IconTable);
-        break;
-      }
-      case ObjView: {
-        new_node = parent->get_child(1)->add_child();
-        icon_path = get_node_icon_path(IconView);
-        break;
-      }
+      case ObjTable:
+      case ObjView:
       case ObjRoutineGrp: {
-        new_node = parent->get_child(2)->add_child();
-        icon_path = get_node_icon_path(IconRoutineGroup);
+        mforms::TreeNodeRef group = parent->get_child(otype == ObjTable ? 0 : (otype == ObjView ? 1 : 2));
+        GroupNodeData *data = dynamic_cast<GroupNodeData *>(group->get_data());
+        if (data != NULL && !data->loaded) {
+          // The object gets its node with all others when the group is expanded, it only must be expandable.
+          if (group->count() == 0)
+            group->add_child();
+          return new_node;
+        }
+        new_node = group->add_child();
+        icon_path =
+          get_node_icon_path(otype == ObjTable ? IconTable : (otype == ObjView ? IconView : IconRoutineGroup));
         break;
       }
       case ObjSchema:
@@ -151,16 +210,10 @@ mforms::TreeNodeRef CatalogTreeView::create_new_node(const ObjectType &otype, mf
       new_node->set_tag(obj.id());
       if (otype == ObjSchema) // it's different we need to also create catalog nodes
       {
-        mforms::TreeNodeRef child = new_node->add_child();
+        add_group_node(new_node, ObjTable, obj);
         new_node->expand();
-        child->set_string(0, _("Tables"));
-        child->set_icon_path(0, get_node_icon_path(IconTablesMany));
-        child = new_node->add_child();
-        child->set_string(0, _("Views"));
-        child->set_icon_path(0, get_node_icon_path(IconViewsMany));
-        child = new_node->add_child();
-        child->set_string(0, _("Routine Groups"));
-        child->set_icon_path(0, get_node_icon_path(IconRoutineGroupsMany));
+        add_group_node(new_node, ObjView, obj);
+        add_group_node(new_node, ObjRoutineGrp, obj);
       }
     }
   }
@@ -193,6 +246,9 @@ CatalogTreeView::CatalogTreeView(ModelDiagramForm *owner)
   _menu = new mforms::ContextMenu();
   _menu->signal_will_show()->connect(std::bind(&CatalogTreeView::context_menu_will_show, this, std::placeholders::_1));
   set_context_menu(_menu);
+
+  scoped_connect(signal_expand_toggle(),
+                 std::bind(&CatalogTreeView::expand_toggled, this, std::placeholders::_1, std::placeholders::_2));
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -221,6 +277,10 @@ static std::vector<grt::Ref<T> > sort_db_object(grt::ListRef<T> list) {
   return vec;
 }
 
+/**
+ * Creates the nodes for all schemas and their object groups. The object nodes are only created when a group
+ * gets expanded (see fill_group_node()), so that switching to a diagram of a huge model stays fast.
+ */
 void CatalogTreeView::refill(bool force) {
   if (_initialized && !force)
     return;
@@ -228,84 +288,95 @@ void CatalogTreeView::refill(bool force) {
   clear();
   model_ModelRef model = _owner->get_model_diagram()->owner();
 
-  std::unordered_set<grt::internal::Value *> uset;
-  grt::ListRef<model_Figure> figures(_owner->get_model_diagram()->figures());
-  for (size_t c = figures.count(), i = 0; i < c; i++) {
-    model_FigureRef f(figures[i]);
-
-    if (f.has_member("table"))
-      uset.insert(f.get_member("table").valueptr());
-    else if (f.has_member("view"))
-      uset.insert(f.get_member("view").valueptr());
-    else if (f.has_member("routine"))
-      uset.insert(f.get_member("routine").valueptr());
-    else if (f.has_member("routineGroup"))
-      uset.insert(f.get_member("routineGroup").valueptr());
-  }
-
   freeze_refresh();
   grt::ListRef<db_Schema> schema_list = workbench_physical_ModelRef::cast_from(model)->catalog()->schemata();
   for (size_t i = 0; i < schema_list.count(); ++i) {
     mforms::TreeNodeRef node = add_node();
     node->set_string(0, schema_list[i]->name().c_str());
     node->set_icon_path(0, get_node_icon_path(IconSchema));
-    ;
     node->set_tag(schema_list[i].id());
     node->set_data(new ObjectNodeData(schema_list[i]));
-    mforms::TreeNodeRef child = node->add_child();
-    if (i == 0) // we expand by default only first schema on the list
-      node->expand();
-    child->set_string(0, _("Tables"));
-    child->set_icon_path(0, get_node_icon_path(IconTablesMany));
-
-    std::vector<db_TableRef> table_list = sort_db_object<db_Table>(schema_list[i]->tables());
-
-    for (size_t j = 0; j < table_list.size(); ++j) {
-      db_TableRef table = table_list[j];
-      mforms::TreeNodeRef subchild = child->add_child();
-      subchild->set_string(0, table->name().c_str());
-      subchild->set_icon_path(0, get_node_icon_path(IconTable));
-      subchild->set_tag(table.id());
-      subchild->set_data(new ObjectNodeData(table));
-      if (uset.find(table.valueptr()) != uset.end())
-        subchild->set_string(1, "\xe2\x97\x8f");
-    }
 
-    child = node->add_child();
-    child->set_string(0, _("Views"));
-    child->set_icon_path(0, get_node_icon_path(IconViewsMany));
-    std::vector<db_ViewRef> view_list = sort_db_object<db_View>(schema_list[i]->views());
-    for (size_t j = 0; j < view_list.size(); ++j) {
-      db_ViewRef view = view_list[j];
-      mforms::TreeNodeRef subchild = child->add_child();
-      subchild->set_string(0, view->name().c_str());
-      subchild->set_icon_path(0, get_node_icon_path(IconView));
-      subchild->set_tag(view.id());
-      subchild->set_data(new ObjectNodeData(view));
-      if (uset.find(view.valueptr()) != uset.end())
-        subchild->set_string(1, "\xe2\x97\x8f");
-    }
+    add_group_node(node, ObjTable, schema_list[i]);
+    add_group_node(node, ObjView, schema_list[i]);
+    add_group_node(node, ObjRoutineGrp, schema_list[i]);
 
-    child = node->add_child();
-    child->set_string(0, _("Routine Groups"));
-    child->set_icon_path(0, get_node_icon_path(IconRoutineGroupsMany));
-    std::vector<db_RoutineGroupRef> routine_group_list =
-      sort_db_object<db_RoutineGroup>(schema_list[i]->routineGroups());
-    for (size_t j = 0; j < routine_group_list.size(); ++j) {
-      db_RoutineGroupRef routineGrp = routine_group_list[j];
-      mforms::TreeNodeRef subchild = child->add_child();
-      subchild->set_string(0, routineGrp->name().c_str());
-      subchild->set_icon_path(0, get_node_icon_path(IconRoutineGroup));
-      subchild->set_tag(routineGrp.id());
-      subchild->set_data(new ObjectNodeData(routineGrp));
-      if (uset.find(routineGrp.valueptr()) != uset.end())
-        subchild->set_string(1, "\xe2\x97\x8f");
-    }
+    if (i == 0) // we expand by default only first schema on the list
+      node->expand();
   }
   thaw_refresh();
   _initialized = true;
 }
 
+//--------------------------------------------------------------------------------------------------
+
+mforms::TreeNodeRef CatalogTreeView::add_group_node(mforms::TreeNodeRef schema_node, ObjectType otype,
+                                                    grt::ObjectRef schema) {
+  mforms::TreeNodeRef group = schema_node->add_child();
+  switch (otype) {
+    case ObjTable:
+      group->set_string(0, _("Tables"));
+      group->set_icon_path(0, get_node_icon_path(IconTablesMany));
+      break;
+    case ObjView:
+      group->set_string(0, _("Views"));
+      group->set_icon_path(0, get_node_icon_path(IconViewsMany));
+      break;
+    default:
+      group->set_string(0, _("Routine Groups"));
+      group->set_icon_path(0, get_node_icon_path(IconRoutineGroupsMany));
+      break;
+  }
+
+  GroupNodeData *data = new GroupNodeData(db_SchemaRef::cast_from(schema), otype);
+  group->set_data(data);
+  if (!data->loaded)
+    group->add_child(); // Placeholder, so the group can be expanded.
+
+  return group;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void CatalogTreeView::expand_toggled(mforms::TreeNodeRef node, bool expanded) {
+  if (expanded)
+    fill_group_node(node);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Replaces the placeholder of a not yet loaded group node with the nodes for the objects in that group.
+ * Later changes are applied node by node (see add_update_node_caption() and remove_node()).
+ */
+void CatalogTreeView::fill_group_node(mforms::TreeNodeRef group) {
+  GroupNodeData *data = dynamic_cast<GroupNodeData *>(group->get_data());
+  if (data == NULL || data->loaded)
+    return;
+  data->loaded = true;
+
+  std::vector<db_DatabaseObjectRef> objects = sort_db_object<db_DatabaseObject>(data->objects());
+  std::unordered_set<grt::internal::Value *> uset = objects_on_diagram(_owner->get_model_diagram());
+
+  mforms::TreeNodeCollectionSkeleton collection(get_node_icon_path(data->object_icon()));
+  for (size_t i = 0; i < objects.size(); ++i)
+    collection.captions.push_back(objects[i]->name());
+
+  group->remove_children();
+  if (objects.empty())
+    return;
+
+  std::vector<mforms::TreeNodeRef> nodes = group->add_node_collection(collection);
+  for (size_t i = 0; i < nodes.size() && i < objects.size(); ++i) {
+    nodes[i]->set_tag(objects[i].id());
+    nodes[i]->set_data(new ObjectNodeData(objects[i]));
+    if (uset.find(objects[i].valueptr()) != uset.end())
+      nodes[i]->set_string(1, "\xe2\x97\x8f");
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void CatalogTreeView::set_activate_callback(const std::function<void(grt::ValueRef)> &active_callback) {
   _activate_callback = active_callback;
 }
@@ -398,64 +469,52 @@ void CatalogTreeView::add_update_node_caption(grt::ValueRef val) {
       mforms::TreeNodeRef prnt = node;
       node = create_new_node(otype, prnt, new_name, obj);
       workbench_physical_DiagramRef view(workbench_physical_DiagramRef::cast_from(_owner->get_model_diagram()));
-      if (view->getFigureForDBObject(obj).is_valid())
+      if (node.is_valid() && view->getFigureForDBObject(obj).is_valid())
         node->set_string(1, "\xe2\x97\x8f");
 
     } else if (db_SchemaRef::can_wrap(obj)) // check if it's schemaref
       node = create_new_node(otype, root_node(), new_name, obj);
   }
 
-  if (node.is_valid() &&
-      node->get_parent()->count() >
-        1) // We check if node is valid, and if so we need to rearrange this into different position.
-  {
-    mforms::TreeNodeRef next_node = node->next_sibling();
-    mforms::TreeNodeRef parent = node->get_parent();
-    mforms::TreeNodeRef prev_node = node->previous_sibling();
-    bool moved = false;
-    if (next_node.is_valid()) {
-      int new_idx = -1;
-      while (next_node.is_valid()) {
-        int ret = base::string_compare(node->get_string(0), next_node->get_string(0), false);
-        if (ret > 0)
-          new_idx = parent->get_child_index(next_node);
-        else {
-          next_node = next_node->previous_sibling(); // wee need to get back to the prev node
-          break;
-        }
+  if (node.is_valid())
+    move_to_sorted_position(node);
+}
 
-        if (next_node->next_sibling().is_valid())
-          next_node = next_node->next_sibling();
-        else
-          break;
-      }
-      if (new_idx > -1 && next_node.is_valid()) {
-        node->move_node(next_node, false);
-        moved = true;
-      }
-    }
-    if (prev_node.is_valid() && !moved) {
-      int new_idx = -1;
-      while (prev_node.is_valid()) {
-        int ret = base::string_compare(node->get_string(0), prev_node->get_string(0), false);
-        if (ret < 0)
-          new_idx = parent->get_child_index(prev_node);
-        else {
-          prev_node = prev_node->next_sibling(); // wee need to get back to the prev node
-          break;
-        }
+//--------------------------------------------------------------------------------------------------
 
-        if (prev_node->previous_sibling().is_valid())
-          prev_node = prev_node->previous_sibling();
-        else
-          break;
-      }
-      if (new_idx > -1 && prev_node.is_valid()) {
-        node->move_node(prev_node, true);
-        moved = true;
-      }
-    }
+/**
+ * Moves a new or renamed node to its place among its (sorted) siblings. Uses a binary search, object groups
+ * can have many thousand entries.
+ */
+void CatalogTreeView::move_to_sorted_position(mforms::TreeNodeRef node) {
+  mforms::TreeNodeRef parent = node->get_parent();
+  int count = parent->count();
+  if (count < 2)
+    return;
+
+  std::string name = node->get_string(0);
+  mforms::TreeNodeRef prev_node = node->previous_sibling();
+  mforms::TreeNodeRef next_node = node->next_sibling();
+  if ((!prev_node.is_valid() || base::string_compare(prev_node->get_string(0), name, false) <= 0) &&
+      (!next_node.is_valid() || base::string_compare(name, next_node->get_string(0), false) <= 0))
+    return; // Already in place.
+
+  // Search the position among the other children, i.e. as if the node had been removed.
+  int index = parent->get_child_index(node);
+  int low = 0, high = count - 1;
+  while (low < high) {
+    int middle = (low + high) / 2;
+    mforms::TreeNodeRef child = parent->get_child(middle < index ? middle : middle + 1);
+    if (base::string_compare(child->get_string(0), name, false) > 0)
+      high = middle;
+    else
+      low = middle + 1;
   }
+
+  if (low < count - 1)
+    node->move_node(parent->get_child(low < index ? low : low + 1), true);
+  else
+    node->move_node(parent->get_child(index == count - 1 ? count - 2 : count - 1), false);
 }
 
 void CatalogTreeView::remove_node(grt::ValueRef val) {
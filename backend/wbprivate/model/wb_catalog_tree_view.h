@@ -64,12 +64,20 @@ namespace wb {
     };
 
     enum ObjectType { ObjSchema, ObjTable, ObjView, ObjRoutineGrp, ObjNone };
+
+    // Attached to the Tables/Views/Routine Groups nodes, whose children are only created when first expanded.
+    class GroupNodeData;
+
     ModelDiagramForm *_owner;
     mforms::ContextMenu *_menu;
     std::list<GrtObjectRef> _dragged_objects;
     bool _initialized;
 
     void context_menu_will_show(mforms::MenuItem *parent_item);
+    void expand_toggled(mforms::TreeNodeRef node, bool expanded);
+    mforms::TreeNodeRef add_group_node(mforms::TreeNodeRef schema_node, ObjectType otype, grt::ObjectRef schema);
+    void fill_group_node(mforms::TreeNodeRef group);
+    void move_to_sorted_position(mforms::TreeNodeRef node);
     std::function<void(grt::ValueRef)> _activate_callback;
 
   protected:
@@ -43,6 +43,7 @@
 
 #include "grtdb/db_helpers.h"
 #include "grtdb/db_object_helpers.h"
+#include "objimpl/db/db_ForeignKey_impl.h"
 #include "grtui/db_conn_be.h"
 
 #include "mdc.h"
@@ -1023,10 +1024,9 @@ void WBComponentPhysical::delete_db_object(const db_DatabaseObjectRef &object) {
     // remove referencing foreign keys
     {
       db_TableRef table = db_TableRef::cast_from(object);
-      grt::ListRef<db_ForeignKey> foreignKeys(
-        db_SchemaRef::cast_from(table->owner())->getForeignKeysReferencingTable(table));
-      if (0 < foreignKeys.count()) {
-        for (grt::ListRef<db_ForeignKey>::const_iterator iter = foreignKeys.begin(); iter != foreignKeys.end();
+      std::vector<db_ForeignKeyRef> foreignKeys(foreign_keys_referencing_table(table));
+      if (!foreignKeys.empty()) {
+        for (std::vector<db_ForeignKeyRef>::const_iterator iter = foreignKeys.begin(); iter != foreignKeys.end();
              ++iter) {
           db_ForeignKeyRef fk(*iter);
           db_TableRef ref_table = db_TableRef::cast_from(fk->owner());
@@ -1686,11 +1686,10 @@ std::string WBComponentPhysical::get_object_tooltip(const model_ObjectRef &objec
             }
           }
 
-          grt::ListRef<db_ForeignKey> foreignKeys(
-            db_SchemaRef::cast_from(table->owner())->getForeignKeysReferencingTable(table));
-          if (foreignKeys.is_valid() && foreignKeys.count() > 0) {
+          std::vector<db_ForeignKeyRef> foreignKeys(foreign_keys_referencing_table(table));
+          if (!foreignKeys.empty()) {
             text.append("Referenced By:\n");
-            for (grt::ListRef<db_ForeignKey>::const_iterator iter = foreignKeys.begin(); iter != foreignKeys.end();
+            for (std::vector<db_ForeignKeyRef>::const_iterator iter = foreignKeys.begin(); iter != foreignKeys.end();
                  ++iter) {
               db_ForeignKeyRef fk(*iter);
               text.append("  ");
@@ -35,6 +35,9 @@
 #include "grts/structs.db.mysql.h"
 #include "base/string_utilities.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 /**
  * @file  wb_overview_physical_schema.cpp
  * @brief Schema specific panels for the overview window
@@ -200,7 +203,15 @@ public:
       add_node = children.front();
       children.erase(children.begin());
     }
-    clear_children();
+
+    // Keep the nodes of objects which are still in the list, only nodes for added objects are created and
+    // those of removed objects deleted. A single change in a huge schema must not rebuild all nodes.
+    std::unordered_map<grt::internal::Value *, Node *> existing_nodes;
+    existing_nodes.reserve(children.size());
+    for (std::vector<Node *>::const_iterator iter = children.begin(); iter != children.end(); ++iter)
+      existing_nodes[(*iter)->object.valueptr()] = *iter;
+    children.clear();
+    children.reserve(_list.count() + 1);
 
     if (add_node)
       children.push_back(add_node);
@@ -208,6 +219,14 @@ public:
     for (size_t c = _list.count(), i = 0; i < c; i++) {
       db_DatabaseObjectRef object(_list[i]);
 
+      std::unordered_map<grt::internal::Value *, Node *>::iterator existing = existing_nodes.find(object.valueptr());
+      if (existing != existing_nodes.end()) {
+        existing->second->label = object->name();
+        children.push_back(existing->second);
+        existing_nodes.erase(existing);
+        continue;
+      }
+
       SchemaObjectNode *node = _create_node(object);
 
       node->type = OverviewBE::OItem;
@@ -217,8 +236,15 @@ public:
 
       children.push_back(node);
     }
+
+    // What's left belongs to objects no longer in the list.
+    for (std::unordered_map<grt::internal::Value *, Node *>::iterator iter = existing_nodes.begin();
+         iter != existing_nodes.end(); ++iter)
+      delete iter->second;
+
     // sort items after add_node
-    std::sort(children.begin() + (add_node ? 1 : 0), children.end(), CompNodeLabel);
+    if (!std::is_sorted(children.begin() + (add_node ? 1 : 0), children.end(), CompNodeLabel))
+      std::sort(children.begin() + (add_node ? 1 : 0), children.end(), CompNodeLabel);
   }
 
   void set_detail_fields(const std::vector<std::string> &fields) {
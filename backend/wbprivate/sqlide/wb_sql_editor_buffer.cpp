@@ -641,7 +641,8 @@ void SqlEditorForm::open_file(const std::string &path, bool in_new_tab, bool ask
   }
 
   try {
-    if (askForFile && panel->load_from(file_path) == SqlEditorPanel::RunInstead) {
+    SqlEditorPanel::LoadResult result = askForFile ? panel->load_from(file_path) : SqlEditorPanel::Loaded;
+    if (result == SqlEditorPanel::RunInstead) {
       if (in_new_tab)
         remove_sql_editor(panel);
       grt::BaseListRef args(true);
@@ -649,6 +650,12 @@ void SqlEditorForm::open_file(const std::string &path, bool in_new_tab, bool ask
       args.ginsert(grt::StringRef(file_path));
       grt::GRT::get()->call_module_function("SQLIDEUtils", "runSQLScriptFile", args);
       return;
+    } else if (result == SqlEditorPanel::RunStreamed) {
+      // Files too large for the editor are executed while being read, instead of loading them at once.
+      if (in_new_tab)
+        remove_sql_editor(panel);
+      run_sql_script_file(file_path);
+      return;
     }
   } catch (std::exception &exc) {
     logError("Cannot open file %s: %s\n", file_path.c_str(), exc.what());
@@ -74,9 +74,12 @@
 #include "mforms/code_editor.h"
 
 #include "grtsqlparser/mysql_parser_services.h"
+#include "grtsqlparser/sql_script_reader.h"
+#include "code-completion/mysql-code-completion.h"
 
 #include "wb_tunnel.h"
 
+#include <map>
 #include <math.h>
 #include <mutex>
 #include <thread>
@@ -187,6 +190,10 @@ private:
 
 struct SqlEditorForm::PrivateMutex {
   std::mutex _symbolsMutex;
+
+  // Column symbols are loaded per schema on first use. Both sets are protected by _symbolsMutex.
+  std::set<std::string> _columnsLoaded;
+  std::set<std::string> _columnsPending;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -393,6 +400,7 @@ void SqlEditorForm::finish_startup() {
   }
 
   _column_width_cache = new ColumnWidthCache(sanitize_file_name(get_session_name()), cache_dir);
+  setCodeCompletionCacheFolder(bec::GRTManager::get()->get_user_datadir() + "/cache");
 
   if (_usr_dbc_conn && !_usr_dbc_conn->active_schema.empty())
     _live_tree->on_active_schema_change(_usr_dbc_conn->active_schema);
@@ -1854,6 +1862,109 @@ RecordsetsRef SqlEditorForm::exec_sql_returning_results(const std::string &sql_s
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/**
+ * Executes the given script file in the background, without loading it into an editor. The file is read and split
+ * in chunks, so this works for dumps of any size. Progress is shown in the output log.
+ */
+void SqlEditorForm::run_sql_script_file(const std::string &path) {
+  if (!connected())
+    throw grt::db_not_connected("Not connected");
+
+  exec_sql_task->exec(false, std::bind(&SqlEditorForm::do_run_sql_script_file, this, weak_ptr_from(this), path));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+grt::StringRef SqlEditorForm::do_run_sql_script_file(Ptr self_ptr, const std::string &path) {
+  std::shared_ptr<SqlEditorForm> self_ref = (self_ptr).lock();
+  if (!self_ref) {
+    logError("Couldn't aquire lock for SQL editor form\n");
+    return grt::StringRef("");
+  }
+
+  logDebug("Running SQL script file %s\n", path.c_str());
+  bec::GRTManager::get()->replace_status_text(strfmt(_("Running SQL script %s..."), path.c_str()));
+
+  std::string context = strfmt(_("Run SQL script %s"), path.c_str());
+  RowId log_message_index = add_log_message(DbSqlEditorLog::BusyMsg, _("Running..."), context, "");
+  Timer timer(false);
+
+  sql::Driver *dbc_driver = nullptr;
+  try {
+    RecMutexLock use_dbc_conn_mutex(ensure_valid_usr_connection());
+
+    dbc_driver = _usr_dbc_conn->ref->getDriver();
+    dbc_driver->threadInit();
+
+    bool is_running_query = true;
+    AutoSwap<bool> is_running_query_keeper(_is_running_query, is_running_query);
+    update_menu_and_toolbar();
+
+    SqlScriptReader reader(path);
+
+    sql::SqlBatchExec sql_batch_exec;
+    sql_batch_exec.stop_on_error(!_continueOnError);
+    sql_batch_exec.error_cb([this](long long code, const std::string &message, const std::string &statement) {
+      add_log_message(DbSqlEditorLog::ErrorMsg, strfmt(SQL_EXCEPTION_MSG_FORMAT, (int)code, message.c_str()),
+                      statement, "");
+      return 0;
+    });
+
+    // The log entry is updated only when the percentage changes, not for every statement.
+    int reported_percentage = -1;
+    sql_batch_exec.batch_exec_progress_cb([&](float progress) {
+      int percentage = (int)(progress * 100);
+      if (percentage != reported_percentage) {
+        reported_percentage = percentage;
+        set_log_message(log_message_index, DbSqlEditorLog::BusyMsg,
+                        strfmt(_("Running... %i%% (%.1f of %.1f MB)"), percentage, reader.offset() / 1024.0 / 1024.0,
+                               reader.size() / 1024.0 / 1024.0),
+                        context, timer.duration_formatted());
+      }
+      return 0;
+    });
+
+    std::unique_ptr<sql::Statement> stmt(_usr_dbc_conn->ref->createStatement());
+    timer.run();
+    long error_count = sql_batch_exec(stmt.get(), [&](std::string &statement, float &progress) {
+      if (_usr_dbc_conn->is_stop_query_requested)
+        return false;
+      bool have_statement = reader.next(statement);
+      progress = reader.progress();
+      return have_statement;
+    });
+    timer.stop();
+
+    if (_usr_dbc_conn->is_stop_query_requested) {
+      set_log_message(log_message_index, DbSqlEditorLog::NoteMsg,
+                      strfmt(_("Cancelled after %.1f of %.1f MB"), reader.offset() / 1024.0 / 1024.0,
+                             reader.size() / 1024.0 / 1024.0),
+                      context, timer.duration_formatted());
+      bec::GRTManager::get()->replace_status_text(_("Query interrupted"));
+    } else if (error_count > 0) {
+      set_log_message(log_message_index, DbSqlEditorLog::ErrorMsg,
+                      strfmt(_("Finished with %li error(s)"), error_count), context, timer.duration_formatted());
+      bec::GRTManager::get()->replace_status_text(_("SQL script finished with errors"));
+    } else {
+      set_log_message(log_message_index, DbSqlEditorLog::OKMsg, _("OK"), context, timer.duration_formatted());
+      bec::GRTManager::get()->replace_status_text(_("SQL script finished"));
+    }
+  }
+  CATCH_ANY_EXCEPTION_AND_DISPATCH(context)
+
+  if (dbc_driver)
+    dbc_driver->threadEnd();
+
+  update_menu_and_toolbar();
+  refresh_log_messages(true);
+
+  _usr_dbc_conn->is_stop_query_requested = false;
+
+  return grt::StringRef("");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 /**
  * Runs the current content of the given editor on the target server and returns true if the query
  * was actually started (useful for the platform layers to show a busy animation).
@@ -2825,6 +2936,8 @@ std::string SqlEditorForm::active_schema() const {
 void SqlEditorForm::schemaListRefreshed(std::vector<std::string> const &schemas) {
   std::unique_lock<std::mutex> lock(_pimplMutex->_symbolsMutex);
   _databaseSymbols.clear(); // Doesn't clear the dependencies.
+  _pimplMutex->_columnsLoaded.clear();
+  _pimplMutex->_columnsPending.clear();
 
   for (auto schema : schemas) {
     _databaseSymbols.addNewSymbol<SchemaSymbol>(nullptr, schema);
@@ -2881,78 +2994,157 @@ void SqlEditorForm::readStaticServerSymbols() {
 
 /**
  * Notification from the tree controller that (some) schema meta data has been refreshed. We use this
- * info to update the database symbol table.
+ * info to update the database symbol table. Columns are not part of this: they are loaded separately
+ * per schema (see request_column_symbols), once an editor references that schema.
  */
 void SqlEditorForm::schema_meta_data_refreshed(const std::string &schema_name, base::StringListPtr tables,
                                                base::StringListPtr views, base::StringListPtr procedures,
                                                base::StringListPtr functions) {
-  std::unique_lock<std::mutex> lock(_pimplMutex->_symbolsMutex);
-  std::unique_ptr<sql::Statement> statement;
-  RecMutexLock usr_dbc_conn_mutex(ensure_valid_usr_connection());
-  if (_usr_dbc_conn->ref.get() != nullptr)
-    statement.reset(_usr_dbc_conn->ref->createStatement());
-
-  auto schemaSymbols = _databaseSymbols.getSymbolsOfType<SchemaSymbol>();
-  bool hasPerformanceSchema = std::find_if(schemaSymbols.begin(), schemaSymbols.end(), [](auto symbol) -> bool {
-    return symbol->name == "performance_schema";
-  }) != schemaSymbols.end();
-
-  for (SchemaSymbol *schemaSymbol : schemaSymbols) {
-    if (schemaSymbol->name == schema_name) {
-      schemaSymbol->clear();
-      for (auto table : *tables) {
-        TableSymbol *tableSymbol = _databaseSymbols.addNewSymbol<TableSymbol>(schemaSymbol, table);
-
-        // Fetch column info for each table.
-        if (statement != nullptr) {
-          std::unique_ptr<sql::ResultSet> rs(statement->executeQuery(
-            std::string(base::sqlstring("SHOW FULL COLUMNS FROM !.!", 0) << schema_name << table)));
-
-          while (rs->next()) {
-            _databaseSymbols.addNewSymbol<ColumnSymbol>(tableSymbol, rs->getString(1), nullptr);
-          }
-        }
-      }
+  bool hasPerformanceSchema = false;
+  {
+    std::unique_lock<std::mutex> lock(_pimplMutex->_symbolsMutex);
 
-      for (auto view : *views) {
-        ViewSymbol *viewSymbol = _databaseSymbols.addNewSymbol<ViewSymbol>(schemaSymbol, view);
+    auto schemaSymbols = _databaseSymbols.getSymbolsOfType<SchemaSymbol>();
+    hasPerformanceSchema = std::find_if(schemaSymbols.begin(), schemaSymbols.end(), [](auto symbol) -> bool {
+      return symbol->name == "performance_schema";
+    }) != schemaSymbols.end();
 
-        // Same for each view.
-        if (statement != nullptr) {
-          std::unique_ptr<sql::ResultSet> rs(statement->executeQuery(
-            std::string(base::sqlstring("SHOW FULL COLUMNS FROM !.!", 0) << schema_name << view)));
+    auto iterator = std::find_if(schemaSymbols.begin(), schemaSymbols.end(), [&](auto symbol) -> bool {
+      return symbol->name == schema_name;
+    });
+    if (iterator == schemaSymbols.end())
+      return;
 
-          while (rs->next()) {
-            _databaseSymbols.addNewSymbol<ColumnSymbol>(viewSymbol, rs->getString(1), nullptr);
-          }
-        }
-      }
+    SchemaSymbol *schemaSymbol = *iterator;
+    _databaseSymbols.lock();
+    schemaSymbol->clear();
+    for (auto table : *tables)
+      _databaseSymbols.addNewSymbol<TableSymbol>(schemaSymbol, table);
+    for (auto view : *views)
+      _databaseSymbols.addNewSymbol<ViewSymbol>(schemaSymbol, view);
+    for (auto procedure : *procedures)
+      _databaseSymbols.addNewSymbol<StoredRoutineSymbol>(schemaSymbol, procedure, nullptr);
+    for (auto function : *functions)
+      _databaseSymbols.addNewSymbol<StoredRoutineSymbol>(schemaSymbol, function, nullptr);
+    _databaseSymbols.unlock();
+
+    // The columns went away with the old table symbols. The caller reloads them if they were in use.
+    if (_pimplMutex->_columnsLoaded.erase(schema_name) > 0)
+      _pimplMutex->_columnsPending.insert(schema_name);
+  }
+
+  // User variables are global to the server, so the aux connection serves as well as the user connection
+  // and we don't block script execution with this query.
+  sql::Dbc_connection_handler::Ref conn;
+  RecMutexLock aux_dbc_conn_mutex(ensure_valid_aux_connection(conn));
+  if (conn->ref.get() == nullptr)
+    return;
 
-      for (auto procedure : *procedures) {
-        _databaseSymbols.addNewSymbol<StoredRoutineSymbol>(schemaSymbol, procedure, nullptr);
-      }
+  auto metaInfo = conn->ref->getMetaData();
+  if (hasPerformanceSchema && (metaInfo->getDatabaseMajorVersion() > 7
+      || (metaInfo->getDatabaseMajorVersion() == 5 && metaInfo->getDatabaseMinorVersion() > 6))) {
+    std::unique_ptr<sql::Statement> statement(conn->ref->createStatement());
+    std::unique_ptr<sql::ResultSet> rs(
+      statement->executeQuery("SELECT VARIABLE_NAME FROM performance_schema.user_variables_by_thread")
+    );
 
-      for (auto function : *functions) {
-        _databaseSymbols.addNewSymbol<StoredRoutineSymbol>(schemaSymbol, function, nullptr);
-      }
+    std::unique_lock<std::mutex> lock(_pimplMutex->_symbolsMutex);
+    while (rs->next()) {
+      std::string name = "@" + rs->getString(1);
+      if (_databaseSymbols.resolve(name, true) == nullptr)
+        _databaseSymbols.addNewSymbol<UserVariableSymbol>(nullptr, name, nullptr);
+    }
+  }
+}
 
-      if (statement != nullptr) {
-        auto metaInfo = _usr_dbc_conn->ref->getMetaData();
-        if (hasPerformanceSchema && (metaInfo->getDatabaseMajorVersion() > 7
-            || (metaInfo->getDatabaseMajorVersion() == 5 && metaInfo->getDatabaseMinorVersion() > 6))) {
-          std::unique_ptr<sql::ResultSet> rs(
-            statement->executeQuery("SELECT VARIABLE_NAME FROM performance_schema.user_variables_by_thread")
-          );
+//----------------------------------------------------------------------------------------------------------------------
 
-          while (rs->next()) {
-            _databaseSymbols.addNewSymbol<UserVariableSymbol>(nullptr, "@" + rs->getString(1), nullptr);
-          }
-        }
-      }
+/**
+ * Called by editors before code completion runs, with the schemas their current statement refers to.
+ * Schemas whose columns haven't been loaded yet are scheduled for loading on the aux connection.
+ */
+void SqlEditorForm::request_column_symbols(std::set<std::string> const &schemas) {
+  // Without a tree controller nothing would load the columns, so nothing may be marked as pending either.
+  if (!_live_tree)
+    return;
 
-      return;
+  std::vector<std::string> toLoad;
+  {
+    std::unique_lock<std::mutex> lock(_pimplMutex->_symbolsMutex);
+    for (auto &schema : schemas) {
+      if (_pimplMutex->_columnsLoaded.count(schema) > 0 || _pimplMutex->_columnsPending.count(schema) > 0)
+        continue;
+
+      // Only real schemas. The scan in the editor also reports table names from table.column references.
+      if (dynamic_cast<SchemaSymbol *>(_databaseSymbols.resolve(schema, true)) == nullptr)
+        continue;
+
+      _pimplMutex->_columnsPending.insert(schema);
+      toLoad.push_back(schema);
     }
   }
+
+  for (auto &schema : toLoad)
+    _live_tree->fetch_schema_columns(schema);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Returns true if the columns of the given schema are in use (or about to be), so they must be reloaded
+ * when the schema content is refreshed.
+ */
+bool SqlEditorForm::column_symbols_wanted(const std::string &schema_name) {
+  std::unique_lock<std::mutex> lock(_pimplMutex->_symbolsMutex);
+  return _pimplMutex->_columnsPending.count(schema_name) > 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Stores the columns of all tables and views of a schema in the symbol table, in one go.
+ * The list is ordered by table and contains (table name, column name) pairs. A null list means loading failed.
+ */
+void SqlEditorForm::schema_columns_refreshed(const std::string &schema_name,
+                                             std::vector<std::pair<std::string, std::string>> const *columns) {
+  std::unique_lock<std::mutex> lock(_pimplMutex->_symbolsMutex);
+  _pimplMutex->_columnsPending.erase(schema_name);
+  if (columns == nullptr)
+    return;
+
+  SchemaSymbol *schemaSymbol = dynamic_cast<SchemaSymbol *>(_databaseSymbols.resolve(schema_name, true));
+  if (schemaSymbol == nullptr)
+    return;
+
+  _databaseSymbols.lock();
+
+  // Index the tables and views once instead of resolving each column's owner by a linear search.
+  std::map<std::string, ScopedSymbol *> owners;
+  for (auto table : schemaSymbol->getSymbolsOfType<TableSymbol>()) {
+    table->clear(); // In case of a repeated load.
+    owners[table->name] = table;
+  }
+  for (auto view : schemaSymbol->getSymbolsOfType<ViewSymbol>()) {
+    view->clear();
+    owners[view->name] = view;
+  }
+
+  ScopedSymbol *owner = nullptr;
+  std::string ownerName;
+  for (auto &column : *columns) {
+    if (column.first != ownerName) {
+      ownerName = column.first;
+      auto iterator = owners.find(ownerName);
+      owner = iterator == owners.end() ? nullptr : iterator->second;
+    }
+
+    // No owner means the table was created after the schema content was read. Comes with the next refresh.
+    if (owner != nullptr)
+      _databaseSymbols.addNewSymbol<ColumnSymbol>(owner, column.second, nullptr);
+  }
+
+  _databaseSymbols.unlock();
+  _pimplMutex->_columnsLoaded.insert(schema_name);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -348,6 +348,7 @@ public:
                                           bool dont_add_limit_clause = false);
 
   RecordsetsRef exec_sql_returning_results(const std::string &sql_script, bool dont_add_limit_clause);
+  void run_sql_script_file(const std::string &path);
 
   void exec_management_sql(const std::string &sql, bool log);
   db_query_ResultsetRef exec_management_query(const std::string &sql, bool log);
@@ -368,6 +369,7 @@ private:
 
   grt::StringRef do_exec_sql(Ptr self_ptr, std::shared_ptr<std::string> sql, SqlEditorPanel *editor, ExecFlags flags,
                              RecordsetsRef result_list);
+  grt::StringRef do_run_sql_script_file(Ptr self_ptr, const std::string &path);
 
   void handle_command_side_effects(const std::string &sql);
 
@@ -438,6 +440,11 @@ public:
   void schema_meta_data_refreshed(const std::string &schema_name, base::StringListPtr tables, base::StringListPtr views,
                                   base::StringListPtr procedures, base::StringListPtr functions);
 
+  void request_column_symbols(std::set<std::string> const &schemas);
+  bool column_symbols_wanted(const std::string &schema_name);
+  void schema_columns_refreshed(const std::string &schema_name,
+                                std::vector<std::pair<std::string, std::string>> const *columns);
+
 private:
   void cache_active_schema_name();
 
@@ -100,6 +100,8 @@ SqlEditorPanel::SqlEditorPanel(SqlEditorForm *owner, bool is_scratch, bool start
   _editor->set_sql_mode(owner->sql_mode());
   _editor->set_current_schema(owner->active_schema());
   UIForm::scoped_connect(_editor->text_change_signal(), std::bind(&SqlEditorPanel::update_title, this));
+  UIForm::scoped_connect(_editor->schemas_referenced_signal(),
+                         std::bind(&SqlEditorForm::request_column_symbols, owner, std::placeholders::_1));
 
   add(&_splitter, true, true);
 
@@ -477,21 +479,33 @@ SqlEditorPanel::LoadResult SqlEditorPanel::load_from(const std::string &file, co
 
   if (file_size > EDITOR_TEXT_LIMIT) {
     // File is larger than 100 MB. Tell the user we are going to switch off code folding and
-    // auto completion.
+    // syntax checking.
     int result = mforms::Utilities::show_warning(
       _("Large File"), strfmt(_("The file \"%s\" has a size "
                                 "of %.2f MB. Are you sure you want to open this large file?\n\nNote: code folding "
-                                "will be disabled for this file.\n\nClick Run SQL Script... to just execute the file."),
+                                "and syntax checking will be disabled for this file.\n\nClick Run SQL Script... to "
+                                "just execute the file."),
                               file.c_str(), file_size / 1024.0 / 1024.0),
       _("Open"), _("Cancel"), _("Run SQL Script..."));
     if (result == mforms::ResultCancel)
       return Cancelled;
     else if (result == mforms::ResultOther)
-      return RunInstead;
+      return RunStreamed;
   }
 
   _orig_encoding = encoding;
 
+  // Large UTF-8 files are paged into the editor, instead of loading and converting them as a whole.
+  bool large_file = file_size > (gsize)MySQLEditor::LargeFileSize;
+  _editor->set_large_file_mode(large_file);
+  if (large_file && encoding.empty()) {
+    _editor->set_refresh_enabled(true);
+    if (_editor->load_file(file)) {
+      finish_loading(file, "", keep_dirty);
+      return Loaded;
+    }
+  }
+
   if (!g_file_get_contents(file.c_str(), &data, &length, &error)) {
     logError("Could not read file %s: %s\n", file.c_str(), error->message);
     std::string what = error->message;
@@ -522,6 +536,13 @@ SqlEditorPanel::LoadResult SqlEditorPanel::load_from(const std::string &file, co
 
   g_free(utf8_data);
 
+  finish_loading(file, original_encoding, keep_dirty);
+  return Loaded;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void SqlEditorPanel::finish_loading(const std::string &file, const std::string &original_encoding, bool keep_dirty) {
   if (!keep_dirty) {
     _editor->get_editor_control()->reset_dirty();
 
@@ -535,7 +556,6 @@ SqlEditorPanel::LoadResult SqlEditorPanel::load_from(const std::string &file, co
     logWarning("Can't get timestamp for %s\n", file.c_str());
     _file_timestamp = 0;
   }
-  return Loaded;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -91,6 +91,7 @@ class MYSQLWBBACKEND_PUBLIC_FUNC SqlEditorPanel : public mforms::AppView {
 
   mforms::ToolBar *setup_editor_toolbar();
   void update_title();
+  void finish_loading(const std::string &file, const std::string &original_encoding, bool keep_dirty);
 
   void dock_result_panel(SqlEditorResult *result);
   void show_find_panel(mforms::CodeEditor *editor, bool show);
@@ -165,7 +166,7 @@ public:
     static AutoSaveInfo old_autosave(const std::string &autosave_file);
   };
 
-  enum LoadResult { Cancelled, Loaded, RunInstead };
+  enum LoadResult { Cancelled, Loaded, RunInstead, RunStreamed };
 
   LoadResult load_from(const std::string &file, const std::string &encoding = "", bool keep_dirty = false);
   bool load_autosave(const AutoSaveInfo &info, const std::string &text_file);
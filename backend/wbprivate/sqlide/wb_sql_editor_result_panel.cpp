@@ -576,10 +576,11 @@ void SqlEditorResult::onRecordsetColumnsResized(const std::vector<int> cols) {
     }
   }
   if (!widths.empty()) {
-    bec::GRTManager::get()->get_dispatcher()->execute_async_function("store column widths", [this, widths]() {
+    // Only touches the width cache, so it can run in the worker pool. Width updates are kept in order.
+    bec::GRTManager::get()->get_dispatcher()->execute_pooled_function("store column widths", [this, widths]() {
       _owner->owner()->column_width_cache()->save_columns_width(widths);
       return grt::ValueRef();
-    });
+    }, "column widths");
   }
 }
 
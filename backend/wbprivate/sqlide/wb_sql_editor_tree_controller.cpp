@@ -167,6 +167,9 @@ SqlEditorTreeController::SqlEditorTreeController(SqlEditorForm *owner)
                                                std::placeholders::_2, std::placeholders::_3, ""));
 
   live_schema_fetch_task->desc("Live Schema Fetch Task");
+  // The fetches run in the worker pool of the task's dispatcher. They all use the aux connection of this editor,
+  // so they share one ordering key to keep their order (e.g. schema contents before the columns of that schema).
+  live_schema_fetch_task->ordering_key("aux_connection");
   live_schema_fetch_task->send_task_res_msg(false);
   live_schema_fetch_task->msg_cb(std::bind(&SqlEditorForm::add_log_message, _owner, std::placeholders::_1,
                                            std::placeholders::_2, std::placeholders::_3, ""));
@@ -468,6 +471,18 @@ bool SqlEditorTreeController::fetch_schema_contents(
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/**
+ * Loads the column names of all tables and views in the given schema for code completion, in the background.
+ */
+void SqlEditorTreeController::fetch_schema_columns(const std::string &schema_name) {
+  logDebug3("Fetch column symbols for %s\n", schema_name.c_str());
+
+  live_schema_fetch_task->exec(false, std::bind(&SqlEditorTreeController::do_fetch_schema_columns, this,
+                                                weak_ptr_from(this), schema_name));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void SqlEditorTreeController::refresh_live_object_in_overview(wb::LiveSchemaTree::ObjectType type,
                                                               const std::string schema_name,
                                                               const std::string old_obj_name,
@@ -548,12 +563,18 @@ grt::StringRef SqlEditorTreeController::do_fetch_live_schema_contents(
 
     // Let the owner form know we got fresh schema meta data. Can be used to update caches.
     _owner->schema_meta_data_refreshed(schema_name, tables, views, procedures, functions);
+    if (_owner->column_symbols_wanted(schema_name))
+      do_fetch_schema_columns(self_ptr, schema_name);
   } catch (const sql::SQLException &e) {
     _owner->add_log_message(DbSqlEditorLog::ErrorMsg, strfmt(SQL_EXCEPTION_MSG_FORMAT, e.getErrorCode(), e.what()),
                             "Error loading schema content", "");
     logError("SQLException executing %s: %s\n", std::string("Error loading schema content").c_str(),
              strfmt(SQL_EXCEPTION_MSG_FORMAT, e.getErrorCode(), e.what()).c_str());
 
+    // The columns may have been marked for reloading before the error, they won't be loaded now.
+    if (_owner->column_symbols_wanted(schema_name))
+      _owner->schema_columns_refreshed(schema_name, nullptr);
+
     if (arrived_slot) {
       StringListPtr empty_list;
       std::function<void()> schema_contents_arrived =
@@ -567,6 +588,52 @@ grt::StringRef SqlEditorTreeController::do_fetch_live_schema_contents(
 
 //----------------------------------------------------------------------------------------------------------------------
 
+grt::StringRef SqlEditorTreeController::do_fetch_schema_columns(std::weak_ptr<SqlEditorTreeController> self_ptr,
+                                                                const std::string &schema_name) {
+  RETVAL_IF_FAIL_TO_RETAIN_WEAK_PTR(SqlEditorTreeController, self_ptr, self, grt::StringRef(""))
+  try {
+    load_schema_columns(schema_name);
+  } catch (const sql::SQLException &e) {
+    logError("SQLException loading columns of schema %s: %s\n", schema_name.c_str(),
+             strfmt(SQL_EXCEPTION_MSG_FORMAT, e.getErrorCode(), e.what()).c_str());
+    _owner->schema_columns_refreshed(schema_name, nullptr);
+  } catch (const std::exception &e) {
+    logError("Exception loading columns of schema %s: %s\n", schema_name.c_str(), e.what());
+    _owner->schema_columns_refreshed(schema_name, nullptr);
+  } catch (...) {
+    logError("Unknown exception loading columns of schema %s\n", schema_name.c_str());
+    _owner->schema_columns_refreshed(schema_name, nullptr);
+  }
+
+  return grt::StringRef("");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Reads all columns of a schema with a single query, instead of one SHOW COLUMNS per table, and hands them over
+ * to the owner for the symbol table. Must run in a fetch task.
+ */
+void SqlEditorTreeController::load_schema_columns(const std::string &schema_name) {
+  std::vector<std::pair<std::string, std::string>> columns;
+  {
+    sql::Dbc_connection_handler::Ref conn;
+    RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
+    std::unique_ptr<sql::Statement> stmt(conn->ref->createStatement());
+    std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(std::string(
+      sqlstring("SELECT TABLE_NAME, COLUMN_NAME FROM information_schema.COLUMNS WHERE TABLE_SCHEMA = ? "
+                "ORDER BY TABLE_NAME, ORDINAL_POSITION", 0) << schema_name)));
+
+    columns.reserve(rs->rowsCount());
+    while (rs->next())
+      columns.emplace_back(rs->getString(1), rs->getString(2));
+  }
+
+  _owner->schema_columns_refreshed(schema_name, &columns);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 grt::StringRef SqlEditorTreeController::do_fetch_data_for_filter(
   std::weak_ptr<SqlEditorTreeController> self_ptr, const std::string &schema_filter, const std::string &object_filter,
   wb::LiveSchemaTree::NewSchemaContentArrivedSlot arrived_slot) {
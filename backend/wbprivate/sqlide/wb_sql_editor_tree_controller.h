@@ -110,6 +110,7 @@ private:
                                      const wb::LiveSchemaTree::NewSchemaContentArrivedSlot &arrived_slot);
   virtual bool fetch_schema_contents(const std::string &schema_name,
                                      const wb::LiveSchemaTree::NewSchemaContentArrivedSlot &arrived_slot);
+  void fetch_schema_columns(const std::string &schema_name);
   virtual bool fetch_object_details(const std::string &schema_name, const std::string &object_name,
                                     wb::LiveSchemaTree::ObjectType type, short flags,
                                     const wb::LiveSchemaTree::NodeChildrenUpdaterSlot &);
@@ -131,6 +132,9 @@ private:
   grt::StringRef do_fetch_live_schema_contents(std::weak_ptr<SqlEditorTreeController> self_ptr,
                                                const std::string &schema_name,
                                                wb::LiveSchemaTree::NewSchemaContentArrivedSlot arrived_slot);
+  grt::StringRef do_fetch_schema_columns(std::weak_ptr<SqlEditorTreeController> self_ptr,
+                                         const std::string &schema_name);
+  void load_schema_columns(const std::string &schema_name);
   wb::LiveSchemaTree::ObjectType fetch_object_type(const std::string &schema_name, const std::string &obj_name);
   void fetch_column_data(const std::string &schema_name, const std::string &obj_name,
                          wb::LiveSchemaTree::ObjectType type,
@@ -83,7 +83,14 @@ namespace ssh {
     auto timeoutLock = lockTimeout();
     // before we continue, we should close all opened files
     _sftp.reset();
-    _session->disconnect();
+
+    // The session may be shared with tunnels or other wrappers, so it goes back to the pool (which disconnects it
+    // if it's not pooled). We continue with a fresh one in case we get connected again.
+    if (_session->isConnected()) {
+      SSHSessionPool::get()->release(_session);
+      _session = SSHSession::createSession();
+    } else
+      _session->disconnect();
   }
 
   grt::IntegerRef SSHSessionWrapper::isConnected() {
@@ -91,9 +98,22 @@ namespace ssh {
   }
 
   grt::IntegerRef SSHSessionWrapper::connect() {
+    // Pooled sessions are only shared between users with the same credentials, so complete them first.
     bool resetPassword = false;
+    std::string service = fillupAuthInfo(_config, _credentials, resetPassword);
+
+    auto pooledSession = SSHSessionPool::get()->acquire(_config, _credentials);
+    if (pooledSession) {
+      logInfo("Reusing SSH connection to %s\n", _config.getServer().c_str());
+      _session = pooledSession;
+      makeSessionPoll();
+      _sftp = std::shared_ptr<ssh::SSHSftp>(new ssh::SSHSftp(_session, wb::WBContextUI::get()->get_wb()->get_wb_options().get_int("SSH:maxFileSize", 65535)));
+      return 0;
+    }
+
     while (true) {
-      std::string service = fillupAuthInfo(_config, _credentials, resetPassword);
+      if (resetPassword)
+        service = fillupAuthInfo(_config, _credentials, resetPassword);
 
       logInfo("Opening new SSH connection to %s\n", _config.getServer().c_str());
 
@@ -106,6 +126,7 @@ namespace ssh {
         }
         case ssh::SSHReturnType::CONNECTED: {
           logInfo("Succesfully made SSH connection\n");
+          SSHSessionPool::get()->add(_session);
           makeSessionPoll();
           _sftp = std::shared_ptr<ssh::SSHSftp>(new ssh::SSHSftp(_session, wb::WBContextUI::get()->get_wb()->get_wb_options().get_int("SSH:maxFileSize", 65535)));
           return 0;
@@ -25,6 +25,7 @@
 
 #include "SSHCommon.h"
 #include "SSHSession.h"
+#include "SSHSessionPool.h"
 #include "SSHSftp.h"
 #include "base/any.h"
 #include "objimpl/db.mgmt/db_mgmt_SSHConnection.h"
@@ -1387,6 +1387,7 @@ void WBContext::set_default_options(grt::DictRef options) {
   set_default(options, "workbench:ForceSWRendering", 0);
   set_default(options, "workbench:OSSHideMissing", 0);
   set_default(options, "workbench:UndoEntries", DEFAULT_UNDO_STACK_SIZE);
+  set_default(options, "workbench:UndoMemoryLimit", 0); // In MB, 0 for no limit.
   set_default(options, "workbench:AutoSaveModelInterval", AUTO_SAVE_MODEL_INTERVAL);
   set_default(options, "workbench:AutoSaveSQLEditorInterval", AUTO_SAVE_SQLEDITOR_INTERVAL);
   set_default(options, "workbench.AutoReopenLastModel", 0);
@@ -1945,6 +1946,9 @@ void WBContext::option_dict_changed(grt::internal::OwnedDict *options, bool, con
       undo_size = 1;
 
     grt::GRT::get()->get_undo_manager()->set_undo_limit(undo_size);
+
+    ssize_t undo_memory = get_wb_options().get_int("workbench:UndoMemoryLimit", 0);
+    grt::GRT::get()->get_undo_manager()->set_undo_memory_limit(undo_memory > 0 ? (size_t)undo_memory << 20 : 0);
   }
 }
 
@@ -2117,6 +2121,7 @@ void WBContext::new_document() {
     wb->docPath(_filename);
 
     _model_context->model_created(_file, doc);
+    ValidationManager::watch(doc, { CHECK_NAME, CHECK_SYNTAX, CHECK_EFFICIENCY, CHECK_LOGIC });
 
     reset_document();
 
@@ -2346,7 +2351,7 @@ bool WBContext::open_document(const std::string &file) {
     for (std::list<std::string>::const_iterator iter = warnings.begin(); iter != warnings.end(); ++iter)
       grt::GRT::get()->send_output(base::strfmt(" - %s\n", iter->c_str()));
 
-    _file->copy_file(file, file + ".beforefix");
+    _file->link_or_copy_file(file, file + ".beforefix");
     grt::GRT::get()->send_output(base::strfmt("Original file backed up to %s\n", (file + ".beforefix").c_str()));
   }
 
@@ -2360,7 +2365,7 @@ bool WBContext::open_document(const std::string &file) {
     else
       bakpath = file + ".wb50.mwb";
 
-    _file->copy_file(file, bakpath);
+    _file->link_or_copy_file(file, bakpath);
 
     // make backup
     grt::GRT::get()->send_info(strfmt("Model file is from 5.0, making backup to %s", bakpath.c_str()));
@@ -2372,7 +2377,7 @@ bool WBContext::open_document(const std::string &file) {
     else
       bakpath = file + ".wb51.mwb";
 
-    _file->copy_file(file, bakpath);
+    _file->link_or_copy_file(file, bakpath);
 
     // make backup
     grt::GRT::get()->send_info(strfmt("Model file is from 5.1, making backup to %s", bakpath.c_str()));
@@ -2405,6 +2410,7 @@ bool WBContext::open_document(const std::string &file) {
   reset_document();
 
   _model_context->model_loaded(_file, doc);
+  ValidationManager::watch(doc, { CHECK_NAME, CHECK_SYNTAX, CHECK_EFFICIENCY, CHECK_LOGIC });
 
   _filename = file;
   _save_point = grt::GRT::get()->get_undo_manager()->get_latest_undo_action();
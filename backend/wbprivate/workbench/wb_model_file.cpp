@@ -23,13 +23,21 @@
 
 #include <algorithm>
 #include <fcntl.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
 
 #include <zip.h>
 #include "wb_model_file.h"
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
 #include <set>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 #include <errno.h>
 
 #include "grt.h"
@@ -71,6 +79,17 @@
 
 #define ZIP_FILE_COMMENT DOCUMENT_FORMAT " archive " ZIP_FILE_FORMAT
 
+// Archives with less (uncompressed) data than this are packed and unpacked on the calling thread only.
+#define PARALLEL_ZIP_THRESHOLD (8 * 1024 * 1024)
+// Smaller files are not worth being compressed in a separate step.
+#define PARALLEL_ZIP_MIN_FILE_SIZE (512 * 1024)
+#define ZIP_BUFFER_SIZE (64 * 1024)
+
+// libzip 1.0 added in-memory archives, which are needed to compress entries in parallel.
+#if defined(LIBZIP_VERSION_MAJOR) && LIBZIP_VERSION_MAJOR >= 1
+#define HAVE_ZIP_SOURCE_BUFFER
+#endif
+
 /* Auto-saving
  *
  * Auto-saving works by saving the model document file (the XML) to the expanded document folder
@@ -114,6 +133,19 @@ void ModelFile::copy_file(const std::string &srcfile, const std::string &destfil
   fclose(tf);
 }
 
+/**
+ * Makes a backup of a saved model file. Model files are never changed in place (saving writes a new file
+ * and renames the old one), so a hard link does the job where supported, without copying the whole archive.
+ */
+void ModelFile::link_or_copy_file(const std::string &srcfile, const std::string &destfile) {
+#ifndef _MSC_VER
+  g_remove(destfile.c_str());
+  if (link(srcfile.c_str(), destfile.c_str()) == 0)
+    return;
+#endif
+  copy_file(srcfile, destfile);
+}
+
 static int rmdir_recursively(const char *path) {
   int res = 0;
   GError *error = NULL;
@@ -429,12 +461,10 @@ bool ModelFile::semantic_check(workbench_DocumentRef doc) {
 
 //--------------------------------------------------------------------------------------------------
 
-std::list<std::string> ModelFile::unpack_zip(const std::string &zipfile, const std::string &destdir) {
-  std::list<std::string> unpacked_files;
-
-  if (g_mkdir_with_parents(destdir.c_str(), 0700) < 0)
-    throw grt::os_error(strfmt(_("Cannot create temporary directory for open document: %s"), destdir.c_str()), errno);
-
+/**
+ * Opens the given zip file for reading. Throws an exception with a user readable message on failure.
+ */
+static zip *open_zip_archive(const std::string &zipfile) {
   int err;
 #ifdef ZIP_DISABLE_DEPRECATED
   // Would be good if we could test for zip_fdopen, but there's no way in the preprocessor.
@@ -471,33 +501,136 @@ std::list<std::string> ModelFile::unpack_zip(const std::string &zipfile, const s
     zip_close(z);
     throw std::runtime_error(strfmt(_("Cannot open document file: %s"), msg.c_str()));
   }
+  return z;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Decompresses a single archive entry straight into the given file.
+ */
+static void extract_zip_entry(zip *z, zip_uint64_t index, const std::string &outpath) {
+  zip_file *file = zip_fopen_index(z, index, 0);
+  if (!file)
+    throw std::runtime_error(strfmt(_("Error opening document file: %s"), zip_strerror(z)));
+
+  FILE *outfile = base_fopen(outpath.c_str(), "w+");
+  if (!outfile) {
+    int err = errno;
+    zip_fclose(file);
+    throw grt::os_error(_("Error creating temporary file while opending document."), err);
+  }
+
+  std::vector<char> buffer(ZIP_BUFFER_SIZE);
+  ssize_t c;
+  while ((c = (ssize_t)zip_fread(file, buffer.data(), buffer.size())) > 0) {
+    if ((ssize_t)fwrite(buffer.data(), 1, c, outfile) < c) {
+      int err = ferror(outfile);
+      fclose(outfile);
+      zip_fclose(file);
+      throw grt::os_error(_("Error writing temporary file while opending document."), err);
+    }
+  }
+
+  if (c < 0) {
+    std::string err = zip_file_strerror(file) ? zip_file_strerror(file) : "";
+    fclose(outfile);
+    zip_fclose(file);
+    throw std::runtime_error(strfmt(_("Error opening document file: %s"), err.c_str()));
+  }
+
+  zip_fclose(file);
+  fclose(outfile);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Runs work(z, i) for every i < count. Large jobs are spread over worker threads. Each of them processes
+ * the next pending index until none is left, the calling thread works along. Returns the first error
+ * thrown by any of the threads.
+ */
+static std::exception_ptr run_parallel(size_t count, bool parallel, const std::function<zip *()> &open_archive,
+                                       const std::function<void(zip *, size_t)> &work, zip *z) {
+  std::atomic<size_t> next(0);
+  std::mutex error_mutex;
+  std::exception_ptr error;
+
+  auto process = [&](zip *archive) {
+    try {
+      for (size_t i = next++; i < count; i = next++)
+        work(archive, i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error)
+        error = std::current_exception();
+      next = count;
+    }
+  };
+
+  std::vector<std::thread> workers;
+  if (parallel) {
+    size_t thread_count = std::min<size_t>(std::max(1U, std::thread::hardware_concurrency()), count);
+    for (size_t i = 1; i < thread_count; ++i)
+      workers.emplace_back([&]() {
+        // libzip handles must not be shared between threads, so each worker gets its own. If that fails
+        // the other threads take over.
+        zip *archive = nullptr;
+        if (open_archive) {
+          try {
+            archive = open_archive();
+          } catch (...) {
+            return;
+          }
+        }
+        process(archive);
+        if (archive != nullptr)
+          zip_close(archive);
+      });
+  }
+
+  process(z);
+  for (auto &worker : workers)
+    worker.join();
+
+  return error;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::list<std::string> ModelFile::unpack_zip(const std::string &zipfile, const std::string &destdir) {
+  std::list<std::string> unpacked_files;
+
+  if (g_mkdir_with_parents(destdir.c_str(), 0700) < 0)
+    throw grt::os_error(strfmt(_("Cannot create temporary directory for open document: %s"), destdir.c_str()), errno);
+
+  zip *z = open_zip_archive(zipfile);
 
 #ifdef ZIP_DISABLE_DEPRECATED
   zip_int64_t count = zip_get_num_entries(z, 0);
 #else
   int count = zip_get_num_files(z);
 #endif
+
+  // Collect the entries and create their folders first, so the files can then be extracted in any order.
+  std::vector<std::pair<zip_uint64_t, std::string> > entries;
+  zip_uint64_t total_size = 0;
   for (int i = 0; i < count; i++) {
-    zip_file *file = zip_fopen_index(z, i, 0);
-    if (!file) {
-      const char *err = zip_strerror(z);
+    const char *zname = zip_get_name(z, i, 0);
+    if (!zname) {
+      std::string err = zip_strerror(z) ? zip_strerror(z) : "";
       zip_close(z);
-      throw std::runtime_error(strfmt(_("Error opening document file: %s"), err));
+      throw std::runtime_error(strfmt(_("Error opening document file: %s"), err.c_str()));
     }
 
-    const char *zname = zip_get_name(z, i, 0);
-    if (strcmp(zname, "/") == 0 || strcmp(zname, "\\") == 0) {
-      zip_fclose(file);
+    if (strcmp(zname, "/") == 0 || strcmp(zname, "\\") == 0)
       continue;
-    }
     std::string dirname = base::dirname(zname);
     std::string basename = base::basename(zname);
 
     // skip lock file as it is already locked and inaccessible
-    if (basename == lock_filename) {
-      zip_fclose(file);
+    if (basename == lock_filename)
       continue;
-    }
 
     std::string outpath = destdir;
 
@@ -505,7 +638,6 @@ std::list<std::string> ModelFile::unpack_zip(const std::string &zipfile, const s
       outpath.append("/");
       outpath.append(dirname);
       if (g_mkdir_with_parents(outpath.c_str(), 0700) < 0) {
-        zip_fclose(file);
         zip_close(z);
         throw grt::os_error(_("Error creating temporary directory while opending document."), errno);
       }
@@ -513,48 +645,41 @@ std::list<std::string> ModelFile::unpack_zip(const std::string &zipfile, const s
     outpath.append("/");
     outpath.append(basename);
 
-    FILE *outfile = base_fopen(outpath.c_str(), "w+");
-    if (!outfile) {
-      zip_fclose(file);
-      zip_close(z);
-      throw grt::os_error(_("Error creating temporary file while opending document."), errno);
-    }
+    struct zip_stat st;
+    zip_stat_init(&st);
+    if (zip_stat_index(z, i, 0, &st) == 0 && (st.valid & ZIP_STAT_SIZE))
+      total_size += st.size;
 
-    unpacked_files.push_back(outpath);
+    entries.push_back(std::make_pair((zip_uint64_t)i, outpath));
+  }
 
-    char buffer[4098];
-    ssize_t c;
-    while ((c = (size_t)zip_fread(file, buffer, sizeof(buffer))) > 0) {
-      if ((ssize_t)fwrite(buffer, 1, c, outfile) < c) {
-        int err = ferror(outfile);
-        fclose(outfile);
-        zip_fclose(file);
-        zip_close(z);
-        throw grt::os_error(_("Error writing temporary file while opending document."), err);
-      }
-    }
+  // Large documents (mostly because of images and inserts data) are decompressed on several threads.
+  std::exception_ptr error =
+    run_parallel(entries.size(), total_size >= PARALLEL_ZIP_THRESHOLD && entries.size() > 1,
+                 [&]() { return open_zip_archive(zipfile); },
+                 [&](zip *archive, size_t i) { extract_zip_entry(archive, entries[i].first, entries[i].second); }, z);
 
-    if (c < 0) {
-      std::string err = zip_file_strerror(file) ? zip_file_strerror(file) : "";
-      zip_fclose(file);
-      zip_close(z);
-      throw std::runtime_error(strfmt(_("Error opening document file: %s"), err.c_str()));
-    }
+  zip_close(z);
 
-    zip_fclose(file);
-    fclose(outfile);
-  }
+  if (error)
+    std::rethrow_exception(error);
 
-  zip_close(z);
+  for (auto &entry : entries)
+    unpacked_files.push_back(entry.second);
 
   return unpacked_files;
 }
 
-static void zip_dir_contents(zip *z, const std::string &destdir, const std::string &partial) {
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Collects the files in the document directory in the order they are stored in the archive: for each
+ * folder its files first, then the content of its sub folders.
+ */
+static void collect_dir_contents(const std::string &destdir, std::vector<std::string> &files) {
   GError *error = 0;
   GDir *dir = g_dir_open(destdir.empty() ? "." : destdir.c_str(), 0, &error);
   if (!dir) {
-    zip_close(z);
     std::string err = error ? error->message : "Cannot open document directory.";
     g_error_free(error);
     throw grt::os_error(err);
@@ -574,36 +699,130 @@ static void zip_dir_contents(zip *z, const std::string &destdir, const std::stri
       if (g_file_test(tmp.c_str(), G_FILE_TEST_IS_DIR)) {
         if (add_directories) {
           try {
-            zip_dir_contents(z, destdir.empty() ? entry : destdir + G_DIR_SEPARATOR + entry, tmp);
+            collect_dir_contents(destdir.empty() ? entry : destdir + G_DIR_SEPARATOR + entry, files);
           } catch (...) {
             g_dir_close(dir);
             throw;
           }
         }
-      } else {
-        if (!add_directories) {
-          zip_source *src = zip_source_file(z, tmp.c_str(), 0, 0);
-#ifdef _MSC_VER
-          if (!src || zip_file_add(z, tmp.c_str(), src, ZIP_FL_OVERWRITE | ZIP_FL_ENC_UTF_8) < 0) {
-            zip_source_free(src);
-            g_dir_close(dir);
-            throw std::runtime_error(zip_strerror(z));
-          }
-#else
-          if (!src || zip_add(z, tmp.c_str(), src) < 0) {
-            zip_source_free(src);
-            g_dir_close(dir);
-            throw std::runtime_error(zip_strerror(z));
-          }
-#endif
-        }
-      }
+      } else if (!add_directories)
+        files.push_back(tmp);
     }
     g_dir_rewind(dir);
   }
   g_dir_close(dir);
 }
 
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Images are compressed already, deflating them again only costs time.
+ */
+static bool is_compressed_format(const std::string &file) {
+  std::string extension = base::tolower(base::extension(file));
+  return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".gif";
+}
+
+//--------------------------------------------------------------------------------------------------
+
+#ifdef HAVE_ZIP_SOURCE_BUFFER
+
+/**
+ * Deflates the given file into a single entry archive in memory. This allows to compress several files
+ * in parallel (libzip itself compresses one entry after the other when the archive is written). The
+ * compressed data is then copied as is into the document archive.
+ */
+static zip *compress_to_memory(const std::string &file) {
+  zip_error_t error;
+  zip_error_init(&error);
+
+  zip_source *buffer = zip_source_buffer_create(NULL, 0, 0, &error);
+  zip *archive = buffer ? zip_open_from_source(buffer, ZIP_TRUNCATE, &error) : NULL;
+  if (!archive) {
+    std::string msg = zip_error_strerror(&error);
+    zip_source_free(buffer);
+    zip_error_fini(&error);
+    throw std::runtime_error(strfmt(_("Error writing zip file: %s"), msg.c_str()));
+  }
+
+  // The buffer must survive zip_close(), it holds the compressed archive afterwards.
+  zip_source_keep(buffer);
+
+  zip_source *src = zip_source_file(archive, file.c_str(), 0, 0);
+  if (!src || zip_file_add(archive, "data", src, 0) < 0) {
+    zip_source_free(src);
+    src = NULL;
+  }
+
+  // Compression happens here.
+  if (!src || zip_close(archive) < 0) {
+    std::string msg = zip_strerror(archive) ? zip_strerror(archive) : "";
+    zip_discard(archive);
+    zip_source_free(buffer);
+    zip_error_fini(&error);
+    throw std::runtime_error(strfmt(_("Error writing zip file: %s"), msg.c_str()));
+  }
+
+  archive = zip_open_from_source(buffer, 0, &error);
+  if (!archive) {
+    std::string msg = zip_error_strerror(&error);
+    zip_source_free(buffer);
+    zip_error_fini(&error);
+    throw std::runtime_error(strfmt(_("Error writing zip file: %s"), msg.c_str()));
+  }
+
+  zip_error_fini(&error);
+  return archive;
+}
+
+#endif
+
+//--------------------------------------------------------------------------------------------------
+
+namespace {
+  // Archives created by compress_to_memory(). They must stay open until the document archive is written.
+  struct CompressedFiles {
+    std::vector<zip *> archives;
+
+    ~CompressedFiles() {
+#ifdef HAVE_ZIP_SOURCE_BUFFER
+      for (zip *archive : archives)
+        if (archive != NULL)
+          zip_discard(archive);
+#endif
+    }
+  };
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void add_file_to_zip(zip *z, const std::string &file, zip *compressed) {
+  zip_source *src;
+#ifdef HAVE_ZIP_SOURCE_BUFFER
+  if (compressed != NULL)
+    src = zip_source_zip(z, compressed, 0, ZIP_FL_COMPRESSED, 0, -1);
+  else
+#endif
+    src = zip_source_file(z, file.c_str(), 0, 0);
+
+#ifdef _MSC_VER
+  zip_int64_t index = src ? zip_file_add(z, file.c_str(), src, ZIP_FL_OVERWRITE | ZIP_FL_ENC_UTF_8) : -1;
+#else
+  zip_int64_t index = src ? zip_add(z, file.c_str(), src) : -1;
+#endif
+  if (index < 0) {
+    zip_source_free(src);
+    throw std::runtime_error(zip_strerror(z));
+  }
+
+#ifdef HAVE_ZIP_SOURCE_BUFFER
+  if (compressed == NULL && is_compressed_format(file))
+    zip_set_file_compression(z, index, ZIP_CM_STORE, 0);
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void ModelFile::pack_zip(const std::string &zipfile, const std::string &destdir, const std::string &comment) {
   std::string curdir;
 
@@ -633,6 +852,7 @@ void ModelFile::pack_zip(const std::string &zipfile, const std::string &destdir,
 #*/
   zip *z = zip_open(zipfile.c_str(), ZIP_CREATE, &err);
   if (!z) {
+    g_chdir(curdir.c_str());
     if (err == ZIP_ER_MEMORY)
       throw grt::os_error("Cannot allocate enough temporary memory to save document.");
     else if (err == ZIP_ER_NOENT)
@@ -653,8 +873,40 @@ void ModelFile::pack_zip(const std::string &zipfile, const std::string &destdir,
   zip_set_archive_comment(z, zip_comment.c_str(), (int)zip_comment.size());
 #endif
 
+  // Must outlive z, whose sources may refer to them until it is closed.
+  CompressedFiles compressed;
+
   try {
-    zip_dir_contents(z, "", "");
+    std::vector<std::string> files;
+    collect_dir_contents("", files);
+    compressed.archives.resize(files.size(), NULL);
+
+#ifdef HAVE_ZIP_SOURCE_BUFFER
+    // Deflate the big files (XML document, inserts database) in parallel, if there is enough to do.
+    std::vector<size_t> large_files;
+    zip_uint64_t total_size = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+      std::int64_t size = get_file_size(files[i].c_str());
+      if (!is_compressed_format(files[i]) && size >= PARALLEL_ZIP_MIN_FILE_SIZE) {
+        large_files.push_back(i);
+        total_size += size;
+      }
+    }
+
+    if (large_files.size() > 1 && total_size >= PARALLEL_ZIP_THRESHOLD) {
+      std::exception_ptr error = run_parallel(large_files.size(), true, std::function<zip *()>(),
+                                              [&](zip *, size_t i) {
+                                                compressed.archives[large_files[i]] =
+                                                  compress_to_memory(files[large_files[i]]);
+                                              },
+                                              NULL);
+      if (error)
+        std::rethrow_exception(error);
+    }
+#endif
+
+    for (size_t i = 0; i < files.size(); ++i)
+      add_file_to_zip(z, files[i], compressed.archives[i]);
 
     if (zip_close(z) < 0) {
       std::string err = zip_strerror(z) ? zip_strerror(z) : "";
@@ -664,7 +916,11 @@ void ModelFile::pack_zip(const std::string &zipfile, const std::string &destdir,
 
     g_chdir(curdir.c_str());
   } catch (...) {
+#ifdef HAVE_ZIP_SOURCE_BUFFER
+    zip_discard(z); // Don't write an incomplete archive.
+#else
     zip_close(z);
+#endif
     g_chdir(curdir.c_str());
     throw;
   }
@@ -782,7 +1038,8 @@ bool ModelFile::save_to(const std::string &path, const std::string &comment) {
   _delete_queue.clear();
 
   // saving the file for real can delete the autosave
-  g_remove(get_path_for("document-autosave.mwb.xml").c_str());
+  finish_autosave();
+  g_remove(get_path_for(MAIN_DOCUMENT_AUTOSAVE_NAME).c_str());
   g_remove(get_path_for("real_path").c_str());
 
   if (g_path_is_absolute(path.c_str()))
@@ -802,6 +1059,8 @@ bool ModelFile::save_to(const std::string &path, const std::string &comment) {
 void ModelFile::cleanup() {
   RecMutexLock lock(_mutex);
 
+  finish_autosave();
+
   delete _temp_dir_lock;
   _temp_dir_lock = 0;
 
@@ -927,8 +1186,62 @@ void ModelFile::store_document(const workbench_DocumentRef &doc) {
   _dirty = true;
 }
 
+/**
+ * Autosaves the document without blocking the caller for the write. The document is still serialized to an
+ * XML tree here, on the calling (main) thread, which gives a consistent snapshot of it. Only formatting and
+ * writing that tree (the expensive part for big models) happens on a background thread, edits can continue
+ * meanwhile. The file is written under a temporary name and then renamed, so there is always a complete
+ * autosave file on disk.
+ *
+ * If writing the previous autosave failed, its error is thrown here, but only after the new snapshot was
+ * handed to the background thread, so a single failed write doesn't stop autosaving.
+ */
 void ModelFile::store_document_autosave(const workbench_DocumentRef &doc) {
-  grt::GRT::get()->serialize(doc, get_path_for("document-autosave.mwb.xml"), DOCUMENT_FORMAT, DOCUMENT_VERSION);
+  std::exception_ptr previous_error = join_autosave();
+
+  xmlDocPtr xmldoc = grt::GRT::get()->serialize_xml(doc, DOCUMENT_FORMAT, DOCUMENT_VERSION);
+  std::string path = get_path_for(MAIN_DOCUMENT_AUTOSAVE_NAME);
+
+  _autosave_thread = std::thread([this, xmldoc, path]() {
+    try {
+      grt::GRT::save_xml(xmldoc, path);
+    } catch (...) {
+      _autosave_error = std::current_exception();
+    }
+    xmlFreeDoc(xmldoc);
+  });
+
+  if (previous_error)
+    std::rethrow_exception(previous_error);
+}
+
+/**
+ * Blocks until a running background autosave is done and returns its error, if there was one.
+ */
+std::exception_ptr ModelFile::join_autosave() {
+  if (_autosave_thread.joinable())
+    _autosave_thread.join();
+
+  std::exception_ptr error = _autosave_error;
+  _autosave_error = nullptr;
+  return error;
+}
+
+/**
+ * Like join_autosave(), but an error is only logged. For places where a failed previous write doesn't matter.
+ */
+void ModelFile::finish_autosave() {
+  std::exception_ptr error = join_autosave();
+  if (!error)
+    return;
+
+  try {
+    std::rethrow_exception(error);
+  } catch (std::exception &exc) {
+    logWarning("Autosave failed: %s", exc.what());
+  } catch (...) {
+    logWarning("Autosave failed");
+  }
 }
 
 void ModelFile::delete_file(const std::string &path) {
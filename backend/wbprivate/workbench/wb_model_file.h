@@ -25,7 +25,9 @@
 
 #include "wb_backend_public_interface.h"
 
+#include <exception>
 #include <string>
+#include <thread>
 #include "grt.h"
 #include "base/file_utilities.h"
 #include "grts/structs.workbench.h"
@@ -94,6 +96,7 @@ namespace wb {
     }
 
     static void copy_file(const std::string &path, const std::string &dest);
+    static void link_or_copy_file(const std::string &path, const std::string &dest);
 
     void copy_file_to(const std::string &file, const std::string &dest);
 
@@ -122,6 +125,9 @@ namespace wb {
 
     bool _dirty;
 
+    std::thread _autosave_thread;         //< writes the autosave file in the background
+    std::exception_ptr _autosave_error;   //< set by _autosave_thread if writing failed
+
     typedef std::map<std::string, std::string> TableInsertsSqlScripts; // table guid -> sql script (inserts)
     TableInsertsSqlScripts
       table_inserts_sql_scripts; // for model upgrade only: move insert sql scripts from xml to sqlite db
@@ -136,6 +142,9 @@ namespace wb {
                                                    const std::string &version);
     void cleanup_upgrade_data();
 
+    std::exception_ptr join_autosave();
+    void finish_autosave();
+
     void check_and_fix_data_file_bug();
     bool check_and_fix_duplicate_uuid_bug(xmlDocPtr xmldoc);
 
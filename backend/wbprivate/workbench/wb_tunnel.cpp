@@ -39,6 +39,7 @@
 
 #include "base/log.h"
 #include "SSHSession.h"
+#include "SSHSessionPool.h"
 #include "SSHSessionWrapper.h"
 
 DEFAULT_LOG_DOMAIN("SSH tunnel")
@@ -55,8 +56,13 @@ TunnelManager::TunnelManager()
 //----------------------------------------------------------------------------------------------------------------------
 
 void TunnelManager::start() {
-  if (_manager == nullptr)
+  if (_manager == nullptr) {
     _manager = new ssh::SSHTunnelManager();
+    ssh::SSHSessionPool::get()->setIdleTimeout(
+      bec::GRTManager::get()->get_app_option_int("SSH:sessionIdleTimeout", 300));
+    ssh::SSHSessionPool::get()->setKeepAliveInterval(
+      bec::GRTManager::get()->get_app_option_int("SSH:keepAliveInterval", 60));
+  }
 
   if (!_manager->isRunning()) {
     logInfo("Starting tunnel\n");
@@ -128,9 +134,25 @@ std::shared_ptr<SSHTunnel> TunnelManager::createTunnel(db_mgmt_ConnectionRef con
       bec::GRTManager::get()->replace_status_text("Existing SSH tunnel not found, opening new one...");
       logInfo("Existing SSH tunnel not found, opening new one\n");
 
-      auto session = ssh::SSHSession::createSession();
+      // An authenticated session to the same server may already be open (another tunnel, sftp or remote commands),
+      // in which case we only need a new channel over it. The pool only hands out sessions that were authenticated
+      // with the same credentials, so these must be complete before looking.
+      std::string service = ssh::SSHSessionWrapper::fillupAuthInfo(config, credentials, resetPassword);
+      auto session = ssh::SSHSessionPool::get()->acquire(config, credentials);
+      if (session) {
+        logInfo("Reusing SSH session to %s\n", config.getServer().c_str());
+        auto retVal = _manager->createTunnel(session, config);
+        uint16_t port = std::get<1>(retVal);
+        bec::GRTManager::get()->replace_status_text("SSH tunnel opened");
+        logInfo("SSH tunnel opened on port: %d\n", (int)port);
+        config.localport = port;
+        return std::shared_ptr<SSHTunnel>(new ::SSHTunnel(this, config));
+      }
+
+      session = ssh::SSHSession::createSession();
       while (true) {
-        std::string service = ssh::SSHSessionWrapper::fillupAuthInfo(config, credentials, resetPassword);
+        if (resetPassword)
+          service = ssh::SSHSessionWrapper::fillupAuthInfo(config, credentials, resetPassword);
 
         bec::GRTManager::get()->replace_status_text("Opening SSH tunnel to " + config.getServer() + "...");
         logInfo("Opening SSH tunnel to %s\n", config.getServer().c_str());
@@ -144,7 +166,8 @@ std::shared_ptr<SSHTunnel> TunnelManager::createTunnel(db_mgmt_ConnectionRef con
             throw std::runtime_error(std::string("Cannot open SSH Tunnel: ").append(errorMsg.c_str()));
           }
           case ssh::SSHReturnType::CONNECTED: {
-            retVal = _manager->createTunnel(session);
+            ssh::SSHSessionPool::get()->add(session);
+            retVal = _manager->createTunnel(session, config);
             uint16_t port = std::get<1>(retVal);
             bec::GRTManager::get()->replace_status_text("SSH tunnel opened");
             logInfo("SSH tunnel opened on port: %d\n", (int )port);
@@ -211,6 +234,7 @@ TunnelManager::~TunnelManager() {
 
     delete _manager;
   }
+  ssh::SSHSessionPool::get()->clear();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -32,6 +32,14 @@
 
 #include "mforms/utilities.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+
 using namespace bec;
 
 DEFAULT_LOG_DOMAIN("GRTDispatcher");
@@ -321,6 +329,226 @@ void GRTShellTask::process_message_m(const grt::Message &msg) {
   _message(msg);
 }
 
+//----------------- GRTDispatcher::WorkerPool ------------------------------------------------------
+
+static bool call_process_message(const grt::Message &msgs, void *sender, const GRTTaskBase::Ref task);
+
+/**
+ * A set of worker threads for tasks that don't need to run on the dispatcher thread.
+ * Each thread has its own task queue, which it processes in FIFO order. Idle threads steal work from
+ * the end of the other queues. Tasks sharing an ordering key are held back until their predecessor finished.
+ */
+class GRTDispatcher::WorkerPool {
+public:
+  WorkerPool(GRTDispatcher *owner, size_t size)
+    : _owner(owner), _pending(0), _next_worker(0), _running(size), _stopping(false) {
+    for (size_t i = 0; i < size; ++i)
+      _workers.push_back(std::unique_ptr<Worker>(new Worker()));
+    for (size_t i = 0; i < size; ++i)
+      _workers[i]->thread = std::thread(&WorkerPool::run, this, i);
+  }
+
+  ~WorkerPool() {
+    stop();
+    for (auto &worker : _workers)
+      if (worker->thread.joinable())
+        worker->thread.join();
+  }
+
+  // Asks all threads to end after their current task. Tasks not yet started stay queued, see take_queued_tasks().
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(_idle_mutex);
+      _stopping = true;
+    }
+    _idle.notify_all();
+  }
+
+  bool is_running() const {
+    return _running > 0;
+  }
+
+  void push(const GRTTaskBase::Ref task) {
+    if (!task->ordering_key().empty()) {
+      std::lock_guard<std::mutex> lock(_order_mutex);
+      if (_running_keys.find(task->ordering_key()) != _running_keys.end()) {
+        _waiting[task->ordering_key()].push_back(task);
+        return;
+      }
+      _running_keys.insert(task->ordering_key());
+    }
+    enqueue(task);
+  }
+
+  // Removes all tasks that were not started. Only valid once the threads have ended.
+  std::vector<GRTTaskBase::Ref> take_queued_tasks() {
+    std::vector<GRTTaskBase::Ref> tasks;
+    for (auto &worker : _workers) {
+      std::lock_guard<std::mutex> lock(worker->mutex);
+      tasks.insert(tasks.end(), worker->tasks.begin(), worker->tasks.end());
+      worker->tasks.clear();
+    }
+
+    std::lock_guard<std::mutex> lock(_order_mutex);
+    for (auto &entry : _waiting)
+      tasks.insert(tasks.end(), entry.second.begin(), entry.second.end());
+    _waiting.clear();
+    _pending = 0;
+
+    return tasks;
+  }
+
+  // The number of tasks queued, including those waiting for a predecessor with the same ordering key.
+  size_t queued_tasks() {
+    size_t count = _pending;
+    std::lock_guard<std::mutex> lock(_order_mutex);
+    for (auto &entry : _waiting)
+      count += entry.second.size();
+    return count;
+  }
+
+private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<GRTTaskBase::Ref> tasks;
+    std::thread thread;
+  };
+
+  GRTDispatcher *_owner;
+  std::vector<std::unique_ptr<Worker>> _workers;
+
+  std::mutex _idle_mutex;
+  std::condition_variable _idle;
+  std::atomic<size_t> _pending;
+  std::atomic<size_t> _next_worker;
+  std::atomic<size_t> _running;
+  bool _stopping;
+
+  std::mutex _order_mutex;
+  std::set<std::string> _running_keys;
+  std::map<std::string, std::deque<GRTTaskBase::Ref>> _waiting;
+
+  void enqueue(const GRTTaskBase::Ref task) {
+    Worker *worker = _workers[_next_worker++ % _workers.size()].get();
+    {
+      // Count the task before it becomes visible, pop() decrements the counter as soon as it takes it.
+      std::lock_guard<std::mutex> lock(worker->mutex);
+      ++_pending;
+      worker->tasks.push_back(task);
+    }
+    {
+      // Waiters check _pending with this mutex held, so taking it here makes sure none misses the notification.
+      std::lock_guard<std::mutex> lock(_idle_mutex);
+    }
+    _idle.notify_one();
+  }
+
+  bool pop(size_t index, GRTTaskBase::Ref &task, bool &stolen) {
+    {
+      Worker *own = _workers[index].get();
+      std::lock_guard<std::mutex> lock(own->mutex);
+      if (!own->tasks.empty()) {
+        task = own->tasks.front();
+        own->tasks.pop_front();
+        --_pending;
+        stolen = false;
+        return true;
+      }
+    }
+
+    for (size_t i = 1; i < _workers.size(); ++i) {
+      Worker *victim = _workers[(index + i) % _workers.size()].get();
+      std::lock_guard<std::mutex> lock(victim->mutex);
+      if (!victim->tasks.empty()) {
+        task = victim->tasks.back();
+        victim->tasks.pop_back();
+        --_pending;
+        stolen = true;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void finished(const GRTTaskBase::Ref task) {
+    if (task->ordering_key().empty())
+      return;
+
+    GRTTaskBase::Ref next;
+    {
+      std::lock_guard<std::mutex> lock(_order_mutex);
+      auto iterator = _waiting.find(task->ordering_key());
+      if (iterator == _waiting.end()) {
+        _running_keys.erase(task->ordering_key());
+        return;
+      }
+
+      next = iterator->second.front();
+      iterator->second.pop_front();
+      if (iterator->second.empty())
+        _waiting.erase(iterator);
+    }
+    enqueue(next);
+  }
+
+  void run(size_t index) {
+    mforms::Utilities::set_thread_name("GRTDispatcher pool");
+
+    while (true) {
+      GRTTaskBase::Ref task;
+      bool stolen = false;
+      {
+        std::unique_lock<std::mutex> lock(_idle_mutex);
+        if (_stopping)
+          break;
+      }
+
+      if (!pop(index, task, stolen)) {
+        std::unique_lock<std::mutex> lock(_idle_mutex);
+        _idle.wait(lock, [this]() { return _stopping || _pending > 0; });
+        continue;
+      }
+
+      if (!task->is_cancelled()) {
+        _owner->task_started(task, true, stolen);
+        logDebug3("Running pooled task \"%s\"\n", task->name().c_str());
+
+        // GRT messages sent by the task go to the task, like they do for tasks on the dispatcher thread.
+        std::unique_ptr<grt::SlotHolder> handler;
+        if (_owner->_is_main_dispatcher) {
+          handler.reset(
+            new grt::SlotHolder(std::bind(call_process_message, std::placeholders::_1, std::placeholders::_2, task)));
+          grt::GRT::get()->setThreadMessageHandler(handler.get());
+        }
+
+        try {
+          task->started();
+          grt::ValueRef result = task->execute();
+          task->finished(result);
+        } catch (std::exception &error) {
+          logException("exception in pooled grt task, continuing", error);
+          task->failed(error);
+        } catch (std::exception *error) {
+          logException("exception in pooled grt task, continuing", *error);
+          task->failed(*error);
+          delete error;
+        } catch (...) {
+          logError("Unknown exception in pooled grt task.");
+          task->failed(std::runtime_error("Unknown reason"));
+        }
+
+        if (handler)
+          grt::GRT::get()->setThreadMessageHandler(nullptr);
+      } else
+        logDebug3("Task \"%s\" cancelled\n", task->name().c_str());
+
+      finished(task);
+    }
+
+    --_running;
+  }
+};
+
 //----------------- GRTDispatcher ------------------------------------------------------------------
 
 static void sleep_2ms() {
@@ -335,7 +563,9 @@ GRTDispatcher::GRTDispatcher(bool threaded, bool is_main_dispatcher)
     _w_runing(0),
     _is_main_dispatcher(is_main_dispatcher),
     _shut_down(false),
-    _started(false) {
+    _started(false),
+    _pool(nullptr),
+    _pool_size(std::max(2U, std::thread::hardware_concurrency()) - 1) {
   _shutdown_callback = false;
 
   if (threaded) {
@@ -422,6 +652,29 @@ void GRTDispatcher::shutdown() {
     logDebug2("Background thread finished\n");
   }
 
+  // Let the pool threads finish their current task. Running tasks might wait for the main thread, so keep
+  // serving callbacks meanwhile (they are not executed anymore at this point).
+  WorkerPool *pool = nullptr;
+  {
+    base::MutexLock lock(_pool_mutex);
+    std::swap(pool, _pool);
+    if (pool != nullptr)
+      pool->stop();
+  }
+
+  if (pool != nullptr) {
+    while (pool->is_running()) {
+      flush_pending_callbacks();
+      g_usleep(1000);
+    }
+
+    // Pool tasks that never started are failed, so that nobody waits for them forever.
+    std::vector<GRTTaskBase::Ref> dropped = pool->take_queued_tasks();
+    delete pool;
+    for (auto &task : dropped)
+      abandon_task(task);
+  }
+
   if (_started && !_grtm.expired())
     _grtm.lock()->remove_dispatcher(shared_from_this());
 
@@ -472,6 +725,7 @@ gpointer GRTDispatcher::worker_thread(gpointer data) {
     delete helper;
 #endif
 
+    self->task_started(task, false, false);
     g_atomic_int_inc(&self->_busy);
     logDebug3("Running task \"%s\"\n", task->name().c_str());
 
@@ -539,11 +793,24 @@ void GRTDispatcher::execute_now(const GRTTaskBase::Ref task) {
 //--------------------------------------------------------------------------------------------------
 
 void GRTDispatcher::add_task(const GRTTaskBase::Ref task) {
+  if (task->affinity() == GRTTaskBase::AnyThread && !_threading_disabled) {
+    base::MutexLock lock(_pool_mutex);
+    if (!_shut_down) {
+      if (_pool == nullptr)
+        _pool = new WorkerPool(this, _pool_size);
+      task_queued(task);
+      _pool->push(task);
+    } else
+      abandon_task(task);
+    return;
+  }
+
   // If threading is disabled or the worker thread is calling another
   // task, we have to execute it immediately otherwise we'd just deadlock.
   if (_threading_disabled || _thread == g_thread_self())
     execute_now(task);
   else {
+    task_queued(task);
     GRTTaskHelper *helper = new GRTTaskHelper(task);
     g_async_queue_push(_task_queue, helper);
   }
@@ -551,6 +818,73 @@ void GRTDispatcher::add_task(const GRTTaskBase::Ref task) {
 
 //--------------------------------------------------------------------------------------------------
 
+void GRTDispatcher::set_pool_size(size_t size) {
+  base::MutexLock lock(_pool_mutex);
+  if (_pool != nullptr)
+    logWarning("Worker pool already running, new pool size (%i) is ignored\n", (int)size);
+  else
+    _pool_size = std::max((size_t)1, size);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void GRTDispatcher::abandon_task(const GRTTaskBase::Ref task) {
+  logDebug3("Task \"%s\" dropped, the dispatcher is shut down\n", task->name().c_str());
+
+  if (task->_queued_time != 0) {
+    task->_queued_time = 0;
+    base::MutexLock lock(_stats_mutex);
+    if (_stats.queued_tasks > 0)
+      --_stats.queued_tasks;
+  }
+
+  if (task->_exception == nullptr)
+    task->_exception = new grt::grt_runtime_error("Task was not run", "The dispatcher was shut down");
+  task->set_finished();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void GRTDispatcher::task_queued(const GRTTaskBase::Ref task) {
+  task->_queued_time = g_get_monotonic_time();
+
+  base::MutexLock lock(_stats_mutex);
+  ++_stats.queued_tasks;
+  if (_stats.queued_tasks > _stats.max_queue_depth)
+    _stats.max_queue_depth = _stats.queued_tasks;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void GRTDispatcher::task_started(const GRTTaskBase::Ref task, bool pooled, bool stolen) {
+  if (task->_queued_time == 0)
+    return;
+
+  gint64 wait_time = g_get_monotonic_time() - task->_queued_time;
+  task->_queued_time = 0;
+
+  base::MutexLock lock(_stats_mutex);
+  if (_stats.queued_tasks > 0)
+    --_stats.queued_tasks;
+  ++_stats.executed_tasks;
+  if (pooled)
+    ++_stats.pooled_tasks;
+  if (stolen)
+    ++_stats.stolen_tasks;
+  _stats.total_wait_time += wait_time;
+  if (wait_time > _stats.max_wait_time)
+    _stats.max_wait_time = wait_time;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+DispatcherStats GRTDispatcher::get_stats() {
+  base::MutexLock lock(_stats_mutex);
+  return _stats;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void GRTDispatcher::cancel_task(const GRTTaskBase::Ref task) {
   task->cancel();
 }
@@ -766,3 +1100,13 @@ void GRTDispatcher::execute_async_function(const std::string &name, const std::f
 }
 
 //--------------------------------------------------------------------------------------------------
+
+void GRTDispatcher::execute_pooled_function(const std::string &name, const std::function<grt::ValueRef()> &function,
+                                            const std::string &ordering_key) {
+  GRTSimpleTask::Ref task(GRTSimpleTask::create_task(name, shared_from_this(), function));
+  task->set_affinity(GRTTaskBase::AnyThread);
+  task->set_ordering_key(ordering_key);
+  add_task(task);
+}
+
+//--------------------------------------------------------------------------------------------------
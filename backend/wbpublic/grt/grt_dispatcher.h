@@ -114,8 +114,29 @@ namespace bec {
   public:
     typedef std::shared_ptr<GRTTaskBase> Ref;
 
+    // Determines which thread(s) may run a task. By default tasks run on the dispatcher's own worker thread,
+    // which is also the thread Python code runs in. Tasks that don't use Python can be allowed to run on any
+    // thread of the dispatcher's worker pool. GRT messages they send are still delivered to the task.
+    enum Affinity { DispatcherThread, AnyThread };
+
     virtual ~GRTTaskBase();
 
+    Affinity affinity() const {
+      return _affinity;
+    }
+    void set_affinity(Affinity affinity) {
+      _affinity = affinity;
+    }
+
+    // Pool tasks with the same (non-empty) ordering key are never run concurrently and are started in the order
+    // they were added. Use e.g. the id of an editor or connection to serialize all work done for it.
+    const std::string &ordering_key() const {
+      return _ordering_key;
+    }
+    void set_ordering_key(const std::string &key) {
+      _ordering_key = key;
+    }
+
     inline bool is_finished() {
       return _finished;
     }
@@ -179,17 +200,25 @@ namespace bec {
         _name(name),
         _cancelled(false),
         _finished(false),
-        _messages_to_main_thread(true) {
+        _messages_to_main_thread(true),
+        _affinity(DispatcherThread),
+        _queued_time(0) {
     }
 
     void set_finished();
 
   private:
+    friend class GRTDispatcher;
+
     std::string _name;
     bool _cancelled;
     bool _finished;
     bool _messages_to_main_thread;
 
+    Affinity _affinity;
+    std::string _ordering_key;
+    gint64 _queued_time; // Monotonic time (in microseconds) when the task was added to a queue.
+
     // Should never be defined and called.
     GRTTaskBase(GRTTaskBase &);
     GRTTaskBase &operator=(GRTTaskBase &);
@@ -289,12 +318,37 @@ namespace bec {
 
   //------------------------------------------------------------------------------------------------
 
+  // Queue statistics of a dispatcher, covering both its own worker thread and the worker pool.
+  struct DispatcherStats {
+    size_t queued_tasks;    // Tasks currently waiting to be started.
+    size_t max_queue_depth; // Highest number of waiting tasks seen so far.
+    size_t executed_tasks;
+    size_t pooled_tasks;    // Executed tasks that ran in the worker pool.
+    size_t stolen_tasks;    // Pool tasks taken from the queue of another pool thread.
+    gint64 total_wait_time; // Sum of the times tasks waited to be started, in microseconds.
+    gint64 max_wait_time;   // Longest time a task waited to be started, in microseconds.
+
+    DispatcherStats()
+      : queued_tasks(0),
+        max_queue_depth(0),
+        executed_tasks(0),
+        pooled_tasks(0),
+        stolen_tasks(0),
+        total_wait_time(0),
+        max_wait_time(0) {
+    }
+  };
+
+  //------------------------------------------------------------------------------------------------
+
   class WBPUBLICBACKEND_PUBLIC_FUNC GRTDispatcher : public std::enable_shared_from_this<GRTDispatcher> {
   public:
     typedef void (*FlushAndWaitCallback)();
     typedef std::shared_ptr<GRTDispatcher> Ref;
 
   private:
+    class WorkerPool;
+
     GAsyncQueue *_task_queue;
     FlushAndWaitCallback _flush_main_thread_and_wait;
     std::weak_ptr<bec::GRTManager> _grtm;
@@ -315,8 +369,20 @@ namespace bec {
 
     GRTTaskBase::Ref _current_task;
 
+    // Pool for tasks with AnyThread affinity. Created on first use.
+    WorkerPool *_pool;
+    size_t _pool_size;
+    base::Mutex _pool_mutex; // Guards _pool, so that no task is pushed while the pool is shut down.
+
+    base::Mutex _stats_mutex;
+    DispatcherStats _stats;
+
     GRTDispatcher(bool threaded, bool is_main_dispatcher);
 
+    void task_queued(const GRTTaskBase::Ref task);
+    void task_started(const GRTTaskBase::Ref task, bool pooled, bool stolen);
+    void abandon_task(const GRTTaskBase::Ref task);
+
     void prepare_task(const GRTTaskBase::Ref task);
     void execute_task(const GRTTaskBase::Ref task);
 
@@ -342,6 +408,18 @@ namespace bec {
 
     void execute_async_function(const std::string &name, const std::function<grt::ValueRef()> &function);
 
+    // Runs the function asynchronously in the worker pool. See GRTTaskBase::set_ordering_key for the key.
+    void execute_pooled_function(const std::string &name, const std::function<grt::ValueRef()> &function,
+                                 const std::string &ordering_key = "");
+
+    // Number of pool threads for AnyThread tasks. Must be set before the first such task is added.
+    void set_pool_size(size_t size);
+    size_t get_pool_size() const {
+      return _pool_size;
+    }
+
+    DispatcherStats get_stats();
+
     void wait_task(const GRTTaskBase::Ref task);
 
     template <class R>
@@ -110,6 +110,10 @@ void GrtThreadedTask::exec(bool sync, Proc_cb proc_cb) {
   bec::GRTDispatcher::Ref dispatcher = this->dispatcher();
 
   _task = bec::GRTTask::create_task(desc(), dispatcher, proc_cb);
+  if (!_ordering_key.empty()) {
+    _task->set_affinity(bec::GRTTaskBase::AnyThread);
+    _task->set_ordering_key(_ordering_key);
+  }
 
   scoped_connect(_task->signal_message(), std::bind(&GrtThreadedTask::process_msg, this, std::placeholders::_1));
   scoped_connect(_task->signal_failed(), std::bind(&GrtThreadedTask::process_fail, this, std::placeholders::_1));
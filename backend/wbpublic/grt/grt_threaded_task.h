@@ -84,6 +84,19 @@ public:
 private:
   std::string _desc;
 
+public:
+  // If set, the task runs in the dispatcher's worker pool instead of its thread. Tasks with the same key
+  // (e.g. the connection they use) still run one after the other, in the order they were started.
+  const std::string &ordering_key() {
+    return _ordering_key;
+  }
+  void ordering_key(const std::string &key) {
+    _ordering_key = key;
+  }
+
+private:
+  std::string _ordering_key;
+
 public:
   void send_task_res_msg(bool value) {
     _send_task_res_msg = value;
@@ -27,6 +27,10 @@
 #include "grt/grt_manager.h"
 
 #include <algorithm>
+#include <atomic>
+#include <map>
+#include <set>
+#include <thread>
 
 DEFAULT_LOG_DOMAIN("validation")
 
@@ -156,6 +160,132 @@ void bec::ValidationMessagesBE::validation_message(const grt::Validator::Tag& ta
 
 bec::ValidationManager::MessageSignal* bec::ValidationManager::_signal_notify = 0;
 
+namespace {
+
+  // What validate_tree() knows about an object. Only used on the main thread.
+  struct ValidationEntry {
+    ValidationEntry() = default;
+    ValidationEntry(const ValidationEntry&) = delete;
+    ValidationEntry& operator=(const ValidationEntry&) = delete;
+
+    ~ValidationEntry() {
+      for (auto& connection : connections)
+        connection.disconnect();
+    }
+
+    const grt::internal::Value* object = nullptr;
+    std::map<grt::Validator::Tag, bool> results; // Cached results, dropped when the object changes.
+    std::vector<boost::signals2::connection> connections;
+  };
+
+  struct PendingMessage {
+    grt::Validator::Tag tag;
+    grt::ObjectRef object;
+    std::string text;
+    int level;
+  };
+
+  std::map<std::string, ValidationEntry> validationCache; // Keyed by object id.
+
+  grt::ObjectRef watchedRoot;
+  std::vector<grt::Validator::Tag> watchedTags;
+  bool revalidationPending = false;
+
+  // Set while validators run in validate_tree(). Their messages are sent from the main thread afterwards,
+  // in tree order, no matter which thread validated an object.
+  thread_local std::vector<PendingMessage>* collectedMessages = nullptr;
+
+  // Batches with at least this many objects are validated on several threads.
+  const size_t PARALLEL_VALIDATION_THRESHOLD = 64;
+
+  // Validators of this class and its parents are not applied.
+  grt::MetaClass* validationBaseClass() {
+    static grt::MetaClass* mc = grt::GRT::get()->get_metaclass("db.DatabaseObject");
+    return mc;
+  }
+
+  bool hasValidators(const grt::ObjectRef& object) {
+    for (grt::MetaClass* mc = object.get_metaclass(); mc && mc != validationBaseClass(); mc = mc->parent()) {
+      if (mc->has_validators())
+        return true;
+    }
+    return false;
+  }
+
+  bool anyValidators() {
+    for (auto mc : grt::GRT::get()->get_metaclasses()) {
+      if (mc->has_validators())
+        return true;
+    }
+    return false;
+  }
+
+  // Collects object and everything owned by it, in tree order, together with the owner of each object.
+  void collectObjects(const grt::ObjectRef& object, const grt::ObjectRef& owner, std::vector<grt::ObjectRef>& objects,
+                      std::vector<grt::ObjectRef>& owners, std::set<const grt::internal::Value*>& visited) {
+    if (!visited.insert(object.valueptr()).second)
+      return;
+
+    objects.push_back(object);
+    owners.push_back(owner);
+
+    auto collect = [&](const grt::ValueRef& value) {
+      if (value.is_valid() && value.type() == grt::ObjectType)
+        collectObjects(grt::ObjectRef::cast_from(value), object, objects, owners, visited);
+    };
+
+    object.get_metaclass()->foreach_member([&](const grt::MetaClass::Member* member) {
+      if (!member->owned_object || member->calculated || member->delegate_get)
+        return true;
+
+      grt::ValueRef value(object.get_member(member->name));
+      if (!value.is_valid())
+        return true;
+
+      switch (value.type()) {
+        case grt::ObjectType:
+          collect(value);
+          break;
+
+        case grt::ListType: {
+          grt::BaseListRef list(grt::BaseListRef::cast_from(value));
+          for (size_t c = list.count(), i = 0; i < c; i++)
+            collect(list[i]);
+          break;
+        }
+
+        case grt::DictType: {
+          grt::DictRef dict(grt::DictRef::cast_from(value));
+          for (grt::DictRef::const_iterator iter = dict.begin(); iter != dict.end(); ++iter)
+            collect(iter->second);
+          break;
+        }
+
+        default:
+          break;
+      }
+      return true;
+    });
+  }
+
+  // Any change of the object itself, its lists or dicts drops the cached results (see ValidationManager::invalidate).
+  void connectChangeSignals(const grt::ObjectRef& object, ValidationEntry& entry) {
+    grt::internal::Object* raw = static_cast<grt::internal::Object*>(object.valueptr());
+
+    entry.connections.push_back(object->signal_changed()->connect(
+      [raw](const std::string&, const grt::ValueRef&) { bec::ValidationManager::invalidate(grt::ObjectRef(raw)); }));
+    entry.connections.push_back(
+      object->signal_list_changed()->connect([raw](grt::internal::OwnedList*, bool, const grt::ValueRef&) {
+        bec::ValidationManager::invalidate(grt::ObjectRef(raw));
+      }));
+    entry.connections.push_back(
+      object->signal_dict_changed()->connect([raw](grt::internal::OwnedDict*, bool, const std::string&) {
+        bec::ValidationManager::invalidate(grt::ObjectRef(raw));
+      }));
+  }
+
+}
+
 //--------------------------------------------------------------------------------------------------
 
 bool bec::ValidationManager::is_validation_plugin(const app_PluginRef& plugin) {
@@ -195,15 +325,25 @@ void bec::ValidationManager::scan() {
 //--------------------------------------------------------------------------------------------------
 
 bool bec::ValidationManager::validate_instance(const grt::ObjectRef& obj, const grt::Validator::Tag& tag) {
-  bool ret = true;
-
   // Clear messages with corresponding tag from the object.
   (*signal_notify())(tag, obj, tag, grt::NoErrorMsg);
 
-  static const grt::MetaClass* mc_to_break_checks = grt::GRT::get()->get_metaclass("db.DatabaseObject");
-  grt::MetaClass* mc = obj->get_metaclass();
+  bool ret = run_validators(obj, tag);
+
+  auto entry = validationCache.find(obj.id());
+  if (entry != validationCache.end() && entry->second.object == obj.valueptr())
+    entry->second.results[tag] = ret;
+
+  return ret;
+}
+
+//--------------------------------------------------------------------------------------------------
 
-  while (mc && mc != mc_to_break_checks) {
+bool bec::ValidationManager::run_validators(const grt::ObjectRef& obj, const grt::Validator::Tag& tag) {
+  bool ret = true;
+
+  grt::MetaClass* mc = obj->get_metaclass();
+  while (mc && mc != validationBaseClass()) {
     if (!mc->foreach_validator(obj, tag))
       ret = false;
     mc = mc->parent();
@@ -213,15 +353,186 @@ bool bec::ValidationManager::validate_instance(const grt::ObjectRef& obj, const
 
 //--------------------------------------------------------------------------------------------------
 
+bool bec::ValidationManager::validate_tree(const grt::ObjectRef& root, const grt::Validator::Tag& tag,
+                                           unsigned threads) {
+  return validate_tree(root, std::vector<grt::Validator::Tag>(1, tag), threads);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool bec::ValidationManager::validate_tree(const grt::ObjectRef& root, const std::vector<grt::Validator::Tag>& tags,
+                                           unsigned threads) {
+  // Nothing to do (and nothing to watch) as long as no validator is registered.
+  if (!root.is_valid() || !anyValidators())
+    return true;
+
+  std::vector<grt::ObjectRef> objects, owners;
+  std::set<const grt::internal::Value*> visited;
+  collectObjects(root, grt::ObjectRef(), objects, owners, visited);
+
+  // Objects without validators are watched too if their owner has some, as the owner's checks usually
+  // look at them (e.g. the columns of a table).
+  bool ret = true;
+  std::vector<std::pair<size_t, grt::Validator::Tag>> pending;
+  std::set<std::string> ids;
+  for (size_t i = 0; i < objects.size(); ++i) {
+    bool validated = hasValidators(objects[i]);
+    if (!validated && !(owners[i].is_valid() && hasValidators(owners[i])))
+      continue;
+
+    ids.insert(objects[i].id());
+    ValidationEntry& entry = validationCache[objects[i].id()];
+    if (entry.object != objects[i].valueptr()) {
+      for (auto& connection : entry.connections)
+        connection.disconnect();
+      entry.connections.clear();
+      entry.results.clear();
+      entry.object = objects[i].valueptr();
+      connectChangeSignals(objects[i], entry);
+    }
+
+    if (!validated)
+      continue;
+
+    for (auto& tag : tags) {
+      auto result = entry.results.find(tag);
+      if (result == entry.results.end())
+        pending.push_back({ i, tag });
+      else if (!result->second)
+        ret = false;
+    }
+  }
+
+  // Drop what we know about objects which are gone from the watched tree.
+  if (root == watchedRoot) {
+    for (auto iter = validationCache.begin(); iter != validationCache.end();) {
+      if (ids.find(iter->first) == ids.end())
+        iter = validationCache.erase(iter);
+      else
+        ++iter;
+    }
+  }
+
+  if (pending.empty())
+    return ret;
+
+  // Validators only read the model, so objects can be validated in parallel. Messages are collected
+  // and sent afterwards from this thread.
+  validationBaseClass();
+  std::vector<std::vector<PendingMessage>> messages(pending.size());
+  std::vector<char> results(pending.size(), 1);
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t i = next++; i < pending.size(); i = next++) {
+      collectedMessages = &messages[i];
+      try {
+        results[i] = run_validators(objects[pending[i].first], pending[i].second);
+      } catch (std::exception& exc) {
+        logError("Validation of %s failed: %s\n", objects[pending[i].first].id().c_str(), exc.what());
+        results[i] = 0;
+      }
+      collectedMessages = nullptr;
+    }
+  };
+
+  size_t thread_count = threads;
+  if (thread_count == 0)
+    thread_count = std::max(1U, std::thread::hardware_concurrency());
+
+  std::vector<std::thread> workers;
+  if (pending.size() >= PARALLEL_VALIDATION_THRESHOLD) {
+    for (size_t i = 1; i < std::min(thread_count, pending.size()); ++i)
+      workers.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : workers)
+    thread.join();
+
+  for (size_t i = 0; i < pending.size(); ++i) {
+    const grt::ObjectRef& object = objects[pending[i].first];
+    const grt::Validator::Tag& tag = pending[i].second;
+
+    (*signal_notify())(tag, object, tag, grt::NoErrorMsg);
+    for (auto& message : messages[i])
+      (*signal_notify())(message.tag, message.object, message.text, message.level);
+
+    auto entry = validationCache.find(object.id());
+    if (entry != validationCache.end())
+      entry->second.results[tag] = results[i] != 0;
+    if (!results[i])
+      ret = false;
+  }
+
+  return ret;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Drops the cached results of the object and of all its owners, whose checks may depend on it.
+ */
+void bec::ValidationManager::invalidate(const grt::ObjectRef& obj) {
+  bool changed = false;
+
+  grt::ObjectRef object(obj);
+  while (object.is_valid()) {
+    auto entry = validationCache.find(object.id());
+    if (entry != validationCache.end() && !entry->second.results.empty()) {
+      entry->second.results.clear();
+      changed = true;
+    }
+
+    if (!object.has_member("owner"))
+      break;
+
+    grt::ValueRef owner(object.get_member("owner"));
+    object = owner.is_valid() && owner.type() == grt::ObjectType ? grt::ObjectRef::cast_from(owner) : grt::ObjectRef();
+  }
+
+  // Changes come in bursts (e.g. while typing or during undo), validate once things settle down.
+  if (changed && watchedRoot.is_valid() && !revalidationPending) {
+    revalidationPending = true;
+    bec::GRTManager::get()->run_once_when_idle(&bec::ValidationManager::revalidate_watched);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void bec::ValidationManager::watch(const grt::ObjectRef& root, const std::vector<grt::Validator::Tag>& tags) {
+  watchedRoot = root;
+  watchedTags = tags;
+
+  if (!revalidationPending) {
+    revalidationPending = true;
+    bec::GRTManager::get()->run_once_when_idle(&bec::ValidationManager::revalidate_watched);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void bec::ValidationManager::revalidate_watched() {
+  revalidationPending = false;
+  if (watchedRoot.is_valid())
+    validate_tree(watchedRoot, watchedTags);
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void bec::ValidationManager::message(const grt::Validator::Tag& tag, const grt::ObjectRef& o, const std::string& m,
                                      const int level) {
-  // Add message to the Object
-  (*signal_notify())(tag, o, m, level);
+  if (collectedMessages != nullptr)
+    collectedMessages->push_back({ tag, o, m, level });
+  else // Add message to the Object
+    (*signal_notify())(tag, o, m, level);
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void bec::ValidationManager::clear() {
+  validationCache.clear();
+  watchedRoot = grt::ObjectRef();
+  watchedTags.clear();
+
   // Clear messages from listeners
   (*signal_notify())("*", grt::ObjectRef(), "", grt::NoErrorMsg);
 }
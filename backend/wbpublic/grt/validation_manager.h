@@ -29,6 +29,7 @@
 #include "tree_model.h"
 #include "refresh_ui.h"
 #include <deque>
+#include <vector>
 
 // Common tag names
 #define CHECK_NAME "name"
@@ -93,13 +94,26 @@ namespace bec {
     static void register_validator(const std::string& type, grt::Validator* v);
     static bool validate_instance(const grt::ObjectRef& obj, const grt::Validator::Tag& tag);
 
+    // Validates root and all objects owned by it. Results are cached per object and tag and dropped when
+    // the object (or an object owned by it) changes, so only changed objects are validated again.
+    // Large batches are validated on several threads (threads == 0 means one per processor).
+    static bool validate_tree(const grt::ObjectRef& root, const grt::Validator::Tag& tag, unsigned threads = 0);
+    static bool validate_tree(const grt::ObjectRef& root, const std::vector<grt::Validator::Tag>& tags,
+                              unsigned threads = 0);
+    static void invalidate(const grt::ObjectRef& obj);
+
+    // Keeps the results for root up to date: changed objects are validated again when the application is idle.
+    static void watch(const grt::ObjectRef& root, const std::vector<grt::Validator::Tag>& tags);
+
     static MessageSignal* signal_notify();
     static void message(const grt::Validator::Tag&, const grt::ObjectRef&, const std::string&,
                         const int level); // level is grt::MessageType
-    static void clear();
+    static void clear(); // Also drops all cached results and stops watching.
 
   private:
     static bool is_validation_plugin(const app_PluginRef& plugin);
+    static bool run_validators(const grt::ObjectRef& obj, const grt::Validator::Tag& tag);
+    static void revalidate_watched();
 
     static MessageSignal* _signal_notify;
   };
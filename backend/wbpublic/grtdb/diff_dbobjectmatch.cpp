@@ -203,6 +203,46 @@ bool grt::DbObjectMatchAlterOmf::equal(const ValueRef& l, const ValueRef& r) con
   return std::equal_to<grt::ValueRef>()(l, r);
 }
 
+// Follows the branches of equal() above.
+bool grt::DbObjectMatchAlterOmf::match_key(const ValueRef& value, std::string& key) const {
+  if (value.type() == ObjectType) {
+    if (db_IndexColumnRef::can_wrap(value)) {
+      if (!match_key(db_IndexColumnRef::cast_from(value)->referencedColumn(), key))
+        return false;
+      key.insert(0, "c");
+      return true;
+    } else if (db_mysql_SchemaRef::can_wrap(value)) {
+      key = "s" + *db_mysql_SchemaRef::cast_from(value)->name();
+      return true;
+    } else if (GrtNamedObjectRef::can_wrap(value)) {
+      GrtNamedObjectRef object = GrtNamedObjectRef::cast_from(value);
+      if (!object->owner().is_valid())
+        return false;
+
+      if (strlen(object->oldName().c_str()) > 0)
+        key = "n" + get_qualified_schema_object_old_name(object, case_sensitive);
+      else
+        key = "n" + get_qualified_schema_object_name(object, case_sensitive);
+      return true;
+    } else if (GrtObjectRef::can_wrap(value)) {
+      key = "o" + *GrtObjectRef::cast_from(value)->name();
+      return true;
+    } else if (ObjectRef::can_wrap(value)) {
+      ObjectRef object = ObjectRef::cast_from(value);
+      if (!object.has_member("oldName"))
+        return false;
+
+      std::string name = object.get_string_member("oldName");
+      if (name.empty())
+        name = object.get_string_member("name");
+      key = "x" + object.class_name() + "." + name;
+      return true;
+    }
+  }
+
+  return simple_match_key(value, key);
+}
+
 //--------------------------------------------------------------------------------------------------
 
 bool sqlCompare(const ValueRef obj1, const ValueRef obj2, const std::string& name) {
@@ -800,8 +840,12 @@ void grt::NormalizedComparer::load_rules() {
 };
 
 bool grt::NormalizedComparer::normalizedComparison(const ValueRef obj1, const ValueRef obj2, const std::string name) {
-  std::list<comparison_rule>& rul_list = rules[name];
-  for (std::list<comparison_rule>::iterator It = rul_list.begin(); It != rul_list.end(); ++It)
+  // Lookup only, comparisons may run on several diff threads at once.
+  std::map<std::string, std::list<comparison_rule> >::const_iterator rule = rules.find(name);
+  if (rule == rules.end())
+    return false;
+  const std::list<comparison_rule>& rul_list = rule->second;
+  for (std::list<comparison_rule>::const_iterator It = rul_list.begin(); It != rul_list.end(); ++It)
     if ((*It)(obj1, obj2, name))
       return true;
   return false;
@@ -812,6 +856,10 @@ void grt::NormalizedComparer::init_omf(Omf* omf) {
   omf->skip_routine_definer = _skip_routine_definer;
   omf->normalizer = std::bind(&NormalizedComparer::normalizedComparison, this, std::placeholders::_1,
                               std::placeholders::_2, std::placeholders::_3);
+
+  // The engine list is loaded lazily on first use, make sure that doesn't happen on a diff worker thread.
+  if (grt::GRT::get()->get_module("DbMySQL"))
+    bec::TableHelper::get_engine_by_name("");
 };
 
 // TODO: This shouldn't be here but rather in DBPlugin, but QE doesn't use that
@@ -41,6 +41,7 @@ namespace grt {
   struct WBPUBLICBACKEND_PUBLIC_FUNC DbObjectMatchAlterOmf : public Omf {
     virtual bool less(const ValueRef&, const ValueRef&) const;
     virtual bool equal(const ValueRef&, const ValueRef&) const;
+    virtual bool match_key(const ValueRef&, std::string&) const;
   };
 
   typedef std::function<bool(const ValueRef obj1, const ValueRef obj2, const std::string name)> comparison_rule;
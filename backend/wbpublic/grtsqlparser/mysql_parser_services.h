@@ -111,7 +111,8 @@ namespace parsers {
     virtual size_t determineStatementRanges(const char *sql, size_t length,
                                             const std::string &initialDelimiter,
                                             std::vector<StatementRange> &ranges,
-                                            const std::string &lineBreak = "\n") = 0;
+                                            const std::string &lineBreak = "\n",
+                                            std::string *endDelimiter = nullptr) = 0;
 
     virtual grt::DictRef parseStatement(MySQLParserContext::Ref context, const std::string &sql) = 0;
 
@@ -128,7 +129,8 @@ namespace parsers {
     // Others.
     virtual std::vector<std::pair<int, std::string>> getCodeCompletionCandidates(
       MySQLParserContext::Ref context, std::pair<size_t, size_t> caret, std::string const &sql,
-      std::string const &defaultSchema, bool uppercaseKeywords, parsers::SymbolTable &symbolTable) = 0;
+      std::string const &defaultSchema, bool uppercaseKeywords, parsers::SymbolTable &symbolTable,
+      std::string const &typedPart) = 0;
   };
 
 } // namespace parsers
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "base/string_utilities.h"
+
+#include "mysql_parser_services.h"
+#include "sql_script_reader.h"
+
+using namespace parsers;
+
+//--------------------------------------------------------------------------------------------------
+
+SqlScriptReader::SqlScriptReader(const std::string &path, const std::string &delimiter, size_t chunkSize)
+  : _chunkSize(chunkSize),
+    _size(0),
+    _offset(0),
+    _scanThreshold(0),
+    _delimiter(delimiter),
+    _line(0),
+    _finished(false) {
+#ifdef _MSC_VER
+  _stream.open(base::string_to_wstring(path).c_str(), std::ios::binary | std::ios::ate);
+#else
+  _stream.open(path.c_str(), std::ios::binary | std::ios::ate);
+#endif
+  if (!_stream.is_open())
+    throw std::runtime_error(base::strfmt("Could not open file %s", path.c_str()));
+
+  _size = (std::uint64_t)_stream.tellg();
+  _stream.seekg(0);
+
+  // Skip a UTF-8 byte order mark, the server would choke on it.
+  char bom[3] = { 0 };
+  if (!_stream.read(bom, 3) || (unsigned char)bom[0] != 0xEF || (unsigned char)bom[1] != 0xBB ||
+      (unsigned char)bom[2] != 0xBF) {
+    _stream.clear();
+    _stream.seekg(0);
+  } else
+    _offset = 3;
+
+  _pendingChunk = std::async(std::launch::async, &SqlScriptReader::readChunk, this);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+SqlScriptReader::~SqlScriptReader() {
+  if (_pendingChunk.valid())
+    _pendingChunk.wait();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the next statement from the script (and optionally the line it starts on, 0-based), or false
+ * if the end of the file was reached.
+ */
+bool SqlScriptReader::next(std::string &statement, size_t *line) {
+  while (_statements.empty()) {
+    if (!splitNextChunk())
+      return false;
+  }
+
+  Statement &front = _statements.front();
+  statement.swap(front.text);
+  if (line != nullptr)
+    *line = front.line;
+  _statements.pop_front();
+
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Runs in a background thread, while the caller works on the statements of the previous chunk.
+ */
+std::string SqlScriptReader::readChunk() {
+  std::string chunk(_chunkSize, '\0');
+  _stream.read(&chunk[0], (std::streamsize)_chunkSize);
+  chunk.resize((size_t)_stream.gcount());
+  return chunk;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Appends the next chunk to the unprocessed text and moves all complete statements from it to the
+ * statement queue. Returns false once the entire file was processed.
+ */
+bool SqlScriptReader::splitNextChunk() {
+  if (_finished)
+    return false;
+
+  std::string chunk = _pendingChunk.get();
+  bool lastChunk = chunk.empty();
+  if (!lastChunk)
+    _pendingChunk = std::async(std::launch::async, &SqlScriptReader::readChunk, this);
+
+  _buffer += chunk;
+  chunk.clear();
+
+  // Only split complete lines, so a DELIMITER command is never cut. Text after the last statement delimiter
+  // is scanned again with the next chunk, so for statements larger than a chunk we wait until
+  // the buffer has grown enough to keep rescanning linear.
+  size_t scanLength = _buffer.size();
+  if (!lastChunk) {
+    if (_buffer.size() < _scanThreshold)
+      return true;
+
+    size_t lineEnd = _buffer.rfind('\n');
+    if (lineEnd == std::string::npos)
+      return true;
+    scanLength = lineEnd + 1;
+  }
+
+  // The splitter looks ahead a few characters and must not see the text after the scanned range.
+  char terminator = _buffer[scanLength];
+  _buffer[scanLength] = '\0';
+
+  std::vector<StatementRange> ranges;
+  std::string delimiter;
+  size_t consumed = MySQLParserServices::get()->determineStatementRanges(_buffer.c_str(), scanLength, _delimiter,
+                                                                         ranges, "\n", &delimiter);
+  if (scanLength < _buffer.size())
+    _buffer[scanLength] = terminator;
+
+  if (lastChunk)
+    consumed = scanLength; // Whatever follows the last delimiter is the final statement.
+
+  for (auto &range : ranges) {
+    if (range.start >= consumed)
+      break;
+    _statements.push_back({ _line + range.line, _buffer.substr(range.start, range.length) });
+  }
+
+  _line += std::count(_buffer.begin(), _buffer.begin() + consumed, '\n');
+  _offset += consumed;
+  _delimiter = delimiter;
+  _buffer.erase(0, consumed);
+  _scanThreshold = consumed == 0 ? 2 * _buffer.size() : 0;
+
+  if (lastChunk)
+    _finished = true;
+
+  return true;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include "wbpublic_public_interface.h"
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <string>
+
+namespace parsers {
+
+  /**
+   * Reads a SQL script file in chunks and hands out its statements one by one, so that scripts of any size
+   * can be executed without loading them into memory. Splitting is done with determineStatementRanges(),
+   * which tells how far it got with complete statements, so the rest is carried over to the next chunk
+   * (together with the delimiter in effect, to support DELIMITER commands).
+   *
+   * The next chunk is read in the background while the statements of the current one are processed.
+   */
+  class WBPUBLICBACKEND_PUBLIC_FUNC SqlScriptReader {
+  public:
+    static const size_t DefaultChunkSize = 4 * 1024 * 1024;
+
+    SqlScriptReader(const std::string &path, const std::string &delimiter = ";",
+                    size_t chunkSize = DefaultChunkSize);
+    ~SqlScriptReader();
+
+    bool next(std::string &statement, size_t *line = nullptr);
+
+    std::uint64_t size() const {
+      return _size;
+    }
+
+    // Number of bytes in the file which have been split into statements so far.
+    std::uint64_t offset() const {
+      return _offset;
+    }
+
+    float progress() const {
+      return _size > 0 ? (float)((double)_offset / _size) : 1.f;
+    }
+
+  private:
+    struct Statement {
+      size_t line;
+      std::string text;
+    };
+
+    std::ifstream _stream;
+    std::future<std::string> _pendingChunk;
+    size_t _chunkSize;
+    std::uint64_t _size;
+    std::uint64_t _offset;
+
+    std::string _buffer;    // Text read from the file, which has not yet been split into statements.
+    size_t _scanThreshold;  // Minimum buffer size before splitting again (grows for statements spanning chunks).
+    std::string _delimiter;
+    size_t _line;           // Line number of the first character in _buffer.
+    std::deque<Statement> _statements;
+    bool _finished;
+
+    std::string readChunk();
+    bool splitNextChunk();
+  };
+
+} // namespace parsers
@@ -391,8 +391,13 @@ void WizardProgressPage::extra_clicked() {
 
 //--------------------------------------------------------------------------------------------------
 
-void WizardProgressPage::execute_grt_task(const std::function<grt::ValueRef()> &slot, bool sync) {
+void WizardProgressPage::execute_grt_task(const std::function<grt::ValueRef()> &slot, bool sync,
+                                          const std::string &ordering_key) {
   bec::GRTTask::Ref task = bec::GRTTask::create_task("wizard task", bec::GRTManager::get()->get_dispatcher(), slot);
+  if (!ordering_key.empty()) {
+    task->set_affinity(bec::GRTTaskBase::AnyThread);
+    task->set_ordering_key(ordering_key);
+  }
 
   // We hold an extra ptr for the task so it's not released too early
   _task_list.insert(std::make_pair(task.get(), task));
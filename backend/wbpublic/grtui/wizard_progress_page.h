@@ -122,7 +122,10 @@ namespace grtui {
                       const std::string &status_text);
 
   public:
-    void execute_grt_task(const std::function<grt::ValueRef()> &slot, bool sync);
+    // A non-empty ordering key runs the task in the worker pool, after earlier tasks with the same key.
+    // Only for tasks that don't touch shared GRT objects, like fetching data through their own connection.
+    void execute_grt_task(const std::function<grt::ValueRef()> &slot, bool sync,
+                          const std::string &ordering_key = "");
 
     void process_grt_task_message(const grt::Message &msg);
     void process_grt_task_fail(const std::exception &error, bec::GRTTask *task);
@@ -26,41 +26,104 @@
 #include "grtpp_util.h"
 #include "grtpp_undo_manager.h"
 
+#include "objimpl/db/db_ForeignKey_impl.h"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
 //================================================================================
 // db_ForeignKey
 
-// don't hold reference to the fk!
-static std::map<grt::internal::Value *, std::set<db_ForeignKey *> > referenced_table_to_fk;
+namespace {
+
+  // Maps referenced tables to the foreign keys pointing to them. Foreign keys don't hold a reference here, they
+  // remove themselves when they are destroyed or get another referenced table. The referenced table can't go
+  // away before that, as the foreign key holds a reference to it.
+  // The map is split into shards with their own lock, so that threads working on different tables (e.g. while
+  // importing or diffing catalogs in parallel) rarely wait for each other.
+  class ForeignKeyIndex {
+  public:
+    void add(const grt::internal::Value *table, db_ForeignKey *fk) {
+      Shard &shard = shard_for(table);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      std::vector<db_ForeignKey *> &fks = shard.tables[table];
+      if (std::find(fks.begin(), fks.end(), fk) == fks.end())
+        fks.push_back(fk);
+    }
+
+    void remove(const grt::internal::Value *table, db_ForeignKey *fk) {
+      Shard &shard = shard_for(table);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto iter = shard.tables.find(table);
+      if (iter != shard.tables.end()) {
+        iter->second.erase(std::remove(iter->second.begin(), iter->second.end(), fk), iter->second.end());
+
+        // if no more FKs to this table, remove the entry
+        if (iter->second.empty())
+          shard.tables.erase(iter);
+      }
+    }
+
+    std::vector<db_ForeignKeyRef> get(const grt::internal::Value *table) {
+      std::vector<db_ForeignKeyRef> result;
+
+      Shard &shard = shard_for(table);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto iter = shard.tables.find(table);
+      if (iter != shard.tables.end()) {
+        result.reserve(iter->second.size());
+        for (db_ForeignKey *fk : iter->second) {
+          // Skip keys which are just being destroyed on another thread (they wait for our lock to unregister).
+          if (fk->retain_if_alive() != nullptr) {
+            result.push_back(db_ForeignKeyRef(fk));
+            fk->release();
+          }
+        }
+      }
+      return result;
+    }
+
+    bool contains(const grt::internal::Value *table) {
+      Shard &shard = shard_for(table);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      return shard.tables.find(table) != shard.tables.end();
+    }
+
+  private:
+    struct Shard {
+      std::mutex mutex;
+      std::unordered_map<const grt::internal::Value *, std::vector<db_ForeignKey *> > tables;
+    };
+
+    static const size_t SHARD_COUNT = 64;
+    Shard _shards[SHARD_COUNT];
+
+    Shard &shard_for(const grt::internal::Value *table) {
+      // Objects are at least 16 byte aligned, the lowest bits carry no information.
+      return _shards[(reinterpret_cast<uintptr_t>(table) >> 4) % SHARD_COUNT];
+    }
+  };
+
+  // Never destroyed: foreign keys may still unregister while static objects are torn down at exit.
+  ForeignKeyIndex &referenced_table_index() {
+    static ForeignKeyIndex *index = new ForeignKeyIndex();
+    return *index;
+  }
+
+}
 
 void db_ForeignKey::init() {
 }
 
 void delete_foreign_key_mapping(const db_TableRef &table, db_ForeignKey *fk) {
-  if (table.is_valid()) {
-    grt::internal::Value *t = table.valueptr();
-    std::map<grt::internal::Value *, std::set<db_ForeignKey *> >::iterator iter = referenced_table_to_fk.find(t);
-    if (iter != referenced_table_to_fk.end()) {
-      if (iter->second.find(fk) != iter->second.end())
-        iter->second.erase(iter->second.find(fk));
-
-      // if no more FKs to this table, remove the entry
-      if (iter->second.empty())
-        referenced_table_to_fk.erase(iter);
-    }
-  }
+  if (table.is_valid())
+    referenced_table_index().remove(table.valueptr(), fk);
 }
 
 void add_foreign_key_mapping(const db_TableRef &table, db_ForeignKey *fk) {
-  if (table.is_valid()) {
-    std::set<db_ForeignKey *> list;
-    std::map<grt::internal::Value *, std::set<db_ForeignKey *> >::iterator iter;
-    if ((iter = referenced_table_to_fk.find(table.valueptr())) != referenced_table_to_fk.end()) {
-      iter->second.insert(fk);
-    } else {
-      list.insert(fk);
-      referenced_table_to_fk[table.valueptr()] = list;
-    }
-  }
+  if (table.is_valid())
+    referenced_table_index().add(table.valueptr(), fk);
 }
 
 db_ForeignKey::~db_ForeignKey() {
@@ -68,15 +131,21 @@ db_ForeignKey::~db_ForeignKey() {
     delete_foreign_key_mapping(_referencedTable, this);
 }
 
+std::vector<db_ForeignKeyRef> foreign_keys_referencing_table(const db_TableRef &table) {
+  if (!table.is_valid())
+    return std::vector<db_ForeignKeyRef>();
+  return referenced_table_index().get(table.valueptr());
+}
+
+bool is_table_referenced(const db_TableRef &table) {
+  return table.is_valid() && referenced_table_index().contains(table.valueptr());
+}
+
 grt::ListRef<db_ForeignKey> get_foreign_keys_referencing_table(const db_TableRef &value) {
-  std::map<grt::internal::Value *, std::set<db_ForeignKey *> >::const_iterator iter;
   grt::ListRef<db_ForeignKey> result(true);
 
-  if ((iter = referenced_table_to_fk.find(value.valueptr())) != referenced_table_to_fk.end()) {
-    for (std::set<db_ForeignKey *>::const_iterator fk = iter->second.begin(); fk != iter->second.end(); ++fk) {
-      result.insert(db_ForeignKeyRef(*fk));
-    }
-  }
+  for (auto &fk : foreign_keys_referencing_table(value))
+    result.insert(fk);
   return result;
 }
 
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2007, 2018, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include "grts/structs.db.h"
+#include "wbpublic_public_interface.h"
+
+#include <vector>
+
+// Back-references from tables to the foreign keys referencing them. The index is thread-safe, so catalogs
+// can be built and inspected on several threads.
+
+// Returns the foreign keys currently referencing table, without creating a GRT list.
+WBPUBLICBACKEND_PUBLIC_FUNC std::vector<db_ForeignKeyRef> foreign_keys_referencing_table(const db_TableRef &table);
+WBPUBLICBACKEND_PUBLIC_FUNC bool is_table_referenced(const db_TableRef &table);
+
+// Same as foreign_keys_referencing_table(), as a GRT list (used by db.Schema.getForeignKeysReferencingTable).
+WBPUBLICBACKEND_PUBLIC_FUNC grt::ListRef<db_ForeignKey> get_foreign_keys_referencing_table(const db_TableRef &table);
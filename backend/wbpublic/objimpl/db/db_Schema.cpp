@@ -30,6 +30,7 @@
 
 #include "grtpp_undo_manager.h"
 #include "grt/common.h"
+#include "objimpl/db/db_ForeignKey_impl.h"
 
 using namespace base;
 
@@ -148,9 +149,6 @@ db_ViewRef db_Schema::addNewView(const std::string &dbpackage) {
 }
 
 grt::ListRef<db_ForeignKey> db_Schema::getForeignKeysReferencingTable(const db_TableRef &table) {
-  // from db_ForeignKey.cpp
-  extern grt::ListRef<db_ForeignKey> get_foreign_keys_referencing_table(const db_TableRef &value);
-
   return get_foreign_keys_referencing_table(table);
 }
 
@@ -158,8 +156,9 @@ void db_Schema::removeTable(const db_TableRef &table) {
   grt::AutoUndo undo(!is_global());
 
   // check foreign keys that refer to this table and reset them
-  grt::ListRef<db_ForeignKey> foreignKeys(getForeignKeysReferencingTable(table));
-  for (grt::ListRef<db_ForeignKey>::const_reverse_iterator fk = foreignKeys.rbegin(); fk != foreignKeys.rend(); ++fk) {
+  std::vector<db_ForeignKeyRef> foreignKeys(foreign_keys_referencing_table(table));
+  for (std::vector<db_ForeignKeyRef>::const_reverse_iterator fk = foreignKeys.rbegin(); fk != foreignKeys.rend();
+       ++fk) {
     grt::AutoUndo undo(!is_global());
 
     (*fk)->referencedTable(db_TableRef());
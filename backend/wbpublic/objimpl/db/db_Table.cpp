@@ -28,6 +28,7 @@
 #include <grts/structs.db.query.h>
 
 #include "objimpl/db.query/db_query_EditableResultset.h"
+#include "objimpl/db/db_ForeignKey_impl.h"
 
 #include "base/string_utilities.h"
 #include <grtpp_undo_manager.h>
@@ -39,7 +40,6 @@
 //================================================================================
 // db_Table
 // from db_ForeignKey.cpp
-extern grt::ListRef<db_ForeignKey> get_foreign_keys_referencing_table(const db_TableRef &value);
 extern void add_foreign_key_mapping(const db_TableRef &table, db_ForeignKey *fk);
 extern void delete_foreign_key_mapping(const db_TableRef &table, db_ForeignKey *fk);
 
@@ -272,8 +272,8 @@ void db_Table::removeColumn(const db_ColumnRef &column) {
   }
 
   // get all FKs that reference this column and remove them too
-  grt::ListRef<db_ForeignKey> references(db_SchemaRef::cast_from(owner())->getForeignKeysReferencingTable(this));
-  GRTLIST_FOREACH(db_ForeignKey, references, fk) {
+  std::vector<db_ForeignKeyRef> references(foreign_keys_referencing_table(this));
+  for (std::vector<db_ForeignKeyRef>::const_iterator fk = references.begin(); fk != references.end(); ++fk) {
     bool deleted = false;
     for (size_t c = (*fk)->referencedColumns().count(), i = 0; i < c; i++) {
       if ((*fk)->referencedColumns()[i] == column) {
@@ -307,7 +307,7 @@ void db_Table::removeForeignKey(const db_ForeignKeyRef &fk, ssize_t removeColumn
     indices().remove_value(fk->index());
 
   if (removeColumns > 0) {
-    grt::ListRef<db_ForeignKey> fks(get_foreign_keys_referencing_table(db_TableRef(this)));
+    std::vector<db_ForeignKeyRef> fks(foreign_keys_referencing_table(db_TableRef(this)));
 
     db_ColumnRef cl;
     for (ssize_t i = fk->columns().count() - 1; i > -1; i--) {
@@ -315,7 +315,7 @@ void db_Table::removeForeignKey(const db_ForeignKeyRef &fk, ssize_t removeColumn
       cl = fk->columns().get(i);
 
       // check if cl is used by some external FK
-      for (size_t j = 0, c = fks.count(); j < c; j++) {
+      for (size_t j = 0, c = fks.size(); j < c; j++) {
         db_ForeignKeyRef rfk(fks[j]);
         if (rfk != fk) {
           if (rfk->referencedColumns().get_index(cl) != grt::BaseListRef::npos) {
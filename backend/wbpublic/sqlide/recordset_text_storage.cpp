@@ -147,6 +147,251 @@ static std::string escape_json_string_(const std::string &s) {
   return base::escape_json_string(s);
 }
 
+/**
+ * Everything needed to turn the data swap db rows into template values.
+ */
+struct RecordsetExportContext {
+  const Recordset::Column_names &column_names;
+  const Recordset::Column_types &column_types;
+  const Recordset::Column_flags &column_flags;
+  const std::vector<std::string> &out_column_types;
+  sqlide::QuoteVar &qv;
+  const std::string &null_syntax;
+  const std::string &row_separator;
+  bool strings_are_pre_quoted;
+  bool include_column_types;
+  ColumnId column_count;
+  size_t partition_count;
+  std::vector<std::shared_ptr<sqlite::result> > &data_results;
+
+  // Row by row expansion (templates with pre/post parts), which also provides null flags, field types and
+  // the row separator.
+  bool per_row;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Data source for the export templates. The ROW section (with its FIELD sub sections) is served straight from
+ * the data swap db results, so no dictionaries are created per row or field. Everything else comes from the
+ * given dictionary.
+ */
+class RecordsetDataSource : public mtemplate::DictionaryDataSource {
+  enum Variable { OtherVariable, FieldName, FieldValue, FieldType, RowSeparator };
+  enum Section { OtherSection, Row, Field, FieldIsNull, FieldIsNotNull };
+
+  // FIELD_is_null and FIELD_is_not_null, a single row without own values.
+  class FlagSource : public mtemplate::DataSource {
+    bool _pending = false;
+
+  public:
+    void rewind() {
+      _pending = true;
+    }
+    virtual bool value(size_t slot, std::string &result) override {
+      return false;
+    }
+    virtual mtemplate::DataSource *section(size_t slot) override {
+      return nullptr;
+    }
+    virtual bool next() override {
+      bool result = _pending;
+      _pending = false;
+      return result;
+    }
+  };
+
+  // One row per visible column of the current recordset row.
+  class FieldSource : public mtemplate::DataSource {
+    RecordsetDataSource &_owner;
+    ColumnId _column = 0;
+    bool _started = false;
+    FlagSource _flag;
+
+  public:
+    FieldSource(RecordsetDataSource &owner) : _owner(owner) {
+    }
+
+    void rewind() {
+      _started = false;
+    }
+
+    virtual bool value(size_t slot, std::string &result) override {
+      const RecordsetExportContext &context = _owner._context;
+      switch (_owner._variable_kinds[slot]) {
+        case FieldName:
+          result += context.column_names[_column];
+          return true;
+        case FieldValue:
+          result += _owner._values[_column];
+          return true;
+        case FieldType:
+          if (!context.per_row || !context.include_column_types || _column >= context.out_column_types.size())
+            return false;
+          result += context.out_column_types[_column];
+          return true;
+        default:
+          return false;
+      }
+    }
+
+    virtual mtemplate::DataSource *section(size_t slot) override {
+      if (!_owner._context.per_row)
+        return nullptr;
+
+      Section kind = _owner._section_kinds[slot];
+      if ((kind == FieldIsNull && _owner._nulls[_column]) || (kind == FieldIsNotNull && !_owner._nulls[_column])) {
+        _flag.rewind();
+        return &_flag;
+      }
+      return nullptr;
+    }
+
+    virtual bool next() override {
+      if (!_started) {
+        _started = true;
+        _column = 0;
+        return _owner._context.column_count > 0;
+      }
+      if (_column + 1 >= _owner._context.column_count)
+        return false;
+      ++_column;
+      return true;
+    }
+
+    virtual bool isLast() override {
+      return _column + 1 >= _owner._context.column_count;
+    }
+  };
+
+  // The recordset rows. In per row mode only the row loaded by fetch_row() is served.
+  class RowSource : public mtemplate::DataSource {
+    RecordsetDataSource &_owner;
+    FieldSource _fields;
+    bool _pending = false;
+
+  public:
+    RowSource(RecordsetDataSource &owner) : _owner(owner), _fields(owner) {
+    }
+
+    void rewind() {
+      _pending = true;
+    }
+
+    virtual bool value(size_t slot, std::string &result) override {
+      if (!_owner._context.per_row || _owner._variable_kinds[slot] != RowSeparator)
+        return false;
+      if (_owner._has_more)
+        result += _owner._context.row_separator;
+      return true;
+    }
+
+    virtual mtemplate::DataSource *section(size_t slot) override {
+      if (_owner._section_kinds[slot] != Field)
+        return nullptr;
+      _fields.rewind();
+      return &_fields;
+    }
+
+    virtual bool next() override {
+      if (_owner._context.per_row) {
+        bool result = _pending;
+        _pending = false;
+        return result;
+      }
+      return _owner.fetch_row();
+    }
+
+    virtual bool isLast() override {
+      return _owner._context.per_row || !_owner._has_more;
+    }
+  };
+
+  RecordsetExportContext &_context;
+  bool _has_more;
+  std::vector<Variable> _variable_kinds;
+  std::vector<Section> _section_kinds;
+  std::vector<std::string> _values;
+  std::vector<char> _nulls;
+  sqlite::variant_t _value;
+  RowSource _rows;
+
+public:
+  RecordsetDataSource(mtemplate::DictionaryInterface *dictionary, RecordsetExportContext &context, bool has_rows)
+    : mtemplate::DictionaryDataSource(dictionary),
+      _context(context),
+      _has_more(has_rows),
+      _values(context.column_count),
+      _nulls(context.column_count),
+      _rows(*this) {
+  }
+
+  virtual void prepare(const std::vector<std::string> &variables, const std::vector<std::string> &sections) override {
+    mtemplate::DictionaryDataSource::prepare(variables, sections);
+
+    static const std::map<std::string, Variable> variable_names = {
+      { "FIELD_NAME", FieldName }, { "FIELD_VALUE", FieldValue }, { "FIELD_TYPE", FieldType },
+      { "ROW_SEPARATOR", RowSeparator } };
+    static const std::map<std::string, Section> section_names = {
+      { "ROW", Row }, { "FIELD", Field }, { "FIELD_is_null", FieldIsNull }, { "FIELD_is_not_null", FieldIsNotNull } };
+
+    _variable_kinds.clear();
+    for (const std::string &name : variables) {
+      auto iter = variable_names.find(name);
+      _variable_kinds.push_back(iter == variable_names.end() ? OtherVariable : iter->second);
+    }
+    _section_kinds.clear();
+    for (const std::string &name : sections) {
+      auto iter = section_names.find(name);
+      _section_kinds.push_back(iter == section_names.end() ? OtherSection : iter->second);
+    }
+  }
+
+  virtual mtemplate::DataSource *section(size_t slot) override {
+    if (_section_kinds[slot] != Row)
+      return mtemplate::DictionaryDataSource::section(slot);
+
+    _rows.rewind();
+    return &_rows;
+  }
+
+  /**
+   * Converts the current row of the swap db results to strings and advances the results.
+   */
+  bool fetch_row() {
+    if (!_has_more)
+      return false;
+
+    sqlide::VarToStr var_to_str;
+    for (size_t partition = 0; partition < _context.partition_count; ++partition) {
+      std::shared_ptr<sqlite::result> &data_rs = _context.data_results[partition];
+      for (ColumnId col_begin = partition * Recordset::DATA_SWAP_DB_TABLE_MAX_COL_COUNT, col = col_begin,
+                    col_end = std::min<ColumnId>(_context.column_count,
+                                                 (partition + 1) * Recordset::DATA_SWAP_DB_TABLE_MAX_COL_COUNT);
+           col < col_end; ++col) {
+        _value = data_rs->get_variant((int)(col - col_begin));
+
+        bool is_null = sqlide::is_var_null(_value); // for some reason, the apply_visitor stuff isnt handling NULL
+        _nulls[col] = is_null;
+        if (is_null && _context.per_row)
+          _values[col] = _context.null_syntax;
+        else if (_context.strings_are_pre_quoted)
+          _values[col] = (_context.column_flags[col] & Recordset::NeedsQuoteFlag) || is_null
+                           ? boost::apply_visitor(_context.qv, _context.column_types[col], _value)
+                           : boost::apply_visitor(var_to_str, _value);
+        else
+          _values[col] = boost::apply_visitor(var_to_str, _value);
+      }
+    }
+
+    for (std::shared_ptr<sqlite::result> &data_rs : _context.data_results)
+      _has_more = data_rs->next_row();
+    return true;
+  }
+};
+
+//--------------------------------------------------------------------------------------------------
+
 void Recordset_text_storage::do_serialize(const Recordset *recordset, sqlite::connection *data_swap_db) {
   const TemplateInfo &info(template_info(_data_format));
   std::string template_name(info.name);
@@ -242,135 +487,47 @@ void Recordset_text_storage::do_serialize(const Recordset *recordset, sqlite::co
     }
   }
 
+  const size_t partition_count = recordset->data_swap_db_partition_count();
+  std::list<std::shared_ptr<sqlite::query> > data_queries(partition_count);
+  Recordset::prepare_partition_queries(data_swap_db, "select * from `data%s`", data_queries);
+  std::vector<std::shared_ptr<sqlite::result> > data_results(data_queries.size());
+  bool has_rows = Recordset::emit_partition_queries(data_swap_db, data_queries, data_results);
+
+  RecordsetExportContext context = { *column_names, column_types, column_flags, out_column_types, qv,
+    null_syntax, info.row_separator, strings_are_pre_quoted, !include_column_types.empty(), visible_col_count,
+    partition_count, data_results, pre_template != nullptr || post_template != nullptr };
+
   // if at least one of pre or post templates exist, then we process the recordset as
   // 1. dump pre
   // 2. for each row, dump the row
   // 3. dump post
   // otherwise, the whole thing is dumped at once
+  // In both cases the rows are pulled from the data swap db while the template is expanded.
   mtemplate::TemplateOutputFile output(_file_path);
-  if (pre_template || post_template) {
+  if (context.per_row) {
     if (pre_template)
       pre_template->expand(dictionary, &output);
 
-    // data
-    {
-      const size_t partition_count = recordset->data_swap_db_partition_count();
-      std::list<std::shared_ptr<sqlite::query> > data_queries(partition_count);
-      Recordset::prepare_partition_queries(data_swap_db, "select * from `data%s`", data_queries);
-      std::vector<std::shared_ptr<sqlite::result> > data_results(data_queries.size());
-
-      if (Recordset::emit_partition_queries(data_swap_db, data_queries, data_results)) {
-        bool next_row_exists = true;
-        sqlite::variant_t v;
-        do {
-          mtemplate::DictionaryInterface *row_dictionary_base = mtemplate::CreateMainDictionary();
-          mtemplate::DictionaryInterface *row_dictionary = row_dictionary_base->addSectionDictionary("ROW");
-
-          for (const Parameters::value_type &param : _parameters)
-            row_dictionary_base->setValue(param.first, param.second);
-
-          // process a single row
-          for (size_t partition = 0; partition < partition_count; ++partition) {
-            std::shared_ptr<sqlite::result> &data_rs = data_results[partition];
-            for (ColumnId col_begin = partition * Recordset::DATA_SWAP_DB_TABLE_MAX_COL_COUNT, col = col_begin,
-                          col_end = std::min<ColumnId>(visible_col_count,
-                                                       (partition + 1) * Recordset::DATA_SWAP_DB_TABLE_MAX_COL_COUNT);
-                 col < col_end; ++col) {
-              ColumnId partition_column = col - col_begin;
-              bool is_null;
-              v = data_rs->get_variant((int)partition_column);
-
-              is_null = sqlide::is_var_null(v); // for some reason, the apply_visitor stuff isnt handling NULL
-
-              mtemplate::DictionaryInterface *field_dictionary = row_dictionary->addSectionDictionary("FIELD");
-
-              if (is_null)
-                field_dictionary->addSectionDictionary("FIELD_is_null");
-              else
-                field_dictionary->addSectionDictionary("FIELD_is_not_null");
-
-              if (!include_column_types.empty())
-                field_dictionary->setValue("FIELD_TYPE", out_column_types[col]);
-
-              field_dictionary->setValue("FIELD_NAME", (*column_names)[col]);
-
-              std::string field_value;
-              sqlide::VarToStr var_to_str;
-
-              if (is_null)
-                field_value = null_syntax;
-              else if (strings_are_pre_quoted)
-                field_value = (column_flags[col] & Recordset::NeedsQuoteFlag) || sqlide::is_var_null(v)
-                                ? boost::apply_visitor(qv, column_types[col], v)
-                                : boost::apply_visitor(var_to_str, v);
-              else
-                field_value = boost::apply_visitor(var_to_str, v);
-              field_dictionary->setValue("FIELD_VALUE", field_value);
-            }
-          }
-
-          for (std::shared_ptr<sqlite::result> &data_rs : data_results)
-            next_row_exists = data_rs->next_row();
-
-          if (next_row_exists)
-            row_dictionary->setValue("ROW_SEPARATOR", info.row_separator);
-          else
-            row_dictionary->setValue("ROW_SEPARATOR", "");
-
-          // expand template & flush row
-          mtpl->expand(row_dictionary_base, &output);
-        } while (next_row_exists);
-      }
-    }
+    // The row template only sees the parameters, not the header values.
+    std::unique_ptr<mtemplate::Dictionary> row_dictionary_base(mtemplate::CreateMainDictionary());
+    for (const Parameters::value_type &param : _parameters)
+      row_dictionary_base->setValue(param.first, param.second);
+
+    RecordsetDataSource source(row_dictionary_base.get(), context, has_rows);
+    while (source.fetch_row())
+      mtpl->expand(source, &output);
 
     if (post_template)
       post_template->expand(dictionary, &output);
-  } else // no pre/post separation
-  {
-    // data
-    {
-      const size_t partition_count = recordset->data_swap_db_partition_count();
-      std::list<std::shared_ptr<sqlite::query> > data_queries(partition_count);
-      Recordset::prepare_partition_queries(data_swap_db, "select * from `data%s`", data_queries);
-      std::vector<std::shared_ptr<sqlite::result> > data_results(data_queries.size());
-      if (Recordset::emit_partition_queries(data_swap_db, data_queries, data_results)) {
-        bool next_row_exists = true;
-        sqlite::variant_t v;
-        do {
-          mtemplate::DictionaryInterface *row_dictionary = dictionary->addSectionDictionary("ROW");
-          for (size_t partition = 0; partition < partition_count; ++partition) {
-            std::shared_ptr<sqlite::result> &data_rs = data_results[partition];
-            for (ColumnId col_begin = partition * Recordset::DATA_SWAP_DB_TABLE_MAX_COL_COUNT, col = col_begin,
-                          col_end = std::min<ColumnId>(visible_col_count,
-                                                       (partition + 1) * Recordset::DATA_SWAP_DB_TABLE_MAX_COL_COUNT);
-                 col < col_end; ++col) {
-              ColumnId partition_column = col - col_begin;
-              v = data_rs->get_variant((int)partition_column);
-              mtemplate::DictionaryInterface *field_dictionary = row_dictionary->addSectionDictionary("FIELD");
-              field_dictionary->setValue("FIELD_NAME", (*column_names)[col]);
-              std::string field_value;
-              sqlide::VarToStr var_to_str;
-
-              if (strings_are_pre_quoted)
-                field_value = (column_flags[col] & Recordset::NeedsQuoteFlag) || sqlide::is_var_null(v)
-                                ? boost::apply_visitor(qv, column_types[col], v)
-                                : boost::apply_visitor(var_to_str, v);
-              else
-                field_value = boost::apply_visitor(var_to_str, v);
-              field_dictionary->setValue("FIELD_VALUE", field_value);
-            }
-          }
-          for (std::shared_ptr<sqlite::result> &data_rs : data_results)
-            next_row_exists = data_rs->next_row();
-        } while (next_row_exists);
-      }
-    }
-
-    // expand tempalte & flush result
-    mtpl->expand(dictionary, &output);
+  } else {
+    RecordsetDataSource source(dictionary, context, has_rows);
+    mtpl->expand(source, &output);
   }
+  delete dictionary;
 }
 
+//--------------------------------------------------------------------------------------------------
+
 void Recordset_text_storage::do_unserialize(Recordset *recordset, sqlite::connection *data_swap_db) {
   throw std::runtime_error("Recordset_text_storage::unserialize is not implemented");
 }
@@ -26,6 +26,7 @@
 #include "base/string_utilities.h"
 #include "base/threaded_timer.h"
 #include "base/util_functions.h"
+#include "base/file_functions.h"
 
 #include "grt/grt_manager.h"
 #include "grt/grt_threaded_task.h"
@@ -45,6 +46,7 @@
 #include "SymbolTable.h"
 
 #include "sql_editor_be.h"
+#include <fstream>
 #include <mutex>
 
 DEFAULT_LOG_DOMAIN("MySQL editor");
@@ -79,6 +81,7 @@ public:
   // Entries determined the last time we started auto completion. The actually shown list
   // is derived from these entries filtered by the current input.
   std::vector<std::pair<int, std::string>> codeCompletionCandidates;
+  std::string codeCompletionPrefix; // The typed text the candidates were collected for.
 
   base::RecMutex sqlCheckerMutex;
   MySQLParseUnit parseUnit; // The type of query we want to limit our parsing to.
@@ -103,10 +106,12 @@ public:
 
   bool isRefreshEnabled;  // Whether the FE control is permitted to replace its contents from the BE.
   bool isSQLCheckEnabled; // Enables automatic syntax checks.
+  bool isLargeFile;       // No syntax checks or statement markers, only statement splitting.
   bool stopProcessing;    // To stop ongoing syntax checks (because of text changes).
   bool ownsToolbar;
 
   boost::signals2::signal<void()> textChangeSignal;
+  boost::signals2::signal<void(std::set<std::string> const &)> schemasReferencedSignal;
 
   mforms::CodeEditor *codeEditor = nullptr;
   std::string currentSchema;
@@ -127,6 +132,7 @@ public:
     currentWorkTimerID = -1;
 
     isSQLCheckEnabled = true;
+    isLargeFile = false;
     container = nullptr;
     editorTextSubmenu = nullptr;
     editorContextMenu = nullptr;
@@ -329,6 +335,12 @@ static void open_file(MySQLEditor *sql_editor) {
   if (fc.run_modal()) {
     std::string file = fc.get_path();
 
+    // Large UTF-8 files are paged in directly, everything else goes through the charset check below.
+    bool large_file = base_get_file_size(file.c_str()) > (long)MySQLEditor::LargeFileSize;
+    sql_editor->set_large_file_mode(large_file);
+    if (large_file && sql_editor->load_file(file))
+      return;
+
     gchar *contents;
     gsize length;
     GError *error = nullptr;
@@ -559,6 +571,105 @@ void MySQLEditor::sql(const char *sql) {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/**
+ * Replaces the editor content with the content of the given UTF-8 encoded file. The file is copied in pages of
+ * LoadPageSize bytes, so loading needs no memory besides one page and the editor's own buffer (instead of
+ * 2 additional copies of the file when loading it as a whole), and the time is linear to the file size.
+ * Undo collection is paused while loading.
+ *
+ * Returns false if the file could not be read or isn't valid UTF-8, in which case the editor is left empty.
+ */
+bool MySQLEditor::load_file(const std::string &path) {
+#ifdef _MSC_VER
+  std::ifstream stream(base::string_to_wstring(path).c_str(), std::ios::binary);
+#else
+  std::ifstream stream(path.c_str(), std::ios::binary);
+#endif
+  if (!stream.is_open())
+    return false;
+
+  // Skip a UTF-8 byte order mark.
+  char bom[3] = { 0 };
+  if (!stream.read(bom, 3) || (unsigned char)bom[0] != 0xEF || (unsigned char)bom[1] != 0xBB ||
+      (unsigned char)bom[2] != 0xBF) {
+    stream.clear();
+    stream.seekg(0);
+  }
+
+  d->codeEditor->set_text("");
+  d->codeEditor->send_editor(SCI_SETUNDOCOLLECTION, 0, 0);
+  long fileSize = base_get_file_size(path.c_str());
+  if (fileSize > 0)
+    d->codeEditor->send_editor(SCI_ALLOCATE, (uptr_t)fileSize + 1, 0);
+
+  bool success = true;
+  std::string page(LoadPageSize, '\0');
+  std::size_t carry = 0; // Bytes of a multibyte sequence which was cut at the end of the previous page.
+  while (stream) {
+    stream.read(&page[carry], (std::streamsize)(LoadPageSize - carry));
+    std::size_t length = carry + (std::size_t)stream.gcount();
+    if (length == 0)
+      break;
+
+    const gchar *end = nullptr;
+    if (!g_utf8_validate(page.data(), (gssize)length, &end)) {
+      // An incomplete sequence at the end of the page is fine, as long as there is more to read.
+      carry = length - (end - page.data());
+      if (!stream || carry > 3) {
+        success = false;
+        break;
+      }
+    } else
+      carry = 0;
+
+    d->codeEditor->append_text(page.data(), length - carry);
+    if (carry > 0)
+      memmove(&page[0], page.data() + length - carry, carry);
+  }
+
+  if (success && carry > 0)
+    success = false;
+  if (!success)
+    d->codeEditor->set_text("");
+
+  d->codeEditor->send_editor(SCI_SETUNDOCOLLECTION, 1, 0);
+  d->codeEditor->send_editor(SCI_EMPTYUNDOBUFFER, 0, 0);
+  d->splittingRequired = true;
+  d->statementMarkerLines.clear();
+
+  // Don't convert line endings for large files, that would touch the entire text again.
+  d->codeEditor->set_eol_mode(mforms::EolLF, !d->isLargeFile);
+
+  return success;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool MySQLEditor::is_large_file_mode() const {
+  return d->isLargeFile;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Switches the editor to a mode for very large files, where all work that involves the entire text in the main thread
+ * is avoided: no folding and word wrapping, no statement markers, no syntax checks. Statements are still split
+ * (in the background), so running the current statement works as usual.
+ */
+void MySQLEditor::set_large_file_mode(bool flag) {
+  if (d->isLargeFile == flag)
+    return;
+
+  d->isLargeFile = flag;
+  d->codeEditor->set_features(mforms::FeatureLargeFile, flag);
+  if (flag) {
+    d->codeEditor->remove_markup(mforms::LineMarkupStatement, -1);
+    d->statementMarkerLines.clear();
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 std::size_t MySQLEditor::cursor_pos() {
   return d->codeEditor->get_caret_pos();
 }
@@ -619,6 +730,12 @@ boost::signals2::signal<void()> *MySQLEditor::text_change_signal() {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+boost::signals2::signal<void(std::set<std::string> const &)> *MySQLEditor::schemas_referenced_signal() {
+  return &d->schemasReferencedSignal;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 std::string MySQLEditor::sql_mode() {
   return d->sqlMode;
 };
@@ -793,7 +910,7 @@ bool MySQLEditor::do_statement_split_and_check(int id) {
   // Start tasks that depend on the statement ranges (markers + auto completion).
   bec::GRTManager::get()->run_once_when_idle(this, std::bind(&MySQLEditor::splitting_done, this));
 
-  if (d->stopProcessing)
+  if (d->stopProcessing || d->isLargeFile)
     return false;
 
   base::RecMutexLock lock(d->sqlCheckerMutex);
@@ -830,6 +947,10 @@ void *MySQLEditor::splitting_done() {
     show_auto_completion(false);
   }
 
+  // A marker for each statement means a marker for every line or so in typical dumps.
+  if (d->isLargeFile)
+    return nullptr;
+
   std::set<size_t> removal_candidates;
   std::set<size_t> insert_candidates;
 
@@ -1073,7 +1194,7 @@ void MySQLEditor::show_special_chars(bool flag) {
 //----------------------------------------------------------------------------------------------------------------------
 
 void MySQLEditor::enable_word_wrap(bool flag) {
-  d->codeEditor->set_features(mforms::FeatureWrapText, flag);
+  d->codeEditor->set_features(mforms::FeatureWrapText, flag && !d->isLargeFile);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -1182,6 +1303,57 @@ std::string MySQLEditor::getWrittenPart(size_t position) {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/**
+ * Collects the names of all schemas the given statement may refer to: the default schema and every (possibly quoted)
+ * identifier which is directly followed by a dot. This is only a rough scan (it also returns table names of
+ * table.column references), but good enough to decide which schemas need symbols for code completion.
+ */
+static std::set<std::string> referencedSchemas(const std::string &statement, const std::string &defaultSchema) {
+  std::set<std::string> result;
+  if (!defaultSchema.empty())
+    result.insert(defaultSchema);
+
+  const char *run = statement.c_str();
+  const char *end = run + statement.size();
+  while (run < end) {
+    std::string identifier;
+    if (*run == '`') {
+      const char *start = ++run;
+      while (run < end && *run != '`')
+        ++run;
+      identifier.assign(start, run);
+      if (run < end)
+        ++run;
+    } else if (*run == '\'' || *run == '"') {
+      // Skip over strings, they cannot contain references.
+      char quote = *run++;
+      while (run < end && *run != quote) {
+        if (*run == '\\' && run + 1 < end)
+          ++run;
+        ++run;
+      }
+      if (run < end)
+        ++run;
+      continue;
+    } else if (std::isalnum((unsigned char)*run) || *run == '_' || *run == '$' || (*run & 0x80) != 0) {
+      const char *start = run;
+      while (run < end && (std::isalnum((unsigned char)*run) || *run == '_' || *run == '$' || (*run & 0x80) != 0))
+        ++run;
+      identifier.assign(start, run);
+    } else {
+      ++run;
+      continue;
+    }
+
+    if (run < end && *run == '.' && !identifier.empty())
+      result.insert(identifier);
+  }
+
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void MySQLEditor::show_auto_completion(bool auto_choose_single) {
   if (!code_completion_enabled())
     return;
@@ -1227,11 +1399,14 @@ void MySQLEditor::show_auto_completion(bool auto_choose_single) {
     caretOffset = g_utf8_pointer_to_offset(line_text.c_str(), line_text.c_str() + caretOffset);
   }
 
+  d->schemasReferencedSignal(referencedSchemas(statement, d->currentSchema));
+
+  d->codeCompletionPrefix = getWrittenPart(caretPosition);
   d->codeCompletionCandidates = d->services->getCodeCompletionCandidates(
     d->autocompletionContext, { caretOffset, caretLine }, statement, d->currentSchema, make_keywords_uppercase(),
-    d->symbolTable);
+    d->symbolTable, d->codeCompletionPrefix);
 
-  update_auto_completion(getWrittenPart(caretPosition));
+  update_auto_completion(d->codeCompletionPrefix);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -1245,6 +1420,17 @@ void MySQLEditor::show_auto_completion(bool auto_choose_single) {
 std::vector<std::pair<int, std::string>> MySQLEditor::update_auto_completion(const std::string &typed_part) {
   logDebug2("Updating auto completion popup in editor\n");
 
+  // Database objects are only collected if they match the text typed when completion started (which keeps the lists
+  // small for large schemas). If some of that text was removed again we have to collect them anew.
+  // show_auto_completion() then filters and shows the new list itself.
+  if (ScopedSymbol::foldName(typed_part).size() < ScopedSymbol::foldName(d->codeCompletionPrefix).size()) {
+    if (code_completion_enabled())
+      show_auto_completion(false);
+    else
+      cancel_auto_completion();
+    return {};
+  }
+
   // Remove all entries that don't start with the typed text before showing the
   // list.
   if (!typed_part.empty()) {
@@ -1258,6 +1444,24 @@ std::vector<std::pair<int, std::string>> MySQLEditor::update_auto_completion(con
       g_free(folded);
     }
 
+    if (filteredEntries.empty()) {
+      // Nothing starts with the typed text. Offer the best fuzzy matches instead, e.g. "cusid" for "customer_id".
+      static const size_t maxFuzzyMatches = 50;
+
+      std::vector<std::pair<int, size_t>> ranked;
+      for (size_t i = 0; i < d->codeCompletionCandidates.size(); ++i) {
+        int score = ScopedSymbol::matchScore(typed_part, d->codeCompletionCandidates[i].second);
+        if (score >= 0)
+          ranked.push_back({ score, i });
+      }
+      std::stable_sort(ranked.begin(), ranked.end(), [](auto const &lhs, auto const &rhs) {
+        return lhs.first > rhs.first;
+      });
+
+      for (size_t i = 0; i < ranked.size() && i < maxFuzzyMatches; ++i)
+        filteredEntries.push_back(d->codeCompletionCandidates[ranked[i].second]);
+    }
+
     switch (filteredEntries.size()) {
       case 0:
         logDebug2("Nothing to autocomplete - hiding popup if it was active\n");
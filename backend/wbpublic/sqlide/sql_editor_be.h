@@ -108,6 +108,15 @@ public:
   std::pair<const char *, size_t> text_ptr();
   void sql(const char *sql);
 
+  // Files larger than this are edited in large file mode.
+  static constexpr std::size_t LargeFileSize = 20 * 1024 * 1024;
+  // load_file() copies files into the editor in pages of this size.
+  static constexpr std::size_t LoadPageSize = 1024 * 1024;
+
+  bool load_file(const std::string &path);
+  bool is_large_file_mode() const;
+  void set_large_file_mode(bool flag);
+
   bool empty();
   void append_text(const std::string &text);
 
@@ -136,6 +145,10 @@ public:
 
   boost::signals2::signal<void()> *text_change_signal();
 
+  // Triggered when code completion is about to run, with the schemas referenced by the current statement.
+  // Allows the owner to load symbols for those schemas on demand.
+  boost::signals2::signal<void(std::set<std::string> const &)> *schemas_referenced_signal();
+
   std::string sql_mode();
   void set_sql_mode(const std::string &value);
   void setServerVersion(GrtVersionRef version);
@@ -27,6 +27,7 @@
 #include "workbench_physical_tablefigure_impl.h"
 
 #include "grtpp_undo_manager.h"
+#include "objimpl/db/db_ForeignKey_impl.h"
 
 #include "base/string_utilities.h"
 
@@ -205,13 +206,9 @@ int workbench_physical_Diagram::ImplData::create_connections_for_table(const db_
     }
 
     // create connections for FKs that reference this one
-    db_SchemaRef schema(db_SchemaRef::cast_from(table->owner()));
-
-    if (schema.is_valid()) {
-      grt::ListRef<db_ForeignKey> fks(schema->getForeignKeysReferencingTable(table));
-
-      for (grt::ListRef<db_ForeignKey>::const_iterator fk = fks.begin(); fk != fks.end(); ++fk) {
-        if (create_connection_for_foreign_key(*fk).is_valid())
+    if (table->owner().is_valid()) {
+      for (auto &fk : foreign_keys_referencing_table(table)) {
+        if (create_connection_for_foreign_key(fk).is_valid())
           c++;
       }
     }
@@ -232,13 +229,9 @@ void workbench_physical_Diagram::ImplData::delete_connections_for_table(const db
     }
 
     // delete connections for FKs that reference this one
-    db_SchemaRef schema(db_SchemaRef::cast_from(table->owner()));
-
-    if (schema.is_valid()) {
-      grt::ListRef<db_ForeignKey> fks(schema->getForeignKeysReferencingTable(table));
-
-      for (grt::ListRef<db_ForeignKey>::const_iterator fk = fks.begin(); fk != fks.end(); ++fk) {
-        workbench_physical_ConnectionRef conn(get_connection_for_foreign_key(*fk));
+    if (table->owner().is_valid()) {
+      for (auto &fk : foreign_keys_referencing_table(table)) {
+        workbench_physical_ConnectionRef conn(get_connection_for_foreign_key(fk));
         if (conn.is_valid())
           remove_connection(conn);
       }
@@ -1321,6 +1321,16 @@ mforms::View *PreferencesForm::create_model_page() {
                           "and slow down operation."));
     }
 
+    {
+      mforms::TextEntry *entry = new_numeric_entry_option("workbench:UndoMemoryLimit", 0, 65535);
+      entry->set_max_length(5);
+      entry->set_size(100, -1);
+
+      table->add_option(entry, _("Model undo history memory (MB):"), "Undo History Memory",
+                        _("Oldest undo entries are discarded when the undo history uses more memory than this. "
+                          "0 means no limit, only the history size applies."));
+    }
+
     {
       static const char *auto_save_intervals =
         "disable:0,10 seconds:10,15 seconds:15,30 seconds:30,1 minute:60,5 minutes:300,10 minutes:600,20 minutes:1200";
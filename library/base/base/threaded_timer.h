@@ -26,7 +26,9 @@
 #include "common.h"
 
 #include "glib.h"
-#include <list>
+#include <map>
+#include <queue>
+#include <vector>
 #include <functional>
 
 #include "base/threading.h"
@@ -42,15 +44,35 @@ typedef std::function<bool(int)> TimerFunction;
 
 struct TimerTask {
   int task_id;
-  gdouble next_time;      // Precomputed target time when this task must be triggered again.
-  gdouble wait_time;      // The time in seconds to wait until this task is executed again.
+  gint64 next_time;       // Precomputed target time (monotonic, in microseconds) when this task must be triggered again.
+  gint64 wait_time;       // The time in microseconds to wait until this task is executed again.
   TimerFunction callback; // The callback to trigger when the timer fires.
   bool stop;              // Tells the scheduler to remove this task.
   bool single_shot;       // If true then this task will only run once.
   bool scheduled;         // True if the task has been scheduled currently (it is waiting in the pool to get executed).
 };
 
-typedef std::list<TimerTask> TaskList;
+typedef std::map<int, TimerTask> TaskList;
+
+// An entry in the deadline heap. Entries are not removed when their task is stopped or rescheduled.
+// Instead they are skipped if they no longer match the next_time of their task.
+struct TimerDeadline {
+  gint64 time;
+  int task_id;
+
+  bool operator>(const TimerDeadline &other) const {
+    return time > other.time;
+  }
+};
+
+typedef std::priority_queue<TimerDeadline, std::vector<TimerDeadline>, std::greater<TimerDeadline> > DeadlineQueue;
+
+// Statistics about how punctual timer events are dispatched to the worker threads.
+struct TimerStats {
+  size_t fired;          // The number of timer events dispatched so far.
+  gint64 total_lateness; // Sum of the delays between the due time and the actual dispatch, in microseconds.
+  gint64 max_lateness;   // The largest of these delays, in microseconds.
+};
 
 // The unit type of the timer value given to ThreadedTimer::add_task.
 enum TimerUnit { TimerFrequency, TimerTimeSpan };
@@ -60,6 +82,9 @@ enum TimerUnit { TimerFrequency, TimerTimeSpan };
  * trigger
  * a timer event, depending on the given frequency (if it is a repeating timer) or delay (for one-shot timers).
  * It forms the base for timed services like animations, server pings in the background etc.
+ *
+ * Due tasks are kept in a heap ordered by their next deadline. The timer thread sleeps until the earliest deadline
+ * (or until a task with an earlier deadline comes in) and hands due tasks over to a pool of worker threads.
  */
 class BASELIBRARY_PUBLIC_FUNC ThreadedTimer {
 public:
@@ -69,21 +94,26 @@ public:
   static int add_task(TimerUnit unit, double value, bool single_shot, TimerFunction callback);
   static bool remove_task(int task_id);
 
+  static TimerStats get_stats();
+
 private:
-  base::Mutex _timer_lock; // Synchronize access to the timer class.
+  GMutex _timer_lock;      // Synchronize access to the timer class.
+  GCond _wakeup;           // Signalled when the timer thread must recompute its wait time.
   GThreadPool* _pool;      // A number of threads which trigger the callbacks (to make them independant of each other).
-  int _wait_time;          // The time the timer thread has to wait until looking for new tasks to execute.
   bool _terminate;         // Set to true when shutting down the timer.
   int _next_id;            // A counter for task ids.
 
   GThread* _thread; // This thread loops endlessly executing tasks as they come in.
   TaskList _tasks;
+  DeadlineQueue _deadlines;
+  TimerStats _stats;
 
-  ThreadedTimer(int base_frequency);
+  ThreadedTimer();
   ~ThreadedTimer();
 
   static gpointer start(gpointer data);
   static void pool_function(gpointer data, gpointer user_data);
   void main_loop();
+  void schedule(TimerTask &task);
   bool remove(int task_id);
 };
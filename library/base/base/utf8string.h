@@ -30,6 +30,7 @@
 #include <glib.h>
 #include <vector>
 #include <cstring>
+#include <memory>
 
 namespace base {
   /**
@@ -40,6 +41,13 @@ namespace base {
     std::string _inner_string;
     int compareNormalized(const utf8string &s) const;
 
+    // Lazily built character to byte offset lookup data, shared between copies and dropped on modification.
+    struct CharIndex;
+    mutable std::shared_ptr<const CharIndex> _char_index;
+    std::shared_ptr<const CharIndex> charIndex() const;
+    void invalidateCharIndex();
+    size_t bytePosition(size_t index) const;
+
   public:
     class utf8char;
     typedef std::string::size_type size_type;
@@ -177,6 +185,7 @@ namespace base {
     utf8string &append(size_type count, char ch);
     utf8string &append(size_type count, utf8char ch);
     utf8string &append(const char *s);
+    utf8string &append(const char *s, size_type count);
     utf8string &append(const utf8string &str);
     utf8string &operator+=(const utf8string &str);
     utf8string &operator+=(const utf8char &c);
@@ -23,6 +23,7 @@
 
 #include <stdio.h>
 #include <stdexcept>
+#include <algorithm>
 
 #include "base/threaded_timer.h"
 #include "base/log.h"
@@ -31,9 +32,12 @@
 // 30 fps should ensure smooth animations. Higher values are better, but put higher load on a system.
 #define BASE_FREQUENCY 30
 
-// Define the maximum number of worker threads. If they are used up tasks have to wait.
+// Define the minimum number of worker threads. If they are used up tasks have to wait.
 #define WORKER_THREAD_COUNT 2
 
+// The longest time the timer thread sleeps when there's nothing to do (in microseconds).
+#define MAX_IDLE_WAIT (10 * G_USEC_PER_SEC)
+
 DEFAULT_LOG_DOMAIN(DOMAIN_BASE)
 
 //--------------------------------------------------------------------------------------------------
@@ -41,13 +45,29 @@ DEFAULT_LOG_DOMAIN(DOMAIN_BASE)
 static ThreadedTimer *_timer = NULL;
 G_LOCK_DEFINE(_timer);
 
+namespace {
+  // Scoped lock for the GMutex used by the timer (which must be a GMutex to be usable with GCond).
+  class TimerLock {
+  public:
+    TimerLock(GMutex *mutex) : _mutex(mutex) {
+      g_mutex_lock(_mutex);
+    }
+    ~TimerLock() {
+      g_mutex_unlock(_mutex);
+    }
+
+  private:
+    GMutex *_mutex;
+  };
+}
+
 /**
  * Returns the singleton instance of the timer.
  */
 ThreadedTimer *ThreadedTimer::get() {
   G_LOCK(_timer);
   if (_timer == NULL) {
-    _timer = new ThreadedTimer(BASE_FREQUENCY);
+    _timer = new ThreadedTimer();
   }
   G_UNLOCK(_timer);
   return _timer;
@@ -78,7 +98,7 @@ void ThreadedTimer::stop() {
  * @result The id of the new task (can be used in the callback) or -1 if the task could not be added.
  */
 int ThreadedTimer::add_task(TimerUnit unit, double value, bool single_shot, TimerFunction callback) {
-  TimerTask task = {0, 0.0, 0.0, callback, false, single_shot, false};
+  TimerTask task = {0, 0, 0, callback, false, single_shot, false};
 
   if (value <= 0)
     throw std::logic_error("The given timer value is invalid.");
@@ -90,19 +110,19 @@ int ThreadedTimer::add_task(TimerUnit unit, double value, bool single_shot, Time
       //       support this nonetheless.
       if (value > BASE_FREQUENCY)
         throw std::logic_error("The given task frequency is higher than the base frequency.");
-      task.wait_time = 1 / value;
+      task.wait_time = (gint64)(G_USEC_PER_SEC / value);
       break;
     case TimerTimeSpan:
       // The given value is a time span given in seconds.
       // It must not be lower than the minimal time span we support.
       if (value < 1.0 / BASE_FREQUENCY)
         throw std::logic_error("The given task time span is smaller than the smallest supported value.");
-      task.wait_time = value;
+      task.wait_time = (gint64)(value * G_USEC_PER_SEC);
       break;
   }
   if (task.wait_time > 0) {
     ThreadedTimer *timer = ThreadedTimer::get();
-    base::MutexLock lock(timer->_timer_lock);
+    TimerLock lock(&timer->_timer_lock);
 
     // in theory, it is possible to wrap around to 0 again.  Not a very likely scenario, but better safe than sorry
     if (timer->_next_id == 0) // 0 is special, skip it over
@@ -110,7 +130,11 @@ int ThreadedTimer::add_task(TimerUnit unit, double value, bool single_shot, Time
 
     // We have the lock acquired so it is save to increment the id counter.
     task.task_id = timer->_next_id++;
-    timer->_tasks.push_back(task);
+    task.next_time = g_get_monotonic_time() + task.wait_time;
+
+    TimerTask &entry = timer->_tasks[task.task_id];
+    entry = task;
+    timer->schedule(entry);
 
     return task.task_id;
   }
@@ -121,7 +145,7 @@ int ThreadedTimer::add_task(TimerUnit unit, double value, bool single_shot, Time
 
 /**
  * Removes the given task from the task list by setting its stop flag. If the task is running
- * currently it can finish as usual. It is then removed on the next run of the scheduler.
+ * currently it can finish as usual. It is then removed when it returns.
  *
  * @param task_id The id of the task to remove. If it does not exist nothing happens.
  */
@@ -132,11 +156,28 @@ bool ThreadedTimer::remove_task(int task_id) {
 
 //--------------------------------------------------------------------------------------------------
 
-ThreadedTimer::ThreadedTimer(int base_frequency) : _terminate(false), _next_id(1) {
-  // Wait time in microseconds.
-  _wait_time = 1000 * 1000 / base_frequency;
+/**
+ * Returns statistics about the punctuality of the timer.
+ */
+TimerStats ThreadedTimer::get_stats() {
+  ThreadedTimer *timer = ThreadedTimer::get();
+  TimerLock lock(&timer->_timer_lock);
+  return timer->_stats;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+ThreadedTimer::ThreadedTimer() : _terminate(false), _next_id(1) {
+  _stats.fired = 0;
+  _stats.total_lateness = 0;
+  _stats.max_lateness = 0;
+
+  g_mutex_init(&_timer_lock);
+  g_cond_init(&_wakeup);
+
+  int worker_count = std::max(WORKER_THREAD_COUNT, (int)g_get_num_processors() / 2);
+  _pool = g_thread_pool_new((GFunc)pool_function, this, worker_count, FALSE, NULL);
   _thread = base::create_thread(start, this);
-  _pool = g_thread_pool_new((GFunc)pool_function, this, WORKER_THREAD_COUNT, FALSE, NULL);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -149,14 +190,21 @@ ThreadedTimer::~ThreadedTimer() {
   // Pending tasks are discarded.
   logDebug2("Threaded timer shutdown...\n");
 
-  // Don't lock the mutex or we might deadlock here if the mutex is currently held by the work loop.
-  _terminate = true;
+  // The timer thread doesn't hold the lock while it is waiting, so it is save to lock here.
+  {
+    TimerLock lock(&_timer_lock);
+    _terminate = true;
+    g_cond_signal(&_wakeup);
+  }
 
   // Wait for the timer thread to terminate.
   g_thread_join(_thread);
 
   g_thread_pool_free(_pool, TRUE, TRUE);
 
+  g_cond_clear(&_wakeup);
+  g_mutex_clear(&_timer_lock);
+
   logDebug2("Threaded timer shutdown done\n");
 }
 
@@ -180,80 +228,96 @@ void ThreadedTimer::pool_function(gpointer data, gpointer user_data) {
   ThreadedTimer *timer = static_cast<ThreadedTimer *>(user_data);
   TimerTask *task = static_cast<TimerTask *>(data);
 
+  bool do_stop;
   try {
-    bool do_stop = task->callback(task->task_id);
-    base::MutexLock lock(timer->_timer_lock);
-    task->stop = do_stop || task->single_shot;
-    task->scheduled = false;
+    do_stop = task->callback(task->task_id);
   } catch (std::exception &e) {
     // In the case of an exception we remove the task silently.
-    base::MutexLock lock(timer->_timer_lock);
-    task->stop = true;
-    task->scheduled = false;
+    do_stop = true;
     logWarning("Threaded timer: exception in pool function: %s\n", e.what());
   } catch (...) {
     // Most exceptions should be caught by the part above. Just to be on the safe side
     // do this extra branch.
-    base::MutexLock(timer->_timer_lock);
-    task->stop = true;
-    task->scheduled = false;
+    do_stop = true;
     logWarning("Threaded timer: unknown exception in pool function\n");
   }
 
+  TimerLock lock(&timer->_timer_lock);
+  task->stop = task->stop || do_stop || task->single_shot;
+  task->scheduled = false;
+
+  // Scheduled tasks are never removed from the task list, so the task pointer is still valid here.
+  if (task->stop)
+    timer->_tasks.erase(task->task_id);
+  else
+    timer->schedule(*task);
 }
 
 //--------------------------------------------------------------------------------------------------
 
-// Helper predicate for removing finished tasks.
-class IsStopped : public std::function<TimerTask (bool)> {
-public:
-  bool operator()(TimerTask &task) {
-    return task.stop;
-  }
-};
+/**
+ * Adds a deadline heap entry for the given task and wakes up the timer thread if this is now the earliest
+ * deadline. Must be called with the timer lock held.
+ */
+void ThreadedTimer::schedule(TimerTask &task) {
+  bool earliest = _deadlines.empty() || task.next_time < _deadlines.top().time;
+  TimerDeadline deadline = {task.next_time, task.task_id};
+  _deadlines.push(deadline);
+
+  if (earliest)
+    g_cond_signal(&_wakeup);
+}
 
 //--------------------------------------------------------------------------------------------------
 
 void ThreadedTimer::main_loop() {
-  // Provides a high-quality clock which is used to compute execution times of tasks.
-  GTimer *clock = g_timer_new();
-  g_timer_start(clock);
+  TimerLock lock(&_timer_lock);
   while (!_terminate) {
-    // This sleep call forms our base frequency.
-    g_usleep(_wait_time);
+    gint64 current_time = g_get_monotonic_time();
 
-    if (_terminate)
-      break;
+    // Execute all tasks which are due now.
+    while (!_deadlines.empty() && _deadlines.top().time <= current_time && !_terminate) {
+      TimerDeadline deadline = _deadlines.top();
+      _deadlines.pop();
 
-    // 1. Compute next execution time for new tasks.
-    base::MutexLock lock(_timer_lock);
-    for (std::list<TimerTask>::iterator iterator = _tasks.begin(); iterator != _tasks.end(); iterator++) {
-      if (iterator->next_time == 0)
-        iterator->next_time = g_timer_elapsed(clock, NULL) + iterator->wait_time;
-    }
+      TaskList::iterator iterator = _tasks.find(deadline.task_id);
+      if (iterator == _tasks.end())
+        continue;
+
+      // Skip outdated heap entries. A scheduled task gets a new entry once it returns.
+      TimerTask &task = iterator->second;
+      if (task.scheduled || task.next_time != deadline.time)
+        continue;
 
-    // 2. Execute all tasks which are due now.
-    // Processing of the task entries should be very fast here. No need to make a copy of them.
-    gdouble current_time = g_timer_elapsed(clock, NULL);
-    for (std::list<TimerTask>::iterator iterator = _tasks.begin(); iterator != _tasks.end(); ++iterator) {
-      if (_terminate)
-        break;
-
-      if (!iterator->scheduled && iterator->next_time <= current_time && !iterator->stop) {
-        // When the task is due push it to our thread pool. It will then get one of the
-        // free threads assigned to run in and pool_function is called in this thread's context.
-        // Do it only if it isn't already scheduled.
-        TimerTask &task = *iterator;
-        task.scheduled = true;
-        task.next_time += task.wait_time;
-        g_thread_pool_push(_pool, &task, NULL);
+      if (task.stop) {
+        _tasks.erase(iterator);
+        continue;
       }
+
+      gint64 lateness = current_time - task.next_time;
+      ++_stats.fired;
+      _stats.total_lateness += lateness;
+      if (lateness > _stats.max_lateness)
+        _stats.max_lateness = lateness;
+
+      // Keep the task's rhythm, but don't try to catch up on intervals we missed.
+      task.next_time += task.wait_time;
+      if (task.next_time <= current_time)
+        task.next_time += ((current_time - task.next_time) / task.wait_time + 1) * task.wait_time;
+
+      // When the task is due push it to our thread pool. It will then get one of the
+      // free threads assigned to run in and pool_function is called in this thread's context.
+      task.scheduled = true;
+      g_thread_pool_push(_pool, &task, NULL);
     }
 
-    // 3. Remove stopped task.
-    _tasks.remove_if(IsStopped());
+    if (_terminate)
+      break;
+
+    // Sleep until the next deadline, a new earlier deadline or the shutdown.
+    gint64 wake_time = _deadlines.empty() ? current_time + MAX_IDLE_WAIT : _deadlines.top().time;
+    g_cond_wait_until(&_wakeup, &_timer_lock, wake_time);
   }
-  g_timer_destroy(clock);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -261,17 +325,22 @@ void ThreadedTimer::main_loop() {
 /**
  * This function is actually doing the work for the static remove_task function.
  * @returns true, if the task could be removed, otherwise false.
- * If the task is already scheduled for execution it cannot be removed anymore.
+ * If the task is already scheduled for execution it cannot be removed anymore (but it won't
+ * be executed again).
  */
 bool ThreadedTimer::remove(int task_id) {
-  base::MutexLock lock(_timer_lock);
-  for (std::list<TimerTask>::iterator iterator = _tasks.begin(); iterator != _tasks.end(); iterator++) {
-    if (iterator->task_id == task_id) {
-      iterator->stop = true;
-      TimerTask &task = *iterator;
-      return !static_cast<bool>(g_thread_pool_move_to_front(_pool, &task));
-    }
+  TimerLock lock(&_timer_lock);
+  TaskList::iterator iterator = _tasks.find(task_id);
+  if (iterator == _tasks.end())
+    return true;
+
+  if (iterator->second.scheduled) {
+    iterator->second.stop = true;
+    return false;
   }
+
+  // The heap entry of this task is skipped once it becomes due.
+  _tasks.erase(iterator);
   return true;
 }
 
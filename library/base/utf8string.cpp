@@ -32,6 +32,11 @@
 #include <cctype>
 #include <memory>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define UTF8STRING_USE_SSE2
+#endif
+
 using boost::locale::conv::utf_to_utf;
 
 namespace base {
@@ -84,12 +89,11 @@ namespace base {
   }
 
   // Converts byte offset to UTF-8 character offset.
-  inline utf8string::size_type utf8_char_offset(const std::string& str, utf8string::size_type offset) {
+  inline utf8string::size_type utf8_char_offset(const utf8string& str, utf8string::size_type offset) {
     if (offset == utf8string::npos)
       return utf8string::npos;
 
-    const char* const pdata = str.data();
-    return g_utf8_pointer_to_offset(pdata, pdata + offset);
+    return str.byteOffsetToCharIndex(offset);
   }
 
   // Helper to implement ustring::find_first_of() and find_first_not_of().
@@ -123,6 +127,112 @@ namespace base {
     return utf8string::npos;
   }
 
+  //////////////////////////////////////////////////////////////////////////////
+  //  Character index
+  //////////////////////////////////////////////////////////////////////////////
+
+  // Number of characters between two checkpoints of the character index.
+  static const size_t CHAR_INDEX_STRIDE = 64;
+
+  // Returns true if the given 64 bytes are all ASCII and non-zero, which means they form 64 characters.
+  static inline bool isAsciiBlock(const char* p) {
+#ifdef UTF8STRING_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    __m128i flags = zero;
+    for (size_t i = 0; i < CHAR_INDEX_STRIDE; i += 16) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      flags = _mm_or_si128(flags, _mm_or_si128(v, _mm_cmpeq_epi8(v, zero)));
+    }
+    return _mm_movemask_epi8(flags) == 0;
+#else
+    // Word-wise check: no high bits set and no zero byte in any of the words.
+    const uint64_t high = 0x8080808080808080ULL;
+    const uint64_t low = 0x0101010101010101ULL;
+    for (size_t i = 0; i < CHAR_INDEX_STRIDE; i += 8) {
+      uint64_t word;
+      std::memcpy(&word, p + i, sizeof(word));
+      if ((word & high) != 0 || ((word - low) & ~word & high) != 0)
+        return false;
+    }
+    return true;
+#endif
+  }
+
+  struct utf8string::CharIndex {
+    bool ascii = true;  // All characters are single bytes, so character index == byte offset.
+    size_t length = 0;  // Number of characters, same as what g_utf8_strlen() returns.
+
+    // Byte offsets of every CHAR_INDEX_STRIDE'th character (only for non-ASCII text).
+    std::vector<size_t> checkpoints;
+
+    // Scans the text once. Character boundaries follow g_utf8_skip, exactly like the glib offset functions.
+    // Counting stops at a terminating zero or an incomplete last character, like g_utf8_strlen().
+    CharIndex(const std::string& text) {
+      const char* const utf8_skip = g_utf8_skip;
+      const char* const begin = text.data();
+      const char* const end = begin + text.size();
+      const char* p = begin;
+
+      std::vector<size_t> offsets;
+      while (p < end) {
+        // Pure ASCII stretches can be skipped without looking at single characters.
+        offsets.push_back(p - begin);
+        if (end - p >= (ptrdiff_t)CHAR_INDEX_STRIDE && isAsciiBlock(p)) {
+          p += CHAR_INDEX_STRIDE;
+          length += CHAR_INDEX_STRIDE;
+          continue;
+        }
+
+        size_t i = 0;
+        for (; i < CHAR_INDEX_STRIDE && p < end && *p != 0; ++i) {
+          const unsigned char c = static_cast<unsigned char>(*p);
+          if (c >= 0x80)
+            ascii = false;
+          if (p + utf8_skip[c] > end)
+            break;
+          p += utf8_skip[c];
+          ++length;
+        }
+        if (i < CHAR_INDEX_STRIDE)
+          break;
+      }
+
+      // Anything behind a terminating zero still counts for the offset conversions.
+      if (ascii && std::any_of(p, end, [](char c) { return static_cast<unsigned char>(c) >= 0x80; }))
+        ascii = false;
+      if (!ascii)
+        checkpoints.swap(offsets);
+    }
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+
+  std::shared_ptr<const utf8string::CharIndex> utf8string::charIndex() const {
+    std::shared_ptr<const CharIndex> index = std::atomic_load(&_char_index);
+    if (!index) {
+      index = std::make_shared<const CharIndex>(_inner_string);
+      std::atomic_store(&_char_index, index);
+    }
+    return index;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+
+  void utf8string::invalidateCharIndex() {
+    std::atomic_store(&_char_index, std::shared_ptr<const CharIndex>());
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+
+  /**
+   * Like charIndexToByteOffset() but returns npos for character indexes beyond the end of the text.
+   */
+  size_t utf8string::bytePosition(size_t index) const {
+    if (index == npos || index > length())
+      return npos;
+    return charIndexToByteOffset(index);
+  }
+
   //////////////////////////////////////////////////////////////////////////////
   //  utf8string::bounds class
   //////////////////////////////////////////////////////////////////////////////
@@ -139,6 +249,16 @@ namespace base {
         _count = utf8_byte_offset(str.data() + _index, count, str.size() - _index);
     }
 
+    // Same as above, using the character index of the string.
+    bounds(const utf8string& str, utf8string::size_type index, utf8string::size_type count)
+      : _index(str.bytePosition(index)), _count(utf8string::npos) {
+      if (_index == utf8string::npos) {
+        _index = str.bytes();
+        _count = 0;
+      } else if (count != utf8string::npos && count < str.length() - index)
+        _count = str.charIndexToByteOffset(index + count) - _index;
+    }
+
     utf8string::size_type index() const {
       return _index;
     }
@@ -228,7 +348,7 @@ namespace base {
   utf8string::utf8string(const std::wstring& s) : _inner_string(base::wstring_to_string(s)) {
   }
 
-  utf8string::utf8string(const utf8string& s) : _inner_string(s.to_string()) {
+  utf8string::utf8string(const utf8string& s) : _inner_string(s._inner_string), _char_index(std::atomic_load(&s._char_index)) {
   }
 
   utf8string::utf8string(size_t size, char c) : _inner_string(size, c) {
@@ -252,12 +372,12 @@ namespace base {
   }
 
   utf8string::utf8string(const char* s, size_t pos, size_t len) {
-    const bounds b(s, pos, len);
+    const bounds b(std::string(s), pos, len);
     _inner_string.assign(s, b.index(), b.count());
   }
 
   utf8string::utf8string(const utf8string& str, size_t pos, size_t len) {
-    const bounds b(str._inner_string, pos, len);
+    const bounds b(str, pos, len);
     _inner_string.assign(str._inner_string, b.index(), b.count());
   }
 
@@ -278,7 +398,12 @@ namespace base {
   }
 
   bool utf8string::validate() const {
-    return g_utf8_validate(_inner_string.c_str(), -1, nullptr) == TRUE;
+    // ASCII stretches are valid by definition, leave only the rest to glib.
+    const char* p = _inner_string.c_str();
+    const char* const end = p + _inner_string.size();
+    while (end - p >= (ptrdiff_t)CHAR_INDEX_STRIDE && isAsciiBlock(p))
+      p += CHAR_INDEX_STRIDE;
+    return g_utf8_validate(p, -1, nullptr) == TRUE;
   }
 
   utf8string utf8string::normalize() const {
@@ -316,6 +441,7 @@ namespace base {
 
   utf8string& utf8string::operator=(char c) {
     _inner_string = std::string(1, c);
+    invalidateCharIndex();
     return *this;
   }
 
@@ -480,11 +606,27 @@ namespace base {
   }
 
   size_t utf8string::charIndexToByteOffset(const size_t index) const {
-    return g_utf8_offset_to_pointer(this->c_str(), (glong)index) - this->c_str();
+    std::shared_ptr<const CharIndex> charIndex = this->charIndex();
+    if (charIndex->ascii)
+      return index;
+
+    // Continue from the closest checkpoint, same stepping as g_utf8_offset_to_pointer.
+    size_t checkpoint = std::min(index / CHAR_INDEX_STRIDE, charIndex->checkpoints.size() - 1);
+    const char* start = c_str() + charIndex->checkpoints[checkpoint];
+    return g_utf8_offset_to_pointer(start, (glong)(index - checkpoint * CHAR_INDEX_STRIDE)) - c_str();
   }
 
   size_t utf8string::byteOffsetToCharIndex(const size_t offset) const {
-    return g_utf8_pointer_to_offset(this->c_str(), this->c_str() + offset);
+    std::shared_ptr<const CharIndex> charIndex = this->charIndex();
+    if (charIndex->ascii)
+      return offset;
+
+    const std::vector<size_t>& checkpoints = charIndex->checkpoints;
+    size_t checkpoint = std::upper_bound(checkpoints.begin(), checkpoints.end(), offset) - checkpoints.begin();
+    if (checkpoint > 0)
+      --checkpoint;
+    const char* start = c_str() + checkpoints[checkpoint];
+    return checkpoint * CHAR_INDEX_STRIDE + g_utf8_pointer_to_offset(start, c_str() + offset);
   }
 
   utf8string::iterator::iterator(char* s, char* p) : str(s) {
@@ -532,8 +674,9 @@ namespace base {
   //  Operations
   //////////////////////////////////////////////////////////////////////////////
   utf8string& utf8string::erase(size_type index, size_type count) {
-    const bounds b(_inner_string, index, count);
+    const bounds b(*this, index, count);
     _inner_string.erase(b.index(), b.count());
+    invalidateCharIndex();
     return *this;
   }
   //
@@ -541,21 +684,31 @@ namespace base {
   //
   utf8string& utf8string::append(const char* s) {
     _inner_string += s;
+    invalidateCharIndex();
+    return *this;
+  }
+
+  utf8string& utf8string::append(const char* s, size_type count) {
+    _inner_string.append(s, count);
+    invalidateCharIndex();
     return *this;
   }
 
   utf8string& utf8string::append(size_type count, char ch) {
     _inner_string.append(count, ch);
+    invalidateCharIndex();
     return *this;
   }
 
   utf8string& utf8string::append(size_type count, utf8string::utf8char ch) {
     _inner_string.append(utf8string(count, ch)._inner_string);
+    invalidateCharIndex();
     return *this;
   }
 
   utf8string& utf8string::append(const utf8string& str) {
     _inner_string += str._inner_string;
+    invalidateCharIndex();
     return *this;
   }
 
@@ -564,16 +717,19 @@ namespace base {
   //
   utf8string& utf8string::operator+=(const utf8string& str) {
     _inner_string += str._inner_string;
+    invalidateCharIndex();
     return *this;
   }
 
   utf8string& utf8string::operator+=(const utf8string::utf8char& c) {
     _inner_string.append(1, c);
+    invalidateCharIndex();
     return *this;
   }
 
   utf8string& utf8string::operator+=(const char* s) {
     _inner_string.append(s);
+    invalidateCharIndex();
     return *this;
   }
 
@@ -604,28 +760,25 @@ namespace base {
   }
 
   base::utf8string::const_reference utf8string::at(size_type pos) const {
-    const size_type byte_offset = utf8_byte_offset(_inner_string, pos);
+    const size_type byte_offset = bytePosition(pos);
 
     // Throws std::out_of_range if the index is invalid.
     return g_utf8_get_char(&_inner_string.at(byte_offset));
   }
 
   utf8string::const_reference utf8string::operator[](size_type pos) const {
-    return g_utf8_get_char(g_utf8_offset_to_pointer(_inner_string.data(), (glong)pos));
+    return g_utf8_get_char(_inner_string.data() + charIndexToByteOffset(pos));
   }
 
   //////////////////////////////////////////////////////////////////////////////
   //  Capacity
   //////////////////////////////////////////////////////////////////////////////
   size_t utf8string::size() const {
-    const char* ptr = _inner_string.data();
-    return g_utf8_pointer_to_offset(ptr, ptr + _inner_string.size());
+    return length();
   }
 
   size_t utf8string::length() const {
-    const char* ptr = _inner_string.data();
-    // return g_utf8_pointer_to_offset(ptr, ptr + _inner_string.size());
-    return g_utf8_strlen(ptr, _inner_string.size());
+    return charIndex()->length;
   }
 
   void utf8string::resize(size_t n) {
@@ -638,10 +791,12 @@ namespace base {
 
   void utf8string::resize(size_t n, char c) {
     const size_type size_now = size();
-    if (n < size_now)
+    if (n < size_now) {
       erase(n, npos);
-    else if (n > size_now)
+    } else if (n > size_now) {
       _inner_string.append(n - size_now, c);
+    }
+    invalidateCharIndex();
   }
 
   bool utf8string::empty() const {
@@ -660,20 +815,19 @@ namespace base {
   //  Search
   //////////////////////////////////////////////////////////////////////////////
   utf8string::size_type utf8string::find(const char* s, size_type pos) const {
-    return utf8_char_offset(_inner_string, _inner_string.find(s, utf8_byte_offset(_inner_string, pos)));
+    return utf8_char_offset(*this, _inner_string.find(s, bytePosition(pos)));
   }
 
   utf8string::size_type utf8string::find(const utf8string& s, size_type pos) const {
-    return utf8_char_offset(_inner_string, _inner_string.find(s._inner_string, utf8_byte_offset(_inner_string, pos)));
+    return utf8_char_offset(*this, _inner_string.find(s._inner_string, bytePosition(pos)));
   }
 
   utf8string::size_type utf8string::find(char ch, size_type pos) const {
-    return utf8_char_offset(_inner_string, _inner_string.find(ch, utf8_byte_offset(_inner_string, pos)));
+    return utf8_char_offset(*this, _inner_string.find(ch, bytePosition(pos)));
   }
 
   utf8string::size_type utf8string::find(const utf8string::utf8char& ch, size_type pos) const {
-    return utf8_char_offset(_inner_string,
-                            _inner_string.find((const char*)ch, utf8_byte_offset(_inner_string, pos), ch.length()));
+    return utf8_char_offset(*this, _inner_string.find((const char*)ch, bytePosition(pos), ch.length()));
   }
 
   utf8string::size_type utf8string::find_first_of(const utf8string& str, size_type pos) const {
@@ -54,27 +54,40 @@ namespace sql {
     return _batch_exec_err_count;
   }
 
+  /**
+   * Executes statements as they are delivered by statement_source, e.g. from a script file which is too large
+   * to be loaded at once. Progress is what the source reports. Statements are not added to the sql log.
+   */
+  long SqlBatchExec::operator()(sql::Statement *stmt, const Statement_source &statement_source) {
+    _batch_exec_success_count = 0;
+    _batch_exec_err_count = 0;
+    _sql_log.clear();
+
+    std::string statement;
+    while (statement_source(statement, _batch_exec_progress_state)) {
+      bool succeeded = exec_statement(stmt, statement, _batch_exec_err_count);
+      if (_batch_exec_progress_cb)
+        _batch_exec_progress_cb(_batch_exec_progress_state);
+
+      if (!succeeded && _stop_on_error)
+        break;
+    }
+
+    if (_batch_exec_stat_cb)
+      _batch_exec_stat_cb(_batch_exec_success_count, _batch_exec_err_count);
+
+    return _batch_exec_err_count;
+  }
+
   void SqlBatchExec::exec_sql_script(sql::Statement *stmt, std::list<std::string> &statements,
                                      long &batch_exec_err_count) {
     _batch_exec_progress_state = 0;
     _batch_exec_progress_inc = 1.f / statements.size();
 
     for (std::list<std::string>::const_iterator i = statements.begin(), i_end = statements.end(); i != i_end; ++i) {
-      try {
-        _sql_log.push_back(*i);
-        if (stmt->execute(*i))
-          std::unique_ptr<sql::ResultSet> rs(stmt->getResultSet());
-        ++_batch_exec_success_count;
-      } catch (SQLException &e) {
-        ++batch_exec_err_count;
-        if (!_error_cb)
-          throw;
-        else {
-          if (&_batch_exec_err_count != &batch_exec_err_count) // applies only to failback scripts
-            _error_cb(-1, "Error when running failback script. Details follow.", "");
-          _error_cb(e.getErrorCode(), e.what(), *i);
-        }
-      }
+      _sql_log.push_back(*i);
+      exec_statement(stmt, *i, batch_exec_err_count);
+
       _batch_exec_progress_state += _batch_exec_progress_inc;
       if (_batch_exec_progress_cb)
         _batch_exec_progress_cb(_batch_exec_progress_state);
@@ -84,4 +97,23 @@ namespace sql {
     }
   }
 
+  bool SqlBatchExec::exec_statement(sql::Statement *stmt, const std::string &statement, long &batch_exec_err_count) {
+    try {
+      if (stmt->execute(statement))
+        std::unique_ptr<sql::ResultSet> rs(stmt->getResultSet());
+      ++_batch_exec_success_count;
+    } catch (SQLException &e) {
+      ++batch_exec_err_count;
+      if (!_error_cb)
+        throw;
+      else {
+        if (&_batch_exec_err_count != &batch_exec_err_count) // applies only to failback scripts
+          _error_cb(-1, "Error when running failback script. Details follow.", "");
+        _error_cb(e.getErrorCode(), e.what(), statement);
+      }
+      return false;
+    }
+    return true;
+  }
+
 } // namespace sql
@@ -38,10 +38,15 @@ namespace sql {
     SqlBatchExec();
 
   public:
+    // Returns false when there are no more statements, otherwise the next statement and the overall progress.
+    typedef std::function<bool(std::string &, float &)> Statement_source;
+
     long operator()(sql::Statement *stmt, std::list<std::string> &statements);
+    long operator()(sql::Statement *stmt, const Statement_source &statement_source);
 
   private:
     void exec_sql_script(sql::Statement *stmt, std::list<std::string> &statements, long &batch_exec_err_count);
+    bool exec_statement(sql::Statement *stmt, const std::string &statement, long &batch_exec_err_count);
 
   public:
     typedef std::function<int(long long, const std::string &, const std::string &)> Error_cb;
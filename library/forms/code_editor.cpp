@@ -1399,6 +1399,17 @@ void CodeEditor::set_features(CodeEditorFeature features, bool flag) {
 
   if ((features & mforms::FeatureAutoIndent) != 0)
     _auto_indent = true;
+
+  if ((features & mforms::FeatureLargeFile) != 0) {
+    // Scintilla styles text lazily up to the visible range, but folding and wrapping require the whole
+    // document to be processed.
+    _code_editor_impl->send_editor(this, SCI_SETPROPERTY, (uptr_t) "fold", flag ? (sptr_t) "0" : (sptr_t) "1");
+    _code_editor_impl->send_editor(this, SCI_SETMARGINWIDTHN, 2, flag ? 0 : 13);
+    if (flag) {
+      _code_editor_impl->send_editor(this, SCI_SETWRAPMODE, SC_WRAP_NONE, 0);
+      _code_editor_impl->send_editor(this, SCI_SETIDLESTYLING, SC_IDLESTYLING_NONE, 0);
+    }
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
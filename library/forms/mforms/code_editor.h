@@ -107,6 +107,8 @@ namespace mforms {
     FeatureScrollOnResize = 1 << 6,    // Scroll caret into view if it would be hidden by a resize action.
     FeatureFolding = 1 << 7,           // Enable code folding.
     FeatureAutoIndent = 1 << 8,        // Auto indent the new line on pressing enter.
+    FeatureLargeFile = 1 << 9,         // Avoid any work for the whole document (folding, wrapping), so that only
+                                       // the visible part is styled and laid out.
 
     FeatureAll = 0xFFFF,
   };
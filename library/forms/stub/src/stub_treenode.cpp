@@ -250,20 +250,50 @@ mforms::TreeNodeRef TreeNodeWrapper::get_parent() const {
 //--------------------------------------------------------------------------------------------------
 
 mforms::TreeNodeRef TreeNodeWrapper::previous_sibling() const {
-  return mforms::TreeNodeRef();
+  mforms::TreeNodeRef parent(_parent);
+  TreeNodeWrapper *inner_parent = dynamic_cast<TreeNodeWrapper *>(parent.ptr());
+  if (inner_parent == NULL)
+    return mforms::TreeNodeRef();
+
+  int index = inner_parent->get_child_index(mforms::TreeNodeRef(const_cast<TreeNodeWrapper *>(this)));
+  return index > 0 ? inner_parent->get_child(index - 1) : mforms::TreeNodeRef();
 }
 
 mforms::TreeNodeRef TreeNodeWrapper::next_sibling() const {
-  return mforms::TreeNodeRef();
+  mforms::TreeNodeRef parent(_parent);
+  TreeNodeWrapper *inner_parent = dynamic_cast<TreeNodeWrapper *>(parent.ptr());
+  if (inner_parent == NULL)
+    return mforms::TreeNodeRef();
+
+  int index = inner_parent->get_child_index(mforms::TreeNodeRef(const_cast<TreeNodeWrapper *>(this)));
+  return index >= 0 ? inner_parent->get_child(index + 1) : mforms::TreeNodeRef();
 }
 
 void TreeNodeWrapper::remove_children() {
   mforms::TreeNode::remove_children();
 }
 
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Moves this node right before or after the given one, which may have a different parent.
+ */
 void TreeNodeWrapper::move_node(mforms::TreeNodeRef node, bool before) {
+  TreeNodeWrapper *location = dynamic_cast<TreeNodeWrapper *>(node.ptr());
+  if (location == NULL || location == this)
+    return;
+
+  TreeNodeWrapper *new_parent = dynamic_cast<TreeNodeWrapper *>(location->_parent.ptr());
+  if (new_parent == NULL)
+    return;
+
+  remove_from_parent();
+  int index = new_parent->get_child_index(node);
+  new_parent->insert_child(before ? index : index + 1, *this);
 }
 
+//--------------------------------------------------------------------------------------------------
+
 void TreeNodeWrapper::expand() {
   _expanded = true;
 }
@@ -287,6 +317,18 @@ std::string TreeNodeWrapper::get_tag() const {
   return _tag;
 }
 
+mforms::TreeNodeRef TreeNodeWrapper::find_node_with_tag(const std::string &tag) {
+  for (std::vector<TreeNodeWrapper *>::const_iterator i = _children.begin(); i != _children.end(); ++i) {
+    if ((*i)->_tag == tag)
+      return mforms::TreeNodeRef(*i);
+
+    mforms::TreeNodeRef node = (*i)->find_node_with_tag(tag);
+    if (node.is_valid())
+      return node;
+  }
+  return mforms::TreeNodeRef();
+}
+
 void TreeNodeWrapper::set_data(mforms::TreeNodeData *data) {
   pdata = data;
 }
@@ -115,6 +115,7 @@ public:
 
   virtual void set_tag(const std::string &tag);
   virtual std::string get_tag() const;
+  mforms::TreeNodeRef find_node_with_tag(const std::string &tag);
 
   virtual void set_data(mforms::TreeNodeData *data);
   virtual mforms::TreeNodeData *get_data() const;
@@ -62,6 +62,7 @@ namespace mforms {
       }
 
       static void clear(TreeView *self) {
+        self->root_node()->remove_children();
       }
 
       static TreeSelectionMode get_selection_mode(TreeView *self) {
@@ -112,7 +113,8 @@ namespace mforms {
       }
 
       static TreeNodeRef node_with_tag(TreeView *self, const std::string &tag) {
-        return TreeNodeRef();
+        TreeViewWrapper *ptree_node_view = dynamic_cast<TreeViewWrapper *>(ObjectWrapper::getData(self));
+        return ptree_node_view->_root->find_node_with_tag(tag);
       }
 
       static void scrollToNode(TreeView *self, TreeNodeRef node) {
@@ -22,7 +22,9 @@
  */
 
 #include <assert.h>
+#include <string.h>
 #include <algorithm>
+#include <typeinfo>
 
 #include "base/util_functions.h"
 #include "base/log.h"
@@ -63,6 +65,294 @@ namespace grt {
     return result;
   }
 
+  //------------------------------------------------------------------------------------------------
+
+  namespace {
+
+    const uint64_t HashSeed = 0xcbf29ce484222325ULL;
+    const uint64_t HashPrime = 0x100000001b3ULL;
+
+    inline uint64_t hash_combine(uint64_t hash, uint64_t value) {
+      value ^= value >> 33;
+      value *= 0xff51afd7ed558ccdULL;
+      value ^= value >> 33;
+      return (hash ^ value) * HashPrime + 0x9e3779b97f4a7c15ULL;
+    }
+
+    inline uint64_t hash_string(uint64_t hash, const char *data, size_t length) {
+      uint64_t value = HashSeed;
+      for (size_t i = 0; i < length; ++i) {
+        value ^= (unsigned char)data[i];
+        value *= HashPrime;
+      }
+      return hash_combine(hash_combine(hash, length), value);
+    }
+
+    inline uint64_t hash_string(uint64_t hash, const std::string &s) {
+      return hash_string(hash, s.data(), s.size());
+    }
+
+    internal::Object *owner_of(internal::Object *object) {
+      if (!object->has_member("owner"))
+        return nullptr;
+      ValueRef owner(object->get_member("owner"));
+      return owner.is_valid() && owner.type() == ObjectType ? static_cast<internal::Object *>(owner.valueptr())
+                                                            : nullptr;
+    }
+
+    /**
+     * Computes structural hashes with exactly the member selection GrtDiff::on_object() uses, so that equal
+     * hashes mean the differ would report nothing. Hashes are cached in the objects and reused until one of
+     * the change hooks in grt::internal::Object invalidates them.
+     *
+     * Anything the hash covers which is not owned by the object (names of referenced objects, followed
+     * references, match keys of list items) ties the cached entry to the global rename or change serial.
+     * Containers which can change without notifying the object aren't cached at all.
+     */
+    class StructuralHasher {
+    public:
+      typedef internal::Object::StructuralHash Entry;
+
+      StructuralHasher(const Omf *omf) : _omf(omf) {
+        _key = hash_string(HashSeed, typeid(*omf).name(), strlen(typeid(*omf).name()));
+        _key = hash_combine(_key, omf->dontdiff_mask);
+        _key = hash_combine(_key, (omf->skip_routine_definer ? 1 : 0) | (omf->case_sensitive ? 2 : 0));
+        if (_key == 0)
+          _key = 1;
+      }
+
+      Entry object_hash(internal::Object *object) {
+        std::shared_ptr<const Entry> cached(object->structural_hash());
+        if (cached && cached->key == _key && is_current(*cached))
+          return *cached;
+
+        Entry entry;
+        entry.key = _key;
+        entry.name_serial = internal::Object::structural_name_serial();
+        entry.change_serial = internal::Object::structural_change_serial();
+        entry.dependency = Entry::Owned;
+        entry.comparable = true;
+
+        // Only followed references can lead back here, never ownership.
+        if (std::find(_active.begin(), _active.end(), object) != _active.end()) {
+          entry.value = 0;
+          entry.dependency = Entry::Volatile;
+          entry.comparable = false;
+          return entry;
+        }
+        _active.push_back(object);
+
+        entry.value = hash_string(HashSeed, object->class_name());
+
+        MetaClass *meta = object->get_metaclass();
+        const bool routine = _omf->skip_routine_definer &&
+                             (object->class_name() == "db.mysql.Routine" || object->class_name() == "db.Routine");
+        do {
+          for (MetaClass::MemberList::const_iterator iter = meta->get_members_partial().begin();
+               iter != meta->get_members_partial().end(); ++iter) {
+            if (iter->second.overrides)
+              continue;
+
+            const std::string &name = iter->second.name;
+            std::string attr = meta->get_member_attribute(name, "dontdiff");
+            if (attr.size() && (base::atoi<int>(attr, 0) & _omf->dontdiff_mask))
+              continue;
+
+            if (routine && (name == "sqlDefinition" || name == "definer"))
+              continue;
+
+            ValueRef value(object->get_member(name));
+            entry.value = hash_string(entry.value, name);
+
+            const bool dontfollow =
+              !iter->second.owned_object && (name != "flags") && (name != "columns" || meta->is_a("db.Index"));
+            if (!dontfollow || !value.is_valid() || is_simple_type(value.type()))
+              value_hash(entry, object, value);
+            else if (value.type() != ObjectType)
+              entry.value = hash_combine(entry.value, value.type()); // Containers which are not followed.
+            else if (GrtObjectRef::can_wrap(value)) {
+              // References which are not followed are compared by name.
+              entry.value = hash_combine(entry.value, ObjectType);
+              entry.value = hash_string(entry.value, GrtObjectRef::cast_from(value)->name());
+              depend(entry, Entry::Names);
+            } else
+              entry.comparable = false;
+          }
+          meta = meta->parent();
+        } while (meta != 0);
+
+        _active.pop_back();
+
+        if (entry.dependency != Entry::Volatile)
+          object->set_structural_hash(std::make_shared<const Entry>(entry));
+        return entry;
+      }
+
+    private:
+      const Omf *_omf;
+      uint64_t _key;
+      std::vector<internal::Object *> _active;
+
+      static bool is_current(const Entry &entry) {
+        if (entry.dependency >= Entry::Names && entry.name_serial != internal::Object::structural_name_serial())
+          return false;
+        if (entry.dependency >= Entry::Changes && entry.change_serial != internal::Object::structural_change_serial())
+          return false;
+        return true;
+      }
+
+      static void depend(Entry &entry, Entry::Dependency dependency) {
+        if (entry.dependency < dependency)
+          entry.dependency = dependency;
+      }
+
+      // Mirrors GrtDiff::on_value(), container is the object the value is reached from.
+      void value_hash(Entry &entry, internal::Object *container, const ValueRef &value) {
+        if (!value.is_valid()) {
+          entry.value = hash_combine(entry.value, UnknownType);
+          return;
+        }
+
+        entry.value = hash_combine(entry.value, value.type());
+        switch (value.type()) {
+          case IntegerType:
+            entry.value = hash_combine(entry.value, (uint64_t) * IntegerRef::cast_from(value));
+            break;
+
+          case DoubleType: {
+            double d = *DoubleRef::cast_from(value);
+            uint64_t bits;
+            memcpy(&bits, &d, sizeof(bits));
+            entry.value = hash_combine(entry.value, bits);
+            if (d != d) // NaN never compares equal.
+              entry.comparable = false;
+            break;
+          }
+
+          case StringType:
+            entry.value = hash_string(entry.value, *StringRef::cast_from(value));
+            break;
+
+          case ListType:
+            list_hash(entry, container, BaseListRef::cast_from(value));
+            break;
+
+          case DictType:
+            dict_hash(entry, container, DictRef::cast_from(value));
+            break;
+
+          case ObjectType: {
+            internal::Object *child = static_cast<internal::Object *>(value.valueptr());
+            Entry child_entry(object_hash(child));
+            entry.value = hash_combine(entry.value, child_entry.value);
+            entry.comparable = entry.comparable && child_entry.comparable;
+            depend(entry, child_entry.dependency);
+
+            // Changes in objects owned elsewhere don't reach us through the owner chain.
+            if (container == nullptr || owner_of(child) != container)
+              depend(entry, Entry::Changes);
+            break;
+          }
+
+          default:
+            entry.comparable = false;
+            break;
+        }
+      }
+
+      // GrtListDiff matches items with omf->equal(), so the items' match keys are part of the structure.
+      void list_hash(Entry &entry, internal::Object *container, const BaseListRef &list) {
+        internal::OwnedList *owned = dynamic_cast<internal::OwnedList *>(&list.content());
+        if (container == nullptr || owned == nullptr || owned->owner_of_owned_list() != container)
+          depend(entry, Entry::Volatile);
+
+        entry.value = hash_combine(entry.value, list.content_type());
+        entry.value = hash_combine(entry.value, list.count());
+
+        std::string item_class;
+        for (size_t i = 0; i < list.count(); ++i) {
+          const ValueRef &item(list.get(i));
+          if (!item.is_valid()) {
+            entry.comparable = false; // Null items never compare equal.
+            continue;
+          }
+
+          std::string key;
+          if (_omf->match_key(item, key))
+            entry.value = hash_string(entry.value, key);
+          else
+            entry.comparable = false;
+
+          if (item.type() == ObjectType) {
+            // Match keys may use names of other objects (owners, referenced columns).
+            depend(entry, Entry::Names);
+
+            const std::string &class_name(static_cast<internal::Object *>(item.valueptr())->class_name());
+            if (item_class.empty())
+              item_class = class_name;
+            else if (item_class != class_name)
+              entry.comparable = false;
+          }
+
+          value_hash(entry, container, item);
+        }
+      }
+
+      void dict_hash(Entry &entry, internal::Object *container, const DictRef &dict) {
+        internal::OwnedDict *owned = dynamic_cast<internal::OwnedDict *>(&dict.content());
+        if (container == nullptr || owned == nullptr || owned->owner_of_owned_dict() != container)
+          depend(entry, Entry::Volatile);
+
+        entry.value = hash_combine(entry.value, dict.count());
+        for (internal::Dict::const_iterator iter = dict.begin(); iter != dict.end(); ++iter) {
+          entry.value = hash_string(entry.value, iter->first);
+          if (!iter->second.is_valid())
+            entry.comparable = false;
+          value_hash(entry, container, iter->second);
+        }
+      }
+    };
+  }
+
+  bool Omf::simple_match_key(const ValueRef &value, std::string &key) {
+    if (!value.is_valid()) {
+      key.clear();
+      return true;
+    }
+
+    switch (value.type()) {
+      case IntegerType:
+        key = "i" + std::to_string(*IntegerRef::cast_from(value));
+        return true;
+
+      case DoubleType: {
+        double d = *DoubleRef::cast_from(value);
+        if (d != d)
+          return false;
+        if (d == 0)
+          d = 0.0; // -0.0 == 0.0
+        key.assign("d");
+        key.append((const char *)&d, sizeof(d));
+        return true;
+      }
+
+      case StringType:
+        key = "s" + *StringRef::cast_from(value);
+        return true;
+
+      default:
+        return false; // Containers and objects compare by identity.
+    }
+  }
+
+  bool structural_hash(const ObjectRef &object, const Omf *omf, uint64_t &hash) {
+    StructuralHasher::Entry entry(StructuralHasher(omf).object_hash(static_cast<internal::Object *>(object.valueptr())));
+    hash = entry.value;
+    return entry.comparable;
+  }
+
+  //------------------------------------------------------------------------------------------------
+
   bool is_any(const ValueRef &v) {
     return !v.is_valid() || v.type() == AnyType;
   }
@@ -151,6 +441,14 @@ namespace grt {
         return std::shared_ptr<DiffChange>();
     }
 
+    // Structurally identical subtrees can't produce any change, so there's no need to descend into them.
+    if (omf != nullptr) {
+      uint64_t source_hash, target_hash;
+      if (structural_hash(source, omf, source_hash) && structural_hash(target, omf, target_hash) &&
+          source_hash == target_hash)
+        return std::shared_ptr<DiffChange>();
+    }
+
     // Compare all members of the objects with each other, looking for any differences
     do {
       for (MetaClass::MemberList::const_iterator iter = meta->get_members_partial().begin();
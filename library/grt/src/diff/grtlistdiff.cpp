@@ -31,6 +31,10 @@
 
 #include <memory>
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 namespace grt {
   // typedef ListDifference<ValueRef, internal::List::raw_iterator, internal::List::raw_iterator> GrtListDifference;
@@ -124,6 +128,59 @@ namespace grt {
     //  std::reverse(res.begin(), res.end());
   }
 
+  // Lists with at least this many matched objects have their items diffed on several threads.
+  static const size_t PARALLEL_DIFF_THRESHOLD = 8;
+
+  // Set on diff worker threads (and on the calling thread while it takes part), so nested lists stay sequential.
+  static thread_local bool in_diff_worker = false;
+
+  /**
+   * Diffs the given item pairs, on several threads if the omf allows it. Results are stored by index so the
+   * order of the generated changes doesn't depend on scheduling.
+   */
+  static void diff_items(const std::vector<std::pair<ValueRef, ValueRef> > &pairs, const std::vector<size_t> &indexes,
+                         const Omf *omf, std::vector<std::shared_ptr<ListItemChange> > &results) {
+    results.resize(pairs.size());
+
+    size_t thread_count = omf ? omf->threads : 1;
+    if (thread_count == 0)
+      thread_count = std::max(1U, std::thread::hardware_concurrency());
+
+    if (in_diff_worker || thread_count < 2 || pairs.size() < PARALLEL_DIFF_THRESHOLD ||
+        pairs.front().first.type() != ObjectType) {
+      for (size_t i = 0; i < pairs.size(); ++i)
+        results[i] = create_item_modified_change(pairs[i].first, pairs[i].second, omf, indexes[i]);
+      return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto worker = [&]() {
+      in_diff_worker = true;
+      try {
+        for (size_t i = next++; i < pairs.size(); i = next++)
+          results[i] = create_item_modified_change(pairs[i].first, pairs[i].second, omf, indexes[i]);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error)
+          error = std::current_exception();
+        next = pairs.size();
+      }
+      in_diff_worker = false;
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min(thread_count, pairs.size()); ++i)
+      threads.emplace_back(worker);
+    worker();
+    for (auto &thread : threads)
+      thread.join();
+
+    if (error)
+      std::rethrow_exception(error);
+  }
+
   bool diffPred(const std::shared_ptr<ListItemChange> &a, const std::shared_ptr<ListItemChange> &b) {
     if (a->get_change_type() == grt::ListItemRemoved)
       if (b->get_change_type() == grt::ListItemRemoved)
@@ -211,16 +268,22 @@ namespace grt {
       changes.push_back(orderchange);
     }
 
+    std::vector<std::pair<ValueRef, ValueRef> > modified_pairs;
+    std::vector<size_t> modified_indexes;
     for (TIndexContainer::iterator It = stable_elements.begin(); It != stable_elements.end(); ++It) {
       internal::List::raw_const_iterator It_target = find_if(target.content().raw_begin(), target.content().raw_end(),
                 std::bind(OmfEqPred(comparer), std::placeholders::_1, source.get(*It)));
       if (It_target != target.content().raw_end()) {
-        std::shared_ptr<ListItemChange> change =
-          create_item_modified_change(source.get(*It), *It_target, omf, target.get_index(*It_target));
-        if (change)
-          changes.push_back(change);
+        modified_pairs.push_back(std::make_pair(source.get(*It), *It_target));
+        modified_indexes.push_back(target.get_index(*It_target));
       }
     }
+
+    std::vector<std::shared_ptr<ListItemChange> > modified_changes;
+    diff_items(modified_pairs, modified_indexes, omf, modified_changes);
+    for (size_t i = 0; i < modified_changes.size(); ++i)
+      if (modified_changes[i])
+        changes.push_back(modified_changes[i]);
     ChangeSet retval;
     std::sort(changes.begin(), changes.end(), diffPred);
     for (std::vector<std::shared_ptr<ListItemChange> >::const_iterator It = changes.begin(); It != changes.end(); ++It)
@@ -217,6 +217,16 @@ internal::Value* internal::Value::retain() {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+internal::Value* internal::Value::retain_if_alive() {
+  for (base::refcount_t count = g_atomic_int_get(&_refcount); count > 0; count = g_atomic_int_get(&_refcount)) {
+    if (g_atomic_int_compare_and_exchange(&_refcount, count, count + 1))
+      return this;
+  }
+  return nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void internal::Value::release() {
 #ifdef WB_DEBUG
   if (_refcount == 0)
@@ -667,6 +677,17 @@ void GRT::serialize(const ValueRef &value, const std::string &path, const std::s
   ser.save_to_xml(value, path, doctype, version, list_objects_as_links);
 }
 
+xmlDocPtr GRT::serialize_xml(const ValueRef &value, const std::string &doctype, const std::string &version,
+                             bool list_objects_as_links) {
+  internal::Serializer ser;
+
+  return ser.create_xmldoc_for_value(value, doctype, version, list_objects_as_links);
+}
+
+void GRT::save_xml(xmlDocPtr doc, const std::string &path) {
+  internal::Serializer::save_xmldoc(doc, path);
+}
+
 std::shared_ptr<grt::internal::Unserializer> GRT::get_unserializer() {
   return std::shared_ptr<grt::internal::Unserializer>(new internal::Unserializer(_check_serialized_crc));
 };
@@ -1004,6 +1025,12 @@ Shell *GRT::get_shell() {
 
 //--------------------------------------------------------------------------------
 
+static thread_local SlotHolder *threadMessageSlot = nullptr;
+
+void GRT::setThreadMessageHandler(SlotHolder *slot) {
+  threadMessageSlot = slot;
+}
+
 void GRT::pushMessageHandler(SlotHolder *slot) {
   base::RecMutexLock lock(_message_mutex);
   _messageSlotStack.push_back(slot);
@@ -1029,6 +1056,9 @@ void GRT::removeMessageHandler(SlotHolder *slot) {
 }
 
 bool GRT::handle_message(const Message &msg, void *sender) {
+  if (threadMessageSlot != nullptr && threadMessageSlot->slot(msg, sender))
+    return true;
+
   // Don't log any message if there's no message slot is occupied. It just means
   // we don't want anything logged.
   if (!_messageSlotStack.empty()) {
@@ -2072,6 +2072,12 @@ namespace grt {
      */
     bool foreach_validator(const ObjectRef &obj, const Validator::Tag &tag);
 
+    /** Tells if validators were added to this class (not counting parent classes).
+     */
+    bool has_validators() const {
+      return !_validators.empty();
+    }
+
     inline const MemberList &get_members_partial() {
       return _members;
     }
@@ -2537,6 +2543,14 @@ namespace grt {
 
     std::string serialize_xml_data(const ValueRef &value, const std::string &doctype = "",
                                    const std::string &version = "", bool list_objects_as_links = false);
+
+    // Serialization in two steps, so big documents can be written in the background. serialize_xml() takes a
+    // snapshot of the value as XML tree and runs on the thread that owns the value (the value must not change
+    // meanwhile). Only save_xml(), which formats and writes that tree, may run on any thread. The caller owns the
+    // returned document.
+    xmlDocPtr serialize_xml(const ValueRef &value, const std::string &doctype = "", const std::string &version = "",
+                            bool list_objects_as_links = false);
+    static void save_xml(xmlDocPtr doc, const std::string &path);
     ValueRef unserialize_xml_data(const std::string &data);
 
     // globals
@@ -2718,6 +2732,10 @@ namespace grt {
     void popMessageHandler();
     void removeMessageHandler(SlotHolder *slot);
 
+    // The handler stack is shared by all threads. Threads running tasks next to the dispatcher thread set a
+    // handler of their own here, which gets their messages first. Pass nullptr to remove it (it's not deleted).
+    void setThreadMessageHandler(SlotHolder *slot);
+
     void push_status_query_handler(const StatusQuerySlot &slot);
     void pop_status_query_handler();
     bool query_status();
@@ -27,6 +27,9 @@
 #include "base/string_utilities.h"
 
 #include <iostream>
+#include <set>
+#include <typeinfo>
+#include <vector>
 #include <time.h>
 
 #ifdef _MSC_VER
@@ -104,12 +107,92 @@ static std::string member_for_object_dict(const ObjectRef &object, const DictRef
   return name;
 }
 
+static size_t value_footprint(const ValueRef &value, bool owned, std::set<const internal::Value *> &visited);
+
+static size_t object_footprint(const ObjectRef &object, std::set<const internal::Value *> &visited) {
+  MetaClass *meta = object.get_metaclass();
+  size_t size = sizeof(internal::Object) + object.id().capacity();
+
+  meta->foreach_member([&](const MetaClass::Member *member) {
+    if (member->calculated || member->delegate_get)
+      return true;
+
+    // Referenced objects are owned by someone else, only owned ones belong to this subtree.
+    ValueRef value = meta->get_member_value((internal::Object *)object.valueptr(), member);
+    if (value.is_valid() && (value.type() != ObjectType || member->owned_object))
+      size += value_footprint(value, member->owned_object, visited);
+    return true;
+  });
+  return size;
+}
+
+/** Approximate size of a value, including all content owned by it. Objects in lists and dicts
+ *  are only counted if the container owns them.
+ */
+static size_t value_footprint(const ValueRef &value, bool owned, std::set<const internal::Value *> &visited) {
+  if (!value.is_valid() || !visited.insert(value.valueptr()).second)
+    return 0;
+
+  switch (value.type()) {
+    case IntegerType:
+      return sizeof(internal::Integer);
+
+    case DoubleType:
+      return sizeof(internal::Double);
+
+    case StringType:
+      return sizeof(internal::String) + (**static_cast<const internal::String *>(value.valueptr())).capacity();
+
+    case ListType: {
+      BaseListRef list(BaseListRef::cast_from(value));
+      size_t size = sizeof(internal::List) + list.count() * sizeof(ValueRef);
+      for (size_t c = list.count(), i = 0; i < c; i++) {
+        if (list[i].is_valid() && (list[i].type() != ObjectType || owned))
+          size += value_footprint(list[i], owned, visited);
+      }
+      return size;
+    }
+
+    case DictType: {
+      DictRef dict(DictRef::cast_from(value));
+      size_t size = sizeof(internal::Dict);
+      for (DictRef::const_iterator iter = dict.begin(); iter != dict.end(); ++iter) {
+        size += iter->first.capacity() + sizeof(ValueRef);
+        if (iter->second.is_valid() && (iter->second.type() != ObjectType || owned))
+          size += value_footprint(iter->second, owned, visited);
+      }
+      return size;
+    }
+
+    case ObjectType:
+      return object_footprint(ObjectRef::cast_from(value), visited);
+
+    default:
+      return 0;
+  }
+}
+
+/** Size of the memory kept alive only because an undo action references the value, e.g. a removed subtree.
+ *  Values which are still referenced elsewhere (e.g. by the model) are not counted.
+ */
+static size_t retained_size(const ValueRef &value) {
+  if (!value.is_valid() || value.valueptr()->refcount() > 1)
+    return 0;
+
+  std::set<const internal::Value *> visited;
+  return value_footprint(value, true, visited);
+}
+
 //---------------------------------------------------------------------------------------------------
 
 void UndoAction::set_description(const std::string &description) {
   _description = description;
 }
 
+size_t UndoAction::memory_size() const {
+  return sizeof(*this) + _description.capacity();
+}
+
 //---------------------------------------------------------------------------------------------------
 
 void SimpleUndoAction::dump(std::ostream &out, int indent) const {
@@ -151,6 +234,10 @@ void UndoObjectChangeAction::dump(std::ostream &out, int indent) const {
       << "> ->" << new_value << ": " << description() << std::endl;
 }
 
+size_t UndoObjectChangeAction::memory_size() const {
+  return UndoAction::memory_size() + sizeof(*this) - sizeof(UndoAction) + _member.capacity() + retained_size(_value);
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoListInsertAction::UndoListInsertAction(const BaseListRef &list, size_t index) : _list(list), _index(index) {
@@ -258,6 +345,10 @@ void UndoListSetAction::dump(std::ostream &out, int indent) const {
   out << ": " << description() << std::endl;
 }
 
+size_t UndoListSetAction::memory_size() const {
+  return UndoAction::memory_size() + sizeof(*this) - sizeof(UndoAction) + retained_size(_value);
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoListRemoveAction::UndoListRemoveAction(const BaseListRef &list, const ValueRef &value)
@@ -301,6 +392,10 @@ void UndoListRemoveAction::dump(std::ostream &out, int indent) const {
   out << ": " << description() << std::endl;
 }
 
+size_t UndoListRemoveAction::memory_size() const {
+  return UndoAction::memory_size() + sizeof(*this) - sizeof(UndoAction) + retained_size(_value);
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoDictSetAction::UndoDictSetAction(const DictRef &dict, const std::string &key) : _dict(dict), _key(key) {
@@ -339,6 +434,10 @@ void UndoDictSetAction::dump(std::ostream &out, int indent) const {
   out << ": " << description() << std::endl;
 }
 
+size_t UndoDictSetAction::memory_size() const {
+  return UndoAction::memory_size() + sizeof(*this) - sizeof(UndoAction) + _key.capacity() + retained_size(_value);
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoDictRemoveAction::UndoDictRemoveAction(const DictRef &dict, const std::string &key) : _dict(dict), _key(key) {
@@ -376,10 +475,15 @@ void UndoDictRemoveAction::dump(std::ostream &out, int indent) const {
   out << ": " << description() << std::endl;
 }
 
+size_t UndoDictRemoveAction::memory_size() const {
+  return UndoAction::memory_size() + sizeof(*this) - sizeof(UndoAction) + _key.capacity() + retained_size(_value);
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoGroup::UndoGroup() {
   _is_open = true;
+  _memory_size = 0;
 }
 
 UndoGroup::~UndoGroup() {
@@ -398,6 +502,8 @@ void UndoGroup::undo(UndoManager *owner) {
 }
 
 void UndoGroup::trim() {
+  _memory_size = 0;
+
   std::list<UndoAction *>::iterator next, iter;
   next = _actions.begin();
   // delete closed groups that are empty or have a single action
@@ -439,20 +545,31 @@ UndoGroup *UndoGroup::get_deepest_open_subgroup(UndoGroup **parent) {
 void UndoGroup::close() {
   // close the topmost open undo group
   UndoGroup *group = get_deepest_open_subgroup();
-  if (group)
+  if (group) {
     group->_is_open = false;
-  else
+    group->_changed_members.clear();
+  } else
     logWarning("trying to close already closed undo group\n");
 }
 
-void UndoGroup::add(UndoAction *op) {
+bool UndoGroup::add(UndoAction *op) {
   // add the action to the topmost open undo group
   UndoGroup *subgroup = get_deepest_open_subgroup();
 
-  if (subgroup)
-    subgroup->_actions.push_back(op);
-  else
+  if (!subgroup)
     throw std::logic_error("trying to add an action to a closed undo group");
+
+  // Bulk operations change the same members over and over (e.g. figure positions during autolayout).
+  // Undoing the first recorded change of a member restores its value anyway, so drop the later ones.
+  // Only exact UndoObjectChangeActions are coalesced, subclasses might do more than setting the member.
+  // A dropped action stays with the caller, which must delete it.
+  if (typeid(*op) == typeid(UndoObjectChangeAction)) {
+    UndoObjectChangeAction *change = static_cast<UndoObjectChangeAction *>(op);
+    if (!subgroup->_changed_members.insert({ change->get_object().valueptr(), change->get_member() }).second)
+      return false;
+  }
+  subgroup->_actions.push_back(op);
+  return true;
 }
 
 bool UndoGroup::empty() const {
@@ -476,6 +593,20 @@ void UndoGroup::set_description(const std::string &description) {
     UndoAction::set_description(description);
 }
 
+size_t UndoGroup::memory_size() const {
+  if (!_is_open && _memory_size > 0)
+    return _memory_size;
+
+  // Each list entry needs a node with 2 links in addition to the action itself.
+  size_t size = UndoAction::memory_size() + sizeof(*this) - sizeof(UndoAction);
+  for (std::list<UndoAction *>::const_iterator iter = _actions.begin(); iter != _actions.end(); ++iter)
+    size += 3 * sizeof(void *) + (*iter)->memory_size();
+
+  if (!_is_open)
+    _memory_size = size;
+  return size;
+}
+
 std::string UndoGroup::description() const {
   if (!_actions.empty() && _is_open) {
     UndoGroup *subgroup = dynamic_cast<UndoGroup *>(_actions.back());
@@ -501,6 +632,7 @@ UndoManager::UndoManager() {
   _is_undoing = false;
   _is_redoing = false;
   _undo_limit = 0;
+  _undo_memory_limit = 0;
   _blocks = 0;
 }
 
@@ -548,10 +680,46 @@ void UndoManager::set_undo_limit(size_t limit) {
   trim_undo_stack();
 }
 
+void UndoManager::set_undo_memory_limit(size_t bytes) {
+  _undo_memory_limit = bytes;
+
+  trim_undo_stack();
+}
+
+size_t UndoManager::get_undo_memory_usage() const {
+  size_t size = 0;
+  lock();
+  for (std::deque<UndoAction *>::const_iterator iter = _undo_stack.begin(); iter != _undo_stack.end(); ++iter)
+    size += (*iter)->memory_size();
+  unlock();
+  return size;
+}
+
 void UndoManager::trim_undo_stack() {
   lock();
-  if (_undo_limit > 0)
-    _undo_stack.erase(_undo_stack.begin(), _undo_stack.begin() + std::max(0, (int)(_undo_stack.size() - _undo_limit)));
+  if (_undo_limit > 0) {
+    while (_undo_stack.size() > _undo_limit) {
+      delete _undo_stack.front();
+      _undo_stack.pop_front();
+    }
+  }
+
+  if (_undo_memory_limit > 0 && _undo_stack.size() > 1) {
+    std::vector<size_t> sizes;
+    size_t total = 0;
+    for (std::deque<UndoAction *>::const_iterator iter = _undo_stack.begin(); iter != _undo_stack.end(); ++iter) {
+      sizes.push_back((*iter)->memory_size());
+      total += sizes.back();
+    }
+
+    // Drop the oldest entries until the history fits, but always keep the latest one.
+    size_t index = 0;
+    while (_undo_stack.size() > 1 && total > _undo_memory_limit) {
+      total -= sizes[index++];
+      delete _undo_stack.front();
+      _undo_stack.pop_front();
+    }
+  }
   unlock();
 }
 
@@ -701,6 +869,10 @@ bool UndoManager::end_undo_group(const std::string &description, bool trim) {
     if (!group->is_open() && _undo_log && _undo_log->good())
       group->dump(*_undo_log);
 
+    // The size of a group is only known once it's complete.
+    if (!group->is_open() && stack == &_undo_stack && _undo_memory_limit > 0)
+      trim_undo_stack();
+
     if (description != "cancelled")
       _changed_signal();
     /* have to 1st merge or check for signal_apply from the deleted groups
@@ -863,13 +1035,16 @@ void UndoManager::add_undo(UndoAction *cmd) {
     return;
   }
 
+  UndoGroup *ugrp = dynamic_cast<UndoGroup *>(cmd);
+  bool dropped = false;
+
   lock();
   if (_is_undoing) {
     bool flag = false;
     if (!_redo_stack.empty()) {
       UndoGroup *group = dynamic_cast<UndoGroup *>(_redo_stack.back());
       if (group && group->is_open()) {
-        group->add(cmd);
+        dropped = !group->add(cmd);
         flag = true;
       }
     }
@@ -880,7 +1055,7 @@ void UndoManager::add_undo(UndoAction *cmd) {
     if (!_undo_stack.empty()) {
       UndoGroup *group = dynamic_cast<UndoGroup *>(_undo_stack.back());
       if (group && group->is_open()) {
-        group->add(cmd);
+        dropped = !group->add(cmd);
         flag = true;
       }
     }
@@ -900,7 +1075,12 @@ void UndoManager::add_undo(UndoAction *cmd) {
   }
   unlock();
 
-  UndoGroup *ugrp = dynamic_cast<UndoGroup *>(cmd);
+  // The action was coalesced with an earlier change of the same member, cmd must not be used after this.
+  if (dropped) {
+    delete cmd;
+    return;
+  }
+
   if (ugrp && !ugrp->is_open())
     _changed_signal();
 }
@@ -26,6 +26,7 @@
 #include "grt.h"
 
 #include <deque>
+#include <set>
 #include <boost/signals2.hpp>
 #include <ostream>
 
@@ -47,6 +48,10 @@ namespace grt {
     }
 
     virtual void dump(std::ostream &out, int indent = 0) const = 0;
+
+    // Approximate number of bytes this action keeps allocated, including values which are only
+    // alive because the action references them (e.g. a deleted subtree).
+    virtual size_t memory_size() const;
   };
 
   class MYSQLGRT_PUBLIC SimpleUndoAction : public UndoAction {
@@ -84,6 +89,7 @@ namespace grt {
     }
 
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
   };
 
   class MYSQLGRT_PUBLIC UndoListInsertAction : public UndoAction {
@@ -109,6 +115,7 @@ namespace grt {
     virtual void undo(UndoManager *owner);
 
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
   };
 
   class MYSQLGRT_PUBLIC UndoListReorderAction : public UndoAction {
@@ -134,6 +141,7 @@ namespace grt {
 
     virtual void undo(UndoManager *owner);
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
   };
 
   class MYSQLGRT_PUBLIC UndoDictSetAction : public UndoAction {
@@ -147,6 +155,7 @@ namespace grt {
 
     virtual void undo(UndoManager *owner);
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
   };
 
   class MYSQLGRT_PUBLIC UndoDictRemoveAction : public UndoAction {
@@ -160,12 +169,18 @@ namespace grt {
 
     virtual void undo(UndoManager *owner);
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
   };
 
   class MYSQLGRT_PUBLIC UndoGroup : public UndoAction {
     std::list<UndoAction *> _actions;
     bool _is_open;
 
+    // Object members already recorded in this (open) group. Only the first change of a member needs to be kept,
+    // as undoing it restores the value the member had when the group started.
+    std::set<std::pair<const internal::Value *, std::string>> _changed_members;
+    mutable size_t _memory_size; // Cached once the group is closed.
+
   public:
     UndoGroup();
     virtual ~UndoGroup();
@@ -182,8 +197,10 @@ namespace grt {
     virtual void undo(UndoManager *owner);
 
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
 
-    void add(UndoAction *op);
+    // Returns false if op was coalesced with an earlier change, ownership then stays with the caller.
+    bool add(UndoAction *op);
     bool empty() const;
 
     virtual bool matches_group(UndoGroup *group) const {
@@ -219,6 +236,14 @@ namespace grt {
       return _undo_limit;
     }
 
+    // Limits the undo history by its (approximate) memory usage instead of, or in addition to, the number of entries.
+    // The latest entry is always kept. 0 means no limit.
+    void set_undo_memory_limit(size_t bytes);
+    size_t get_undo_memory_limit() const {
+      return _undo_memory_limit;
+    }
+    size_t get_undo_memory_usage() const;
+
     void disable();
     void enable();
     bool is_enabled() const {
@@ -285,6 +310,7 @@ namespace grt {
     std::deque<UndoAction *> _redo_stack;
 
     size_t _undo_limit;
+    size_t _undo_memory_limit;
 
     int _blocks;
     bool _is_undoing;
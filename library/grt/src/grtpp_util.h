@@ -81,6 +81,22 @@ namespace grt {
   template <class O>
   inline Ref<O> find_named_object_in_list(const ListRef<O> &list, const std::string &value, bool case_sensitive = true,
                                           const std::string &name = "name") {
+    if (name == "name" && list.is_valid()) {
+      internal::OwnedList *owned = dynamic_cast<internal::OwnedList *>(list.valueptr());
+      // The index is only read here, lookups may run on worker threads. Lists get it when they grow, see OwnedList.
+      internal::Object *object = nullptr;
+      if (owned != nullptr && owned->find_by_name(value, case_sensitive, object)) {
+        // Renames update the index through the change signal, so a miss is final. Hits are still checked,
+        // for objects whose name was set without a change notification.
+        if (object == nullptr)
+          return Ref<O>();
+        if (base::same_string(object->get_string_member(name), value, case_sensitive))
+          return Ref<O>(static_cast<O *>(object));
+      }
+    }
+
+    // No index or no definite answer from it (duplicate names).
+
     for (size_t i = 0; i < list.count(); i++) {
       Ref<O> tmp = list[i];
 
@@ -224,10 +240,22 @@ namespace grt {
     //_dontdiff_mask will hold mask to allow selective bypass of ceratin fields
     // 1 always diff, 2 diff only vs db, 4 diff only vs live object
     unsigned int dontdiff_mask;
-    Omf() : case_sensitive(true), skip_routine_definer(false), dontdiff_mask(1){};
+    // number of threads matched list items may be diffed on (0 = number of processors, 1 = calling thread only)
+    unsigned int threads;
+    Omf() : case_sensitive(true), skip_routine_definer(false), dontdiff_mask(1), threads(0){};
     virtual ~Omf(){};
     virtual bool less(const ValueRef &, const ValueRef &) const = 0;
     virtual bool equal(const ValueRef &, const ValueRef &) const = 0;
+
+    // Produces a key so that equal() holds for two values of the same class exactly when their keys match.
+    // The structural hash used by the differ relies on it to tell how list items get matched. Returns false
+    // if equal() can't be expressed that way (e.g. it compares object identity).
+    virtual bool match_key(const ValueRef &, std::string &) const {
+      return false;
+    }
+
+    // Key for values compared with ValueRef::operator==.
+    static bool simple_match_key(const ValueRef &value, std::string &key);
   };
 
   struct default_omf : public Omf {
@@ -257,9 +285,26 @@ namespace grt {
     virtual bool equal(const ValueRef &l, const ValueRef &r) const {
       return peq(l, r);
     };
+
+    virtual bool match_key(const ValueRef &value, std::string &key) const {
+      if (value.type() == ObjectType && ObjectRef::can_wrap(value)) {
+        ObjectRef object(ObjectRef::cast_from(value));
+        if (!object->has_member("name"))
+          return false;
+        key = object->get_string_member("name");
+        return true;
+      }
+      return simple_match_key(value, key);
+    }
   };
 
   MYSQLGRT_PUBLIC
   std::shared_ptr<DiffChange> diff_make(const ValueRef &source, const ValueRef &target, const Omf *omf,
                                         bool dont_clone_values = false);
+
+  // Hash over everything GrtDiff looks at when comparing the object under the given omf. Objects with equal
+  // hashes produce no changes, so the differ skips them. Returns false if the object contains something the
+  // hash can't vouch for, in which case it must be compared member by member.
+  MYSQLGRT_PUBLIC
+  bool structural_hash(const ObjectRef &object, const Omf *omf, uint64_t &hash);
 };
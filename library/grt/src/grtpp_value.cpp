@@ -29,6 +29,9 @@
 #include "grtpp_undo_manager.h"
 
 #include <glib.h>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
 
 using namespace grt;
 using namespace grt::internal;
@@ -414,12 +417,187 @@ void List::__retype(Type type, const std::string& content_class) {
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Maps the names of the objects in an owned list to the objects, once as given and once case folded.
+ * Keys are glib collation keys of the normalized (and optionally case folded) names, so that comparing
+ * keys gives the same result as base::same_string() does for the names themselves.
+ */
+class grt::internal::OwnedListNameIndex {
+public:
+  OwnedListNameIndex() : _usable(true) {
+  }
+
+  void add(Object* object) {
+    auto iter = _entries.find(object);
+    if (iter != _entries.end()) {
+      ++iter->second->count;
+      return;
+    }
+
+    if (!object->has_member("name")) {
+      // Such lists cannot be searched by name anyway, find_named_object_in_list() will report that.
+      _usable = false;
+      return;
+    }
+
+    Entry* entry = new Entry();
+    _entries[object].reset(entry);
+    entry->connection =
+      object->signal_changed()->connect(std::bind(&OwnedListNameIndex::member_changed, this, object, std::placeholders::_1));
+    add_keys(object, entry);
+  }
+
+  void remove(Object* object, bool all) {
+    auto iter = _entries.find(object);
+    if (iter == _entries.end())
+      return;
+
+    if (!all && --iter->second->count > 0)
+      return;
+
+    remove_keys(object, iter->second.get());
+    _entries.erase(iter);
+  }
+
+  /**
+   * Returns false if the index cannot give a definite answer, which is the case for duplicate names
+   * (the caller must then find the first one in list order).
+   */
+  bool lookup(const std::string& name, bool case_sensitive, Object*& result) const {
+    if (!_usable)
+      return false;
+
+    const KeyMap& map = case_sensitive ? _exact : _folded;
+    auto range = map.equal_range(make_key(name, case_sensitive));
+    result = nullptr;
+    for (auto iter = range.first; iter != range.second; ++iter) {
+      if (result != nullptr && result != iter->second)
+        return false;
+      result = iter->second;
+    }
+    return true;
+  }
+
+private:
+  struct Entry {
+    size_t count = 1;
+    std::string exactKey;
+    std::string foldedKey;
+    boost::signals2::scoped_connection connection;
+  };
+  typedef std::unordered_multimap<std::string, Object*> KeyMap;
+
+  static std::string make_key(const std::string& name, bool case_sensitive) {
+    gchar* normalized = g_utf8_normalize(name.c_str(), -1, G_NORMALIZE_DEFAULT);
+    if (normalized == nullptr) // Invalid UTF-8, use the raw bytes.
+      return name;
+
+    if (!case_sensitive) {
+      gchar* folded = g_utf8_casefold(normalized, -1);
+      g_free(normalized);
+      normalized = folded;
+    }
+    gchar* key = g_utf8_collate_key(normalized, -1);
+    std::string result = key;
+    g_free(key);
+    g_free(normalized);
+    return result;
+  }
+
+  static void erase_from(KeyMap& map, const std::string& key, Object* object) {
+    auto range = map.equal_range(key);
+    for (auto iter = range.first; iter != range.second; ++iter) {
+      if (iter->second == object) {
+        map.erase(iter);
+        break;
+      }
+    }
+  }
+
+  void add_keys(Object* object, Entry* entry) {
+    std::string name = object->get_string_member("name");
+    entry->exactKey = make_key(name, true);
+    entry->foldedKey = make_key(name, false);
+    _exact.emplace(entry->exactKey, object);
+    _folded.emplace(entry->foldedKey, object);
+  }
+
+  void remove_keys(Object* object, Entry* entry) {
+    erase_from(_exact, entry->exactKey, object);
+    erase_from(_folded, entry->foldedKey, object);
+  }
+
+  void member_changed(Object* object, const std::string& member) {
+    if (member != "name")
+      return;
+
+    auto iter = _entries.find(object);
+    if (iter != _entries.end()) {
+      remove_keys(object, iter->second.get());
+      add_keys(object, iter->second.get());
+    }
+  }
+
+  std::unordered_map<Object*, std::unique_ptr<Entry>> _entries;
+  KeyMap _exact;
+  KeyMap _folded;
+  bool _usable;
+};
+
+//--------------------------------------------------------------------------------------------------
+
 OwnedList::OwnedList(Type type, const std::string& content_class, Object* owner, bool allow_null)
-  : List(type, content_class, allow_null), _owner(owner) {
+  : List(type, content_class, allow_null), _owner(owner), _name_index(nullptr) {
   if (!owner)
     throw std::invalid_argument("owner cannot be NULL");
 }
 
+OwnedList::~OwnedList() {
+  delete _name_index;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Builds a name index for this list. Only lists of objects can be indexed.
+ */
+bool OwnedList::attach_name_index() {
+  if (_name_index != nullptr)
+    return true;
+
+  if (content_type() != ObjectType)
+    return false;
+
+  _name_index = new OwnedListNameIndex();
+  for (auto& item : _content) {
+    if (item.is_valid())
+      _name_index->add(static_cast<Object*>(item.valueptr()));
+  }
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void OwnedList::detach_name_index() {
+  delete _name_index;
+  _name_index = nullptr;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Looks up an object by its name member. Returns false if there is no index or the index cannot decide
+ * (e.g. for duplicate names), in which case the caller has to scan the list.
+ */
+bool OwnedList::find_by_name(const std::string& name, bool case_sensitive, Object*& result) const {
+  if (_name_index == nullptr)
+    return false;
+
+  return _name_index->lookup(name, case_sensitive, result);
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void OwnedList::set_unchecked(size_t index, const ValueRef& value) {
   ValueRef item;
 
@@ -430,6 +608,13 @@ void OwnedList::set_unchecked(size_t index, const ValueRef& value) {
 
   List::set_unchecked(index, value);
 
+  if (_name_index != nullptr) {
+    if (item.is_valid())
+      _name_index->remove(static_cast<Object*>(item.valueptr()), false);
+    if (value.is_valid())
+      _name_index->add(static_cast<Object*>(value.valueptr()));
+  }
+
   if (item.is_valid())
     _owner->owned_list_item_removed(this, item);
   if (value.is_valid())
@@ -439,12 +624,22 @@ void OwnedList::set_unchecked(size_t index, const ValueRef& value) {
 void OwnedList::insert_unchecked(const ValueRef& value, size_t index) {
   List::insert_unchecked(value, index);
 
+  if (_name_index != nullptr) {
+    if (value.is_valid())
+      _name_index->add(static_cast<Object*>(value.valueptr()));
+  } else if (_content.size() == NAME_INDEX_THRESHOLD)
+    attach_name_index();
+
   _owner->owned_list_item_added(this, value);
 }
 
 void OwnedList::remove(const ValueRef& value) {
   List::remove(value);
 
+  // List::remove() drops all occurrences of the value.
+  if (_name_index != nullptr && value.is_valid())
+    _name_index->remove(static_cast<Object*>(value.valueptr()), true);
+
   _owner->owned_list_item_removed(this, value);
 }
 
@@ -453,9 +648,20 @@ void OwnedList::remove(size_t index) {
 
   List::remove(index);
 
+  if (_name_index != nullptr && item.is_valid())
+    _name_index->remove(static_cast<Object*>(item.valueptr()), false);
+
   _owner->owned_list_item_removed(this, item);
 }
 
+void OwnedList::reorder(size_t oi, size_t ni) {
+  List::reorder(oi, ni);
+
+  // There is no signal for reordering, but the order is part of the owner's structure.
+  if (oi != ni)
+    _owner->invalidate_structural_hash("");
+}
+
 //--------------------------------------------------------------------------------------------------
 
 std::string Dict::debugDescription(const std::string& indentation) const {
@@ -884,6 +1090,7 @@ bool Object::less_than(const Value* o) const {
 }
 
 void Object::owned_member_changed(const std::string& name, const grt::ValueRef& ovalue, const grt::ValueRef& nvalue) {
+  invalidate_structural_hash(name);
   if (_is_global) {
     if (ovalue != nvalue) {
       if (ovalue.is_valid())
@@ -898,27 +1105,77 @@ void Object::owned_member_changed(const std::string& name, const grt::ValueRef&
 }
 
 void Object::member_changed(const std::string& name, const grt::ValueRef& ovalue, const grt::ValueRef& nvalue) {
+  invalidate_structural_hash(name);
+
+  // An object moved to another owner without leaving the old owner's containers must not leave a stale hash there.
+  if (name == "owner" && ovalue.is_valid() && ovalue.type() == ObjectType)
+    static_cast<Object*>(ovalue.valueptr())->invalidate_structural_hash("");
+
   if (_is_global && grt::GRT::get()->tracking_changes())
     grt::GRT::get()->get_undo_manager()->add_undo(new UndoObjectChangeAction(this, name, ovalue));
   _changed_signal(name, ovalue);
 }
 
 void Object::owned_list_item_added(OwnedList* list, const grt::ValueRef& value) {
+  invalidate_structural_hash("");
   _list_changed_signal(list, true, value);
 }
 
 void Object::owned_list_item_removed(OwnedList* list, const grt::ValueRef& value) {
+  invalidate_structural_hash("");
   _list_changed_signal(list, false, value);
 }
 
 void Object::owned_dict_item_set(OwnedDict* dict, const std::string& key) {
+  invalidate_structural_hash("");
   _dict_changed_signal(dict, true, key);
 }
 
 void Object::owned_dict_item_removed(OwnedDict* dict, const std::string& key) {
+  invalidate_structural_hash("");
   _dict_changed_signal(dict, false, key);
 }
 
+//--------------------------------------------------------------------------------------------------
+
+static std::atomic<uint64_t> structural_name_serial_(1);
+static std::atomic<uint64_t> structural_change_serial_(1);
+
+std::shared_ptr<const Object::StructuralHash> Object::structural_hash() const {
+  return std::atomic_load(&_structural_hash);
+}
+
+void Object::set_structural_hash(const std::shared_ptr<const StructuralHash>& hash) const {
+  std::atomic_store(&_structural_hash, hash);
+}
+
+uint64_t Object::structural_name_serial() {
+  return structural_name_serial_.load();
+}
+
+uint64_t Object::structural_change_serial() {
+  return structural_change_serial_.load();
+}
+
+/**
+ * Drops the cached structural hash of this object and of all its owners. A cached hash implies cached hashes
+ * for everything below it, so the walk can stop at the first owner which has none.
+ */
+void Object::invalidate_structural_hash(const std::string& member) {
+  ++structural_change_serial_;
+  if (member == "name" || member == "oldName")
+    ++structural_name_serial_;
+
+  Object* object = this;
+  while (object != nullptr && std::atomic_exchange(&object->_structural_hash, std::shared_ptr<const StructuralHash>())) {
+    if (!object->_metaclass->has_member("owner"))
+      break;
+
+    ValueRef owner(object->get_member("owner"));
+    object = owner.is_valid() && owner.type() == ObjectType ? static_cast<Object*>(owner.valueptr()) : nullptr;
+  }
+}
+
 #ifdef USE_EXPRERIMENTAL_REFS
 namespace {
   static const int max_ref_size = 32;
@@ -32,6 +32,8 @@
 #endif
 
 #include <boost/signals2.hpp>
+#include <memory>
+#include <stdint.h>
 #include "base/threading.h"
 
 namespace grt {
@@ -116,6 +118,10 @@ namespace internal {
       Value *retain();
       void release();
 
+      // Retains the value unless its reference count already dropped to 0 (i.e. it is being destroyed on another
+      // thread). For lookups in indexes which don't hold a reference. Returns null if the value was not retained.
+      Value *retain_if_alive();
+
       virtual std::string debugDescription(const std::string &indentation = "") const = 0;
       virtual std::string toString() const = 0;
 
@@ -300,7 +306,7 @@ namespace internal {
 
       virtual void remove(const ValueRef &value);
       virtual void remove(size_t index);
-      void reorder(size_t oi, size_t ni);
+      virtual void reorder(size_t oi, size_t ni);
 
       size_t get_index(const ValueRef &value);
 
@@ -354,6 +360,11 @@ namespace internal {
       mutable short _is_global;
     };
 
+    class OwnedListNameIndex;
+
+    // Owned lists of objects get a name index once they grow to this many entries.
+    const size_t NAME_INDEX_THRESHOLD = 32;
+
     class MYSQLGRT_PUBLIC OwnedList : public List {
     public:
       OwnedList(Type type, const std::string &content_class, Object *owner, bool allow_null);
@@ -363,13 +374,29 @@ namespace internal {
 
       virtual void remove(const ValueRef &value);
       virtual void remove(size_t index);
+      virtual void reorder(size_t oi, size_t ni);
 
       Object *owner_of_owned_list() const {
         return _owner;
       }
 
+      // Optional index over the "name" member of the contained objects. Once attached it is kept up to date
+      // on insert, remove and rename (via the objects' change signals) and used by find_named_object_in_list(),
+      // which trusts it for misses too.
+      // It is attached by the insert which makes the list reach NAME_INDEX_THRESHOLD entries, so only code
+      // that modifies the list (and therefore runs on the list's owning thread) changes the index.
+      bool attach_name_index();
+      void detach_name_index();
+      bool has_name_index() const {
+        return _name_index != nullptr;
+      }
+      bool find_by_name(const std::string &name, bool case_sensitive, Object *&result) const;
+
     protected:
+      virtual ~OwnedList();
+
       Object *_owner; // internal: set if it belongs to an object
+      OwnedListNameIndex *_name_index;
     };
 
     //------------------------------------------------------------------------------------------------
@@ -512,6 +539,26 @@ namespace internal {
 
       virtual void reset_references();
 
+      // Structural hash of the object as computed by GrtDiff, cached until the object or anything it owns changes.
+      // Entries depending on other objects (referenced names or content) are also tied to the global serials below.
+      struct StructuralHash {
+        enum Dependency { Owned, Names, Changes, Volatile };
+
+        uint64_t key;
+        uint64_t value;
+        uint64_t name_serial;
+        uint64_t change_serial;
+        Dependency dependency;
+        bool comparable;
+      };
+
+      std::shared_ptr<const StructuralHash> structural_hash() const;
+      void set_structural_hash(const std::shared_ptr<const StructuralHash> &hash) const;
+
+      // Bumped on every rename (name, oldName) and on every change of any object, respectively.
+      static uint64_t structural_name_serial();
+      static uint64_t structural_change_serial();
+
     public:
       virtual void init();
 
@@ -537,6 +584,8 @@ namespace internal {
       virtual void owned_dict_item_set(OwnedDict *dict, const std::string &key);
       virtual void owned_dict_item_removed(OwnedDict *dict, const std::string &key);
 
+      void invalidate_structural_hash(const std::string &member);
+
       MetaClass *_metaclass;
       std::string _id;
       boost::signals2::signal<void(const std::string &, const grt::ValueRef &)> _changed_signal;
@@ -547,6 +596,8 @@ namespace internal {
 
       mutable short _is_global; // whether object is attached to the global GRT tree
 
+      mutable std::shared_ptr<const StructuralHash> _structural_hash;
+
       //    public:
       //      const ObjectValidFlag &weakref_valid_flag() const { return _valid_flag; }
     };
@@ -882,6 +882,8 @@ static PyObject *grt_serialize(PyObject *self, PyObject *args) {
   }
 
   try {
+    WillLeavePython lock;
+
     grt::GRT::get()->serialize(value, path);
   } catch (const std::exception &exc) {
     PythonContext::set_python_error(exc, "serializing object");
@@ -906,7 +908,12 @@ static PyObject *grt_unserialize(PyObject *self, PyObject *args) {
   }
 
   try {
-    grt::ValueRef value = grt::GRT::get()->unserialize(path);
+    grt::ValueRef value;
+    {
+      WillLeavePython lock;
+
+      value = grt::GRT::get()->unserialize(path);
+    }
     return ctx->from_grt(value);
   } catch (const std::exception &exc) {
     PythonContext::set_python_error(exc, base::strfmt("unserializing file %s", path));
@@ -1262,22 +1269,14 @@ PyObject *PythonContext::from_grt(const ValueRef &value) {
         // return PyUnicode_DecodeUTF8(data.data(), data.size(), NULL);
         return PyString_FromStringAndSize(data.data(), data.size());
       }
-      case ListType: {
-        PyObject *content = PythonContext::internal_cobject_from_value(value);
-        PyObject *args = Py_BuildValue("(ssO)", "", "", content);
-        PyObject *r = PyObject_Call(_grt_list_class, args, NULL);
-        Py_XDECREF(args);
-        Py_XDECREF(content);
-        return r;
-      }
-      case DictType: {
-        PyObject *content = PythonContext::internal_cobject_from_value(value);
-        PyObject *args = Py_BuildValue("(ssO)", "", "", content);
-        PyObject *r = PyObject_Call(_grt_dict_class, args, NULL);
-        Py_XDECREF(args);
-        Py_XDECREF(content);
-        return r;
-      }
+      // Lists and dicts are not copied. The returned proxy shares the GRT container, so
+      // there is no need to go through the (much slower) Python level constructor here.
+      case ListType:
+        return list_proxy_from_value(BaseListRef::cast_from(value));
+
+      case DictType:
+        return dict_proxy_from_value(DictRef::cast_from(value));
+
       case ObjectType: {
         std::string class_name = grt::ObjectRef::cast_from(value).class_name();
         PyObject *content = PythonContext::internal_cobject_from_value(value);
@@ -114,6 +114,10 @@ namespace grt {
     static PyObject *internal_cobject_from_value(const ValueRef &value);
     static ValueRef value_from_internal_cobject(PyObject *value);
 
+    // Proxies sharing the given GRT container, created without going through the Python constructor.
+    static PyObject *list_proxy_from_value(const BaseListRef &list);
+    static PyObject *dict_proxy_from_value(const DictRef &dict);
+
     static void set_wrap_pyobject_func(PyObject *(*func)(PyObject *, PyObject *));
     static void set_unwrap_pyobject_func(PyObject *(*func)(PyObject *, PyObject *));
 
@@ -464,6 +464,13 @@ static PyTypeObject PyGRTDictObjectType = {
 #endif
 };
 
+PyObject *grt::PythonContext::dict_proxy_from_value(const grt::DictRef &dict) {
+  PyGRTDictObject *self = (PyGRTDictObject *)PyGRTDictObjectType.tp_alloc(&PyGRTDictObjectType, 0);
+  if (self)
+    self->dict = new grt::DictRef(dict);
+  return (PyObject *)self;
+}
+
 void grt::PythonContext::init_grt_dict_type() {
   PyGRTDictObjectType.tp_new = PyType_GenericNew;
   if (PyType_Ready(&PyGRTDictObjectType) < 0) {
@@ -290,6 +290,126 @@ static PyObject *list_reorder(PyGRTListObject *self, PyObject *args) {
   return NULL;
 }
 
+static PyObject *list_tolist(PyGRTListObject *self) {
+  PythonContext *ctx = PythonContext::get_and_check();
+  if (!ctx)
+    return NULL;
+
+  // Builds the Python list in one go, instead of going through the sequence protocol item by item.
+  size_t count = self->list->count();
+  PyObject *result = PyList_New(count);
+  if (!result)
+    return NULL;
+
+  try {
+    for (size_t i = 0; i < count; ++i) {
+      PyObject *item = ctx->from_grt(self->list->get(i));
+      if (!item) {
+        Py_DECREF(result);
+        return NULL;
+      }
+      PyList_SET_ITEM(result, i, item);
+    }
+  } catch (std::exception &exc) {
+    Py_DECREF(result);
+    PythonContext::set_python_error(exc);
+    return NULL;
+  }
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Packed copy of a typed GRT list, handed out through the buffer protocol.
+ * Integer lists are exported as native longs, double lists as doubles and string lists as
+ * a sequence of zero terminated UTF-8 strings.
+ */
+struct ListBufferExport {
+  std::vector<char> data;
+  Py_ssize_t shape;
+  Py_ssize_t stride;
+};
+
+static int list_getbuffer(PyGRTListObject *self, Py_buffer *view, int flags) {
+  if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE) {
+    PyErr_SetString(PyExc_BufferError, "GRT list buffers are read-only");
+    return -1;
+  }
+
+  const grt::internal::List &content = self->list->content();
+  size_t count = content.count();
+  ListBufferExport *exported = new ListBufferExport();
+  const char *format;
+
+  switch (content.content_type()) {
+    case IntegerType: {
+      format = "l";
+      exported->stride = sizeof(long);
+      exported->data.resize(count * sizeof(long));
+      long *items = reinterpret_cast<long *>(exported->data.data());
+      for (grt::internal::List::raw_const_iterator iter = content.raw_begin(); iter != content.raw_end(); ++iter)
+        *items++ = iter->is_valid() ? (long)*IntegerRef::cast_from(*iter) : 0;
+      break;
+    }
+
+    case DoubleType: {
+      format = "d";
+      exported->stride = sizeof(double);
+      exported->data.resize(count * sizeof(double));
+      double *items = reinterpret_cast<double *>(exported->data.data());
+      for (grt::internal::List::raw_const_iterator iter = content.raw_begin(); iter != content.raw_end(); ++iter)
+        *items++ = iter->is_valid() ? (double)*DoubleRef::cast_from(*iter) : 0.0;
+      break;
+    }
+
+    case StringType: {
+      format = "B";
+      exported->stride = 1;
+      size_t total = 0;
+      for (grt::internal::List::raw_const_iterator iter = content.raw_begin(); iter != content.raw_end(); ++iter)
+        total += (iter->is_valid() ? StringRef::cast_from(*iter)->size() : 0) + 1;
+      exported->data.reserve(total);
+      for (grt::internal::List::raw_const_iterator iter = content.raw_begin(); iter != content.raw_end(); ++iter) {
+        if (iter->is_valid()) {
+          const std::string &item = *StringRef::cast_from(*iter);
+          exported->data.insert(exported->data.end(), item.begin(), item.end());
+        }
+        exported->data.push_back('\0');
+      }
+      break;
+    }
+
+    default:
+      delete exported;
+      PyErr_SetString(PyExc_BufferError, "only integer, double and string lists can be exported as buffer");
+      return -1;
+  }
+  exported->shape = (Py_ssize_t)exported->data.size() / exported->stride;
+
+  view->obj = (PyObject *)self;
+  Py_INCREF(self);
+  view->buf = exported->data.data();
+  view->len = (Py_ssize_t)exported->data.size();
+  view->readonly = 1;
+  view->itemsize = exported->stride;
+  view->format = (flags & PyBUF_FORMAT) == PyBUF_FORMAT ? (char *)format : NULL;
+  view->ndim = 1;
+  view->shape = (flags & PyBUF_ND) == PyBUF_ND ? &exported->shape : NULL;
+  view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &exported->stride : NULL;
+  view->suboffsets = NULL;
+  view->internal = exported;
+
+  return 0;
+}
+
+static void list_releasebuffer(PyGRTListObject *self, Py_buffer *view) {
+  delete static_cast<ListBufferExport *>(view->internal);
+  view->internal = NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 static PyObject *list_get_contenttype(PyGRTListObject *self, void *closure) {
   return Py_BuildValue("(ss)", type_to_str(self->list->content_type()).c_str(),
                        self->list->content_class_name().c_str());
@@ -309,6 +429,7 @@ PyDoc_STRVAR(reorder_doc, "L.reorder(oindex, nindex) -- reorder object at index"
 PyDoc_STRVAR(remove_doc, "L.remove(value) -- remove first occurrence of object");
 PyDoc_STRVAR(remove_all_doc, "L.remove_all() -- remove all elements from the list");
 PyDoc_STRVAR(extend_doc, "L.extend(list) -- add all elements from the list");
+PyDoc_STRVAR(tolist_doc, "L.tolist() -- return the list contents as a Python list");
 
 #if !defined(_MSC_VER) && !defined(__APPLE__)
 
@@ -326,6 +447,7 @@ static PyMethodDef PyGRTListMethods[] = {
   {"reorder", (PyCFunction)list_reorder, METH_VARARGS, reorder_doc},
   {"remove", (PyCFunction)list_remove, METH_O, remove_doc},
   {"remove_all", (PyCFunction)list_remove_all, METH_NOARGS, remove_all_doc},
+  {"tolist", (PyCFunction)list_tolist, METH_NOARGS, tolist_doc},
   {NULL, NULL, 0, NULL}};
 #if !defined(_MSC_VER) && !defined(__APPLE__)
 #pragma GCC diagnostic pop
@@ -351,6 +473,15 @@ static PySequenceMethods PyGRTListObject_as_sequence = {
   0                                // ssizeargfunc sq_inplace_repeat;
 };
 
+static PyBufferProcs PyGRTListObject_as_buffer = {
+  0,                                       // readbufferproc bf_getreadbuffer;
+  0,                                       // writebufferproc bf_getwritebuffer;
+  0,                                       // segcountproc bf_getsegcount;
+  0,                                       // charbufferproc bf_getcharbuffer;
+  (getbufferproc)list_getbuffer,           // getbufferproc bf_getbuffer;
+  (releasebufferproc)list_releasebuffer,   // releasebufferproc bf_releasebuffer;
+};
+
 static PyTypeObject PyGRTListObjectType = {
   PyObject_HEAD_INIT(&PyType_Type) // PyObject_VAR_HEAD
   0,
@@ -381,10 +512,10 @@ static PyTypeObject PyGRTListObjectType = {
   0,                        //  setattrofunc tp_setattro;
 
   /* Functions to access object as input/output buffer */
-  0, //  PyBufferProcs *tp_as_buffer;
+  &PyGRTListObject_as_buffer, //  PyBufferProcs *tp_as_buffer;
 
   /* Flags to define presence of optional/expanded features */
-  Py_TPFLAGS_DEFAULT, //  long tp_flags;
+  Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER, //  long tp_flags;
 
   PyGRTListDoc, //  char *tp_doc; /* Documentation string */
 
@@ -432,6 +563,13 @@ static PyTypeObject PyGRTListObjectType = {
 #endif
 };
 
+PyObject *grt::PythonContext::list_proxy_from_value(const grt::BaseListRef &list) {
+  PyGRTListObject *self = (PyGRTListObject *)PyGRTListObjectType.tp_alloc(&PyGRTListObjectType, 0);
+  if (self)
+    self->list = new grt::BaseListRef(list);
+  return (PyObject *)self;
+}
+
 void grt::PythonContext::init_grt_list_type() {
   PyGRTListObjectType.tp_new = PyType_GenericNew;
   if (PyType_Ready(&PyGRTListObjectType) < 0) {
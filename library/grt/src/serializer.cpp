@@ -83,23 +83,21 @@ static int base_xmlSaveFile(const char *filename, xmlDocPtr doc) {
   if ((local_filename = g_filename_from_utf8(filename, -1, NULL, NULL, NULL)) == NULL)
     return -1;
 
-  // Check if the file already exists and if so store under a temporary name first.
-  file = base_fopen(local_filename, "r");
+  // Always store under a temporary name first, so that an interrupted write never leaves a truncated file.
+  char *tempName = g_strdup_printf("%s.tmp", local_filename);
 
-  if (file != NULL) {
-    char *tempName = g_strdup_printf("%s.tmp", local_filename);
+  result = xmlSaveFormatFile(tempName, doc, 1);
 
-    result = xmlSaveFormatFile(tempName, doc, 1);
-    fclose(file);
-
-    if (result > 0) {
-      // If saving the content was successful then delete the old file and use the new one.
+  if (result > 0) {
+    // If saving the content was successful then delete the old file (if any) and use the new one.
+    file = base_fopen(local_filename, "r");
+    if (file != NULL) {
+      fclose(file);
       base_remove(local_filename);
-      base_rename(tempName, local_filename);
-    };
-    g_free(tempName);
-  } else
-    result = xmlSaveFormatFile(local_filename, doc, 1);
+    }
+    base_rename(tempName, local_filename);
+  }
+  g_free(tempName);
 
   g_free(local_filename);
 
@@ -126,13 +124,24 @@ void internal::Serializer::save_to_xml(const ValueRef &value, const std::string
 
   doc = create_xmldoc_for_value(value, doctype, docversion, list_objects_as_links);
 
-  if (base_xmlSaveFile(path.c_str(), doc) == -1) {
+  try {
+    save_xmldoc(doc, path);
+  } catch (...) {
     xmlFreeDoc(doc);
-    throw std::runtime_error("Could not save XML data to file " + path);
+    throw;
   }
   xmlFreeDoc(doc);
 }
 
+/**
+ * Writes out a document created by create_xmldoc_for_value(). Works only on the XML tree, so it can run on any
+ * thread while the serialized values change.
+ */
+void internal::Serializer::save_xmldoc(xmlDocPtr doc, const std::string &path) {
+  if (base_xmlSaveFile(path.c_str(), doc) == -1)
+    throw std::runtime_error("Could not save XML data to file " + path);
+}
+
 bool internal::Serializer::seen(const ValueRef &value) {
   void *ptr = value.valueptr();
 
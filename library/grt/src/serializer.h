@@ -39,6 +39,8 @@ namespace grt {
       xmlDocPtr create_xmldoc_for_value(const ValueRef &value, const std::string &doctype,
                                         const std::string &docversion, bool list_objects_as_links);
 
+      static void save_xmldoc(xmlDocPtr doc, const std::string &path);
+
       std::string serialize_to_xmldata(const ValueRef &value, const std::string &type, const std::string &version,
                                        bool list_objects_as_links);
 
@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "compiled_template.h"
+#include "dictionary.h"
+#include "output.h"
+
+namespace mtemplate {
+
+  //-----------------------------------------------------------------------------------
+  //  DataSource stuff
+  //-----------------------------------------------------------------------------------
+  DataSource::~DataSource() {
+  }
+
+  void DataSource::prepare(const std::vector<std::string> &variables, const std::vector<std::string> &sections) {
+  }
+
+  bool DataSource::next() {
+    return false;
+  }
+
+  bool DataSource::isLast() {
+    return true;
+  }
+
+  //-----------------------------------------------------------------------------------
+  //  DictionaryDataSource stuff
+  //-----------------------------------------------------------------------------------
+  DictionaryDataSource::DictionaryDataSource(DictionaryInterface *dictionary)
+    : _variables(nullptr), _sections(nullptr), _rows(&_single), _next(0), _current(dictionary) {
+    _single.push_back(dictionary);
+  }
+
+  DictionaryDataSource::DictionaryDataSource(const DictionaryDataSource *parent)
+    : _variables(parent->_variables), _sections(parent->_sections), _rows(nullptr), _next(0), _current(nullptr) {
+  }
+
+  DictionaryDataSource::~DictionaryDataSource() {
+    for (DictionaryDataSource *child : _children)
+      delete child;
+  }
+
+  void DictionaryDataSource::prepare(const std::vector<std::string> &variables,
+                                     const std::vector<std::string> &sections) {
+    _variables = &variables;
+    _sections = &sections;
+    for (DictionaryDataSource *child : _children)
+      delete child;
+    _children.clear();
+  }
+
+  void DictionaryDataSource::reset(const std::vector<DictionaryInterface *> *rows) {
+    _rows = rows;
+    _next = 0;
+    _current = nullptr;
+  }
+
+  bool DictionaryDataSource::value(std::size_t slot, std::string &result) {
+    // A dictionary resolves parent and global values itself. No dictionary at all means nothing is known here.
+    if (_current == nullptr)
+      return false;
+
+    base::utf8string value = _current->getValue((*_variables)[slot]);
+    result.append(value.data(), value.bytes());
+    return true;
+  }
+
+  DataSource *DictionaryDataSource::section(std::size_t slot) {
+    if (_current == nullptr)
+      return nullptr;
+
+    const std::vector<DictionaryInterface *> &rows = _current->getSectionDictionaries((*_sections)[slot]);
+    if (rows.empty())
+      return nullptr;
+
+    if (_children.size() <= slot)
+      _children.resize(_sections->size(), nullptr);
+    if (_children[slot] == nullptr)
+      _children[slot] = new DictionaryDataSource(this);
+
+    _children[slot]->reset(&rows);
+    return _children[slot];
+  }
+
+  bool DictionaryDataSource::next() {
+    if (_rows == nullptr || _next >= _rows->size())
+      return false;
+
+    _current = (*_rows)[_next++];
+    return true;
+  }
+
+  bool DictionaryDataSource::isLast() {
+    return _current != nullptr && _current->isLast();
+  }
+
+  //-----------------------------------------------------------------------------------
+  //  CompiledTemplate stuff
+  //-----------------------------------------------------------------------------------
+  struct CompiledTemplate::ExpandState {
+    TemplateOutput *output;
+    std::vector<DataSource *> sources; // Innermost row last.
+    std::vector<Modifier *> modifiers; // Resolved per expansion, user modifiers can be replaced any time.
+    std::string value;
+  };
+
+  CompiledTemplate::CompiledTemplate(const TemplateDocument &document) {
+    compile(document, true);
+  }
+
+  std::size_t CompiledTemplate::slotFor(std::vector<std::string> &names, const std::string &name) {
+    for (std::size_t i = 0; i < names.size(); ++i) {
+      if (names[i] == name)
+        return i;
+    }
+    names.push_back(name);
+    return names.size() - 1;
+  }
+
+  /**
+   * Mirrors the node based expansion: hidden nodes produce nothing and separator sections only count as such
+   * inside other sections.
+   */
+  void CompiledTemplate::compile(const TemplateDocument &document, bool topLevel) {
+    std::size_t blockStart = _program.size();
+
+    for (const NodeStorageType &node : document) {
+      if (node->isHidden())
+        continue;
+
+      switch (node->type()) {
+        case TemplateObject_Text:
+        case TemplateObject_NewLine: {
+          const base::utf8string &text = node->text();
+          if (_program.size() > blockStart && _program.back().code == Text)
+            _texts[_program.back().operand].append(text.data(), text.bytes());
+          else {
+            _texts.push_back(text);
+            _program.push_back({ Text, _texts.size() - 1, 0, 0, 0 });
+          }
+          break;
+        }
+
+        case TemplateObject_Variable: {
+          NodeVariable *variable = static_cast<NodeVariable *>(node.get());
+          Instruction instruction = { Variable, slotFor(_variables, node->text()), 0, _modifiers.size(),
+                                      variable->_modifiers.size() };
+          _modifiers.insert(_modifiers.end(), variable->_modifiers.begin(), variable->_modifiers.end());
+          _program.push_back(instruction);
+          break;
+        }
+
+        case TemplateObject_Section:
+        case TemplateObject_SectionSeparator: {
+          NodeSection *section = static_cast<NodeSection *>(node.get());
+          Opcode code = (!topLevel && section->is_separator()) ? Separator : Section;
+          std::size_t index = _program.size();
+          _program.push_back({ code, slotFor(_sections, node->text()), 0, 0, 0 });
+          compile(section->_contents, false);
+          _program[index].end = _program.size();
+          break;
+        }
+      }
+    }
+  }
+
+  void CompiledTemplate::expand(DataSource &source, TemplateOutput *output) const {
+    ExpandState state;
+    state.output = output;
+    state.sources.push_back(&source);
+    for (const ModifierAndArgument &modifier : _modifiers)
+      state.modifiers.push_back(GetModifier(modifier._name));
+
+    source.prepare(_variables, _sections);
+    run(0, _program.size(), state);
+  }
+
+  void CompiledTemplate::expand(DictionaryInterface *dict, TemplateOutput *output) const {
+    DictionaryDataSource source(dict);
+    expand(source, output);
+  }
+
+  void CompiledTemplate::run(std::size_t begin, std::size_t end, ExpandState &state) const {
+    for (std::size_t i = begin; i < end; ++i) {
+      const Instruction &instruction = _program[i];
+      switch (instruction.code) {
+        case Text: {
+          const std::string &text = _texts[instruction.operand];
+          state.output->write(text.data(), text.size());
+          break;
+        }
+
+        case Variable: {
+          state.value.clear();
+          bool found = false;
+          for (auto source = state.sources.rbegin(); !found && source != state.sources.rend(); ++source)
+            found = (*source)->value(instruction.operand, state.value);
+          if (!found) {
+            base::utf8string global = GetGlobalValue(_variables[instruction.operand]);
+            state.value.assign(global.data(), global.bytes());
+          }
+
+          if (instruction.modifierCount == 0) {
+            state.output->write(state.value.data(), state.value.size());
+            break;
+          }
+
+          base::utf8string result(state.value);
+          for (std::size_t m = instruction.firstModifier; m < instruction.firstModifier + instruction.modifierCount;
+               ++m) {
+            if (state.modifiers[m] != nullptr)
+              result = state.modifiers[m]->modify(result, _modifiers[m]._arg);
+          }
+          state.output->write(result.data(), result.bytes());
+          break;
+        }
+
+        case Separator:
+          if (!state.sources.back()->isLast()) {
+            run(i + 1, instruction.end, state);
+            i = instruction.end - 1;
+            break;
+          }
+          // On the last row a separator is just a normal section (usually without data).
+          // fall through
+
+        case Section: {
+          DataSource *rows = state.sources.back()->section(instruction.operand);
+          if (rows != nullptr) {
+            state.sources.push_back(rows);
+            while (rows->next())
+              run(i + 1, instruction.end, state);
+            state.sources.pop_back();
+          }
+          i = instruction.end - 1;
+          break;
+        }
+      }
+    }
+  }
+
+} //  namespace mtemplate
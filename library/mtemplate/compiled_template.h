@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include "common.h"
+#include "types.h"
+
+#include <string>
+#include <vector>
+
+namespace mtemplate {
+
+  struct TemplateOutput;
+  class DictionaryInterface;
+
+  /**
+   * @brief Pull style data provider for compiled templates.
+   *
+   * Variable and section names are resolved once per expansion: prepare() receives the names used by the
+   * template and the position of a name in these lists is the slot passed to value() and section().
+   * Sources returned by section() represent the rows of that section and are prepared by their parent.
+   */
+  class MTEMPLATELIBRARY_PUBLIC_FUNC DataSource {
+  public:
+    virtual ~DataSource();
+
+    virtual void prepare(const std::vector<std::string> &variables, const std::vector<std::string> &sections);
+
+    /**
+     * @brief Appends the value of the given variable to result.
+     * @return false if the variable is unknown here (result must be untouched), the enclosing source is asked then.
+     */
+    virtual bool value(std::size_t slot, std::string &result) = 0;
+
+    /**
+     * @brief Returns the rows of a section, positioned before the first row, or nullptr if there are none.
+     * The returned source is owned by this source and stays valid until the next call for the same slot.
+     */
+    virtual DataSource *section(std::size_t slot) = 0;
+
+    // Row navigation, only used for sources returned by section().
+    virtual bool next();
+    virtual bool isLast();
+  };
+
+  /**
+   * @brief Data source for the classic dictionaries, used when a compiled template is expanded with a dictionary.
+   */
+  class MTEMPLATELIBRARY_PUBLIC_FUNC DictionaryDataSource : public DataSource {
+  public:
+    DictionaryDataSource(DictionaryInterface *dictionary);
+    virtual ~DictionaryDataSource();
+
+    virtual void prepare(const std::vector<std::string> &variables, const std::vector<std::string> &sections);
+    virtual bool value(std::size_t slot, std::string &result);
+    virtual DataSource *section(std::size_t slot);
+    virtual bool next();
+    virtual bool isLast();
+
+  protected:
+    DictionaryDataSource(const DictionaryDataSource *parent);
+    void reset(const std::vector<DictionaryInterface *> *rows);
+
+    DictionaryInterface *current() const {
+      return _current;
+    }
+
+    const std::vector<std::string> *_variables;
+    const std::vector<std::string> *_sections;
+
+  private:
+    std::vector<DictionaryInterface *> _single;
+    const std::vector<DictionaryInterface *> *_rows;
+    std::size_t _next;
+    DictionaryInterface *_current;
+    std::vector<DictionaryDataSource *> _children; // Indexed by section slot, created on first use.
+  };
+
+  /**
+   * @brief A template translated into a flat instruction list.
+   *
+   * Hidden nodes are dropped, adjacent text is merged and variables and sections refer to slots instead of names.
+   * Expansion writes straight to the output and does not allocate for plain variables once the internal value
+   * buffer has grown.
+   */
+  class MTEMPLATELIBRARY_PUBLIC_FUNC CompiledTemplate {
+  public:
+    CompiledTemplate(const TemplateDocument &document);
+
+    void expand(DataSource &source, TemplateOutput *output) const;
+    void expand(DictionaryInterface *dict, TemplateOutput *output) const;
+
+    const std::vector<std::string> &variables() const {
+      return _variables;
+    }
+    const std::vector<std::string> &sections() const {
+      return _sections;
+    }
+
+  private:
+    enum Opcode { Text, Variable, Section, Separator };
+
+    struct Instruction {
+      Opcode code;
+      std::size_t operand;       // Text index, variable slot or section slot.
+      std::size_t end;           // Sections: index of the first instruction after the section body.
+      std::size_t firstModifier; // Variables: range in _modifiers.
+      std::size_t modifierCount;
+    };
+
+    struct ExpandState;
+
+    void compile(const TemplateDocument &document, bool topLevel);
+    std::size_t slotFor(std::vector<std::string> &names, const std::string &name);
+    void run(std::size_t begin, std::size_t end, ExpandState &state) const;
+
+    std::vector<Instruction> _program;
+    std::vector<std::string> _texts;
+    std::vector<std::string> _variables;
+    std::vector<std::string> _sections;
+    std::vector<ModifierAndArgument> _modifiers;
+  };
+
+} //  namespace mtemplate
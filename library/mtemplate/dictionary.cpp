@@ -166,4 +166,8 @@ namespace mtemplate {
     GlobalDictionary.setValue(key, value);
   }
 
+  base::utf8string GetGlobalValue(const base::utf8string &key) {
+    return GlobalDictionary.getValue(key);
+  }
+
 } //  namespace mtemplate
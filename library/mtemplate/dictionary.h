@@ -113,5 +113,6 @@ namespace mtemplate {
 
   MTEMPLATELIBRARY_PUBLIC_FUNC Dictionary *CreateMainDictionary();
   MTEMPLATELIBRARY_PUBLIC_FUNC void SetGlobalValue(const base::utf8string &key, const base::utf8string &value);
+  MTEMPLATELIBRARY_PUBLIC_FUNC base::utf8string GetGlobalValue(const base::utf8string &key);
 
 } //  namespace mtemplate
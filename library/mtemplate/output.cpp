@@ -32,6 +32,10 @@ namespace mtemplate {
   TemplateOutput::~TemplateOutput() {
   }
 
+  void TemplateOutput::write(const char *data, std::size_t length) {
+    out(base::utf8string(std::string(data, length)));
+  }
+
   //-----------------------------------------------------------------------------------
   //  TemplateOutputString stuff
   //-----------------------------------------------------------------------------------
@@ -39,6 +43,10 @@ namespace mtemplate {
     _buffer += str;
   }
 
+  void TemplateOutputString::write(const char *data, std::size_t length) {
+    _buffer.append(data, length);
+  }
+
   const base::utf8string &TemplateOutputString::get() {
     return _buffer;
   }
@@ -46,11 +54,19 @@ namespace mtemplate {
   //-----------------------------------------------------------------------------------
   //  TemplateOutputFile stuff
   //-----------------------------------------------------------------------------------
+  // Exports write many small pieces, so give the stream a large buffer.
+  static const size_t OUTPUT_FILE_BUFFER_SIZE = 1024 * 1024;
+
   TemplateOutputFile::TemplateOutputFile(const base::utf8string &filename) : _file(filename.c_str(), "w+") {
+    setvbuf(_file.file(), nullptr, _IOFBF, OUTPUT_FILE_BUFFER_SIZE);
   }
 
   void TemplateOutputFile::out(const base::utf8string &str) {
     fwrite(str.data(), 1, str.bytes(), _file.file());
   }
 
+  void TemplateOutputFile::write(const char *data, std::size_t length) {
+    fwrite(data, 1, length, _file.file());
+  }
+
 } //  namespace mtemplate
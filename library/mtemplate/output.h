@@ -36,6 +36,9 @@ namespace mtemplate {
     virtual ~TemplateOutput();
 
     virtual void out(const base::utf8string &str) = 0;
+
+    // Raw UTF-8 output, used by compiled templates. The default implementation goes through out().
+    virtual void write(const char *data, std::size_t length);
   };
 
   class MTEMPLATELIBRARY_PUBLIC_FUNC TemplateOutputString : public TemplateOutput {
@@ -43,6 +46,7 @@ namespace mtemplate {
 
   public:
     virtual void out(const base::utf8string &str);
+    virtual void write(const char *data, std::size_t length);
 
     const base::utf8string &get();
   };
@@ -53,6 +57,7 @@ namespace mtemplate {
   public:
     TemplateOutputFile(const base::utf8string &filename);
     virtual void out(const base::utf8string &str);
+    virtual void write(const char *data, std::size_t length);
   };
 
 } //  namespace mtemplate
@@ -33,7 +33,9 @@
 
 namespace mtemplate {
 
-  Template::Template(TemplateDocument document) : _document(document) {
+  // Compiled right away, templates can be expanded by several threads at the same time.
+  Template::Template(TemplateDocument document)
+    : _document(document), _compiled(std::make_shared<CompiledTemplate>(_document)) {
   }
 
   Template::~Template() {
@@ -51,17 +53,16 @@ namespace mtemplate {
     std::cout << indent_str << "}" << std::endl;
   }
 
+  const CompiledTemplate &Template::compiled() const {
+    return *_compiled;
+  }
+
   void Template::expand(DictionaryInterface *dict, TemplateOutput *output) {
-    for (NodeStorageType node : _document) {
-      if (node->type() == TemplateObject_Section) {
-        DictionaryInterface::section_dictionary_storage &section_dicts = dict->getSectionDictionaries(node->_text);
-
-        for (DictionaryInterface::section_dictionary_storage_iterator section_iter = section_dicts.begin();
-             section_iter != section_dicts.end(); ++section_iter)
-          node->expand(output, *section_iter);
-      } else
-        node->expand(output, dict);
-    }
+    compiled().expand(dict, output);
+  }
+
+  void Template::expand(DataSource &source, TemplateOutput *output) {
+    compiled().expand(source, output);
   }
 
   Template *GetTemplate(const base::utf8string &path, PARSE_TYPE type) {
@@ -28,6 +28,7 @@
 #include "dictionary.h"
 #include "modifier.h"
 #include "output.h"
+#include "compiled_template.h"
 
 #include <string>
 
@@ -36,13 +37,17 @@ namespace mtemplate {
   class MTEMPLATELIBRARY_PUBLIC_FUNC Template {
   protected:
     TemplateDocument _document;
+    std::shared_ptr<CompiledTemplate> _compiled;
 
   public:
     Template(TemplateDocument document);
     ~Template();
 
     void expand(DictionaryInterface *dict, TemplateOutput *output);
+    void expand(DataSource &source, TemplateOutput *output);
     void dump(int indent = 0);
+
+    const CompiledTemplate &compiled() const;
   };
 
   MTEMPLATELIBRARY_PUBLIC_FUNC Template *GetTemplate(const base::utf8string &path, PARSE_TYPE type = DO_NOT_STRIP);
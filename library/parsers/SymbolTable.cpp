@@ -86,18 +86,22 @@ ScopedSymbol::ScopedSymbol(std::string const &name) : Symbol(name) {
 
 void ScopedSymbol::clear() {
   children.clear();
+  _nameIndex.clear();
+  _foldedNames.clear();
 }
 
 void ScopedSymbol::addAndManageSymbol(Symbol *symbol) {
   children.emplace_back(symbol);
   symbol->setParent(this);
+
+  _nameIndex.emplace(symbol->name, symbol); // Keeps an existing entry, like the linear search did.
+  _foldedNames.emplace(foldName(symbol->name), symbol); // Equal names stay in definition order.
 }
 
 Symbol *ScopedSymbol::resolve(std::string const &name, bool localOnly) {
-  for (auto &child : children) {
-    if (child->name == name)
-      return child.get();
-  }
+  auto iterator = _nameIndex.find(name);
+  if (iterator != _nameIndex.end())
+    return iterator->second;
 
   // Nothing found locally. Let the parent continue.
   if (!localOnly) {
@@ -193,6 +197,54 @@ std::set<std::string> ScopedSymbol::getAllSymbolNames() const {
   return result;
 }
 
+std::string ScopedSymbol::foldName(std::string const &name) {
+  std::string result = name;
+  for (auto &c : result) {
+    if (c >= 'A' && c <= 'Z')
+      c += 'a' - 'A';
+  }
+  return result;
+}
+
+int ScopedSymbol::matchScore(std::string const &pattern, std::string const &name) {
+  static const int wordStartBonus = 8;
+  static const int consecutiveBonus = 4;
+
+  auto fold = [](char c) { return (c >= 'A' && c <= 'Z') ? char(c + 'a' - 'A') : c; };
+
+  int score = 0;
+  size_t p = 0;
+  size_t lastMatch = std::string::npos;
+  for (size_t i = 0; i < name.size() && p < pattern.size(); ++i) {
+    if (fold(name[i]) != fold(pattern[p])) {
+      if (lastMatch != std::string::npos)
+        --score; // Gaps within the match cost a little.
+      continue;
+    }
+
+    ++score;
+    if (i == 0 || name[i - 1] == '_' || name[i - 1] == '$' || name[i - 1] == ' ' || name[i - 1] == '.')
+      score += wordStartBonus;
+    if (lastMatch != std::string::npos && lastMatch + 1 == i)
+      score += consecutiveBonus;
+    lastMatch = i;
+    ++p;
+  }
+
+  if (p < pattern.size())
+    return -1;
+
+  if (!pattern.empty() && pattern.size() <= name.size() && fold(name[0]) == fold(pattern[0])) {
+    size_t i = 1;
+    while (i < pattern.size() && fold(name[i]) == fold(pattern[i]))
+      ++i;
+    if (i == pattern.size())
+      score += wordStartBonus * (int)pattern.size(); // A real prefix.
+  }
+
+  return std::max(score, 0);
+}
+
 //----------------- VariableSymbol -------------------------------------------------------------------------------------
 
 VariableSymbol::VariableSymbol(std::string const &name, Type const *type) : TypedSymbol(name, type) {
@@ -27,6 +27,9 @@
 
 #include <set>
 #include <memory>
+#include <algorithm>
+#include <map>
+#include <unordered_map>
 
 // A simple symbol table implementation, tailored towards code completion.
 
@@ -140,6 +143,58 @@ namespace parsers {
     // Like getAllSymbols but only the names (sorted alpabetically).
     std::set<std::string> getAllSymbolNames() const;
 
+    // Returns the direct children of the given type whose name starts with prefix (ASCII case insensitive),
+    // ordered by name. Uses the name index instead of a scan of all children.
+    template <typename T>
+    std::vector<T *> getSymbolsWithPrefix(std::string const &prefix) const {
+      std::vector<T *> result;
+      std::string folded = foldName(prefix);
+      auto iterator = _foldedNames.lower_bound(folded);
+      for (; iterator != _foldedNames.end() && iterator->first.compare(0, folded.size(), folded) == 0; ++iterator) {
+        T *castChild = dynamic_cast<T *>(iterator->second);
+        if (castChild != nullptr)
+          result.push_back(castChild);
+      }
+
+      return result;
+    }
+
+    // Returns the direct children of the given type which fuzzy match the pattern (see matchScore), best matches
+    // first. At most limit symbols are returned, unless limit is 0.
+    template <typename T>
+    std::vector<T *> matchSymbols(std::string const &pattern, size_t limit = 0) const {
+      std::vector<std::pair<int, T *>> matches;
+      for (auto const &entry : _foldedNames) {
+        int score = matchScore(pattern, entry.first);
+        if (score < 0)
+          continue;
+
+        T *castChild = dynamic_cast<T *>(entry.second);
+        if (castChild != nullptr)
+          matches.push_back({ score, castChild });
+      }
+
+      // Stable, so equal scores stay in name order.
+      std::stable_sort(matches.begin(), matches.end(), [](auto const &lhs, auto const &rhs) {
+        return lhs.first > rhs.first;
+      });
+      if (limit > 0 && limit < matches.size())
+        matches.resize(limit);
+
+      std::vector<T *> result;
+      result.reserve(matches.size());
+      for (auto &match : matches)
+        result.push_back(match.second);
+      return result;
+    }
+
+    // Rates how well name matches pattern, when the pattern characters appear in the name in the same order
+    // (ASCII case insensitive). Matches at word starts and consecutive matches rate higher, so a prefix match always
+    // wins over a scattered match. Returns -1 if there is no match.
+    static int matchScore(std::string const &pattern, std::string const &name);
+
+    static std::string foldName(std::string const &name);
+
   protected:
     ScopedSymbol(const ScopedSymbol&) = delete;
     ScopedSymbol& operator=(const ScopedSymbol&) = delete;
@@ -147,6 +202,12 @@ namespace parsers {
     std::vector<std::unique_ptr<Symbol>> children; // All child symbols in definition order.
 
     ScopedSymbol(std::string const &name = "");
+
+  private:
+    // Indexes over the children, maintained by addAndManageSymbol and clear. Lookups never modify them, so they
+    // are as safe for concurrent readers as the child list itself.
+    std::unordered_map<std::string, Symbol *> _nameIndex;  // The first child for each name.
+    std::multimap<std::string, Symbol *> _foldedNames;     // Lower cased names, for prefix and fuzzy searches.
   };
 
   class PARSERS_PUBLIC_TYPE VariableSymbol : public TypedSymbol {
@@ -414,6 +475,26 @@ namespace parsers {
       return result;
     }
 
+    template <typename T>
+    std::vector<T *> getSymbolsWithPrefix(std::string const &prefix, ScopedSymbol *parent = nullptr) {
+      std::vector<T *> result;
+
+      lock();
+      if (parent == nullptr || parent == this) {
+        result = ScopedSymbol::getSymbolsWithPrefix<T>(prefix);
+
+        for (SymbolTable *table : _dependencies) {
+          auto subList = table->getSymbolsWithPrefix<T>(prefix);
+          result.insert(result.end(), subList.begin(), subList.end());
+        }
+      } else {
+        result = parent->getSymbolsWithPrefix<T>(prefix);
+      }
+
+      unlock();
+      return result;
+    }
+
     virtual Symbol *resolve(std::string const &name, bool localOnly = false) override;
 
   private:
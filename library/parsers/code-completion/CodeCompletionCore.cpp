@@ -21,6 +21,11 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <algorithm>
+#include <mutex>
+#include <istream>
+#include <ostream>
+
 #include "antlr4-runtime.h"
 
 #include "CodeCompletionCore.h"
@@ -31,7 +36,14 @@ using namespace antlr4::misc;
 
 //----------------------------------------------------------------------------------------------------------------------
 
-std::unordered_map<std::type_index, CodeCompletionCore::FollowSetsPerState> CodeCompletionCore::_followSetsByATN;
+std::map<CodeCompletionCore::CacheKey, CodeCompletionCore::FollowSetsPerState> CodeCompletionCore::_followSetsByATN;
+std::map<CodeCompletionCore::CacheKey, CodeCompletionCore::CachedCandidates> CodeCompletionCore::_lastCandidates;
+
+// Guards both static caches. Instances for different editors may run in different threads.
+static std::mutex cacheMutex;
+
+static const char followSetsMagic[4] = { 'C', '3', 'F', 'S' };
+static const uint64_t followSetsFormat = 1;
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -46,6 +58,7 @@ CandidatesCollection CodeCompletionCore::collectCandidates(size_t caretTokenInde
   _candidates.rules.clear();
   _candidates.tokens.clear();
   _statesProcessed = 0;
+  _followSetsComputed = false;
 
   _tokenStartIndex = context != nullptr ? context->start->getTokenIndex() : 0;
 
@@ -65,9 +78,31 @@ CandidatesCollection CodeCompletionCore::collectCandidates(size_t caretTokenInde
   }
   tokenStream->seek(currentOffset);
 
-  std::vector<size_t> callStack;
+  // The candidates depend only on the tokens up to the caret (and the settings), so a previous result for the same
+  // tokens can be returned as is. The shortcut map cannot be reused across calls however, as its entries are only
+  // valid for a specific caret position.
   size_t startRule = context != nullptr ? context->getRuleIndex() : 0;
-  processRule(_atn.ruleToStartState[startRule], 0, callStack, "");
+  bool reused = false;
+  {
+    std::lock_guard<std::mutex> guard(cacheMutex);
+    auto iterator = _lastCandidates.find(cacheKey());
+    if (iterator != _lastCandidates.end()) {
+      CachedCandidates const& cached = iterator->second;
+      if (cached.startRule == startRule && cached.tokens == _tokens && cached.ignoredTokens == ignoredTokens &&
+          cached.preferredRules == preferredRules) {
+        _candidates = cached.candidates;
+        reused = true;
+      }
+    }
+  }
+
+  if (!reused) {
+    std::vector<size_t> callStack;
+    processRule(_atn.ruleToStartState[startRule], 0, callStack, "");
+
+    std::lock_guard<std::mutex> guard(cacheMutex);
+    _lastCandidates[cacheKey()] = { _tokens, startRule, ignoredTokens, preferredRules, _candidates };
+  }
 
   if (showResult) {
     std::cout << std::endl << std::endl << "Collected rules:" << std::endl;
@@ -98,6 +133,197 @@ CandidatesCollection CodeCompletionCore::collectCandidates(size_t caretTokenInde
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+
+  void writeValue(std::ostream &stream, uint64_t value) {
+    stream.write(reinterpret_cast<char const *>(&value), sizeof(value));
+  }
+
+  bool readValue(std::istream &stream, uint64_t &value) {
+    stream.read(reinterpret_cast<char *>(&value), sizeof(value));
+    return stream.good();
+  }
+
+  // Reads a count and checks it for sanity, to avoid huge allocations for a damaged file.
+  bool readCount(std::istream &stream, uint64_t &value) {
+    return readValue(stream, value) && value < (1 << 24);
+  }
+
+  template <typename Container>
+  void writeList(std::ostream &stream, Container const& list) {
+    writeValue(stream, list.size());
+    for (auto value : list)
+      writeValue(stream, static_cast<uint64_t>(value));
+  }
+
+  template <typename Container>
+  bool readList(std::istream &stream, Container &list) {
+    uint64_t count;
+    if (!readCount(stream, count))
+      return false;
+
+    list.clear();
+    list.reserve(count);
+    for (uint64_t i = 0; i < count; ++i) {
+      uint64_t value;
+      if (!readValue(stream, value))
+        return false;
+      list.push_back(static_cast<typename Container::value_type>(value));
+    }
+    return true;
+  }
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Writes all follow sets computed so far for our parser class and settings. The data is only meant to be read back
+ * by the same build on the same machine, so values are written in native byte order.
+ */
+bool CodeCompletionCore::saveFollowSets(std::ostream &stream) const {
+  std::lock_guard<std::mutex> guard(cacheMutex);
+  auto iterator = _followSetsByATN.find(cacheKey());
+  if (iterator == _followSetsByATN.end())
+    return false;
+
+  stream.write(followSetsMagic, sizeof(followSetsMagic));
+  writeValue(stream, followSetsFormat);
+  writeValue(stream, settingsKey.size());
+  stream.write(settingsKey.data(), settingsKey.size());
+
+  // A fingerprint of the grammar, so we don't load the data for a different parser.
+  writeValue(stream, _atn.states.size());
+  writeValue(stream, _atn.maxTokenType);
+  writeValue(stream, _atn.ruleToStartState.size());
+
+  writeValue(stream, iterator->second.size());
+  for (auto &entry : iterator->second) {
+    writeValue(stream, entry.first);
+    writeValue(stream, entry.second.sets.size());
+    for (auto &set : entry.second.sets) {
+      std::vector<Interval> intervals = set.intervals.getIntervals();
+      writeValue(stream, intervals.size());
+      for (auto &interval : intervals) {
+        writeValue(stream, static_cast<uint64_t>(interval.a));
+        writeValue(stream, static_cast<uint64_t>(interval.b));
+      }
+      writeList(stream, set.path);
+      writeList(stream, set.following);
+    }
+  }
+
+  return stream.good();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Reads follow sets written by saveFollowSets() and adds those which are not computed yet to the shared cache.
+ */
+bool CodeCompletionCore::loadFollowSets(std::istream &stream) {
+  char magic[sizeof(followSetsMagic)];
+  stream.read(magic, sizeof(magic));
+  if (!stream.good() || !std::equal(magic, magic + sizeof(magic), followSetsMagic))
+    return false;
+
+  uint64_t format, keySize;
+  if (!readValue(stream, format) || format != followSetsFormat || !readCount(stream, keySize))
+    return false;
+
+  std::string key(keySize, '\0');
+  stream.read(&key[0], keySize);
+  if (!stream.good() || key != settingsKey)
+    return false;
+
+  uint64_t stateCount, maxTokenType, ruleCount;
+  if (!readValue(stream, stateCount) || !readValue(stream, maxTokenType) || !readValue(stream, ruleCount))
+    return false;
+  if (stateCount != _atn.states.size() || maxTokenType != _atn.maxTokenType ||
+      ruleCount != _atn.ruleToStartState.size())
+    return false;
+
+  uint64_t entryCount;
+  if (!readCount(stream, entryCount))
+    return false;
+
+  FollowSetsPerState loaded;
+  for (uint64_t i = 0; i < entryCount; ++i) {
+    uint64_t stateNumber, setCount;
+    if (!readValue(stream, stateNumber) || stateNumber >= stateCount || !readCount(stream, setCount))
+      return false;
+
+    FollowSetsHolder &holder = loaded[stateNumber];
+    for (uint64_t j = 0; j < setCount; ++j) {
+      FollowSetWithPath set;
+      uint64_t intervalCount;
+      if (!readCount(stream, intervalCount))
+        return false;
+      for (uint64_t k = 0; k < intervalCount; ++k) {
+        uint64_t a, b;
+        if (!readValue(stream, a) || !readValue(stream, b))
+          return false;
+        set.intervals.add(static_cast<ssize_t>(a), static_cast<ssize_t>(b));
+      }
+      if (!readList(stream, set.path) || !readList(stream, set.following))
+        return false;
+
+      holder.combined.addAll(set.intervals);
+      holder.sets.push_back(std::move(set));
+    }
+  }
+
+  std::lock_guard<std::mutex> guard(cacheMutex);
+  FollowSetsPerState &setsPerState = _followSetsByATN[cacheKey()];
+  for (auto &entry : loaded)
+    setsPerState.emplace(entry.first, std::move(entry.second)); // Keeps what was computed already.
+
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CodeCompletionCore::clearCaches() {
+  std::lock_guard<std::mutex> guard(cacheMutex);
+  _followSetsByATN.clear();
+  _lastCandidates.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CodeCompletionCore::CacheKey CodeCompletionCore::cacheKey() const {
+  return { typeid(*_parser), settingsKey };
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the (cached) follow sets for the rule starting at the given state, computing them if necessary.
+ * Entries are never removed while instances are working (only by clearCaches), so the returned reference stays valid.
+ */
+CodeCompletionCore::FollowSetsHolder &CodeCompletionCore::followSetsFor(ATNState *startState) {
+  std::lock_guard<std::mutex> guard(cacheMutex);
+
+  FollowSetsPerState &setsPerState = _followSetsByATN[cacheKey()];
+  auto iterator = setsPerState.find(startState->stateNumber);
+  if (iterator != setsPerState.end())
+    return iterator->second;
+
+  FollowSetsHolder &holder = setsPerState[startState->stateNumber];
+  ATNState *stop = _atn.ruleToStopState[startState->ruleIndex];
+  holder.sets = determineFollowSets(startState, stop);
+
+  // Sets are split by path to allow translating them to preferred rules. But for quick hit tests
+  // it is also useful to have a set with all symbols combined.
+  for (auto &set : holder.sets)
+    holder.combined.addAll(set.intervals);
+
+  _followSetsComputed = true;
+  return holder;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 /**
  * Checks if the predicate associated with the given transition evaluates to true.
  */
@@ -289,21 +515,7 @@ CodeCompletionCore::RuleEndStatus CodeCompletionCore::processRule(ATNState *star
   // 3) We get this lookup for free with any 2nd or further visit of the same rule, which often happens
   //    in non trivial grammars, especially with (recursive) expressions and of course when invoking code completion
   //    multiple times.
-  FollowSetsPerState &setsPerState = _followSetsByATN[typeid(_parser)];
-  if (setsPerState.count(startState->stateNumber) == 0) {
-    ATNState *stop = _atn.ruleToStopState[startState->ruleIndex];
-    auto followSets = determineFollowSets(startState, stop);
-    setsPerState[startState->stateNumber].sets = followSets;
-
-    // Sets are split by path to allow translating them to preferred rules. But for quick hit tests
-    // it is also useful to have a set with all symbols combined.
-    IntervalSet combined;
-    for (auto &set : setsPerState[startState->stateNumber].sets)
-      combined.addAll(set.intervals);
-    setsPerState[startState->stateNumber].combined = combined;
-  }
-
-  FollowSetsHolder &followSets = setsPerState[startState->stateNumber];
+  FollowSetsHolder &followSets = followSetsFor(startState);
   callStack.push_back(startState->ruleIndex);
 
   if (tokenIndex >= _tokens.size() - 1) { // At caret?
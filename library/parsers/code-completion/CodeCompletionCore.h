@@ -24,6 +24,8 @@
 #include <unordered_set>
 #include <string>
 #include <vector>
+#include <map>
+#include <iosfwd>
 #include <typeindex>
 
 namespace antlr4 {
@@ -59,10 +61,28 @@ namespace antlr4 {
     std::unordered_set<size_t> ignoredTokens;  // Tokens which should not appear in the candidates set.
     std::unordered_set<size_t> preferredRules; // Rules which replace any candidate token they contain.
                                                // This allows to return descriptive rules (e.g. className, instead of ID/identifier).
+
+    // Identifies parser settings which influence the predicates in the grammar (e.g. a server version).
+    // Cached follow sets and candidates are only shared between instances with the same settings.
+    std::string settingsKey;
+
     CodeCompletionCore(antlr4::Parser *parser);
 
     CandidatesCollection collectCandidates(size_t caretTokenIndex, ParserRuleContext *context);
 
+    // Follow sets are computed once per rule and shared by all instances for the same parser class and settings.
+    // Computing them is most of the work for the first code completion in a process, so they can be written to a
+    // stream and read back in a later session. Loading fails (and changes nothing) if the data was written for
+    // another grammar or other settings.
+    bool saveFollowSets(std::ostream &stream) const;
+    bool loadFollowSets(std::istream &stream);
+
+    // True if the last collectCandidates() call had to compute follow sets which were not cached yet.
+    bool followSetsComputed() const { return _followSetsComputed; }
+
+    // Removes all cached follow sets and candidates, for all parser classes.
+    static void clearCaches();
+
   private:
     // Token stream position info after a rule was processed.
     using RuleEndStatus = std::unordered_set<size_t>;
@@ -79,6 +99,7 @@ namespace antlr4 {
     size_t _tokenStartIndex; // The index of the token which is the start token in a given parser rule context.
 
     size_t _statesProcessed;
+    bool _followSetsComputed = false;
     std::unordered_map<size_t, std::unordered_map<size_t, RuleEndStatus>> _shortcutMap;
     CandidatesCollection _candidates; // The collected candidates (rules and tokens).
 
@@ -103,7 +124,22 @@ namespace antlr4 {
     };
 
     using FollowSetsPerState = std::unordered_map<size_t, FollowSetsHolder>;
-    static std::unordered_map<std::type_index, FollowSetsPerState> _followSetsByATN;
+    using CacheKey = std::pair<std::type_index, std::string>; // Parser class + settings key.
+    static std::map<CacheKey, FollowSetsPerState> _followSetsByATN;
+
+    // The result of the last collection, reused as long as the tokens up to the caret are the same
+    // (e.g. while typing an identifier).
+    struct CachedCandidates {
+      std::vector<size_t> tokens;
+      size_t startRule = 0;
+      std::unordered_set<size_t> ignoredTokens;
+      std::unordered_set<size_t> preferredRules;
+      CandidatesCollection candidates;
+    };
+    static std::map<CacheKey, CachedCandidates> _lastCandidates;
+
+    CacheKey cacheKey() const;
+    FollowSetsHolder &followSetsFor(antlr4::atn::ATNState *startState);
 
     struct PipelineEntry {
       antlr4::atn::ATNState *state;
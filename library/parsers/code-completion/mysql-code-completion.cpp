@@ -27,6 +27,7 @@
 #include <map>
 #include <set>
 #include <deque>
+#include <mutex>
 
 #include "antlr4-runtime.h"
 #include <glib.h>
@@ -60,6 +61,81 @@ struct TableReference {
   std::string alias;
 };
 
+//----------------------------------------------------------------------------------------------------------------------
+
+// The folder for follow set cache files (empty if there is none) and the settings for which we tried loading a file.
+static std::mutex followSetsMutex;
+static std::string followSetsFolder;
+static std::set<std::string> loadedFollowSets;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static std::string followSetsFile(CodeCompletionCore const& c3) {
+  std::lock_guard<std::mutex> guard(followSetsMutex);
+  if (followSetsFolder.empty())
+    return "";
+  return followSetsFolder + "/code_completion_" + c3.settingsKey + ".cache";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Reads the follow sets for the current settings from the cache folder, once per process and settings.
+ */
+static void loadFollowSets(CodeCompletionCore &c3) {
+  std::string fileName = followSetsFile(c3);
+  if (fileName.empty())
+    return;
+
+  {
+    std::lock_guard<std::mutex> guard(followSetsMutex);
+    if (!loadedFollowSets.insert(c3.settingsKey).second)
+      return;
+  }
+
+  if (!base::file_exists(fileName))
+    return;
+
+  try {
+    std::ifstream stream = base::openBinaryInputStream(fileName);
+    if (!c3.loadFollowSets(stream))
+      logWarning("Ignoring outdated or damaged code completion cache %s\n", fileName.c_str());
+  } catch (std::exception &e) {
+    logError("Could not read code completion cache %s: %s\n", fileName.c_str(), e.what());
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Writes all follow sets computed so far to the cache folder. Called whenever a code completion run had to compute
+ * new ones, so the file quickly covers everything needed in practice.
+ */
+static void saveFollowSets(CodeCompletionCore &c3) {
+  std::string fileName = followSetsFile(c3);
+  if (fileName.empty())
+    return;
+
+  // Write to a temporary file first, so a concurrently running instance never reads a half written cache.
+  std::string tempName = fileName + ".tmp";
+  try {
+    bool written;
+    {
+      std::ofstream stream = base::openBinaryOutputStream(tempName);
+      written = c3.saveFollowSets(stream);
+    }
+    if (written) {
+      base::tryRemove(fileName);
+      base::rename(tempName, fileName);
+    } else
+      base::tryRemove(tempName);
+  } catch (std::exception &e) {
+    logError("Could not write code completion cache %s: %s\n", fileName.c_str(), e.what());
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 // Context structure for code completion results and token info.
 struct AutoCompletionContext {
   CandidatesCollection completionCandidates;
@@ -199,12 +275,16 @@ struct AutoCompletionContext {
 
     c3.showResult = false;
     c3.showDebugOutput = false;
+    c3.settingsKey = std::to_string(parser->serverVersion) + "_" + std::to_string((int)parser->sqlMode);
     referencesStack.emplace_front(); // For the root level of table references.
 
     parser->reset();
     ParserRuleContext *context = parser->query();
 
+    loadFollowSets(c3);
     completionCandidates = c3.collectCandidates(caretIndex, context);
+    if (c3.followSetsComputed())
+      saveFollowSets(c3);
 
     // Post processing some entries.
     if (completionCandidates.tokens.count(MySQLLexer::NOT2_SYMBOL) > 0) {
@@ -643,14 +723,36 @@ static void insertSchemas(SymbolTable &symbolTable, CompletionSet &set) {
 
 //----------------------------------------------------------------------------------------------------------------------
 
-static void insertTables(SymbolTable &symbolTable, CompletionSet &set, std::set<std::string> &schemas) {
+/**
+ * Returns the symbols of the given type in a scope which are worth offering for what the user typed so far.
+ * With a typed part only prefix matches are collected (via the scope's name index instead of a scan), or the best
+ * fuzzy matches if nothing starts with it. Non-ASCII input gets all symbols, as the index only folds ASCII letters.
+ */
+template <typename T>
+static std::vector<T *> candidateSymbols(ScopedSymbol *scope, std::string const &typedPart) {
+  static const size_t maxFuzzyMatches = 50;
+
+  bool isAscii = std::all_of(typedPart.begin(), typedPart.end(), [](char c) { return (c & 0x80) == 0; });
+  if (typedPart.empty() || !isAscii)
+    return scope->getSymbolsOfType<T>();
+
+  std::vector<T *> result = scope->getSymbolsWithPrefix<T>(typedPart);
+  if (result.empty())
+    result = scope->matchSymbols<T>(typedPart, maxFuzzyMatches);
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void insertTables(SymbolTable &symbolTable, CompletionSet &set, std::set<std::string> &schemas,
+                         std::string const &typedPart) {
 
   for (auto &schema : schemas) {
     SchemaSymbol *schemaSymbol = dynamic_cast<SchemaSymbol *>(symbolTable.resolve(schema));
     if (schemaSymbol == nullptr)
       continue;
 
-    auto symbols = schemaSymbol->getSymbolsOfType<TableSymbol>();
+    auto symbols = candidateSymbols<TableSymbol>(schemaSymbol, typedPart);
     for (auto symbol : symbols)
       set.insert({ AC_TABLE_IMAGE, symbol->name });
   }
@@ -658,7 +760,8 @@ static void insertTables(SymbolTable &symbolTable, CompletionSet &set, std::set<
 
 //----------------------------------------------------------------------------------------------------------------------
 
-static void insertViews(SymbolTable &symbolTable, CompletionSet &set, const std::set<std::string> &schemas) {
+static void insertViews(SymbolTable &symbolTable, CompletionSet &set, const std::set<std::string> &schemas,
+                        std::string const &typedPart) {
 
   for (auto &schema : schemas) {
     Symbol *symbol = symbolTable.resolve(schema);
@@ -666,7 +769,7 @@ static void insertViews(SymbolTable &symbolTable, CompletionSet &set, const std:
     if (schemaSymbol == nullptr)
       continue;
 
-    auto symbols = schemaSymbol->getSymbolsOfType<ViewSymbol>();
+    auto symbols = candidateSymbols<ViewSymbol>(schemaSymbol, typedPart);
     for (auto symbol : symbols)
       set.insert({ AC_VIEW_IMAGE, symbol->name });
   }
@@ -674,11 +777,12 @@ static void insertViews(SymbolTable &symbolTable, CompletionSet &set, const std:
 
 //----------------------------------------------------------------------------------------------------------------------
 
-static void insertRoutines(SymbolTable &symbolTable, CompletionSet &set, std::string const &schema) {
+static void insertRoutines(SymbolTable &symbolTable, CompletionSet &set, std::string const &schema,
+                           std::string const &typedPart) {
 
   SchemaSymbol *schemaSymbol = dynamic_cast<SchemaSymbol *>(symbolTable.resolve(schema));
   if (schemaSymbol != nullptr) {
-    auto symbols = schemaSymbol->getSymbolsOfType<RoutineSymbol>();
+    auto symbols = candidateSymbols<RoutineSymbol>(schemaSymbol, typedPart);
     for (auto symbol : symbols)
       set.insert({ AC_ROUTINE_IMAGE, symbol->name + "()" });
   }
@@ -687,7 +791,7 @@ static void insertRoutines(SymbolTable &symbolTable, CompletionSet &set, std::st
 //----------------------------------------------------------------------------------------------------------------------
 
 static void insertColumns(SymbolTable &symbolTable, CompletionSet &set, const std::set<std::string> &schemas,
-                          const std::set<std::string> &tables) {
+                          const std::set<std::string> &tables, std::string const &typedPart) {
 
   for (auto &schema : schemas) {
     Symbol *symbol = symbolTable.resolve(schema);
@@ -701,7 +805,7 @@ static void insertColumns(SymbolTable &symbolTable, CompletionSet &set, const st
       if (tableSymbol == nullptr)
         continue;
 
-      auto symbols = tableSymbol->getSymbolsOfType<ColumnSymbol>();
+      auto symbols = candidateSymbols<ColumnSymbol>(tableSymbol, typedPart);
       for (auto symbol : symbols)
         set.insert({ AC_COLUMN_IMAGE, symbol->name });
     }
@@ -712,7 +816,8 @@ static void insertColumns(SymbolTable &symbolTable, CompletionSet &set, const st
 //----------------------------------------------------------------------------------------------------------------------
 
 std::vector<std::pair<int, std::string>> getCodeCompletionList(size_t caretLine, size_t caretOffset,
-  const std::string &defaultSchema, bool uppercaseKeywords, MySQLParser *parser, parsers::SymbolTable &symbolTable) {
+  const std::string &defaultSchema, bool uppercaseKeywords, MySQLParser *parser, parsers::SymbolTable &symbolTable,
+  const std::string &typedPart) {
 
   logDebug("Invoking code completion\n");
 
@@ -892,7 +997,7 @@ std::vector<std::pair<int, std::string>> getCodeCompletionList(size_t caretLine,
           if (qualifier.empty())
             qualifier = defaultSchema;
 
-          insertRoutines(symbolTable, functionEntries, qualifier);
+          insertRoutines(symbolTable, functionEntries, qualifier, typedPart);
         }
 
         break;
@@ -928,7 +1033,7 @@ std::vector<std::pair<int, std::string>> getCodeCompletionList(size_t caretLine,
           if (qualifier.empty())
             qualifier = defaultSchema;
 
-          insertRoutines(symbolTable, functionEntries, qualifier);
+          insertRoutines(symbolTable, functionEntries, qualifier, typedPart);
         }
         break;
       }
@@ -946,8 +1051,8 @@ std::vector<std::pair<int, std::string>> getCodeCompletionList(size_t caretLine,
         std::set<std::string> schemas;
         schemas.insert(schema.empty() ? defaultSchema : schema);
         if ((flags & ShowTables) != 0) {
-          insertTables(symbolTable, tableEntries, schemas);
-          insertViews(symbolTable, viewEntries, schemas);
+          insertTables(symbolTable, tableEntries, schemas, typedPart);
+          insertViews(symbolTable, viewEntries, schemas, typedPart);
         }
         break;
       }
@@ -967,8 +1072,8 @@ std::vector<std::pair<int, std::string>> getCodeCompletionList(size_t caretLine,
           std::set<std::string> schemas;
           schemas.insert(qualifier.empty() ? defaultSchema : qualifier);
 
-          insertTables(symbolTable, tableEntries, schemas);
-          insertViews(symbolTable, viewEntries, schemas);
+          insertTables(symbolTable, tableEntries, schemas, typedPart);
+          insertViews(symbolTable, viewEntries, schemas, typedPart);
         }
         break;
       }
@@ -1004,10 +1109,10 @@ std::vector<std::pair<int, std::string>> getCodeCompletionList(size_t caretLine,
           schemas.insert(defaultSchema);
 
         if ((flags & ShowTables) != 0) {
-          insertTables(symbolTable, tableEntries, schemas);
+          insertTables(symbolTable, tableEntries, schemas, typedPart);
           if (candidate.first == MySQLParser::RuleColumnRef) {
             // Insert also views.
-            insertViews(symbolTable, viewEntries, schemas);
+            insertViews(symbolTable, viewEntries, schemas, typedPart);
 
             // Insert also tables from our references list.
             for (auto &reference : context.references) {
@@ -1044,7 +1149,7 @@ std::vector<std::pair<int, std::string>> getCodeCompletionList(size_t caretLine,
           }
 
           if (!tables.empty())
-            insertColumns(symbolTable, columnEntries, schemas, tables);
+            insertColumns(symbolTable, columnEntries, schemas, tables, typedPart);
 
           // Special deal here: triggers. Show columns for the "new" and "old" qualifiers too.
           // Use the first reference in the list, which is the table to which this trigger belongs (there can be more
@@ -1053,7 +1158,7 @@ std::vector<std::pair<int, std::string>> getCodeCompletionList(size_t caretLine,
               (base::same_string(table, "old") || base::same_string(table, "new"))) {
             tables.clear();
             tables.insert(context.references[0].table);
-            insertColumns(symbolTable, columnEntries, schemas, tables);
+            insertColumns(symbolTable, columnEntries, schemas, tables, typedPart);
           }
         }
 
@@ -1073,7 +1178,7 @@ std::vector<std::pair<int, std::string>> getCodeCompletionList(size_t caretLine,
             schemas.insert(context.references[0].schema);
         }
         if (!tables.empty())
-          insertColumns(symbolTable, columnEntries, schemas, tables);
+          insertColumns(symbolTable, columnEntries, schemas, tables, typedPart);
 
         break;
       }
@@ -1113,7 +1218,7 @@ std::vector<std::pair<int, std::string>> getCodeCompletionList(size_t caretLine,
         if ((flags & ShowSecond) != 0) {
           std::set<std::string> schemas;
           schemas.insert(qualifier.empty() ? defaultSchema : qualifier);
-          insertViews(symbolTable, viewEntries, schemas);
+          insertViews(symbolTable, viewEntries, schemas, typedPart);
         }
         break;
       }
@@ -1243,3 +1348,11 @@ std::vector<std::pair<int, std::string>> getCodeCompletionList(size_t caretLine,
 }
 
 //----------------------------------------------------------------------------------------------------------------------
+
+void setCodeCompletionCacheFolder(const std::string &folder) {
+  std::lock_guard<std::mutex> guard(followSetsMutex);
+  followSetsFolder = folder;
+  loadedFollowSets.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -32,4 +32,8 @@ namespace parsers {
 
 PARSERS_PUBLIC_TYPE std::vector<std::pair<int, std::string>> getCodeCompletionList(
   size_t caretLine, size_t caretOffset, const std::string &defaultSchema, bool uppercaseKeywords,
-  parsers::MySQLParser *parser, parsers::SymbolTable &symbolTable);
+  parsers::MySQLParser *parser, parsers::SymbolTable &symbolTable, const std::string &typedPart = "");
+
+// Sets a folder where code completion keeps data which is expensive to compute (the follow sets of the grammar),
+// to speed up the first code completion in the next session. No data is written if no folder is set.
+PARSERS_PUBLIC_TYPE void setCodeCompletionCacheFolder(const std::string &folder);
@@ -82,11 +82,21 @@ namespace ssh {
 #endif
   }
 
-  inline int wbPoll(pollfd *data, size_t size) {
+  // Tells if the last failed socket operation only failed because it would have blocked.
+  inline bool wbSocketWouldBlock() {
 #if _MSC_VER
-    return WSAPoll(data, static_cast<ULONG>(size), -1);
+    int error = WSAGetLastError();
+    return error == WSAEWOULDBLOCK || error == WSAEINTR;
 #else
-    return poll(data, static_cast<nfds_t>(size), -1);
+    return errno == EWOULDBLOCK || errno == EAGAIN || errno == EINTR;
+#endif
+  }
+
+  inline int wbPoll(pollfd *data, size_t size, int timeout = -1) {
+#if _MSC_VER
+    return WSAPoll(data, static_cast<ULONG>(size), timeout);
+#else
+    return poll(data, static_cast<nfds_t>(size), timeout);
 #endif
   }
 
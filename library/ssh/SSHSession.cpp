@@ -44,7 +44,7 @@ namespace ssh {
   }
 
   SSHSession::SSHSession()
-      : _session(new ssh::Session()), _isConnected(false), _event(nullptr) {
+      : _session(new ssh::Session()), _isConnected(false), _event(nullptr), _channelCount(0) {
     initLibSSH();
   }
 
@@ -241,6 +241,14 @@ namespace ssh {
     return _config;
   }
 
+  std::string SSHSession::getUserName() const {
+    return _credentials.username;
+  }
+
+  SSHConnectionCredentials SSHSession::getCredentials() const {
+    return _credentials;
+  }
+
   ssh::Session* SSHSession::getSession() const {
     return _session;
   }
@@ -279,7 +287,8 @@ namespace ssh {
     auto lock = lockSession();
     logDebug3("Session locked.\n");
     auto channel = std::unique_ptr<ssh::Channel, std::function<void(ssh::Channel *)>>(
-        new ssh::Channel(*_session), [](ssh::Channel *chan) { chan->close(); delete chan; });
+        new ssh::Channel(*_session), [this](ssh::Channel *chan) { chan->close(); delete chan; channelClosed(); });
+    channelOpened();
     if (!openChannel(channel.get())) {
       throw SSHTunnelException("Unable to open channel");
     }
@@ -373,7 +382,8 @@ namespace ssh {
     logDebug2("About to execute elevated command: %s\n", command.c_str());
     auto lock = lockSession();
     auto channel = std::unique_ptr<ssh::Channel, std::function<void(ssh::Channel *)>>(
-            new ssh::Channel(*_session), [](ssh::Channel *chan) { chan->close(); delete chan; });
+            new ssh::Channel(*_session), [this](ssh::Channel *chan) { chan->close(); delete chan; channelClosed(); });
+    channelOpened();
 
     if (!openChannel(channel.get())) {
       throw SSHTunnelException("Unable to open channel");
@@ -495,6 +505,39 @@ namespace ssh {
     return mutexLock;
   }
 
+  /**
+   * Sends a keep alive message to the server, so that idle sessions are not dropped by the server or firewalls
+   * in between. A session which is currently in use doesn't need that, so we don't wait for the lock.
+   */
+  bool SSHSession::sendKeepAlive() {
+    if (!_isConnected)
+      return false;
+
+    if (!_sessionMutex.tryLock()) {
+      logDebug2("Session busy, skipping keep alive.\n");
+      return true;
+    }
+
+    int rc = ssh_send_keepalive(_session->getCSession());
+    _sessionMutex.unlock();
+    if (rc != SSH_OK)
+      logWarning("Unable to send keep alive: %s\n", _session->getError());
+    return rc == SSH_OK;
+  }
+
+  void SSHSession::channelOpened() {
+    ++_channelCount;
+  }
+
+  void SSHSession::channelClosed() {
+    if (_channelCount > 0)
+      --_channelCount;
+  }
+
+  std::size_t SSHSession::channelCount() const {
+    return _channelCount;
+  }
+
   int SSHSession::verifyKnownHost(const ssh::SSHConnectionConfig &config, std::string &fingerprint) {
     std::unique_ptr<unsigned char, void (*)(unsigned char*)> hash(
         nullptr, [](unsigned char* v) {if (v != nullptr) ssh_clean_pubkey_hash(&v);});
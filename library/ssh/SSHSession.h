@@ -51,6 +51,7 @@ namespace ssh {
     bool _isConnected;
     ssh_event _event;
     mutable base::Mutex _sessionMutex;
+    std::atomic<std::size_t> _channelCount;
   public:
     static std::shared_ptr<SSHSession> createSession();
     virtual ~SSHSession();
@@ -61,6 +62,8 @@ namespace ssh {
     void disconnect();
     bool isConnected() const;
     SSHConnectionConfig getConfig() const;
+    std::string getUserName() const;
+    SSHConnectionCredentials getCredentials() const;
     ssh::Session* getSession() const;
     std::tuple<std::string, std::string, int> execCmd(std::string command, std::size_t logSize = LOG_SIZE_100MB);
     std::tuple<std::string, std::string, int> execCmdSudo(std::string command, std::string password,
@@ -69,6 +72,12 @@ namespace ssh {
 
     base::MutexLock lockSession();
     void reconnect();
+    bool sendKeepAlive();
+
+    // Book keeping of the channels multiplexed over this session (tunnels, sftp, remote commands).
+    void channelOpened();
+    void channelClosed();
+    std::size_t channelCount() const;
   protected:
     SSHSession();
     SSHSession(const SSHSession& ses) = delete;
@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+#include <chrono>
+#include <glib.h>
+
+#include "base/log.h"
+#include "base/threaded_timer.h"
+
+#include "SSHSessionPool.h"
+
+DEFAULT_LOG_DOMAIN("SSHSessionPool")
+
+namespace ssh {
+
+  static const std::size_t DEFAULT_IDLE_TIMEOUT = 300;  // Seconds.
+  static const std::size_t DEFAULT_KEEP_ALIVE = 60;     // Seconds.
+  static const double MAINTENANCE_INTERVAL = 5.0;       // Seconds.
+
+  static std::int64_t now() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  SSHSessionPool::SSHSessionPool()
+    : _idleTimeout(DEFAULT_IDLE_TIMEOUT), _keepAliveInterval(DEFAULT_KEEP_ALIVE), _maintenanceTask(0) {
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  SSHSessionPool *SSHSessionPool::get() {
+    static SSHSessionPool instance;
+    return &instance;
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  /**
+   * Sessions are only shared between users who authenticate the same way, so the key contains a digest of the
+   * credentials besides the user name and server. Otherwise a wrong password or key would be accepted as long as
+   * somebody else had already logged in.
+   */
+  std::string SSHSessionPool::keyFor(const SSHConnectionConfig &config, const SSHConnectionCredentials &credentials) {
+    std::string identity = std::to_string(static_cast<int>(credentials.auth)) + "\n" + credentials.keyfile + "\n" +
+                           credentials.password + "\n" + credentials.keypassword;
+    gchar *digest = g_compute_checksum_for_string(G_CHECKSUM_SHA256, identity.c_str(), identity.size());
+    std::string key = credentials.username + "@" + config.remoteSSHhost + ":" + std::to_string(config.remoteSSHport) +
+                      "#" + digest;
+    g_free(digest);
+    return key;
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  /**
+   * Returns an authenticated session for the given server and user, if there is one in the pool.
+   * Otherwise the caller has to connect a new session and can then hand it over via add().
+   */
+  std::shared_ptr<SSHSession> SSHSessionPool::acquire(const SSHConnectionConfig &config,
+                                                      const SSHConnectionCredentials &credentials) {
+    std::vector<std::shared_ptr<SSHSession>> idle;
+    {
+      base::MutexLock lock(_mutex);
+      auto it = _sessions.find(keyFor(config, credentials));
+      if (it == _sessions.end())
+        return std::shared_ptr<SSHSession>();
+
+      if (it->second.session->isConnected()) {
+        ++it->second.leases;
+        it->second.lastUsed = now();
+        ++_stats.reused;
+        logDebug2("Reusing pooled session for %s (%lu users).\n", it->first.c_str(),
+                  static_cast<unsigned long>(it->second.leases));
+        return it->second.session;
+      }
+
+      logDebug("Pooled session for %s lost its connection, dropping it.\n", it->first.c_str());
+      retire(it, idle);
+      ++_stats.evicted;
+    }
+
+    for (auto &session : idle)
+      session->disconnect();
+    return std::shared_ptr<SSHSession>();
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  /**
+   * Removes the entry from the pool. Idle sessions are collected in idle, so the caller can disconnect them once the
+   * pool lock is released. Sessions still in use are kept aside until their last user releases them.
+   * Must be called with the pool locked.
+   */
+  void SSHSessionPool::retire(std::map<std::string, Entry>::iterator entry,
+                              std::vector<std::shared_ptr<SSHSession>> &idle) {
+    if (entry->second.leases == 0)
+      idle.push_back(entry->second.session);
+    else
+      _retired[entry->second.session] = entry->second.leases;
+    _sessions.erase(entry);
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  /**
+   * Takes the session out of the pool, e.g. because it lost its connection. It will not be handed out again and is
+   * disconnected when its last user releases it, so users still working with it are not cut off here.
+   */
+  void SSHSessionPool::evict(std::shared_ptr<SSHSession> session) {
+    std::vector<std::shared_ptr<SSHSession>> idle;
+    {
+      base::MutexLock lock(_mutex);
+      for (auto it = _sessions.begin(); it != _sessions.end(); ++it) {
+        if (it->second.session == session) {
+          logDebug("Evicting session for %s.\n", it->first.c_str());
+          retire(it, idle);
+          ++_stats.evicted;
+          break;
+        }
+      }
+    }
+
+    for (auto &session : idle)
+      session->disconnect();
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  /**
+   * Registers a connected session with the pool. The caller holds the first lease on it.
+   */
+  void SSHSessionPool::add(std::shared_ptr<SSHSession> session) {
+    if (!session || !session->isConnected())
+      return;
+
+    std::string key = keyFor(session->getConfig(), session->getCredentials());
+    {
+      base::MutexLock lock(_mutex);
+      auto it = _sessions.find(key);
+      if (it != _sessions.end()) {
+        if (it->second.session == session) {
+          ++it->second.leases;
+          return;
+        }
+
+        // Another session was connected for the same server meanwhile. We keep the older one in the pool, the new
+        // one stays with its owner and is closed on release as any other unpooled session.
+        if (it->second.session->isConnected())
+          return;
+        _sessions.erase(it);
+      }
+
+      Entry entry;
+      entry.session = session;
+      entry.leases = 1;
+      entry.lastUsed = now();
+      entry.lastKeepAlive = entry.lastUsed;
+      _sessions.insert({ key, entry });
+      ++_stats.created;
+    }
+
+    logDebug("Added session for %s to the pool.\n", key.c_str());
+    startMaintenance();
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  /**
+   * Gives up a lease on the session. Pooled sessions stay open for reuse, all others are disconnected.
+   */
+  void SSHSessionPool::release(std::shared_ptr<SSHSession> session) {
+    if (!session)
+      return;
+
+    {
+      base::MutexLock lock(_mutex);
+      for (auto &it : _sessions) {
+        if (it.second.session == session) {
+          if (it.second.leases > 0)
+            --it.second.leases;
+          it.second.lastUsed = now();
+          logDebug2("Released pooled session for %s (%lu users left).\n", it.first.c_str(),
+                    static_cast<unsigned long>(it.second.leases));
+          return;
+        }
+      }
+
+      auto retired = _retired.find(session);
+      if (retired != _retired.end()) {
+        if (--retired->second > 0)
+          return;
+        _retired.erase(retired);
+      }
+    }
+
+    session->disconnect();
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  bool SSHSessionPool::isPooled(const std::shared_ptr<SSHSession> &session) const {
+    base::MutexLock lock(_mutex);
+    for (auto &it : _sessions) {
+      if (it.second.session == session)
+        return true;
+    }
+    return false;
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  /**
+   * Disconnects all sessions which are not in use and removes them from the pool. Sessions which are still leased are
+   * only removed from the pool and get disconnected when their last user releases them.
+   */
+  void SSHSessionPool::clear() {
+    std::vector<std::shared_ptr<SSHSession>> idleSessions;
+    {
+      base::MutexLock lock(_mutex);
+      if (_maintenanceTask != 0) {
+        ThreadedTimer::remove_task(_maintenanceTask);
+        _maintenanceTask = 0;
+      }
+
+      while (!_sessions.empty())
+        retire(_sessions.begin(), idleSessions);
+    }
+
+    for (auto &session : idleSessions)
+      session->disconnect();
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  void SSHSessionPool::setIdleTimeout(std::size_t seconds) {
+    base::MutexLock lock(_mutex);
+    _idleTimeout = seconds;
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  void SSHSessionPool::setKeepAliveInterval(std::size_t seconds) {
+    base::MutexLock lock(_mutex);
+    _keepAliveInterval = seconds;
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  void SSHSessionPool::startMaintenance() {
+    base::MutexLock lock(_mutex);
+    if (_maintenanceTask != 0)
+      return;
+
+    _maintenanceTask = ThreadedTimer::add_task(TimerTimeSpan, MAINTENANCE_INTERVAL, false, [this](int) {
+      maintain();
+      return false;
+    });
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  /**
+   * Called periodically: closes sessions which were unused for longer than the idle timeout or lost their connection
+   * and sends keep alive messages over the remaining ones.
+   */
+  void SSHSessionPool::maintain() {
+    std::vector<std::shared_ptr<SSHSession>> evicted;
+    std::vector<std::shared_ptr<SSHSession>> keepAlive;
+    {
+      base::MutexLock lock(_mutex);
+      std::int64_t current = now();
+      for (auto it = _sessions.begin(); it != _sessions.end();) {
+        Entry &entry = it->second;
+        bool idle = entry.leases == 0 && current - entry.lastUsed >= static_cast<std::int64_t>(_idleTimeout);
+        if (idle || !entry.session->isConnected()) {
+          logDebug("Evicting %s session for %s.\n", idle ? "idle" : "disconnected", it->first.c_str());
+          retire(it++, evicted);
+          ++_stats.evicted;
+          continue;
+        }
+
+        if (_keepAliveInterval > 0 && current - entry.lastKeepAlive >= static_cast<std::int64_t>(_keepAliveInterval)) {
+          entry.lastKeepAlive = current;
+          keepAlive.push_back(entry.session);
+        }
+        ++it;
+      }
+    }
+
+    // Network I/O happens outside of the pool lock.
+    for (auto &session : evicted)
+      session->disconnect();
+
+    for (auto &session : keepAlive) {
+      if (session->sendKeepAlive()) {
+        base::MutexLock lock(_mutex);
+        ++_stats.keepAlivesSent;
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  SSHSessionPoolStats SSHSessionPool::getStats() const {
+    base::MutexLock lock(_mutex);
+    SSHSessionPoolStats result = _stats;
+    std::int64_t current = now();
+    for (auto &it : _sessions) {
+      SSHPooledSessionInfo info;
+      info.key = it.first;
+      info.leases = it.second.leases;
+      info.channels = it.second.session->channelCount();
+      info.idleTime = it.second.leases == 0 ? current - it.second.lastUsed : 0;
+      result.sessions.push_back(info);
+    }
+    return result;
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+} /* namespace ssh */
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include "SSHCommon.h"
+#include "SSHSession.h"
+
+namespace ssh {
+
+  struct SSHPooledSessionInfo {
+    std::string key;       // user@host:port#credential digest
+    std::size_t leases;    // Number of users (tunnels, sftp/command wrappers) currently holding the session.
+    std::size_t channels;  // Number of channels currently open over the session.
+    std::int64_t idleTime; // Seconds since the session was released by its last user, 0 while leased.
+  };
+
+  struct SSHSessionPoolStats {
+    std::size_t created = 0;        // Sessions added to the pool after a full connect + authentication.
+    std::size_t reused = 0;         // Requests served by an already authenticated session.
+    std::size_t evicted = 0;        // Sessions closed because they were idle for too long or lost their connection.
+    std::size_t keepAlivesSent = 0;
+    std::vector<SSHPooledSessionInfo> sessions;
+  };
+
+  /**
+   * Keeps authenticated SSH sessions, keyed by user, host, port and credentials, so that tunnels, SFTP and remote commands
+   * to the same server multiplex their channels over a single session, instead of repeating key exchange and
+   * authentication for each of them.
+   *
+   * Users get a session via acquire() (or hand over a freshly connected one via add()) and must call release()
+   * when done. Released sessions are kept open (and alive) until they were idle for the configured time.
+   */
+  class WBSSHLIBRARY_PUBLIC_FUNC SSHSessionPool {
+  public:
+    static SSHSessionPool *get();
+
+    std::shared_ptr<SSHSession> acquire(const SSHConnectionConfig &config, const SSHConnectionCredentials &credentials);
+    void add(std::shared_ptr<SSHSession> session);
+    void release(std::shared_ptr<SSHSession> session);
+    bool isPooled(const std::shared_ptr<SSHSession> &session) const;
+    void evict(std::shared_ptr<SSHSession> session);
+    void clear();
+
+    void setIdleTimeout(std::size_t seconds);
+    void setKeepAliveInterval(std::size_t seconds);
+
+    void maintain();
+    SSHSessionPoolStats getStats() const;
+
+    static std::string keyFor(const SSHConnectionConfig &config, const SSHConnectionCredentials &credentials);
+
+  private:
+    struct Entry {
+      std::shared_ptr<SSHSession> session;
+      std::size_t leases;
+      std::int64_t lastUsed;
+      std::int64_t lastKeepAlive;
+    };
+
+    SSHSessionPool();
+    SSHSessionPool(const SSHSessionPool &) = delete;
+    SSHSessionPool &operator=(const SSHSessionPool &) = delete;
+
+    void startMaintenance();
+    void retire(std::map<std::string, Entry>::iterator entry, std::vector<std::shared_ptr<SSHSession>> &idle);
+
+    mutable base::Mutex _mutex;
+    std::map<std::string, Entry> _sessions;
+    std::map<std::shared_ptr<SSHSession>, std::size_t> _retired; // Sessions removed from the pool but still leased.
+    std::size_t _idleTimeout;
+    std::size_t _keepAliveInterval;
+    int _maintenanceTask;
+    SSHSessionPoolStats _stats;
+  };
+
+} /* namespace ssh */
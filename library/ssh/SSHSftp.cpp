@@ -54,6 +54,7 @@ namespace ssh {
     // check if first element isn't empty, if so we remove it
     if (_path.front().empty())
       _path.erase(_path.begin());
+    _session->channelOpened();
   }
 
   void SSHSftp::throwOnError(int rc) const {
@@ -151,6 +152,7 @@ namespace ssh {
   SSHSftp::~SSHSftp() {
     auto lock = _session->lockSession();
     sftp_free(_sftp);
+    _session->channelClosed();
   }
 
   sftp_file SSHSftp::open(const std::string &path) const {
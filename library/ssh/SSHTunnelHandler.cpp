@@ -21,7 +21,13 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#ifndef _MSC_VER
+#  include <sys/socket.h>
+#  include <netinet/in.h>
+#  include <arpa/inet.h>
+#endif
 #include "SSHTunnelHandler.h"
+#include "SSHSessionPool.h"
 
 #include "base/log.h"
 
@@ -37,21 +43,96 @@ DEFAULT_LOG_DOMAIN("SSHTunnelHandler")
 
 namespace ssh {
 
-  SSHTunnelHandler::SSHTunnelHandler(uint16_t localPort, int localSocket, std::shared_ptr<SSHSession> session)
-      : _session(std::move(session)), _localPort(localPort), _localSocket(localSocket), _pollTimeout(-1) {
-    _event = ssh_event_new();
-    ssh_event_add_session(_event, _session->getSession()->getCSession());
+  // Channel callbacks. They run in whatever thread processes the session's incoming packets, which can be a
+  // different user of a shared session. The data stays queued in the channel, we only wake up the handler.
+  static int channelDataReceived(ssh_session, ssh_channel, void *, uint32_t, int, void *userdata) {
+    static_cast<SSHTunnelHandler *>(userdata)->wakeUp();
+    return 0;
+  }
+
+  static void channelEofReceived(ssh_session, ssh_channel, void *userdata) {
+    static_cast<SSHTunnelHandler *>(userdata)->wakeUp();
+  }
+
+  static void channelCloseReceived(ssh_session, ssh_channel, void *userdata) {
+    static_cast<SSHTunnelHandler *>(userdata)->wakeUp();
+  }
+
+#if LIBSSH_VERSION_INT >= SSH_VERSION_INT(0, 8, 0)
+  static int channelWindowOpened(ssh_session, ssh_channel, uint32_t, void *userdata) {
+    static_cast<SSHTunnelHandler *>(userdata)->wakeUp();
+    return 0;
+  }
+#endif
+
+  SSHTunnelHandler::SSHTunnelHandler(uint16_t localPort, int localSocket, std::shared_ptr<SSHSession> session,
+                                     const SSHConnectionConfig &config)
+      : _session(std::move(session)), _config(config), _localPort(localPort), _localSocket(localSocket),
+        _wakeupSocket(-1), _wakeupPort(0), _wakeupPending(false) {
+    createWakeupSocket();
   }
 
   SSHTunnelHandler::~SSHTunnelHandler() {
     stop();
-    ssh_event_remove_session(_event, _session->getSession()->getCSession());
-    ssh_event_free(_event);
+    wbCloseSocket(_wakeupSocket);
     if (_session) {
-      _session->disconnect();
+      // The session may be shared with other tunnels or sftp/command users, so only give it back to the pool.
+      SSHSessionPool::get()->release(_session);
       _session.reset();
     }
+  }
+
+  void SSHTunnelHandler::stop() {
+    _stop = true;
+    wakeUp();
+    SSHThread::stop();
+  }
+
+  void SSHTunnelHandler::createWakeupSocket() {
+    errno = 0;
+    _wakeupSocket = static_cast<int>(socket(AF_INET, SOCK_DGRAM, 0));
+    if (_wakeupSocket == -1)
+      throw SSHTunnelException("unable to create wakeup socket: " + getError());
+
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    memset(&addr, 0, len);
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    addr.sin_port = htons(0);
+    if (bind(_wakeupSocket, (struct sockaddr *)&addr, len) == -1 ||
+        getsockname(_wakeupSocket, (struct sockaddr *)&addr, &len) == -1) {
+      wbCloseSocket(_wakeupSocket);
+      throw SSHTunnelException("unable to bind wakeup socket: " + getError());
+    }
+    _wakeupPort = ntohs(addr.sin_port);
 
+    setSocketNonBlocking(_wakeupSocket);
+  }
+
+  // Makes the poll in handleConnection() return. Can be called from any thread. Wake ups which arrive while one is
+  // still pending are merged, as the handler serves all connections after waking up anyway.
+  void SSHTunnelHandler::wakeUp() {
+    if (std::this_thread::get_id() == _handlerThread.load() || _wakeupPending.exchange(true))
+      return;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    addr.sin_port = htons(_wakeupPort);
+    char byte = 0;
+    if (sendto(_wakeupSocket, &byte, 1, 0, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+      _wakeupPending = false;
+      logError("Unable to wake up tunnel handler: %s\n", getError().c_str());
+    }
+  }
+
+  void SSHTunnelHandler::drainWakeupSocket() {
+    _wakeupPending = false;
+    char buffer[16];
+    while (recv(_wakeupSocket, buffer, sizeof(buffer), 0) > 0)
+      ;
   }
 
   int SSHTunnelHandler::getLocalSocket() const {
@@ -63,26 +144,21 @@ namespace ssh {
   }
 
   SSHConnectionConfig SSHTunnelHandler::getConfig() const {
-    return _session->getConfig();
+    return _config;
+  }
+
+  std::shared_ptr<SSHSession> SSHTunnelHandler::getSession() const {
+    return _session;
   }
 
   void SSHTunnelHandler::run() {
     handleConnection();
   }
 
-  // This is noop function so ssh_even_dopoll will exit once client socket will have new data
-
-    static int onSocketEvent(socket_t fd, int revents, void *userdata) {
-      //the return should be:
-      //  0 success
-      // -1 the internal ssh_poll_handle was removed/freed and should be removed from the context
-      // -2 an error happened and the ssh_event_dopoll() should stop
-      return 0;
-    }
-
   void SSHTunnelHandler::handleConnection() {
     logDebug3("Start tunnel handler thread.\n");
-    int rc = 0;
+    _handlerThread = std::this_thread::get_id();
+    std::vector<pollfd> pollList;
 
     do {
       std::unique_lock<std::recursive_mutex> lock(_newConnMtx);
@@ -91,57 +167,72 @@ namespace ssh {
         _newConnection.pop_back();
       }
       lock.unlock();
-      rc = ssh_event_dopoll(_event, 100);
 
-      if (rc == SSH_ERROR) {
-        logError("There was an error handling connection poll, retrying: %s\n", _session->getSession()->getError());
+      // Wait for the session socket or any client socket we can serve. This happens without holding the session lock,
+      // so other users of a shared session (sftp, remote commands, other tunnels) are not blocked meanwhile.
+      // New connections, stop requests and channel data which another user of the session received come in via the
+      // wakeup socket.
+      pollList.clear();
+      pollfd sessionFd;
+      sessionFd.fd = ssh_get_fd(_session->getSession()->getCSession());
+      sessionFd.events = POLLIN;
+      sessionFd.revents = 0;
+      pollList.push_back(sessionFd);
+      pollfd wakeupFd;
+      wakeupFd.fd = _wakeupSocket;
+      wakeupFd.events = POLLIN;
+      wakeupFd.revents = 0;
+      pollList.push_back(wakeupFd);
+      for (auto &it : _clientSocketList) {
+        if (it.second->events == 0)
+          continue;
+        pollfd clientFd;
+        clientFd.fd = it.first;
+        clientFd.events = it.second->events;
+        clientFd.revents = 0;
+        pollList.push_back(clientFd);
+      }
 
-        for (auto &sIt : _clientSocketList) {
-          ssh_event_remove_fd(_event, sIt.first);
-          sIt.second->close();
-          wbCloseSocket(sIt.first);
-          sIt.second.reset();
-        }
-        _clientSocketList.clear();
+      if (wbPoll(pollList.data(), pollList.size()) < 0 && !wbSocketWouldBlock())
+        logError("poll() error: %s.\n", getError().c_str());
 
-        ssh_event_remove_session(_event, _session->getSession()->getCSession());
-        ssh_event_free(_event);
+      if (pollList[1].revents != 0)
+        drainWakeupSocket();
+      if (_stop)
+        break;
 
-        if (!_session->isConnected())
-          _session->reconnect();
-        if (!_session->isConnected()) {
-          logError("Unable to reconnect session.\n");
-          break;
-        }
+      // Let libssh process what arrived on the session, even if none of our channels picks it up (e.g. keep alive
+      // replies), otherwise we would wake up again right away.
+      if (pollList.front().revents != 0)
+        _session->pollEvent();
 
-        _event = ssh_event_new();
-        ssh_event_add_session(_event, _session->getSession()->getCSession());
-        continue;
+      // The session may be used by others, so it is not reconnected here. Instead it's taken out of the pool and this
+      // tunnel ends. The tunnel manager then sees a dead tunnel and the next connection sets up a new one.
+      if (!_session->isConnected()) {
+        logError("SSH session lost its connection, closing tunnel: %s\n", _session->getSession()->getError());
+        SSHSessionPool::get()->evict(_session);
+        break;
       }
 
+      auto sessionLock = _session->lockSession();
       for (auto it = _clientSocketList.begin(); it != _clientSocketList.end() && !_stop;) {
         try {
-          transferDataFromClient(it->first, it->second.get());
-          transferDataToClient(it->first, it->second.get());
+          transferDataFromClient(it->first, *it->second);
+          transferDataToClient(it->first, *it->second);
+          updateSocketEvents(it->first, *it->second);
           ++it;
         } catch (SSHTunnelException &exc) {
-            ssh_event_remove_fd(_event, it->first);
-            it->second->close();
-            it->second.reset();
-            wbCloseSocket(it->first);
-            it = _clientSocketList.erase(it);
+          closeConnection(it->first, *it->second);
+          it = _clientSocketList.erase(it);
           logError("Error during data transfer: %s\n", exc.what());
         }
       }
 
     } while (!_stop);
 
-    for (auto &sIt : _clientSocketList) {
-      ssh_event_remove_fd(_event, sIt.first);
-      sIt.second->close();
-      wbCloseSocket(sIt.first);
-      sIt.second.reset();
-    }
+    auto sessionLock = _session->lockSession();
+    for (auto &sIt : _clientSocketList)
+      closeConnection(sIt.first, *sIt.second);
     _clientSocketList.clear();
     logDebug3("Tunnel handler thread stopped.\n");
   }
@@ -160,68 +251,141 @@ namespace ssh {
 
     setSocketNonBlocking(clientSock);
 
-    std::lock_guard<std::recursive_mutex> guard(_newConnMtx);
-    _newConnection.push_back(clientSock);
+    {
+      std::lock_guard<std::recursive_mutex> guard(_newConnMtx);
+      _newConnection.push_back(clientSock);
+    }
+    wakeUp();
     logDebug3("Accepted new connection.\n");
   }
 
-  void SSHTunnelHandler::transferDataFromClient(int sock, ssh::Channel *chan) {
-    ssize_t readlen = 0;
-    std::vector<char> buff(_session->getConfig().bufferSize, '\0');
+  // Reads from the client only as long as there is room in the connection buffer and passes the data on as far as the
+  // channel window allows. If the remote side stalls, the buffer fills up and we stop reading from the client, which
+  // in turn lets TCP flow control slow down the client (backpressure), instead of piling up data in memory.
+  void SSHTunnelHandler::transferDataFromClient(int sock, TunnelConnection &connection) {
+    TunnelBuffer &buffer = connection.toChannel;
+    bool progress = true;
+    while (!_stop && progress) {
+      progress = false;
+
+      std::size_t length = 0;
+      char *target = buffer.writePointer(length);
+      if (length > 0 && !connection.clientEof) {
+        ssize_t readlen = recv(sock, target, length, 0);
+        if (readlen > 0) {
+          buffer.commit(static_cast<std::size_t>(readlen));
+          progress = true;
+        } else if (readlen == 0)
+          connection.clientEof = true;
+        else if (!wbSocketWouldBlock())
+          throw SSHTunnelException("unable to read, client disconnected");
+      }
 
-    while (!_stop && (readlen = recv(sock, buff.data(), buff.size(), 0)) > 0) {
-      int bWritten = 0;
-      for (char* buffPtr = buff.data(); readlen > 0 && !_stop; buffPtr += bWritten, readlen -= bWritten) {
-        try {
-          bWritten = chan->write(buffPtr, readlen);
-          if (bWritten <= 0) {
+      const char *source = buffer.readPointer(length);
+      if (length > 0) {
+        uint32_t window = ssh_channel_window_size(connection.channel->getCChannel());
+        if (window > 0) {
+          int bWritten = 0;
+          try {
+            bWritten = connection.channel->write(source, std::min<std::size_t>(length, window));
+          } catch (SshException &exc) {
+            throw SSHTunnelException(exc.getError());
+          }
+          if (bWritten < 0)
             throw SSHTunnelException("unable to write, remote end disconnected");
+          if (bWritten > 0) {
+            buffer.consume(static_cast<std::size_t>(bWritten));
+            progress = true;
           }
-        } catch (SshException &exc) {
-          throw SSHTunnelException(exc.getError());
         }
       }
     }
+
+    if (connection.clientEof && buffer.empty() && connection.toClient.empty())
+      throw SSHTunnelException("client closed the connection");
   }
 
-  void SSHTunnelHandler::transferDataToClient(int sock, ssh::Channel *chan) {
-    ssize_t readlen = 0;
-    std::vector<char> buff(_session->getConfig().bufferSize, '\0');
-    do {
-      try {
-        readlen = chan->readNonblocking(buff.data(), buff.size());
-      } catch (SshException &exc) {
-        throw SSHTunnelException(exc.getError());
+  // Counterpart of transferDataFromClient: channel data is only read if the client buffer has room, which leaves
+  // unread data in the channel and so lets the SSH window throttle the remote end while the client is slow.
+  void SSHTunnelHandler::transferDataToClient(int sock, TunnelConnection &connection) {
+    TunnelBuffer &buffer = connection.toClient;
+    bool progress = true;
+    while (!_stop && progress) {
+      progress = false;
+
+      std::size_t length = 0;
+      const char *source = buffer.readPointer(length);
+      if (length > 0) {
+        ssize_t bWritten = send(sock, source, length, MSG_NOSIGNAL);
+        if (bWritten > 0) {
+          buffer.consume(static_cast<std::size_t>(bWritten));
+          progress = true;
+        } else if (bWritten == 0 || !wbSocketWouldBlock())
+          throw SSHTunnelException("unable to write, client disconnected");
       }
 
-      if (readlen < 0 && readlen != SSH_AGAIN)
-        throw SSHTunnelException("unable to read, remote end disconnected");
+      char *target = buffer.writePointer(length);
+      if (length > 0) {
+        int readlen = 0;
+        try {
+          readlen = connection.channel->readNonblocking(target, length);
+        } catch (SshException &exc) {
+          throw SSHTunnelException(exc.getError());
+        }
 
-      if (readlen == 0) {
-        if (chan->isClosed())
-          throw SSHTunnelException("channel is closed");
-        break;
-      }
+        if (readlen < 0 && readlen != SSH_AGAIN)
+          throw SSHTunnelException("unable to read, remote end disconnected");
 
-      ssize_t bWritten = 0;
-      for (char* buffPtr = buff.data(); readlen > 0 && !_stop; buffPtr += bWritten, readlen -= bWritten) {
-        bWritten = send(sock, buffPtr, readlen, MSG_NOSIGNAL);
-        if (bWritten <= 0)
-          throw SSHTunnelException("unable to write, client disconnected");
+        if (readlen > 0) {
+          buffer.commit(static_cast<std::size_t>(readlen));
+          progress = true;
+        }
       }
-    } while (!_stop && true);
+    }
+
+    if (buffer.empty() && connection.channel->isClosed())
+      throw SSHTunnelException("channel is closed");
+  }
+
+  // Determines the poll events we can act on: no POLLIN while the client buffer is full (or the client is done
+  // sending) and POLLOUT only while there is data waiting for the client. This way the poll loop sleeps until there
+  // is actual work instead of spinning on a socket we can't serve at the moment.
+  void SSHTunnelHandler::updateSocketEvents(int sock, TunnelConnection &connection) {
+    short events = 0;
+    if (!connection.toChannel.full() && !connection.clientEof)
+      events |= POLLIN;
+    if (!connection.toClient.empty())
+      events |= POLLOUT;
+    connection.events = events;
+  }
+
+  // Must be called with the session locked.
+  void SSHTunnelHandler::closeConnection(int sock, TunnelConnection &connection) {
+    connection.events = 0;
+    connection.channel->close();
+    connection.channel.reset();
+    _session->channelClosed();
+    wbCloseSocket(sock);
   }
 
   std::unique_ptr<ssh::Channel> SSHTunnelHandler::openTunnel() {
-    std::unique_ptr<ssh::Channel> channel(new ssh::Channel(*(_session->getSession())));
-    ssh_channel_set_blocking(channel->getCChannel(), false);
+    std::unique_ptr<ssh::Channel> channel;
+    {
+      auto sessionLock = _session->lockSession();
+      channel.reset(new ssh::Channel(*(_session->getSession())));
+      ssh_channel_set_blocking(channel->getCChannel(), false);
+    }
 
     int rc = SSH_ERROR;
     std::size_t i = 0;
 
-    while ((_session->getConfig().connectTimeout * 1000 - (i * 100))  > 0) {
-      rc = channel->openForward(_session->getConfig().remotehost.c_str(), _session->getConfig().remoteport,
-                              _session->getConfig().localhost.c_str(), _session->getConfig().localport);
+    while ((_config.connectTimeout * 1000 - (i * 100))  > 0) {
+      {
+        // Lock per attempt only, we don't want to block other users of the session while waiting.
+        auto sessionLock = _session->lockSession();
+        rc = channel->openForward(_config.remotehost.c_str(), _config.remoteport, _config.localhost.c_str(),
+                                  _config.localport);
+      }
       if (rc == SSH_AGAIN) {
         logDebug3("Unable to open channel, wait a moment and retry.\n");
         i++;
@@ -233,8 +397,11 @@ namespace ssh {
     }
 
     // If we're here and it's still not ok, we throw exception as we can't open the channel.
-    if (rc != SSH_OK)
+    if (rc != SSH_OK) {
+      auto sessionLock = _session->lockSession();
+      channel.reset();
       throw SSHTunnelException("Unable to open channel");
+    }
 
     return channel;
   }
@@ -253,17 +420,27 @@ namespace ssh {
       return;
     }
 
-    short events = POLLIN;
-    if (ssh_event_add_fd(_event, clientSocket, events, onSocketEvent, this) != SSH_OK) {
-      logError("Unable to open tunnel. Could not register event handler.\n");
-      channel.reset();
-      wbCloseSocket(clientSocket);
-      return;
-    } else {
-      logDebug("Tunnel created.\n");
+    // Buffers are allocated once here and reused for the whole lifetime of the connection.
+    std::unique_ptr<TunnelConnection> connection(
+      new TunnelConnection(std::move(channel), static_cast<std::size_t>(_config.bufferSize)));
+    connection->events = POLLIN;
+
+    ssh_callbacks_init(&connection->callbacks);
+    connection->callbacks.userdata = this;
+    connection->callbacks.channel_data_function = channelDataReceived;
+    connection->callbacks.channel_eof_function = channelEofReceived;
+    connection->callbacks.channel_close_function = channelCloseReceived;
+#if LIBSSH_VERSION_INT >= SSH_VERSION_INT(0, 8, 0)
+    connection->callbacks.channel_write_wontblock_function = channelWindowOpened;
+#endif
+    {
+      auto sessionLock = _session->lockSession();
+      ssh_set_channel_callbacks(connection->channel->getCChannel(), &connection->callbacks);
     }
+    _session->channelOpened();
+    logDebug("Tunnel created.\n");
 
-    _clientSocketList.insert(std::make_pair(clientSocket, std::move(channel)));
+    _clientSocketList.insert(std::make_pair(clientSocket, std::move(connection)));
     return;
   }
 
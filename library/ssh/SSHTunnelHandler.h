@@ -28,6 +28,7 @@
 #include <poll.h>
 #endif
 #include <string.h>
+#include <algorithm>
 #include <thread>
 #include <map>
 #include <mutex>
@@ -36,31 +37,117 @@
 #include "SSHSession.h"
 
 namespace ssh {
+
+  // A fixed size FIFO byte buffer, used to move data between a client socket and its SSH channel.
+  // Memory is allocated once when the connection is set up. Socket and channel I/O work directly on that memory
+  // (writePointer/commit and readPointer/consume), so no data is copied or allocated while forwarding.
+  class TunnelBuffer {
+  public:
+    explicit TunnelBuffer(std::size_t capacity) : _data(capacity > 0 ? capacity : 1), _start(0), _size(0) {
+    }
+
+    std::size_t size() const {
+      return _size;
+    }
+
+    std::size_t capacity() const {
+      return _data.size();
+    }
+
+    bool empty() const {
+      return _size == 0;
+    }
+
+    bool full() const {
+      return _size == _data.size();
+    }
+
+    // Returns the contiguous free space after the stored data. This can be less than the total free space
+    // if the free space wraps around the buffer end.
+    char *writePointer(std::size_t &length) {
+      std::size_t end = (_start + _size) % _data.size();
+      if (full())
+        length = 0;
+      else if (end >= _start)
+        length = _data.size() - end;
+      else
+        length = _start - end;
+      return _data.data() + end;
+    }
+
+    void commit(std::size_t length) {
+      _size += length;
+    }
+
+    // Returns the contiguous stored data, starting with the oldest byte.
+    const char *readPointer(std::size_t &length) const {
+      length = std::min(_size, _data.size() - _start);
+      return _data.data() + _start;
+    }
+
+    void consume(std::size_t length) {
+      _size -= length;
+      _start = (_size == 0) ? 0 : (_start + length) % _data.size();
+    }
+
+  private:
+    std::vector<char> _data;
+    std::size_t _start;
+    std::size_t _size;
+  };
+
+  // State of a single forwarded client connection.
+  struct TunnelConnection {
+    std::unique_ptr<ssh::Channel> channel;
+    TunnelBuffer toChannel; // Data received from the client, not yet accepted by the channel.
+    TunnelBuffer toClient;  // Data read from the channel, not yet accepted by the client socket.
+    short events;           // The poll events we currently wait for on the client socket.
+    bool clientEof;
+    ssh_channel_callbacks_struct callbacks; // Wake the handler when another thread received data for the channel.
+
+    TunnelConnection(std::unique_ptr<ssh::Channel> chan, std::size_t bufferSize)
+      : channel(std::move(chan)), toChannel(bufferSize), toClient(bufferSize), events(0), clientEof(false) {
+      memset(&callbacks, 0, sizeof(callbacks));
+    }
+  };
+
   class WBSSHLIBRARY_PUBLIC_FUNC SSHTunnelHandler : public SSHThread {
   public:
-    SSHTunnelHandler(uint16_t localPort, int localSocket, std::shared_ptr<ssh::SSHSession> session);
+    SSHTunnelHandler(uint16_t localPort, int localSocket, std::shared_ptr<ssh::SSHSession> session,
+                     const SSHConnectionConfig &config);
     ~SSHTunnelHandler();
     int getLocalSocket() const;
     int getLocalPort() const;
     SSHConnectionConfig getConfig() const;
+    std::shared_ptr<SSHSession> getSession() const;
 
     void handleConnection();
     void handleNewConnection(int incomingSocket);
-    void transferDataFromClient(int sock, ssh::Channel *chan);
-    void transferDataToClient(int sock, ssh::Channel *chan);
+    void transferDataFromClient(int sock, TunnelConnection &connection);
+    void transferDataToClient(int sock, TunnelConnection &connection);
 
     std::unique_ptr<ssh::Channel> openTunnel();
     void prepareTunnel(int clientSocket);
 
+    void wakeUp();
+    virtual void stop() override;
+
   protected:
     virtual void run() override;
+    void createWakeupSocket();
+    void drainWakeupSocket();
+    void updateSocketEvents(int sock, TunnelConnection &connection);
+    void closeConnection(int sock, TunnelConnection &connection);
 
     std::shared_ptr<SSHSession> _session;
+    SSHConnectionConfig _config;
     uint16_t _localPort;
     int _localSocket;
-    std::map<int, std::unique_ptr<ssh::Channel>> _clientSocketList;
-    int _pollTimeout;
-    ssh_event _event;
+    std::map<int, std::unique_ptr<TunnelConnection>> _clientSocketList;
+    int _wakeupSocket;       // Datagram socket, which wakes up the poll in handleConnection() when it receives data.
+    uint16_t _wakeupPort;
+    std::atomic<bool> _wakeupPending;
+    std::atomic<std::thread::id> _handlerThread;
     std::vector<int> _sockRemovalList;
     std::recursive_mutex _newConnMtx;
     std::vector<int> _newConnection;
@@ -35,6 +35,7 @@
 #include <vector>
 #include "base/log.h"
 #include "SSHTunnelManager.h"
+#include "SSHSessionPool.h"
 
 DEFAULT_LOG_DOMAIN("SSHTunnelManager")
 namespace ssh {
@@ -125,18 +126,30 @@ namespace ssh {
   }
 
   std::tuple<SSHReturnType, base::any> SSHTunnelManager::createTunnel(std::shared_ptr<SSHSession> &session) {
+    return createTunnel(session, session->getConfig());
+  }
+
+  /**
+   * Creates a tunnel to the target given in config, using the given session. The session might be shared with other
+   * tunnels to different targets (see SSHSessionPool), that's why the target doesn't come from the session config.
+   */
+  std::tuple<SSHReturnType, base::any> SSHTunnelManager::createTunnel(std::shared_ptr<SSHSession> &session,
+                                                                      const SSHConnectionConfig &config) {
     logDebug3("About to create ssh tunnel.\n");
     auto sockLock = lockSocketList();
     for (auto &it : _socketList) {
-      if (it.second->getConfig() == session->getConfig()) {
+      if (it.second->getConfig() == config) {
         logDebug3("Found existing ssh tunnel.\n");
+        // The caller's hold on the session is not needed for this tunnel.
+        if (it.second->getSession() != session || SSHSessionPool::get()->isPooled(session))
+          SSHSessionPool::get()->release(session);
         return std::make_tuple(SSHReturnType::CONNECTED, it.second->getLocalPort());
       }
     }
 
     auto ret = createSocket();
     logDebug2("Tunnel port created on socket: %d\n", ret.port);
-    std::unique_ptr<SSHTunnelHandler> handler(new SSHTunnelHandler(ret.port, ret.socketHandle, session));
+    std::unique_ptr<SSHTunnelHandler> handler(new SSHTunnelHandler(ret.port, ret.socketHandle, session, config));
     handler->start();
     _socketList.insert(std::make_pair(ret.socketHandle, std::move(handler)));
     pokeWakeupSocket();  // If we're connected, we should notify manager that it shoud reload connection list.
@@ -43,6 +43,8 @@ namespace ssh {
   public:
     SSHTunnelManager();
     std::tuple<SSHReturnType, base::any> createTunnel(std::shared_ptr<SSHSession> &session);
+    std::tuple<SSHReturnType, base::any> createTunnel(std::shared_ptr<SSHSession> &session,
+                                                      const SSHConnectionConfig &config);
     int lookupTunnel(const SSHConnectionConfig &config);
     virtual ~SSHTunnelManager();
     void pokeWakeupSocket();
@@ -21,6 +21,17 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
  */
 
+#include <atomic>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SPLITTER_USE_SSE2
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
 #include "base/string_utilities.h"
 #include "base/util_functions.h"
 #include "base/log.h"
@@ -130,6 +141,27 @@ struct MySQLParserContextImpl : public MySQLParserContext {
     parser.addErrorListener(&parserErrorListener);
   }
 
+  /**
+   * Creates a context with the same lexer and parser settings as the given one, e.g. to parse in parallel.
+   */
+  MySQLParserContextImpl(const MySQLParserContextImpl &other)
+    : lexer(&input), tokens(&lexer), parser(&tokens), lexerErrorListener(this), parserErrorListener(this),
+      version(other.version), mode(other.mode), caseSensitive(other.caseSensitive) {
+
+    lexer.charsets = other.lexer.charsets;
+    lexer.serverVersion = other.lexer.serverVersion;
+    parser.serverVersion = other.parser.serverVersion;
+    lexer.sqlMode = other.lexer.sqlMode;
+    parser.sqlMode = other.parser.sqlMode;
+
+    lexer.removeErrorListeners();
+    lexer.addErrorListener(&lexerErrorListener);
+
+    parser.removeParseListeners();
+    parser.removeErrorListeners();
+    parser.addErrorListener(&parserErrorListener);
+  }
+
   virtual bool isCaseSensitive() override {
     return caseSensitive;
   }
@@ -224,7 +256,7 @@ struct MySQLParserContextImpl : public MySQLParserContext {
 
   std::vector<std::pair<int, std::string>> getCodeCompletionCandidates(
     std::pair<size_t, size_t> caret, std::string const &sql, std::string const &defaultSchema, bool uppercaseKeywords,
-    parsers::SymbolTable &symbolTable) {
+    parsers::SymbolTable &symbolTable, std::string const &typedPart) {
 
     parser.reset();
     errors.clear();
@@ -232,7 +264,8 @@ struct MySQLParserContextImpl : public MySQLParserContext {
     input.load(sql);
     lexer.setInputStream(&input);
     tokens.setTokenSource(&lexer);
-    return getCodeCompletionList(caret.second, caret.first, defaultSchema, uppercaseKeywords, &parser, symbolTable);
+    return getCodeCompletionList(caret.second, caret.first, defaultSchema, uppercaseKeywords, &parser, symbolTable,
+                                 typedPart);
   }
 
 private:
@@ -1396,6 +1429,117 @@ size_t MySQLParserServicesImpl::parseSQLIntoCatalogSql(parser_ContextReferenceRe
 
 //----------------------------------------------------------------------------------------------------------------------
 
+// Statement types which are handled by parseSQLIntoCatalog. Everything else is not even parsed.
+static const std::set<MySQLQueryType> relevantCatalogQueryTypes = {
+  QtAlterDatabase,
+  QtAlterLogFileGroup,
+  QtAlterFunction,
+  QtAlterProcedure,
+  QtAlterServer,
+  QtAlterTable,
+  QtAlterTableSpace,
+  QtAlterEvent,
+  QtAlterView,
+
+  QtCreateTable,
+  QtCreateIndex,
+  QtCreateDatabase,
+  QtCreateEvent,
+  QtCreateView,
+  QtCreateRoutine,
+  QtCreateProcedure,
+  QtCreateFunction,
+  QtCreateUdf,
+  QtCreateTrigger,
+  QtCreateLogFileGroup,
+  QtCreateServer,
+  QtCreateTableSpace,
+
+  QtDropDatabase,
+  QtDropEvent,
+  QtDropFunction,
+  QtDropProcedure,
+  QtDropIndex,
+  QtDropLogfileGroup,
+  QtDropServer,
+  QtDropTable,
+  QtDropTablespace,
+  QtDropTrigger,
+  QtDropView,
+
+  QtRenameTable,
+
+  QtUse
+};
+
+// Scripts with less statements than this are parsed on the calling thread only.
+static const size_t MIN_PARALLEL_STATEMENTS = 100;
+
+// Number of statements parsed in parallel before they are applied to the catalog. Each needs its own parser context
+// while the batch is alive, so this limits the memory used for parse trees.
+static const size_t PARSE_BATCH_SIZE = 256;
+
+/**
+ * The result of the first (parallel) phase when parsing a script into a catalog. The tree is owned by the parser
+ * context which produced it and stays valid until that context is used for the next statement.
+ */
+struct ParsedStatement {
+  size_t rangeIndex = 0;
+  std::string query;
+  MySQLQueryType type = QtUnknown;
+  ParseTree *tree = nullptr;
+  std::vector<ParserErrorInfo> errors;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void parseStatement(MySQLParserContextImpl *context, const std::string &sql, const StatementRange &range,
+                           ParsedStatement &statement) {
+  statement.query.assign(sql.c_str() + range.start, range.length);
+  statement.tree = nullptr;
+  statement.errors.clear();
+
+  try {
+    statement.type = context->determineQueryType(statement.query);
+    if (relevantCatalogQueryTypes.count(statement.type) == 0)
+      return; // Something we are not interested in. Don't bother parsing it.
+
+    statement.tree = context->parse(statement.query, MySQLParseUnit::PuGeneric);
+    statement.errors = context->errors;
+  } catch (std::exception &e) {
+    statement.tree = nullptr;
+    statement.errors.push_back({ e.what(), 0, 0, 0, 0, 1 });
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Phase one of parseSQLIntoCatalog: parses the statements in [first, first + statements.size()) of the given ranges,
+ * using one parser context per statement. With more than one thread the statements are distributed over the threads,
+ * which share ANTLR's DFA cache (which is thread safe) but nothing else.
+ */
+static void parseStatementBatch(std::vector<std::unique_ptr<MySQLParserContextImpl>> &contexts,
+                                const std::string &sql, const std::vector<StatementRange> &ranges, size_t first,
+                                std::vector<ParsedStatement> &statements, size_t threadCount) {
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t i = next++; i < statements.size(); i = next++) {
+      statements[i].rangeIndex = first + i;
+      parseStatement(contexts[i].get(), sql, ranges[first + i], statements[i]);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < std::min(threadCount, statements.size()); ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (auto &thread : threads)
+    thread.join();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 /**
 *	Expects the sql to be a single or multi-statement text in utf-8 encoding which is parsed and
 *	the details are used to build a grt tree. Existing objects are replaced unless the SQL has
@@ -1406,54 +1550,16 @@ size_t MySQLParserServicesImpl::parseSQLIntoCatalogSql(parser_ContextReferenceRe
 *  This is determined by the case_sensitive() function of the given context. All other objects
 *  are searched for case-insensitively.
 *
+*  Larger scripts are processed in two phases: batches of statements are parsed in parallel (each on its own parser
+*  context), then the results are applied to the catalog in script order. The option "parse_threads" limits the
+*  number of threads (0 = number of processors, 1 = parse on the calling thread only).
+*
 *	@result Returns the number of errors found during parsing.
 */
 size_t MySQLParserServicesImpl::parseSQLIntoCatalog(MySQLParserContext::Ref context, db_mysql_CatalogRef catalog,
                                                     const std::string &sql, grt::DictRef options) {
   MySQLParserContextImpl *impl = dynamic_cast<MySQLParserContextImpl *>(context.get());
 
-  static std::set<MySQLQueryType> relevantQueryTypes = {
-    QtAlterDatabase,
-    QtAlterLogFileGroup,
-    QtAlterFunction,
-    QtAlterProcedure,
-    QtAlterServer,
-    QtAlterTable,
-    QtAlterTableSpace,
-    QtAlterEvent,
-    QtAlterView,
-
-    QtCreateTable,
-    QtCreateIndex,
-    QtCreateDatabase,
-    QtCreateEvent,
-    QtCreateView,
-    QtCreateRoutine,
-    QtCreateProcedure,
-    QtCreateFunction,
-    QtCreateUdf,
-    QtCreateTrigger,
-    QtCreateLogFileGroup,
-    QtCreateServer,
-    QtCreateTableSpace,
-
-    QtDropDatabase,
-    QtDropEvent,
-    QtDropFunction,
-    QtDropProcedure,
-    QtDropIndex,
-    QtDropLogfileGroup,
-    QtDropServer,
-    QtDropTable,
-    QtDropTablespace,
-    QtDropTrigger,
-    QtDropView,
-
-    QtRenameTable,
-
-    QtUse
-  };
-
   logDebug2("Parse sql into catalog\n");
 
   bool caseSensitive = impl->caseSensitive;
@@ -1492,547 +1598,576 @@ size_t MySQLParserServicesImpl::parseSQLIntoCatalog(MySQLParserContext::Ref cont
   // Collect textual FK references into a local cache. At the end this is used
   // to find actual ref tables + columns, when all tables have been parsed.
   DbObjectsRefsCache refCache;
-  for (auto &range : ranges) {
-    std::string query(sql.c_str() + range.start, range.length);
-    MySQLQueryType queryType = impl->determineQueryType(query);
-
-    if (relevantQueryTypes.count(queryType) == 0)
-      continue; // Something we are not interested in. Don't bother parsing it.
-
-    auto tree = impl->parse(query, MySQLParseUnit::PuGeneric);
-    if (!impl->errors.empty()) {
-      errorCount += impl->errors.size();
-      if (errors.is_valid()) {
-        for (auto &error : impl->errors)
-          errors.insert("(" + std::to_string(range.line) + ", " + std::to_string(error.offset) + ") "
-                        + error.message);
-      }
-      continue;
+
+  size_t threadCount = (size_t)options.get_int("parse_threads", 0);
+  if (threadCount == 0)
+    threadCount = std::max(1U, std::thread::hardware_concurrency());
+  if (ranges.size() < MIN_PARALLEL_STATEMENTS)
+    threadCount = 1;
+
+  // Parser contexts for phase one. For a single thread we parse one statement at a time with the given context,
+  // which is exactly the classic parse-and-apply loop.
+  std::vector<std::unique_ptr<MySQLParserContextImpl>> contexts;
+  size_t batchSize = 1;
+  if (threadCount > 1) {
+    batchSize = std::min(PARSE_BATCH_SIZE, ranges.size());
+    for (size_t i = 0; i < batchSize; ++i)
+      contexts.emplace_back(new MySQLParserContextImpl(*impl));
+    logDebug2("Parsing %lu statements with %lu threads\n", (unsigned long)ranges.size(), (unsigned long)threadCount);
+  }
+
+  std::vector<ParsedStatement> batch;
+  for (size_t batchStart = 0; batchStart < ranges.size(); batchStart += batchSize) {
+    batch.resize(std::min(batchSize, ranges.size() - batchStart));
+    if (threadCount > 1)
+      parseStatementBatch(contexts, sql, ranges, batchStart, batch, threadCount);
+    else {
+      batch[0].rangeIndex = batchStart;
+      parseStatement(impl, sql, ranges[batchStart], batch[0]);
     }
 
-    auto statementContext = dynamic_cast<MySQLParser::QueryContext *>(tree)->simpleStatement();
-    switch (queryType) {
-      case QtCreateDatabase: {
-        db_mysql_SchemaRef schema(grt::Initialized);
-        schema->createDate(base::fmttime(0, DATETIME_FMT));
-        schema->lastChangeDate(schema->createDate());
-        schema->owner(catalog);
-
-        SchemaListener listener(statementContext, catalog, schema, impl->caseSensitive);
-        schema->oldName(schema->name());
-
-        db_SchemaRef existing = find_named_object_in_list(catalog->schemata(), schema->name(), caseSensitive);
-        if (existing.is_valid()) {
-          if (!listener.ignoreIfExists) {
-            catalog->schemata()->remove(existing);
-            createdObjects.remove_value(existing);
+    // Phase two: apply the parsed statements to the catalog, in script order.
+    for (auto &statement : batch) {
+      if (statement.tree == nullptr && statement.errors.empty())
+        continue; // Not relevant for the catalog.
+
+      const StatementRange &range = ranges[statement.rangeIndex];
+      const std::string &query = statement.query;
+      MySQLQueryType queryType = statement.type;
+      if (!statement.errors.empty()) {
+        errorCount += statement.errors.size();
+        if (errors.is_valid()) {
+          for (auto &error : statement.errors)
+            errors.insert("(" + std::to_string(range.line) + ", " + std::to_string(error.offset) + ") "
+                          + error.message);
+        }
+        continue;
+      }
 
+      auto statementContext = dynamic_cast<MySQLParser::QueryContext *>(statement.tree)->simpleStatement();
+      switch (queryType) {
+        case QtCreateDatabase: {
+          db_mysql_SchemaRef schema(grt::Initialized);
+          schema->createDate(base::fmttime(0, DATETIME_FMT));
+          schema->lastChangeDate(schema->createDate());
+          schema->owner(catalog);
+
+          SchemaListener listener(statementContext, catalog, schema, impl->caseSensitive);
+          schema->oldName(schema->name());
+
+          db_SchemaRef existing = find_named_object_in_list(catalog->schemata(), schema->name(), caseSensitive);
+          if (existing.is_valid()) {
+            if (!listener.ignoreIfExists) {
+              catalog->schemata()->remove(existing);
+              createdObjects.remove_value(existing);
+
+              catalog->schemata().insert(schema);
+              createdObjects.insert(schema);
+            }
+          } else {
             catalog->schemata().insert(schema);
             createdObjects.insert(schema);
           }
-        } else {
-          catalog->schemata().insert(schema);
-          createdObjects.insert(schema);
-        }
 
-        break;
-      }
-
-      case QtUse: {
-        std::string schemaName =
-          base::unquote(statementContext->utilityStatement()->useCommand()->identifier()->getText());
-        currentSchema = ObjectListener::ensureSchemaExists(catalog, schemaName, caseSensitive);
-        break;
-      }
+          break;
+        }
 
-      case QtCreateTable: {
-        db_mysql_TableRef table(grt::Initialized);
-        table->createDate(base::fmttime(0, DATETIME_FMT));
-        table->lastChangeDate(table->createDate());
-        table->owner(currentSchema);
-
-        TableListener listener(statementContext, catalog, currentSchema, table, caseSensitive, autoGenerateFkNames,
-                               refCache);
-        table->oldName(table->name());
-
-        db_mysql_SchemaRef schema =
-          db_mysql_SchemaRef::cast_from(table->owner()); // Might be different from current schema.
-
-        // Ignore tables that use a name that is already used for a view (no drop/new-add takes place then).
-        db_mysql_ViewRef existingView = find_named_object_in_list(schema->views(), table->name());
-        if (!existingView.is_valid()) {
-          db_TableRef existingTable = find_named_object_in_list(schema->tables(), table->name());
-          if (existingTable.is_valid()) {
-            // Ignore if the table exists already?
-            if (!listener.ignoreIfExists) {
-              schema->tables()->remove(existingTable);
-              createdObjects.remove_value(existingTable);
+        case QtUse: {
+          std::string schemaName =
+            base::unquote(statementContext->utilityStatement()->useCommand()->identifier()->getText());
+          currentSchema = ObjectListener::ensureSchemaExists(catalog, schemaName, caseSensitive);
+          break;
+        }
 
+        case QtCreateTable: {
+          db_mysql_TableRef table(grt::Initialized);
+          table->createDate(base::fmttime(0, DATETIME_FMT));
+          table->lastChangeDate(table->createDate());
+          table->owner(currentSchema);
+
+          TableListener listener(statementContext, catalog, currentSchema, table, caseSensitive, autoGenerateFkNames,
+                                 refCache);
+          table->oldName(table->name());
+
+          db_mysql_SchemaRef schema =
+            db_mysql_SchemaRef::cast_from(table->owner()); // Might be different from current schema.
+
+          // Ignore tables that use a name that is already used for a view (no drop/new-add takes place then).
+          db_mysql_ViewRef existingView = find_named_object_in_list(schema->views(), table->name());
+          if (!existingView.is_valid()) {
+            db_TableRef existingTable = find_named_object_in_list(schema->tables(), table->name());
+            if (existingTable.is_valid()) {
+              // Ignore if the table exists already?
+              if (!listener.ignoreIfExists) {
+                schema->tables()->remove(existingTable);
+                createdObjects.remove_value(existingTable);
+
+                schema->tables().insert(table);
+                createdObjects.insert(table);
+              }
+            } else {
               schema->tables().insert(table);
               createdObjects.insert(table);
             }
-          } else {
-            schema->tables().insert(table);
-            createdObjects.insert(table);
           }
-        }
 
-        break;
-      }
+          break;
+        }
 
-      case QtCreateIndex: {
-        db_mysql_IndexRef index(grt::Initialized);
-        index->createDate(base::fmttime(0, DATETIME_FMT));
-        index->lastChangeDate(index->createDate());
+        case QtCreateIndex: {
+          db_mysql_IndexRef index(grt::Initialized);
+          index->createDate(base::fmttime(0, DATETIME_FMT));
+          index->lastChangeDate(index->createDate());
 
-        IndexListener listener(statementContext, catalog, currentSchema, index, impl->caseSensitive, refCache);
-        index->oldName(index->name());
+          IndexListener listener(statementContext, catalog, currentSchema, index, impl->caseSensitive, refCache);
+          index->oldName(index->name());
 
-        db_TableRef table = db_TableRef::cast_from(index->owner());
-        if (table.is_valid()) {
-          db_IndexRef existing = find_named_object_in_list(table->indices(), index->name());
-          if (existing.is_valid()) {
-            table->indices()->remove(existing);
-            createdObjects.remove_value(existing);
+          db_TableRef table = db_TableRef::cast_from(index->owner());
+          if (table.is_valid()) {
+            db_IndexRef existing = find_named_object_in_list(table->indices(), index->name());
+            if (existing.is_valid()) {
+              table->indices()->remove(existing);
+              createdObjects.remove_value(existing);
+            }
+            table->indices().insert(index);
+            createdObjects.insert(index);
           }
-          table->indices().insert(index);
-          createdObjects.insert(index);
+
+          break;
         }
 
-        break;
-      }
+        case QtCreateEvent: {
+          db_mysql_EventRef event(grt::Initialized);
+          event->sqlDefinition(base::trim(query));
+          event->createDate(base::fmttime(0, DATETIME_FMT));
+          event->lastChangeDate(event->createDate());
+          event->owner(currentSchema);
 
-      case QtCreateEvent: {
-        db_mysql_EventRef event(grt::Initialized);
-        event->sqlDefinition(base::trim(query));
-        event->createDate(base::fmttime(0, DATETIME_FMT));
-        event->lastChangeDate(event->createDate());
-        event->owner(currentSchema);
-
-        EventListener listener(statementContext, catalog, event, impl->caseSensitive);
-        event->oldName(event->name());
-
-        db_mysql_SchemaRef schema =
-          db_mysql_SchemaRef::cast_from(event->owner()); // Might be different from current schema.
-        db_EventRef existing = find_named_object_in_list(schema->events(), event->name());
-        if (existing.is_valid()) {
-          if (!listener.ignoreIfExists) // Ignore if exists?
-          {
-            schema->events()->remove(existing);
-            createdObjects.remove_value(existing);
+          EventListener listener(statementContext, catalog, event, impl->caseSensitive);
+          event->oldName(event->name());
+
+          db_mysql_SchemaRef schema =
+            db_mysql_SchemaRef::cast_from(event->owner()); // Might be different from current schema.
+          db_EventRef existing = find_named_object_in_list(schema->events(), event->name());
+          if (existing.is_valid()) {
+            if (!listener.ignoreIfExists) // Ignore if exists?
+            {
+              schema->events()->remove(existing);
+              createdObjects.remove_value(existing);
 
+              schema->events().insert(event);
+              createdObjects.insert(event);
+            }
+          } else {
             schema->events().insert(event);
             createdObjects.insert(event);
           }
-        } else {
-          schema->events().insert(event);
-          createdObjects.insert(event);
-        }
 
-        break;
-      }
+          break;
+        }
 
-      case QtCreateView: {
-        db_mysql_ViewRef view(grt::Initialized);
-        view->sqlDefinition(base::trim(base::trim(query)));
-        view->createDate(base::fmttime(0, DATETIME_FMT));
-        view->lastChangeDate(view->createDate());
-        view->owner(currentSchema);
-
-        ViewListener listener(statementContext, catalog, view, caseSensitive);
-        view->oldName(view->name());
-
-        db_mysql_SchemaRef schema =
-          db_mysql_SchemaRef::cast_from(view->owner()); // Might be different from current schema.
-
-        // Ignore views that use a name that is already used for a table (no drop/new-add takes place then).
-        db_mysql_TableRef existingTable = find_named_object_in_list(schema->tables(), view->name());
-        if (!existingTable.is_valid()) {
-          db_mysql_ViewRef existingView = find_named_object_in_list(schema->views(), view->name());
-          if (existingView.is_valid()) {
-            schema->views()->remove(existingView);
-            createdObjects.remove_value(existingView);
+        case QtCreateView: {
+          db_mysql_ViewRef view(grt::Initialized);
+          view->sqlDefinition(base::trim(base::trim(query)));
+          view->createDate(base::fmttime(0, DATETIME_FMT));
+          view->lastChangeDate(view->createDate());
+          view->owner(currentSchema);
+
+          ViewListener listener(statementContext, catalog, view, caseSensitive);
+          view->oldName(view->name());
+
+          db_mysql_SchemaRef schema =
+            db_mysql_SchemaRef::cast_from(view->owner()); // Might be different from current schema.
+
+          // Ignore views that use a name that is already used for a table (no drop/new-add takes place then).
+          db_mysql_TableRef existingTable = find_named_object_in_list(schema->tables(), view->name());
+          if (!existingTable.is_valid()) {
+            db_mysql_ViewRef existingView = find_named_object_in_list(schema->views(), view->name());
+            if (existingView.is_valid()) {
+              schema->views()->remove(existingView);
+              createdObjects.remove_value(existingView);
+            }
+            schema->views().insert(view);
+            createdObjects.insert(view);
           }
-          schema->views().insert(view);
-          createdObjects.insert(view);
+
+          break;
         }
 
-        break;
-      }
+        case QtCreateProcedure:
+        case QtCreateFunction:
+        case QtCreateUdf: {
+          db_mysql_RoutineRef routine(grt::Initialized);
+          routine->owner(currentSchema);
+          routine->sqlDefinition(base::trim(query));
+          routine->createDate(base::fmttime(0, DATETIME_FMT));
+          routine->lastChangeDate(routine->createDate());
 
-      case QtCreateProcedure:
-      case QtCreateFunction:
-      case QtCreateUdf: {
-        db_mysql_RoutineRef routine(grt::Initialized);
-        routine->owner(currentSchema);
-        routine->sqlDefinition(base::trim(query));
-        routine->createDate(base::fmttime(0, DATETIME_FMT));
-        routine->lastChangeDate(routine->createDate());
+          RoutineListener listener(statementContext, catalog, routine, caseSensitive);
+          routine->oldName(routine->name());
 
-        RoutineListener listener(statementContext, catalog, routine, caseSensitive);
-        routine->oldName(routine->name());
+          db_mysql_SchemaRef schema =
+            db_mysql_SchemaRef::cast_from(routine->owner()); // Might be different from current schema.
 
-        db_mysql_SchemaRef schema =
-          db_mysql_SchemaRef::cast_from(routine->owner()); // Might be different from current schema.
+          db_RoutineRef existing = find_named_object_in_list(schema->routines(), routine->name());
+          if (existing.is_valid()) {
+            schema->routines()->remove(existing);
+            createdObjects.remove_value(existing);
+          }
+          schema->routines().insert(routine);
+          createdObjects.insert(routine);
 
-        db_RoutineRef existing = find_named_object_in_list(schema->routines(), routine->name());
-        if (existing.is_valid()) {
-          schema->routines()->remove(existing);
-          createdObjects.remove_value(existing);
+          break;
         }
-        schema->routines().insert(routine);
-        createdObjects.insert(routine);
 
-        break;
-      }
+        case QtCreateTrigger: {
+          db_mysql_TriggerRef trigger(grt::Initialized);
+          trigger->sqlDefinition(base::trim(query));
+          trigger->createDate(base::fmttime(0, DATETIME_FMT));
+          trigger->lastChangeDate(trigger->createDate());
 
-      case QtCreateTrigger: {
-        db_mysql_TriggerRef trigger(grt::Initialized);
-        trigger->sqlDefinition(base::trim(query));
-        trigger->createDate(base::fmttime(0, DATETIME_FMT));
-        trigger->lastChangeDate(trigger->createDate());
+          TriggerListener listener(statementContext, catalog, currentSchema, trigger, caseSensitive);
+          trigger->oldName(trigger->name());
 
-        TriggerListener listener(statementContext, catalog, currentSchema, trigger, caseSensitive);
-        trigger->oldName(trigger->name());
+          // It could be the listener had to create stub table. We have to add this to our created objects list.
+          db_mysql_TableRef table = db_mysql_TableRef::cast_from(trigger->owner());
+          if (table->isStub())
+            createdObjects.insert(table);
 
-        // It could be the listener had to create stub table. We have to add this to our created objects list.
-        db_mysql_TableRef table = db_mysql_TableRef::cast_from(trigger->owner());
-        if (table->isStub())
-          createdObjects.insert(table);
+          db_TriggerRef existing = find_named_object_in_list(table->triggers(), trigger->name());
+          if (existing.is_valid()) {
+            table->triggers()->remove(existing);
+            createdObjects.remove_value(existing);
+          }
+          table->triggers().insert(trigger);
+          createdObjects.insert(trigger);
 
-        db_TriggerRef existing = find_named_object_in_list(table->triggers(), trigger->name());
-        if (existing.is_valid()) {
-          table->triggers()->remove(existing);
-          createdObjects.remove_value(existing);
+          break;
         }
-        table->triggers().insert(trigger);
-        createdObjects.insert(trigger);
 
-        break;
-      }
+        case QtCreateLogFileGroup: {
+          db_mysql_LogFileGroupRef group(grt::Initialized);
+          group->createDate(base::fmttime(0, DATETIME_FMT));
+          group->lastChangeDate(group->createDate());
+          group->owner(catalog);
 
-      case QtCreateLogFileGroup: {
-        db_mysql_LogFileGroupRef group(grt::Initialized);
-        group->createDate(base::fmttime(0, DATETIME_FMT));
-        group->lastChangeDate(group->createDate());
-        group->owner(catalog);
+          LogfileGroupListener listener(statementContext, catalog, group, impl->caseSensitive);
+          group->oldName(group->name());
 
-        LogfileGroupListener listener(statementContext, catalog, group, impl->caseSensitive);
-        group->oldName(group->name());
+          db_LogFileGroupRef existing = find_named_object_in_list(catalog->logFileGroups(), group->name());
+          if (existing.is_valid()) {
+            catalog->logFileGroups()->remove(existing);
+            createdObjects.remove_value(existing);
+          }
 
-        db_LogFileGroupRef existing = find_named_object_in_list(catalog->logFileGroups(), group->name());
-        if (existing.is_valid()) {
-          catalog->logFileGroups()->remove(existing);
-          createdObjects.remove_value(existing);
-        }
+          catalog->logFileGroups().insert(group);
+          createdObjects.insert(group);
 
-        catalog->logFileGroups().insert(group);
-        createdObjects.insert(group);
+          break;
+        }
 
-        break;
-      }
+        case QtCreateServer: {
+          db_mysql_ServerLinkRef server(grt::Initialized);
+          server->createDate(base::fmttime(0, DATETIME_FMT));
+          server->lastChangeDate(server->createDate());
+          server->owner(catalog);
 
-      case QtCreateServer: {
-        db_mysql_ServerLinkRef server(grt::Initialized);
-        server->createDate(base::fmttime(0, DATETIME_FMT));
-        server->lastChangeDate(server->createDate());
-        server->owner(catalog);
+          ServerListener listener(statementContext, catalog, server, impl->caseSensitive);
+          server->oldName(server->name());
 
-        ServerListener listener(statementContext, catalog, server, impl->caseSensitive);
-        server->oldName(server->name());
+          db_ServerLinkRef existing = find_named_object_in_list(catalog->serverLinks(), server->name());
+          if (existing.is_valid()) {
+            catalog->serverLinks()->remove(existing);
+            createdObjects.remove_value(existing);
+          }
+          catalog->serverLinks().insert(server);
+          createdObjects.insert(server);
 
-        db_ServerLinkRef existing = find_named_object_in_list(catalog->serverLinks(), server->name());
-        if (existing.is_valid()) {
-          catalog->serverLinks()->remove(existing);
-          createdObjects.remove_value(existing);
+          break;
         }
-        catalog->serverLinks().insert(server);
-        createdObjects.insert(server);
 
-        break;
-      }
+        case QtCreateTableSpace: {
+          db_mysql_TablespaceRef tablespace(grt::Initialized);
+          tablespace->createDate(base::fmttime(0, DATETIME_FMT));
+          tablespace->lastChangeDate(tablespace->createDate());
+          tablespace->owner(catalog);
 
-      case QtCreateTableSpace: {
-        db_mysql_TablespaceRef tablespace(grt::Initialized);
-        tablespace->createDate(base::fmttime(0, DATETIME_FMT));
-        tablespace->lastChangeDate(tablespace->createDate());
-        tablespace->owner(catalog);
+          TablespaceListener listener(statementContext, catalog, tablespace, impl->caseSensitive);
+          tablespace->oldName(tablespace->name());
 
-        TablespaceListener listener(statementContext, catalog, tablespace, impl->caseSensitive);
-        tablespace->oldName(tablespace->name());
+          db_TablespaceRef existing = find_named_object_in_list(catalog->tablespaces(), tablespace->name());
+          if (existing.is_valid()) {
+            catalog->tablespaces()->remove(existing);
+            createdObjects.remove_value(existing);
+          }
+          catalog->tablespaces().insert(tablespace);
+          createdObjects.insert(tablespace);
 
-        db_TablespaceRef existing = find_named_object_in_list(catalog->tablespaces(), tablespace->name());
-        if (existing.is_valid()) {
-          catalog->tablespaces()->remove(existing);
-          createdObjects.remove_value(existing);
+          break;
         }
-        catalog->tablespaces().insert(tablespace);
-        createdObjects.insert(tablespace);
 
-        break;
-      }
-
-      case QtDropDatabase: {
-        std::string name = base::unquote(statementContext->dropStatement()->dropDatabase()->schemaRef()->getText());
-        db_SchemaRef schema = find_named_object_in_list(catalog->schemata(), name);
-        if (schema.is_valid()) {
-          catalog->schemata()->remove(schema);
-          createdObjects.remove_value(schema);
-
-          if (catalog->defaultSchema() == schema)
-            catalog->defaultSchema(db_mysql_SchemaRef());
-          if (currentSchema == schema)
-            currentSchema = db_mysql_SchemaRef::cast_from(catalog->defaultSchema());
-          if (!currentSchema.is_valid())
-            currentSchema = ObjectListener::ensureSchemaExists(catalog, "default_schema", caseSensitive);
+        case QtDropDatabase: {
+          std::string name = base::unquote(statementContext->dropStatement()->dropDatabase()->schemaRef()->getText());
+          db_SchemaRef schema = find_named_object_in_list(catalog->schemata(), name);
+          if (schema.is_valid()) {
+            catalog->schemata()->remove(schema);
+            createdObjects.remove_value(schema);
+
+            if (catalog->defaultSchema() == schema)
+              catalog->defaultSchema(db_mysql_SchemaRef());
+            if (currentSchema == schema)
+              currentSchema = db_mysql_SchemaRef::cast_from(catalog->defaultSchema());
+            if (!currentSchema.is_valid())
+              currentSchema = ObjectListener::ensureSchemaExists(catalog, "default_schema", caseSensitive);
+          }
+          break;
         }
-        break;
-      }
-
-      case QtDropEvent: {
-        IdentifierListener listener(statementContext->dropStatement()->dropEvent()->eventRef());
 
-        db_SchemaRef schema = currentSchema;
-        if (listener.parts.size() > 1 && !listener.parts[0].empty())
-          schema = ObjectListener::ensureSchemaExists(catalog, listener.parts[0], caseSensitive);
-        db_EventRef event = find_named_object_in_list(schema->events(), listener.parts.back());
-        if (event.is_valid()) {
-          schema->events()->remove(event);
-          createdObjects.remove_value(event);
-        }
+        case QtDropEvent: {
+          IdentifierListener listener(statementContext->dropStatement()->dropEvent()->eventRef());
 
-        break;
-      }
+          db_SchemaRef schema = currentSchema;
+          if (listener.parts.size() > 1 && !listener.parts[0].empty())
+            schema = ObjectListener::ensureSchemaExists(catalog, listener.parts[0], caseSensitive);
+          db_EventRef event = find_named_object_in_list(schema->events(), listener.parts.back());
+          if (event.is_valid()) {
+            schema->events()->remove(event);
+            createdObjects.remove_value(event);
+          }
 
-      case QtDropProcedure:
-      case QtDropFunction: // Including UDFs.
-      {
-        tree::ParseTree *nameContext;
-        if (queryType == QtDropFunction)
-          nameContext = statementContext->dropStatement()->dropFunction()->functionRef();
-        else
-          nameContext = statementContext->dropStatement()->dropProcedure()->procedureRef();
-        IdentifierListener listener(nameContext);
-
-        db_SchemaRef schema = currentSchema;
-        if (listener.parts.size() > 1 && !listener.parts[0].empty())
-          schema = ObjectListener::ensureSchemaExists(catalog, listener.parts[0], caseSensitive);
-        db_RoutineRef routine = find_named_object_in_list(schema->routines(), listener.parts.back());
-        if (routine.is_valid()) {
-          schema->routines()->remove(routine);
-          createdObjects.remove_value(routine);
+          break;
         }
 
-        break;
-      }
-
-      case QtDropIndex: {
-        std::string name;
+        case QtDropProcedure:
+        case QtDropFunction: // Including UDFs.
         {
-          IdentifierListener listener(statementContext->dropStatement()->dropIndex()->indexRef());
-          name = listener.parts.back();
-        }
+          tree::ParseTree *nameContext;
+          if (queryType == QtDropFunction)
+            nameContext = statementContext->dropStatement()->dropFunction()->functionRef();
+          else
+            nameContext = statementContext->dropStatement()->dropProcedure()->procedureRef();
+          IdentifierListener listener(nameContext);
 
-        IdentifierListener listener(statementContext->dropStatement()->dropIndex()->tableRef());
-
-        db_SchemaRef schema = currentSchema;
-        if (listener.parts.size() > 1 && !listener.parts[0].empty())
-          schema = ObjectListener::ensureSchemaExists(catalog, listener.parts[0], caseSensitive);
-        db_TableRef table = find_named_object_in_list(schema->tables(), listener.parts.back());
-        if (table.is_valid()) {
-          db_IndexRef index = find_named_object_in_list(table->indices(), name);
-          if (index.is_valid()) {
-            table->indices()->remove(index);
-            createdObjects.remove_value(index);
+          db_SchemaRef schema = currentSchema;
+          if (listener.parts.size() > 1 && !listener.parts[0].empty())
+            schema = ObjectListener::ensureSchemaExists(catalog, listener.parts[0], caseSensitive);
+          db_RoutineRef routine = find_named_object_in_list(schema->routines(), listener.parts.back());
+          if (routine.is_valid()) {
+            schema->routines()->remove(routine);
+            createdObjects.remove_value(routine);
           }
-        }
-        break;
-      }
 
-      case QtDropLogfileGroup: {
-        IdentifierListener listener(statementContext->dropStatement()->dropLogfileGroup()->logfileGroupRef());
-
-        db_LogFileGroupRef group = find_named_object_in_list(catalog->logFileGroups(), listener.parts.back());
-        if (group.is_valid()) {
-          catalog->logFileGroups()->remove(group);
-          createdObjects.remove_value(group);
+          break;
         }
 
-        break;
-      }
-
-      case QtDropServer: {
-        IdentifierListener listener(statementContext->dropStatement()->dropServer()->serverRef());
-        db_ServerLinkRef server = find_named_object_in_list(catalog->serverLinks(), listener.parts.back());
-        if (server.is_valid()) {
-          catalog->serverLinks()->remove(server);
-          createdObjects.remove_value(server);
-        }
+        case QtDropIndex: {
+          std::string name;
+          {
+            IdentifierListener listener(statementContext->dropStatement()->dropIndex()->indexRef());
+            name = listener.parts.back();
+          }
 
-        break;
-      }
+          IdentifierListener listener(statementContext->dropStatement()->dropIndex()->tableRef());
 
-      case QtDropTable: {
-        // We can have a list of tables to drop here.
-        for (auto tableRef : statementContext->dropStatement()->dropTable()->tableRefList()->tableRef()) {
-          IdentifierListener listener(tableRef);
           db_SchemaRef schema = currentSchema;
           if (listener.parts.size() > 1 && !listener.parts[0].empty())
             schema = ObjectListener::ensureSchemaExists(catalog, listener.parts[0], caseSensitive);
-
           db_TableRef table = find_named_object_in_list(schema->tables(), listener.parts.back());
           if (table.is_valid()) {
-            schema->tables()->remove(table);
-            createdObjects.remove_value(table);
+            db_IndexRef index = find_named_object_in_list(table->indices(), name);
+            if (index.is_valid()) {
+              table->indices()->remove(index);
+              createdObjects.remove_value(index);
+            }
           }
+          break;
         }
 
-        break;
-      }
+        case QtDropLogfileGroup: {
+          IdentifierListener listener(statementContext->dropStatement()->dropLogfileGroup()->logfileGroupRef());
 
-      case QtDropView: {
-        // We can have a list of views to drop here.
-        for (auto tableRef : statementContext->dropStatement()->dropView()->viewRefList()->viewRef()) {
-          IdentifierListener listener(tableRef);
-          db_SchemaRef schema = currentSchema;
-          if (listener.parts.size() > 1 && !listener.parts[0].empty())
-            schema = ObjectListener::ensureSchemaExists(catalog, listener.parts[0], caseSensitive);
+          db_LogFileGroupRef group = find_named_object_in_list(catalog->logFileGroups(), listener.parts.back());
+          if (group.is_valid()) {
+            catalog->logFileGroups()->remove(group);
+            createdObjects.remove_value(group);
+          }
+
+          break;
+        }
 
-          db_ViewRef view = find_named_object_in_list(schema->views(), listener.parts.back());
-          if (view.is_valid()) {
-            schema->views()->remove(view);
-            createdObjects.remove_value(view);
+        case QtDropServer: {
+          IdentifierListener listener(statementContext->dropStatement()->dropServer()->serverRef());
+          db_ServerLinkRef server = find_named_object_in_list(catalog->serverLinks(), listener.parts.back());
+          if (server.is_valid()) {
+            catalog->serverLinks()->remove(server);
+            createdObjects.remove_value(server);
           }
+
+          break;
         }
 
-        break;
-      }
+        case QtDropTable: {
+          // We can have a list of tables to drop here.
+          for (auto tableRef : statementContext->dropStatement()->dropTable()->tableRefList()->tableRef()) {
+            IdentifierListener listener(tableRef);
+            db_SchemaRef schema = currentSchema;
+            if (listener.parts.size() > 1 && !listener.parts[0].empty())
+              schema = ObjectListener::ensureSchemaExists(catalog, listener.parts[0], caseSensitive);
 
-      case QtDropTablespace: {
-        IdentifierListener listener(statementContext->dropStatement()->dropTableSpace()->tablespaceRef());
-        db_TablespaceRef tablespace = find_named_object_in_list(catalog->tablespaces(), listener.parts.back());
-        if (tablespace.is_valid()) {
-          catalog->tablespaces()->remove(tablespace);
-          createdObjects.remove_value(tablespace);
+            db_TableRef table = find_named_object_in_list(schema->tables(), listener.parts.back());
+            if (table.is_valid()) {
+              schema->tables()->remove(table);
+              createdObjects.remove_value(table);
+            }
+          }
+
+          break;
         }
 
-        break;
-      }
+        case QtDropView: {
+          // We can have a list of views to drop here.
+          for (auto tableRef : statementContext->dropStatement()->dropView()->viewRefList()->viewRef()) {
+            IdentifierListener listener(tableRef);
+            db_SchemaRef schema = currentSchema;
+            if (listener.parts.size() > 1 && !listener.parts[0].empty())
+              schema = ObjectListener::ensureSchemaExists(catalog, listener.parts[0], caseSensitive);
+
+            db_ViewRef view = find_named_object_in_list(schema->views(), listener.parts.back());
+            if (view.is_valid()) {
+              schema->views()->remove(view);
+              createdObjects.remove_value(view);
+            }
+          }
+
+          break;
+        }
+
+        case QtDropTablespace: {
+          IdentifierListener listener(statementContext->dropStatement()->dropTableSpace()->tablespaceRef());
+          db_TablespaceRef tablespace = find_named_object_in_list(catalog->tablespaces(), listener.parts.back());
+          if (tablespace.is_valid()) {
+            catalog->tablespaces()->remove(tablespace);
+            createdObjects.remove_value(tablespace);
+          }
+
+          break;
+        }
 
-      case QtDropTrigger: {
-        IdentifierListener listener(statementContext->dropStatement()->dropTrigger()->triggerRef());
+        case QtDropTrigger: {
+          IdentifierListener listener(statementContext->dropStatement()->dropTrigger()->triggerRef());
 
-        // Even though triggers are schema level objects they work on specific tables
-        // and that's why we store them under the affected tables, not in the schema object.
-        // This however makes it more difficult to find the trigger to delete, as we have to
-        // iterate over all tables.
-        db_SchemaRef schema = currentSchema;
-        if (listener.parts.size() > 1 && !listener.parts[0].empty())
-          schema = ObjectListener::ensureSchemaExists(catalog, listener.parts[0], caseSensitive);
+          // Even though triggers are schema level objects they work on specific tables
+          // and that's why we store them under the affected tables, not in the schema object.
+          // This however makes it more difficult to find the trigger to delete, as we have to
+          // iterate over all tables.
+          db_SchemaRef schema = currentSchema;
+          if (listener.parts.size() > 1 && !listener.parts[0].empty())
+            schema = ObjectListener::ensureSchemaExists(catalog, listener.parts[0], caseSensitive);
 
-        for (auto table : schema->tables()) {
-          db_TriggerRef trigger = find_named_object_in_list(table->triggers(), listener.parts.back());
-          if (trigger.is_valid()) {
-            table->triggers()->remove(trigger);
-            createdObjects.remove_value(trigger);
+          for (auto table : schema->tables()) {
+            db_TriggerRef trigger = find_named_object_in_list(table->triggers(), listener.parts.back());
+            if (trigger.is_valid()) {
+              table->triggers()->remove(trigger);
+              createdObjects.remove_value(trigger);
 
-            break; // A trigger can only be assigned to a single table, so we can stop here.
+              break; // A trigger can only be assigned to a single table, so we can stop here.
+            }
           }
+          break;
         }
-        break;
-      }
 
-      case QtRenameTable: {
-        // Renaming a table is special as you can use it also to rename a view and to move
-        // a table from one schema to the other (not for views, though).
-        // Due to the way we store triggers we have an easy life wrt. related triggers.
-        for (auto renamePair : statementContext->renameTableStatement()->renamePair()) {
-          IdentifierListener sourceListener(renamePair->tableRef());
-
-          db_SchemaRef sourceSchema = currentSchema;
-          if (sourceListener.parts.size() > 1 && !sourceListener.parts[0].empty())
-            sourceSchema = ObjectListener::ensureSchemaExists(catalog, sourceListener.parts[0], caseSensitive);
-
-          IdentifierListener targetListener(renamePair->tableName());
-          db_SchemaRef targetSchema = currentSchema;
-          if (targetListener.parts.size() > 1 && !targetListener.parts[0].empty())
-            targetSchema = ObjectListener::ensureSchemaExists(catalog, targetListener.parts[0], caseSensitive);
-
-          db_ViewRef view = find_named_object_in_list(sourceSchema->views(), sourceListener.parts.back());
-          if (view.is_valid()) {
-            // Cannot move between schemas.
-            if (sourceSchema == targetSchema)
-              view->name(targetListener.parts.back());
-          } else {
-            // Renaming a table.
-            db_TableRef table = find_named_object_in_list(sourceSchema->tables(), sourceListener.parts.back());
-            if (table.is_valid()) {
-              if (sourceSchema != targetSchema) {
-                sourceSchema->tables()->remove(table);
-                targetSchema->tables().insert(table);
-                createdObjects.insert(table);
+        case QtRenameTable: {
+          // Renaming a table is special as you can use it also to rename a view and to move
+          // a table from one schema to the other (not for views, though).
+          // Due to the way we store triggers we have an easy life wrt. related triggers.
+          for (auto renamePair : statementContext->renameTableStatement()->renamePair()) {
+            IdentifierListener sourceListener(renamePair->tableRef());
+
+            db_SchemaRef sourceSchema = currentSchema;
+            if (sourceListener.parts.size() > 1 && !sourceListener.parts[0].empty())
+              sourceSchema = ObjectListener::ensureSchemaExists(catalog, sourceListener.parts[0], caseSensitive);
+
+            IdentifierListener targetListener(renamePair->tableName());
+            db_SchemaRef targetSchema = currentSchema;
+            if (targetListener.parts.size() > 1 && !targetListener.parts[0].empty())
+              targetSchema = ObjectListener::ensureSchemaExists(catalog, targetListener.parts[0], caseSensitive);
+
+            db_ViewRef view = find_named_object_in_list(sourceSchema->views(), sourceListener.parts.back());
+            if (view.is_valid()) {
+              // Cannot move between schemas.
+              if (sourceSchema == targetSchema)
+                view->name(targetListener.parts.back());
+            } else {
+              // Renaming a table.
+              db_TableRef table = find_named_object_in_list(sourceSchema->tables(), sourceListener.parts.back());
+              if (table.is_valid()) {
+                if (sourceSchema != targetSchema) {
+                  sourceSchema->tables()->remove(table);
+                  targetSchema->tables().insert(table);
+                  createdObjects.insert(table);
+                }
+                table->name(targetListener.parts.back());
               }
-              table->name(targetListener.parts.back());
             }
           }
-        }
 
-        break;
-      }
+          break;
+        }
 
-      // Alter commands. At the moment we only support a limited number of cases as we mostly
-      // need SQL-to-GRT conversion for create scripts.
-      case QtAlterDatabase: {
-        IdentifierListener listener(statementContext->alterStatement()->alterDatabase()->schemaRef());
+        // Alter commands. At the moment we only support a limited number of cases as we mostly
+        // need SQL-to-GRT conversion for create scripts.
+        case QtAlterDatabase: {
+          IdentifierListener listener(statementContext->alterStatement()->alterDatabase()->schemaRef());
 
-        db_mysql_SchemaRef schema = ObjectListener::ensureSchemaExists(catalog, listener.parts.back(), caseSensitive);
-        schema->lastChangeDate(base::fmttime(0, DATETIME_FMT));
+          db_mysql_SchemaRef schema = ObjectListener::ensureSchemaExists(catalog, listener.parts.back(), caseSensitive);
+          schema->lastChangeDate(base::fmttime(0, DATETIME_FMT));
 
-        SchemaListener(statementContext, catalog, schema, impl->caseSensitive);
-        break;
-      }
+          SchemaListener(statementContext, catalog, schema, impl->caseSensitive);
+          break;
+        }
 
-      case QtAlterLogFileGroup:
-        break;
+        case QtAlterLogFileGroup:
+          break;
 
-      case QtAlterFunction:
-        break;
+        case QtAlterFunction:
+          break;
 
-      case QtAlterProcedure:
-        break;
+        case QtAlterProcedure:
+          break;
 
-      case QtAlterServer:
-        break;
+        case QtAlterServer:
+          break;
 
-      case QtAlterTable: { // Alter table only for adding/removing indices and for renames.
-        IdentifierListener listener(statementContext->alterStatement()->alterTable()->tableRef());
+        case QtAlterTable: { // Alter table only for adding/removing indices and for renames.
+          IdentifierListener listener(statementContext->alterStatement()->alterTable()->tableRef());
 
-        db_mysql_SchemaRef schema = currentSchema;
-        if (listener.parts.size() > 1 && !listener.parts[0].empty())
-          schema = ObjectListener::ensureSchemaExists(catalog, listener.parts[0], caseSensitive);
+          db_mysql_SchemaRef schema = currentSchema;
+          if (listener.parts.size() > 1 && !listener.parts[0].empty())
+            schema = ObjectListener::ensureSchemaExists(catalog, listener.parts[0], caseSensitive);
 
-        db_mysql_TableRef table = find_named_object_in_list(schema->tables(), listener.parts.back(), caseSensitive);
-        if (table.is_valid())
-          TableAlterListener(statementContext, catalog, table, caseSensitive, autoGenerateFkNames, refCache);
-        else {
-          db_mysql_ViewRef view = find_named_object_in_list(schema->views(), listener.parts.back(), caseSensitive);
-          if (view.is_valid())
-            TableAlterListener(statementContext, catalog, view, caseSensitive, autoGenerateFkNames, refCache);
+          db_mysql_TableRef table = find_named_object_in_list(schema->tables(), listener.parts.back(), caseSensitive);
+          if (table.is_valid())
+            TableAlterListener(statementContext, catalog, table, caseSensitive, autoGenerateFkNames, refCache);
+          else {
+            db_mysql_ViewRef view = find_named_object_in_list(schema->views(), listener.parts.back(), caseSensitive);
+            if (view.is_valid())
+              TableAlterListener(statementContext, catalog, view, caseSensitive, autoGenerateFkNames, refCache);
+          }
+          break;
         }
-        break;
-      }
 
-      case QtAlterTableSpace:
-        break;
+        case QtAlterTableSpace:
+          break;
 
-      case QtAlterEvent:
-        break;
+        case QtAlterEvent:
+          break;
 
-      case QtAlterView:
-        break;
+        case QtAlterView:
+          break;
 
-      default:
-        continue; // Ignore anything else.
+        default:
+          continue; // Ignore anything else.
+      }
     }
   }
 
@@ -2246,6 +2381,78 @@ static bool isLineBreak(const unsigned char *head, const unsigned char *line_bre
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+
+  /**
+   * A small set of characters the statement splitter has to look at. Everything else is skipped 16 bytes at a time,
+   * as long as SSE2 is available (without it, skip() does nothing and the splitter goes byte by byte).
+   */
+  class StopCharacters {
+  public:
+    StopCharacters(std::initializer_list<unsigned char> characters) {
+      for (unsigned char c : characters)
+        set(_count++, c);
+    }
+
+    void set(size_t index, unsigned char c) {
+#ifdef SPLITTER_USE_SSE2
+      _stops[index] = _mm_set1_epi8(static_cast<char>(c));
+#endif
+    }
+
+    /**
+     * Returns the first position in [head, end) with a stop character. If there is none, the returned position can
+     * be up to 15 bytes before end, so callers must continue byte by byte from there, as they did without skipping.
+     * If haveContent is given it is set to true when any non-whitespace character was skipped.
+     */
+    const unsigned char *skip(const unsigned char *head, const unsigned char *end, bool *haveContent) const {
+#ifdef SPLITTER_USE_SSE2
+      const __m128i space = _mm_set1_epi8(' ');
+      while (end - head >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(head));
+        __m128i found = _mm_cmpeq_epi8(block, _stops[0]);
+        for (size_t i = 1; i < _count; ++i)
+          found = _mm_or_si128(found, _mm_cmpeq_epi8(block, _stops[i]));
+
+        unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(found));
+        unsigned int length = mask == 0 ? 16 : firstBit(mask);
+        if (haveContent != nullptr && !*haveContent && length > 0) {
+          // Bytes <= space (unsigned) are whitespace/control characters.
+          unsigned int blank = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(block, space), space));
+          unsigned int skipped = length == 16 ? 0xFFFF : (1U << length) - 1;
+          if ((~blank & skipped) != 0)
+            *haveContent = true;
+        }
+
+        head += length;
+        if (mask != 0)
+          break;
+      }
+#endif
+      return head;
+    }
+
+  private:
+#ifdef SPLITTER_USE_SSE2
+    static unsigned int firstBit(unsigned int mask) {
+#ifdef _MSC_VER
+      unsigned long index;
+      _BitScanForward(&index, mask);
+      return index;
+#else
+      return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+    }
+
+    __m128i _stops[10];
+#endif
+    size_t _count = 0;
+  };
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 grt::BaseListRef MySQLParserServicesImpl::getSqlStatementRanges(const std::string &sql) {
 
   std::vector<StatementRange> ranges;
@@ -2267,9 +2474,18 @@ grt::BaseListRef MySQLParserServicesImpl::getSqlStatementRanges(const std::strin
 /**
  * A statement splitter to take a list of sql statements and split them into individual statements,
  * return their position and length in the original string (instead the copied strings).
+ *
+ * The returned value is the offset of the first character after the last delimiter (or DELIMITER command)
+ * found in the text. Everything before it forms complete statements, so callers feeding a script
+ * in chunks can continue with the remainder, using the delimiter returned in endDelimiter (if given).
+ * The text must be null terminated (the scanner looks ahead by a few characters).
+ *
+ * Runs of characters without special meaning (which is most of any script) are skipped with SSE2 where possible.
+ * The result is the same as going byte by byte.
  */
 size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t length,
-  const std::string &initialDelimiter, std::vector<StatementRange> &ranges, const std::string &lineBreak) {
+  const std::string &initialDelimiter, std::vector<StatementRange> &ranges, const std::string &lineBreak,
+  std::string *endDelimiter) {
 
   static const unsigned char keyword[] = "delimiter";
 
@@ -2284,8 +2500,15 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
 
   size_t currentLine = 0;
   size_t statementStart = 0;
+  size_t consumed = 0;
   bool haveContent = false; // Set when anything else but comments were found for the current statement.
 
+  // Stop characters for the main loop (the last one being the first delimiter char), in comments and in quotes.
+  StopCharacters statementStops = { '/', '-', '#', '"', '\'', '`', 'd', 'D', *newLine, *delimiterHead };
+  StopCharacters commentStops = { '*', *newLine };
+  StopCharacters lineStops = { *newLine };
+  StopCharacters quoteStops[] = { { '"', '\\', *newLine }, { '\'', '\\', *newLine }, { '`', '\\', *newLine } };
+
   while (tail < end) {
     switch (*tail) {
       case '/': { // Possible multi line comment or hidden (conditional) command.
@@ -2293,10 +2516,12 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
           tail += 2;
           bool isHiddenCommand = (*tail == '!');
           while (true) {
+            tail = commentStops.skip(tail, end, nullptr);
             while (tail < end && *tail != '*') {
               if (isLineBreak(tail, newLine))
                 ++currentLine;
               tail++;
+              tail = commentStops.skip(tail, end, nullptr);
             }
 
             if (tail == end) // Unfinished comment.
@@ -2327,8 +2552,11 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
         if (*(tail + 1) == '-' && (*end_char == ' ' || *end_char == '\t' || isLineBreak(end_char, newLine))) {
           // Skip everything until the end of the line.
           tail += 2;
-          while (tail < end && !isLineBreak(tail, newLine))
+          tail = lineStops.skip(tail, end, nullptr);
+          while (tail < end && !isLineBreak(tail, newLine)) {
             tail++;
+            tail = lineStops.skip(tail, end, nullptr);
+          }
 
           if (!haveContent) {
             head = tail;
@@ -2341,8 +2569,10 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
       }
 
       case '#': { // MySQL single line comment.
-        while (tail < end && !isLineBreak(tail, newLine))
+        while (tail < end && !isLineBreak(tail, newLine)) {
           tail++;
+          tail = lineStops.skip(tail, end, nullptr);
+        }
 
         if (!haveContent) {
           head = tail;
@@ -2357,11 +2587,16 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
       case '`': { // Quoted string/id. Skip this in a local loop.
         haveContent = true;
         unsigned char quote = *tail++;
+        const StopCharacters &stops = quoteStops[quote == '"' ? 0 : (quote == '\'' ? 1 : 2)];
+        tail = stops.skip(tail, end, nullptr);
         while (tail < end && *tail != quote) {
           // Skip any escaped character too.
-          if (*tail == '\\')
+          if (*tail == '\\' && tail + 1 < end)
             tail++;
+          else if (isLineBreak(tail, newLine))
+            ++currentLine;
           tail++;
+          tail = stops.skip(tail, end, nullptr);
         }
         if (*tail == quote)
           tail++; // Skip trailing quote char if one was there.
@@ -2392,6 +2627,7 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
               ++run;
             delimiter = base::trim(std::string(reinterpret_cast<const char *>(tail), run - tail));
             delimiterHead = reinterpret_cast<const unsigned char *>(delimiter.c_str());
+            statementStops.set(9, *delimiterHead);
 
             // Skip over the delimiter statement and any following line breaks.
             while (isLineBreak(run, newLine)) {
@@ -2401,6 +2637,8 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
             tail = run;
             head = tail;
             statementStart = currentLine;
+            consumed = tail - start;
+            haveContent = false;
           } else
             ++tail;
         } else
@@ -2419,6 +2657,7 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
         if (*tail > ' ')
           haveContent = true;
         tail++;
+        tail = statementStops.skip(tail, end, &haveContent);
         break;
     }
 
@@ -2432,6 +2671,7 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
           ranges.push_back({ statementStart, static_cast<size_t>(head - start), static_cast<size_t>(tail - head) });
         head = ++tail;
         statementStart = currentLine;
+        consumed = tail - start;
         haveContent = false;
       } else {
         const unsigned char *run = tail + 1;
@@ -2448,6 +2688,7 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
           tail = run;
           head = run;
           statementStart = currentLine;
+          consumed = tail - start;
           haveContent = false;
         }
       }
@@ -2459,7 +2700,10 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
   if (head < tail)
     ranges.push_back({ statementStart, static_cast<size_t>(head - start), static_cast<size_t>(tail - head) });
 
-  return 0;
+  if (endDelimiter != nullptr)
+    *endDelimiter = delimiter;
+
+  return consumed;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -2752,11 +2996,12 @@ bool MySQLParserServicesImpl::parseTypeDefinition(const std::string &typeDefinit
 
 std::vector<std::pair<int, std::string>> MySQLParserServicesImpl::getCodeCompletionCandidates(
   MySQLParserContext::Ref context, std::pair<size_t, size_t> caret, std::string const &sql,
-  std::string const &defaultSchema, bool uppercaseKeywords, parsers::SymbolTable &symbolTable) {
+  std::string const &defaultSchema, bool uppercaseKeywords, parsers::SymbolTable &symbolTable,
+  std::string const &typedPart) {
   
   MySQLParserContextImpl *impl = dynamic_cast<MySQLParserContextImpl *>(context.get());
   std::vector<std::pair<int, std::string>> candidates =
-    impl->getCodeCompletionCandidates(caret, sql, defaultSchema, uppercaseKeywords, symbolTable);
+    impl->getCodeCompletionCandidates(caret, sql, defaultSchema, uppercaseKeywords, symbolTable, typedPart);
 
   return candidates;
 }
@@ -186,7 +186,8 @@ public:
 
   grt::BaseListRef getSqlStatementRanges(const std::string &sql);
   virtual size_t determineStatementRanges(const char *sql, size_t length, const std::string &initialDelimiter,
-    std::vector<parsers::StatementRange> &ranges, const std::string &lineBreak = "\n") override;
+    std::vector<parsers::StatementRange> &ranges, const std::string &lineBreak = "\n",
+    std::string *endDelimiter = nullptr) override;
 
   grt::DictRef parseStatementDetails(parser_ContextReferenceRef context_ref, const std::string &sql);
   virtual grt::DictRef parseStatement(parsers::MySQLParserContext::Ref context, const std::string &sql) override;
@@ -201,5 +202,6 @@ public:
   // Others.
   virtual std::vector<std::pair<int, std::string>> getCodeCompletionCandidates(
     parsers::MySQLParserContext::Ref context, std::pair<size_t, size_t> caret, std::string const &sql,
-    std::string const &defaultSchema, bool uppercaseKeywords, parsers::SymbolTable &symbolTable) override;
+    std::string const &defaultSchema, bool uppercaseKeywords, parsers::SymbolTable &symbolTable,
+    std::string const &typedPart) override;
 };
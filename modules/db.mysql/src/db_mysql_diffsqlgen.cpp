@@ -33,7 +33,12 @@
 #include "grt/common.h"
 
 #include <algorithm>
+#include <atomic>
 #include <ctype.h>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 #include "module_db_mysql.h"
 #include "module_db_mysql_shared_code.h"
@@ -1114,6 +1119,70 @@ void DiffSQLGeneratorBE::generate_routine_alter_stmt(db_mysql_RoutineRef old_rou
   }
 }
 
+// Change lists with at least this many items are generated on several threads.
+static const size_t PARALLEL_GENERATION_THRESHOLD = 4;
+
+// Set while generating on a worker thread, nested change lists are then handled sequentially.
+static thread_local bool in_generator_worker = false;
+
+void DiffSQLGeneratorBE::generate_each(
+  const std::vector<const grt::DiffChange *> &changes,
+  const std::function<void(DiffSQLGeneratorBE &, const grt::DiffChange *)> &generate) {
+  size_t thread_count = _threads;
+  if (thread_count == 0)
+    thread_count = std::max(1U, std::thread::hardware_concurrency());
+
+  std::vector<std::unique_ptr<DiffSQLGeneratorBEActionInterface> > recorders;
+  if (!in_generator_worker && thread_count > 1 && changes.size() >= PARALLEL_GENERATION_THRESHOLD) {
+    for (size_t i = 0; i < changes.size(); ++i) {
+      recorders.emplace_back(callback->clone());
+      if (!recorders.back()) { // The call-back doesn't support parallel generation.
+        recorders.clear();
+        break;
+      }
+    }
+  }
+
+  if (recorders.empty()) {
+    for (size_t i = 0; i < changes.size(); ++i)
+      generate(*this, changes[i]);
+    return;
+  }
+
+  std::atomic<size_t> next(0);
+  std::exception_ptr error;
+  std::mutex error_mutex;
+  auto worker = [&]() {
+    in_generator_worker = true;
+    DiffSQLGeneratorBE generator(*this);
+    try {
+      for (size_t i = next++; i < changes.size(); i = next++) {
+        generator.callback = recorders[i].get();
+        generate(generator, changes[i]);
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error)
+        error = std::current_exception();
+      next = changes.size();
+    }
+    in_generator_worker = false;
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < std::min(thread_count, changes.size()); ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (auto &thread : threads)
+    thread.join();
+
+  if (error)
+    std::rethrow_exception(error);
+
+  for (size_t i = 0; i < recorders.size(); ++i)
+    callback->replay(recorders[i].get());
+}
+
 void DiffSQLGeneratorBE::generate_alter_stmt(db_mysql_SchemaRef schema, const grt::DiffChange *diffchange) {
   bool process_alter_schema = true;
   std::string schema_name_for_filter(get_old_object_name_for_key(schema, _case_sensitive));
@@ -1155,20 +1224,23 @@ void DiffSQLGeneratorBE::generate_alter_stmt(db_mysql_SchemaRef schema, const gr
     if (attr_change->get_attr_name().compare("tables") == 0) {
       const grt::MultiChange *list_change = static_cast<const grt::MultiChange *>(attr_change->get_subchange().get());
       const grt::ChangeSet *tables_cs = list_change->subchanges();
-      for (grt::ChangeSet::const_iterator e2 = tables_cs->end(), jt = tables_cs->begin(); jt != e2; jt++) {
-        const grt::DiffChange *table_change = jt->get();
+      std::vector<const grt::DiffChange *> table_changes;
+      for (grt::ChangeSet::const_iterator e2 = tables_cs->end(), jt = tables_cs->begin(); jt != e2; jt++)
+        table_changes.push_back(jt->get());
+
+      generate_each(table_changes, [](DiffSQLGeneratorBE &generator, const grt::DiffChange *table_change) {
         if (table_change->get_change_type() == grt::ListItemModified) {
-          generate_alter_stmt_drops(
+          generator.generate_alter_stmt_drops(
             db_mysql_TableRef::cast_from(
               static_cast<const grt::ListItemModifiedChange *>(table_change)->get_new_value()),
             static_cast<const grt::ListItemModifiedChange *>(table_change)->get_subchange().get());
         } else if (table_change->get_change_type() == grt::ListItemOrderChanged) {
           const grt::ListItemOrderChange *oc = static_cast<const grt::ListItemOrderChange *>(table_change);
           if (oc->get_subchange())
-            generate_alter_stmt_drops(db_mysql_TableRef::cast_from(oc->get_subchange()->get_new_value()),
-                                      oc->get_subchange()->get_subchange().get());
+            generator.generate_alter_stmt_drops(db_mysql_TableRef::cast_from(oc->get_subchange()->get_new_value()),
+                                                oc->get_subchange()->get_subchange().get());
         }
-      }
+      });
     }
   }
 
@@ -1177,62 +1249,64 @@ void DiffSQLGeneratorBE::generate_alter_stmt(db_mysql_SchemaRef schema, const gr
     if (attr_change->get_attr_name().compare("tables") == 0) {
       const grt::MultiChange *list_change = static_cast<const grt::MultiChange *>(attr_change->get_subchange().get());
       const grt::ChangeSet *tables_cs = list_change->subchanges();
+      std::vector<const grt::DiffChange *> table_changes;
+      for (grt::ChangeSet::const_iterator e2 = tables_cs->end(), jt = tables_cs->begin(); jt != e2; jt++)
+        table_changes.push_back(jt->get());
 
       // 1st pass, do everything except FKs
-      for (grt::ChangeSet::const_iterator e2 = tables_cs->end(), jt = tables_cs->begin(); jt != e2; jt++) {
-        const grt::DiffChange *table_change = jt->get();
+      generate_each(table_changes, [](DiffSQLGeneratorBE &generator, const grt::DiffChange *table_change) {
         switch (table_change->get_change_type()) {
           case grt::ListItemAdded:
-            generate_create_stmt(
+            generator.generate_create_stmt(
               db_mysql_TableRef::cast_from(static_cast<const grt::ListItemAddedChange *>(table_change)->get_value()));
             break;
           case grt::ListItemRemoved:
-            generate_drop_stmt(
+            generator.generate_drop_stmt(
               db_mysql_TableRef::cast_from(static_cast<const grt::ListItemRemovedChange *>(table_change)->get_value()));
             break;
           case grt::ListItemModified:
-            generate_alter_stmt(
+            generator.generate_alter_stmt(
               db_mysql_TableRef::cast_from(
                 static_cast<const grt::ListItemModifiedChange *>(table_change)->get_new_value()),
               static_cast<const grt::ListItemModifiedChange *>(table_change)->get_subchange().get(),
-              _separate_foreign_keys ? EverythingButForeignKeys : Everything); // everything but FK 1st
+              generator._separate_foreign_keys ? EverythingButForeignKeys : Everything); // everything but FK 1st
             break;
           case grt::ListItemOrderChanged: {
             const grt::ListItemOrderChange *oc = static_cast<const grt::ListItemOrderChange *>(table_change);
             if (oc->get_subchange())
-              generate_alter_stmt(db_mysql_TableRef::cast_from(oc->get_subchange()->get_new_value()),
-                                  oc->get_subchange()->get_subchange().get(),
-                                  _separate_foreign_keys ? EverythingButForeignKeys : Everything);
+              generator.generate_alter_stmt(db_mysql_TableRef::cast_from(oc->get_subchange()->get_new_value()),
+                                            oc->get_subchange()->get_subchange().get(),
+                                            generator._separate_foreign_keys ? EverythingButForeignKeys : Everything);
           } break;
           default:
             break;
         }
-      }
+      });
 
       if (_separate_foreign_keys) {
         // 2nd pass, do FKs only
-        for (grt::ChangeSet::const_iterator e2 = tables_cs->end(), jt = tables_cs->begin(); jt != e2; jt++) {
-          const grt::DiffChange *table_change = jt->get();
+        generate_each(table_changes, [](DiffSQLGeneratorBE &generator, const grt::DiffChange *table_change) {
           switch (table_change->get_change_type()) {
             case grt::ListItemAdded:
             case grt::ListItemRemoved:
               break;
             case grt::ListItemModified:
-              generate_alter_stmt(db_mysql_TableRef::cast_from(
-                                    static_cast<const grt::ListItemModifiedChange *>(table_change)->get_new_value()),
-                                  static_cast<const grt::ListItemModifiedChange *>(table_change)->get_subchange().get(),
-                                  OnlyForeignKeys); // FK only
+              generator.generate_alter_stmt(
+                db_mysql_TableRef::cast_from(
+                  static_cast<const grt::ListItemModifiedChange *>(table_change)->get_new_value()),
+                static_cast<const grt::ListItemModifiedChange *>(table_change)->get_subchange().get(),
+                OnlyForeignKeys); // FK only
               break;
             case grt::ListItemOrderChanged: {
               const grt::ListItemOrderChange *oc = static_cast<const grt::ListItemOrderChange *>(table_change);
               if (oc->get_subchange())
-                generate_alter_stmt(db_mysql_TableRef::cast_from(oc->get_subchange()->get_new_value()),
-                                    oc->get_subchange()->get_subchange().get(), OnlyForeignKeys);
+                generator.generate_alter_stmt(db_mysql_TableRef::cast_from(oc->get_subchange()->get_new_value()),
+                                              oc->get_subchange()->get_subchange().get(), OnlyForeignKeys);
             } break;
             default:
               break;
           }
-        }
+        });
       }
     } else if (attr_change->get_attr_name().compare("views") == 0) {
       const grt::MultiChange *list_change = static_cast<const grt::MultiChange *>(attr_change->get_subchange().get());
@@ -1326,22 +1400,24 @@ void DiffSQLGeneratorBE::generate_alter_stmt(db_mysql_CatalogRef catalog, const
         const grt::DiffChange *objattr_subchange = objattrchange->get_subchange().get();
         if (objattr_subchange->get_change_type() == grt::ListModified) {
           const grt::MultiChange *schemata_list_change = static_cast<const grt::MultiChange *>(objattr_subchange);
-
+          std::vector<const grt::DiffChange *> schema_changes;
           for (grt::ChangeSet::const_iterator schemata_e = schemata_list_change->subchanges()->end(),
                                               schemata_it = schemata_list_change->subchanges()->begin();
-               schemata_it != schemata_e; schemata_it++) {
-            const grt::DiffChange *schema_subchange = schemata_it->get();
+               schemata_it != schemata_e; schemata_it++)
+            schema_changes.push_back(schemata_it->get());
+
+          generate_each(schema_changes, [](DiffSQLGeneratorBE &generator, const grt::DiffChange *schema_subchange) {
             switch (schema_subchange->get_change_type()) {
               case grt::ListItemAdded:
-                generate_create_stmt(db_mysql_SchemaRef::cast_from(
+                generator.generate_create_stmt(db_mysql_SchemaRef::cast_from(
                   static_cast<const grt::ListItemAddedChange *>(schema_subchange)->get_value()));
                 break;
               case grt::ListItemRemoved:
-                generate_drop_stmt(db_mysql_SchemaRef::cast_from(
+                generator.generate_drop_stmt(db_mysql_SchemaRef::cast_from(
                   static_cast<const grt::ListItemRemovedChange *>(schema_subchange)->get_value()));
                 break;
               case grt::ListItemModified:
-                generate_alter_stmt(
+                generator.generate_alter_stmt(
                   db_mysql_SchemaRef::cast_from(
                     static_cast<const grt::ListItemModifiedChange *>(schema_subchange)->get_new_value()),
                   static_cast<const grt::ListItemModifiedChange *>(schema_subchange)->get_subchange().get());
@@ -1349,13 +1425,13 @@ void DiffSQLGeneratorBE::generate_alter_stmt(db_mysql_CatalogRef catalog, const
               case grt::ListItemOrderChanged: {
                 const grt::ListItemOrderChange *oc = static_cast<const grt::ListItemOrderChange *>(schema_subchange);
                 if (oc->get_subchange())
-                  generate_alter_stmt(db_mysql_SchemaRef::cast_from(oc->get_subchange()->get_new_value()),
-                                      oc->get_subchange()->get_subchange().get());
+                  generator.generate_alter_stmt(db_mysql_SchemaRef::cast_from(oc->get_subchange()->get_new_value()),
+                                                oc->get_subchange()->get_subchange().get());
               } break;
               default:
                 break;
             }
-          }
+          });
         }
       }
     }
@@ -1376,7 +1452,8 @@ DiffSQLGeneratorBE::DiffSQLGeneratorBE(grt::DictRef options, grt::DictRef dbtrai
     _skip_fk_indexes(false),
     _case_sensitive(false),
     _use_oid_as_dict_key(false),
-    _separate_foreign_keys(true) {
+    _separate_foreign_keys(true),
+    _threads(0) {
   if (!options.is_valid())
     return;
   _case_sensitive = (dbtraits.get_int("CaseSensitive", _case_sensitive) != 0);
@@ -1388,6 +1465,7 @@ DiffSQLGeneratorBE::DiffSQLGeneratorBE(grt::DictRef options, grt::DictRef dbtrai
   _gen_create_index = (options.get_int("GenerateCreateIndex", _gen_create_index) != 0);
   _use_filtered_lists = options.get_int("UseFilteredLists", _use_filtered_lists) != 0;
   _separate_foreign_keys = options.get_int("SeparateForeignKeys", _separate_foreign_keys) != 0;
+  _threads = (size_t)std::max((ssize_t)0, options.get_int("GeneratorThreads", 0));
   cb->setOmitSchemas(options.get_int("OmitSchemas", 0) != 0);
   cb->set_gen_use(options.get_int("GenerateUse", 0) != 0);
   fill_set_from_list(grt::StringListRef::cast_from(options.get("UserFilterList", empty_list)), _filtered_users);
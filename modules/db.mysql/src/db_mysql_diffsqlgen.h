@@ -52,6 +52,7 @@
 #include "grtpp_module_cpp.h"
 #include "grts/structs.db.mysql.h"
 
+#include <functional>
 #include <set>
 
 namespace grt {
@@ -96,6 +97,7 @@ class DiffSQLGeneratorBE {
   bool _case_sensitive;
   bool _use_oid_as_dict_key;
   bool _separate_foreign_keys;
+  size_t _threads;
   std::set<std::string> _filtered_schemata, _filtered_tables, _filtered_views, _filtered_routines, _filtered_triggers,
     _filtered_users;
 
@@ -177,6 +179,14 @@ class DiffSQLGeneratorBE {
 
   void process_trigger_alter_stmts(db_mysql_TableRef table, const grt::DiffChange *triggers_cs);
 
+  /**
+   * Calls generate for each of the given changes. Big change lists are spread over several threads, each item
+   * generating into its own clone of the call-back. The clones are replayed in list order afterwards, so the
+   * output is the same as when generating sequentially.
+   */
+  void generate_each(const std::vector<const grt::DiffChange *> &changes,
+                     const std::function<void(DiffSQLGeneratorBE &, const grt::DiffChange *)> &generate);
+
   void do_process_diff_change(grt::ValueRef org_object, grt::DiffChange *);
 
 public:
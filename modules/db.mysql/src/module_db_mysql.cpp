@@ -26,6 +26,8 @@
 #include <stdio.h>
 #endif
 
+#include <errno.h>
+
 #include "base/sqlstring.h"
 
 #include "grt/grt_manager.h"
@@ -43,6 +45,7 @@
 #include "base/sqlstring.h"
 #include "base/util_functions.h"
 #include "base/file_utilities.h"
+#include "base/file_functions.h"
 
 #include "grtsqlparser/sql_specifics.h"
 #include "sqlide/recordset_table_inserts_storage.h"
@@ -284,8 +287,21 @@ namespace {
     grt::ListRef<GrtNamedObject> target_object_list;
     bool disable_object_list;
 
+    // Output of a clone, kept until it's replayed into the generator it was cloned from.
+    struct RecordedSQL {
+      GrtNamedObjectRef object;
+      std::string sql;
+      bool front;
+      bool alter;
+    };
+    bool _recording;
+    std::vector<RecordedSQL> _recorded;
+
     void remember_alter(const GrtNamedObjectRef& obj, const std::string& sql);
     void remember(const GrtNamedObjectRef& obj, const std::string& sql, const bool front = false);
+    void store_alter(const GrtNamedObjectRef& obj, const std::string& sql);
+    bool was_remembered(const GrtNamedObjectRef& obj);
+    void store(const GrtNamedObjectRef& obj, const std::string& sql, const bool front);
 
     void alter_table_property(std::string& to, const std::string& name, const std::string& value);
 
@@ -421,11 +437,14 @@ namespace {
     virtual void disable_list_insert(const bool flag) {
       disable_object_list = flag;
     };
+
+    virtual DiffSQLGeneratorBEActionInterface* clone() const;
+    virtual void replay(DiffSQLGeneratorBEActionInterface* clone);
   };
 
   ActionGenerateSQL::ActionGenerateSQL(grt::ValueRef target, grt::ListRef<GrtNamedObject> obj_list,
                                        const grt::DictRef options, bool use_oids_as_key = false)
-    : padding(2), _use_oids_as_dict_key(use_oids_as_key), disable_object_list(false) {
+    : padding(2), _use_oids_as_dict_key(use_oids_as_key), disable_object_list(false), _recording(false) {
     first_column = false;
     first_change = false;
     empty_length = 0;
@@ -1188,6 +1207,7 @@ namespace {
   }
 
   void ActionGenerateSQL::alter_table_indexes_begin(db_mysql_TableRef) {
+    indexAlter.clear();
   }
 
   void ActionGenerateSQL::alter_table_add_index(db_mysql_IndexRef index) {
@@ -1418,17 +1438,7 @@ namespace {
       db_mysql_TriggerRef preceding = find_ordering_for_trigger(trigger, position);
       if (preceding.is_valid()) {
         // check if the remember() at the end of this method was called for the "preceding" object
-        bool flag = false;
-        if (target_list.is_valid()) {
-          if (target_object_list.get_index(preceding) != grt::BaseListRef::npos)
-            flag = true;
-        } else {
-          if (target_map
-                .get(_use_oids_as_dict_key ? preceding.id() : get_full_object_name_for_key(preceding, _case_sensitive))
-                .is_valid())
-            flag = true;
-        }
-        if (!flag) {
+        if (!was_remembered(preceding)) {
           trigger_definition = "CREATE";
           if (!trigger->definer().empty()) {
             std::string definer = trigger->definer();
@@ -1616,10 +1626,75 @@ namespace {
     remember(user, sql);
   }
 
+  DiffSQLGeneratorBEActionInterface* ActionGenerateSQL::clone() const {
+    // The engine list is loaded lazily, do that here so clones running on other threads only read it.
+    bec::TableHelper::get_engine_by_name("");
+
+    ActionGenerateSQL* copy = new ActionGenerateSQL(*this);
+    copy->_recording = true;
+    copy->_recorded.clear();
+    return copy;
+  }
+
+  void ActionGenerateSQL::replay(DiffSQLGeneratorBEActionInterface* clone) {
+    ActionGenerateSQL* recorder = static_cast<ActionGenerateSQL*>(clone);
+    for (std::vector<RecordedSQL>::const_iterator it = recorder->_recorded.begin(); it != recorder->_recorded.end();
+         ++it) {
+      if (it->alter)
+        store_alter(it->object, it->sql);
+      else
+        store(it->object, it->sql, it->front);
+    }
+    recorder->_recorded.clear();
+  }
+
   void ActionGenerateSQL::remember(const GrtNamedObjectRef& obj, const std::string& sql, const bool front) {
+    if (target_list.is_valid() && disable_object_list)
+      return;
+    if (_recording) {
+      RecordedSQL recorded = {obj, sql, front, false};
+      _recorded.push_back(recorded);
+    } else
+      store(obj, sql, front);
+  }
+
+  // in case of ALTERs there could be > 1 statement to remember
+  // so we use grt::StringListRefs as needed
+  void ActionGenerateSQL::remember_alter(const GrtNamedObjectRef& obj, const std::string& sql) {
+    if (target_list.is_valid() && disable_object_list)
+      return;
+    if (_recording) {
+      RecordedSQL recorded = {obj, sql, false, true};
+      _recorded.push_back(recorded);
+    } else
+      store_alter(obj, sql);
+  }
+
+  // Tells if remember() was called for the object. A clone must also look at what it recorded itself, as that
+  // is only added to the output containers when the clone is replayed.
+  bool ActionGenerateSQL::was_remembered(const GrtNamedObjectRef& obj) {
+    if (target_list.is_valid()) {
+      if (target_object_list.get_index(obj) != grt::BaseListRef::npos)
+        return true;
+      for (std::vector<RecordedSQL>::const_iterator it = _recorded.begin(); it != _recorded.end(); ++it) {
+        if (it->object.valueptr() == obj.valueptr())
+          return true;
+      }
+      return false;
+    }
+
+    std::string key = _use_oids_as_dict_key ? obj.id() : get_full_object_name_for_key(obj, _case_sensitive);
+    if (target_map.get(key).is_valid())
+      return true;
+    for (std::vector<RecordedSQL>::const_iterator it = _recorded.begin(); it != _recorded.end(); ++it) {
+      if ((_use_oids_as_dict_key ? it->object.id() : get_full_object_name_for_key(it->object, _case_sensitive)) == key)
+        return true;
+    }
+    return false;
+  }
+
+  void ActionGenerateSQL::store(const GrtNamedObjectRef& obj, const std::string& sql, const bool front) {
     if (target_list.is_valid()) {
-      if (disable_object_list)
-        return;
       target_list.insert(grt::StringRef(sql), front ? 0 : (size_t)StringListRef::npos);
       if (target_object_list.is_valid())
         target_object_list.insert(obj, front ? 0 : (size_t)StringListRef::npos);
@@ -1629,12 +1704,8 @@ namespace {
     }
   }
 
-  // in case of ALTERs there could be > 1 statement to remember
-  // so we use grt::StringListRefs as needed
-  void ActionGenerateSQL::remember_alter(const GrtNamedObjectRef& obj, const std::string& sql) {
+  void ActionGenerateSQL::store_alter(const GrtNamedObjectRef& obj, const std::string& sql) {
     if (target_list.is_valid()) {
-      if (disable_object_list)
-        return;
       target_list.insert(grt::StringRef(sql));
       if (target_object_list.is_valid())
         target_object_list.insert(obj);
@@ -1798,6 +1869,109 @@ public:
   }
 };
 
+/**
+ * Destination of a composed script. Composers hand over the script piecewise and in final order, so a sink
+ * can pass it on (e.g. to a file) without the whole script ever being kept in memory.
+ */
+class SQLScriptSink {
+public:
+  virtual ~SQLScriptSink() {
+  }
+
+  SQLScriptSink& append(const std::string& sql) {
+    write(sql);
+    return *this;
+  }
+
+protected:
+  virtual void write(const std::string& sql) = 0;
+};
+
+class StringScriptSink : public SQLScriptSink {
+  std::string& _script;
+
+public:
+  StringScriptSink(std::string& script) : _script(script) {
+  }
+
+protected:
+  virtual void write(const std::string& sql) {
+    _script.append(sql);
+  }
+};
+
+/**
+ * Buffered file output. Progress is reported in bytes written, relative to the expected script size.
+ * The script is written to a temporary file next to the destination, which replaces the destination only once it
+ * was closed successfully. A failed or cancelled export leaves an existing script file untouched.
+ */
+class FileScriptSink : public SQLScriptSink {
+  static const size_t BUFFER_SIZE = 1024 * 1024;
+
+  std::string _path;
+  std::string _temp_path;
+  FILE* _file;
+  std::string _buffer;
+  size_t _written;
+  size_t _expected_size;
+  bool _complete;
+
+  void flush() {
+    if (_buffer.empty())
+      return;
+    if (fwrite(_buffer.data(), 1, _buffer.size(), _file) != _buffer.size())
+      throw std::runtime_error(base::strfmt("Error writing to %s: %s", _temp_path.c_str(), g_strerror(errno)));
+    _written += _buffer.size();
+    _buffer.clear();
+
+    float progress = _expected_size > _written ? (float)_written / _expected_size : 1.0f;
+    grt::GRT::get()->send_progress(progress, base::strfmt("Writing script (%s bytes written)",
+                                                          std::to_string(_written).c_str()));
+  }
+
+public:
+  FileScriptSink(const std::string& path, size_t expected_size)
+    : _path(path), _temp_path(path + ".tmp"), _written(0), _expected_size(expected_size), _complete(false) {
+    _file = base_fopen(_temp_path.c_str(), "wb");
+    if (_file == nullptr)
+      throw std::runtime_error(
+        base::strfmt("Could not open %s for writing: %s", _temp_path.c_str(), g_strerror(errno)));
+    _buffer.reserve(BUFFER_SIZE);
+  }
+
+  virtual ~FileScriptSink() {
+    if (_file != nullptr)
+      fclose(_file);
+    if (!_complete)
+      base_remove(_temp_path);
+  }
+
+  size_t close() {
+    flush();
+    int result = fclose(_file);
+    _file = nullptr;
+    if (result != 0)
+      throw std::runtime_error(base::strfmt("Error writing to %s: %s", _temp_path.c_str(), g_strerror(errno)));
+
+#ifdef _WIN32
+    // rename() doesn't replace existing files on Windows.
+    base_remove(_path);
+#endif
+    if (base_rename(_temp_path.c_str(), _path.c_str()) != 0)
+      throw std::runtime_error(base::strfmt("Could not rename %s to %s: %s", _temp_path.c_str(), _path.c_str(),
+                                            g_strerror(errno)));
+    _complete = true;
+    return _written;
+  }
+
+protected:
+  virtual void write(const std::string& sql) {
+    _buffer.append(sql);
+    if (_buffer.size() >= BUFFER_SIZE)
+      flush();
+  }
+};
+
 class SQLComposer {
 protected:
   std::string sql_mode;
@@ -2237,11 +2411,36 @@ protected:
     return result;
   }
 
+  void user_scripts_sql(const db_mysql_CatalogRef cat, const std::string& position, SQLScriptSink& out_sql) const {
+    if (include_scripts && cat->owner().is_valid()) {
+      GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script) {
+        if ((*script)->forwardEngineerScriptPosition() == position)
+          out_sql.append(user_script(*script));
+      }
+    }
+  }
+
 public:
   std::string get_export_sql(const db_mysql_CatalogRef cat) {
-    std::string out_sql;
-    std::string inserts_sql;  // separate from main sql script & append to it as a last step,
-                              // to separate creation of structures from data loading.
+    std::string script;
+    StringScriptSink sink(script);
+    write_export_sql(cat, sink);
+    return script;
+  }
+
+  size_t expected_size() const {
+    size_t size = 0;
+    for (grt::DictRef::const_iterator it = create_map.begin(); it != create_map.end(); ++it)
+      if (grt::StringRef::can_wrap(it->second))
+        size += (*grt::StringRef::cast_from(it->second)).size();
+    for (grt::DictRef::const_iterator it = drop_map.begin(); it != drop_map.end(); ++it)
+      if (grt::StringRef::can_wrap(it->second))
+        size += (*grt::StringRef::cast_from(it->second)).size();
+    return size;
+  }
+
+  void write_export_sql(const db_mysql_CatalogRef cat, SQLScriptSink& out_sql) {
+    std::vector<db_mysql_TableRef> insert_tables; // Data goes after all structures, it's generated when written.
     std::string triggers_sql; // Triggers DDLs could be prior or after INSERTs depending on settings
 
     out_sql.append("-- MySQL Workbench Forward Engineering").append("\n");
@@ -2306,11 +2505,8 @@ public:
           continue;
         if (exists_in_map(table, create_map, caseSensitive)) {
           out_sql.append(table_sql(table));
-          if (gen_inserts) {
-            std::string tmp = table_inserts_sql(table);
-            if (!tmp.empty())
-              inserts_sql.append(tmp).append("\n");
-          }
+          if (gen_inserts)
+            insert_tables.push_back(table);
         } // process table
 
         // Fill triggers_sql with triggers DDLs and append it to out_sql later
@@ -2378,23 +2574,22 @@ public:
     if (!no_FK_for_inserts)
       out_sql.append(restore_server_vars());
 
-    if (gen_inserts && !inserts_sql.empty()) {
-      if (include_scripts && cat->owner().is_valid()) {
-        GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script) {
-          if ((*script)->forwardEngineerScriptPosition() == "before_inserts")
-            out_sql.append(user_script(*script));
-        }
-      }
-
-      out_sql.append(inserts_sql);
+    // separate from main sql script & append to it as a last step,
+    // to separate creation of structures from data loading.
+    bool wrote_inserts = false;
+    for (std::vector<db_mysql_TableRef>::const_iterator It = insert_tables.begin(); It != insert_tables.end(); ++It) {
+      std::string table_inserts = table_inserts_sql(*It);
+      if (table_inserts.empty())
+        continue;
 
-      if (include_scripts && cat->owner().is_valid()) {
-        GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script) {
-          if ((*script)->forwardEngineerScriptPosition() == "after_inserts")
-            out_sql.append(user_script(*script));
-        }
+      if (!wrote_inserts) {
+        user_scripts_sql(cat, "before_inserts", out_sql);
+        wrote_inserts = true;
       }
+      out_sql.append(table_inserts).append("\n");
     }
+    if (wrote_inserts)
+      user_scripts_sql(cat, "after_inserts", out_sql);
 
     if (triggers_after_inserts)
       out_sql.append(triggers_sql);
@@ -2414,8 +2609,6 @@ public:
           out_sql.append(user_script(*script));
       }
     }
-
-    return out_sql;
   }
 };
 
@@ -2427,6 +2620,19 @@ ssize_t DbMySQLImpl::makeSQLExportScript(GrtNamedObjectRef dbobject, grt::DictRe
 
   db_mysql_CatalogRef catalog = db_mysql_CatalogRef::cast_from(dbobject);
   SQLExportComposer composer(options, createSQL, dropSQL);
+
+  // With an output file the script is streamed there (after the header), instead of being returned.
+  std::string output_file = options.get_string("OutputFile");
+  if (!output_file.empty()) {
+    std::string header = options.get_string("OutputScriptHeader");
+    FileScriptSink sink(output_file, header.size() + composer.expected_size());
+    sink.append(header);
+    composer.write_export_sql(catalog, sink);
+    options.set("OutputScriptSize", grt::IntegerRef((ssize_t)sink.close()));
+    options.set("OutputScript", grt::StringRef(""));
+    return 0;
+  }
+
   options.set("OutputScript", grt::StringRef(composer.get_export_sql(catalog)));
   return 0;
 }
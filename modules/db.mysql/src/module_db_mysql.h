@@ -198,6 +198,13 @@ public:
   virtual void alter_schema_default_collate(db_mysql_SchemaRef, grt::StringRef value) = 0;
   virtual void alter_schema_props_end(db_mysql_SchemaRef) = 0;
   virtual void disable_list_insert(const bool flag) = 0;
+
+  // Parallel generation: clone() returns a copy that records its output instead of storing it (or nullptr if the
+  // call-back must run sequentially), replay() stores the output recorded by such a copy.
+  virtual DiffSQLGeneratorBEActionInterface* clone() const {
+    return nullptr;
+  };
+  virtual void replay(DiffSQLGeneratorBEActionInterface*){};
 };
 
 #define DOC_DbMySQLImpl                                          \
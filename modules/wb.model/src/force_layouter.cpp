@@ -0,0 +1,546 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "force_layouter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <thread>
+
+// A level of the coarsening hierarchy. Level 0 holds the figures, each following level merges pairs of nodes from
+// the level before.
+struct ForceLayouter::Level {
+  std::vector<double> x;      // Node centers.
+  std::vector<double> y;
+  std::vector<double> radius; // Half the side of a square with the node's area.
+  std::vector<std::vector<std::pair<std::size_t, double>>> links; // Linked nodes with edge weights.
+  std::vector<std::size_t> parent; // Node in the next coarser level.
+
+  std::size_t size() const {
+    return radius.size();
+  }
+};
+
+namespace {
+
+  // Nodes are bucketed into square cells, so that neighbours can be found without looking at all other nodes.
+  class NodeGrid {
+  public:
+    NodeGrid(const std::vector<double> &x, const std::vector<double> &y, double cell_size) : _cell_size(cell_size) {
+      _entries.reserve(x.size());
+      for (std::size_t i = 0; i < x.size(); ++i)
+        _entries.push_back({ key(cell(x[i]), cell(y[i])), i });
+      std::sort(_entries.begin(), _entries.end());
+    }
+
+    // Calls function(j) for all nodes in the 3x3 cells around the given position, in a fixed order.
+    template <typename Function>
+    void for_each_near(double x, double y, Function function) const {
+      const int64_t cx = cell(x);
+      const int64_t cy = cell(y);
+      for (int64_t row = cy - 1; row <= cy + 1; ++row) {
+        auto iterator = std::lower_bound(_entries.begin(), _entries.end(), std::make_pair(key(cx - 1, row), (std::size_t)0));
+        const int64_t last = key(cx + 1, row);
+        for (; iterator != _entries.end() && iterator->first <= last; ++iterator)
+          function(iterator->second);
+      }
+    }
+
+  private:
+    int64_t cell(double value) const {
+      return (int64_t)std::floor(value / _cell_size);
+    }
+
+    // Rows are far enough apart that the cells of a row form a contiguous key range.
+    static int64_t key(int64_t column, int64_t row) {
+      return row * (int64_t(1) << 32) + column;
+    }
+
+    double _cell_size;
+    std::vector<std::pair<int64_t, std::size_t>> _entries;
+  };
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ForceLayouter::ForceLayouter(double width, double height, unsigned int seed)
+  : _width(width), _height(height), _seed(seed), _thread_count(0), _min_dist(80) {
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::size_t ForceLayouter::add_node(double width, double height) {
+  _nodes.push_back({ 0, 0, width, height });
+  return _nodes.size() - 1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ForceLayouter::connect(std::size_t node1, std::size_t node2) {
+  if (node1 != node2 && node1 < _nodes.size() && node2 < _nodes.size())
+    _edges.push_back({ std::min(node1, node2), std::max(node1, node2) });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ForceLayouter::set_thread_count(unsigned int count) {
+  _thread_count = count;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::size_t ForceLayouter::node_count() const {
+  return _nodes.size();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+const ForceLayouter::Node &ForceLayouter::node(std::size_t index) const {
+  return _nodes[index];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Runs function(i) for all i < count, spread over the worker threads. Each call must only write data for its own i.
+ */
+template <typename Function>
+void ForceLayouter::for_each_node(std::size_t count, Function function) {
+  static const std::size_t chunk_size = 64;
+
+  std::size_t thread_count = _thread_count;
+  if (thread_count == 0)
+    thread_count = std::max(1U, std::thread::hardware_concurrency());
+  thread_count = std::min(thread_count, (count + chunk_size - 1) / chunk_size);
+
+  if (thread_count <= 1) {
+    for (std::size_t i = 0; i < count; ++i)
+      function(i);
+    return;
+  }
+
+  std::atomic<std::size_t> next(0);
+  auto worker = [&]() {
+    for (std::size_t start = next.fetch_add(chunk_size); start < count; start = next.fetch_add(chunk_size)) {
+      std::size_t end = std::min(count, start + chunk_size);
+      for (std::size_t i = start; i < end; ++i)
+        function(i);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t i = 1; i < thread_count; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (auto &thread : threads)
+    thread.join();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Builds coarser levels until the graph is small or doesn't shrink anymore. Each node is merged with its unmatched
+ * neighbour of smallest area (nodes with few links first), unconnected nodes are merged with each other.
+ */
+void ForceLayouter::coarsen(std::vector<Level> &levels) {
+  static const std::size_t min_size = 30;
+  static const std::size_t max_levels = 30;
+
+  while (levels.back().size() > min_size && levels.size() < max_levels) {
+    Level &level = levels.back();
+    const std::size_t count = level.size();
+
+    std::vector<std::size_t> order(count);
+    for (std::size_t i = 0; i < count; ++i)
+      order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+      return level.links[a].size() < level.links[b].size();
+    });
+
+    const std::size_t unmatched = std::numeric_limits<std::size_t>::max();
+    level.parent.assign(count, unmatched);
+    std::size_t coarse_count = 0;
+    std::size_t waiting = unmatched; // An unconnected node still looking for a partner.
+    for (std::size_t i : order) {
+      if (level.parent[i] != unmatched)
+        continue;
+
+      std::size_t partner = unmatched;
+      if (level.links[i].empty()) {
+        if (waiting == unmatched) {
+          waiting = i;
+          continue;
+        }
+        partner = waiting;
+        waiting = unmatched;
+      } else {
+        for (auto &link : level.links[i]) {
+          if (level.parent[link.first] == unmatched &&
+              (partner == unmatched || level.radius[link.first] < level.radius[partner]))
+            partner = link.first;
+        }
+      }
+
+      level.parent[i] = coarse_count;
+      if (partner != unmatched)
+        level.parent[partner] = coarse_count;
+      ++coarse_count;
+    }
+    if (waiting != unmatched)
+      level.parent[waiting] = coarse_count++;
+
+    if (coarse_count > count * 9 / 10) {
+      level.parent.clear();
+      break;
+    }
+
+    Level coarse;
+    coarse.radius.assign(coarse_count, 0);
+    for (std::size_t i = 0; i < count; ++i)
+      coarse.radius[level.parent[i]] += level.radius[i] * level.radius[i];
+    for (auto &radius : coarse.radius)
+      radius = std::sqrt(radius);
+
+    // Combine the links between merged nodes, summing up their weights.
+    std::vector<std::pair<std::pair<std::size_t, std::size_t>, double>> edges;
+    for (std::size_t i = 0; i < count; ++i) {
+      for (auto &link : level.links[i]) {
+        std::size_t a = level.parent[i];
+        std::size_t b = level.parent[link.first];
+        if (a != b)
+          edges.push_back({ { a, b }, link.second });
+      }
+    }
+    std::sort(edges.begin(), edges.end());
+    coarse.links.resize(coarse_count);
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+      auto &links = coarse.links[edges[i].first.first];
+      if (!links.empty() && links.back().first == edges[i].first.second && i > 0 &&
+          edges[i - 1].first == edges[i].first)
+        links.back().second += edges[i].second;
+      else
+        links.push_back({ edges[i].first.second, edges[i].second });
+    }
+
+    levels.push_back(std::move(coarse));
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ForceLayouter::place_coarsest(Level &level) {
+  std::mt19937 random(_seed);
+
+  double area = 0;
+  for (double radius : level.radius)
+    area += (2 * radius + _min_dist) * (2 * radius + _min_dist);
+  std::uniform_real_distribution<double> position(0, std::sqrt(area));
+
+  level.x.resize(level.size());
+  level.y.resize(level.size());
+  for (std::size_t i = 0; i < level.size(); ++i) {
+    level.x[i] = position(random);
+    level.y[i] = position(random);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ForceLayouter::place_from_parent(const Level &parent, Level &level) {
+  std::mt19937 random(_seed + (unsigned int)level.size());
+  std::uniform_real_distribution<double> offset(-0.5, 0.5);
+
+  level.x.resize(level.size());
+  level.y.resize(level.size());
+  for (std::size_t i = 0; i < level.size(); ++i) {
+    std::size_t p = level.parent[i];
+    level.x[i] = parent.x[p] + offset(random) * parent.radius[p];
+    level.y[i] = parent.y[p] + offset(random) * parent.radius[p];
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Fruchterman-Reingold style iterations. Nodes repel each other within twice their desired distance (the sum of their
+ * radii plus _min_dist), linked nodes attract each other and a weak gravity keeps unconnected parts together.
+ */
+void ForceLayouter::run_forces(Level &level) {
+  static const double gravity = 0.005;
+  static const double cooling = 0.92;
+
+  const std::size_t count = level.size();
+  if (count < 2)
+    return;
+
+  double max_radius = 0;
+  double mean_radius = 0;
+  for (double radius : level.radius) {
+    max_radius = std::max(max_radius, radius);
+    mean_radius += radius;
+  }
+  mean_radius /= count;
+  const double cell_size = 2 * (2 * max_radius + _min_dist);
+
+  std::vector<double> dx(count), dy(count);
+  double temperature = level.parent.empty() ? std::sqrt((double)count) * (2 * mean_radius + _min_dist)
+                                            : 2 * mean_radius + _min_dist;
+  const double min_temperature = 1;
+
+  while (temperature > min_temperature) {
+    double center_x = 0, center_y = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      center_x += level.x[i];
+      center_y += level.y[i];
+    }
+    center_x /= count;
+    center_y /= count;
+
+    NodeGrid grid(level.x, level.y, cell_size);
+    for_each_node(count, [&](std::size_t i) {
+      double fx = 0, fy = 0;
+      const double x = level.x[i], y = level.y[i];
+
+      grid.for_each_near(x, y, [&](std::size_t j) {
+        if (i == j)
+          return;
+        const double desired = level.radius[i] + level.radius[j] + _min_dist;
+        double ddx = x - level.x[j], ddy = y - level.y[j];
+        double distance2 = ddx * ddx + ddy * ddy;
+        if (distance2 >= 4 * desired * desired)
+          return;
+        if (distance2 < 1e-6) {
+          // Coinciding nodes: separate them in a direction derived from their indexes.
+          ddx = i < j ? -1.0 : 1.0;
+          ddy = (double)((i + j) % 3) - 1.0;
+          distance2 = ddx * ddx + ddy * ddy;
+        }
+        const double force = desired * desired / distance2;
+        fx += ddx * force;
+        fy += ddy * force;
+      });
+
+      for (auto &link : level.links[i]) {
+        const std::size_t j = link.first;
+        const double desired = level.radius[i] + level.radius[j] + _min_dist;
+        const double ddx = level.x[j] - x, ddy = level.y[j] - y;
+        const double force = link.second * std::sqrt(ddx * ddx + ddy * ddy) / desired;
+        fx += ddx * force;
+        fy += ddy * force;
+      }
+
+      fx += (center_x - x) * gravity;
+      fy += (center_y - y) * gravity;
+
+      const double length = std::sqrt(fx * fx + fy * fy);
+      const double scale = length > temperature ? temperature / length : 1.0;
+      dx[i] = fx * scale;
+      dy[i] = fy * scale;
+    });
+
+    for (std::size_t i = 0; i < count; ++i) {
+      level.x[i] += dx[i];
+      level.y[i] += dy[i];
+    }
+    temperature *= cooling;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Forces produce a roughly round layout. Stretch it (keeping its area) to the proportions of the layout area,
+ * which is usually wider than high.
+ */
+void ForceLayouter::match_aspect_ratio(Level &level) {
+  if (level.size() < 2 || _width <= 0 || _height <= 0)
+    return;
+
+  double left = *std::min_element(level.x.begin(), level.x.end());
+  double right = *std::max_element(level.x.begin(), level.x.end());
+  double top = *std::min_element(level.y.begin(), level.y.end());
+  double bottom = *std::max_element(level.y.begin(), level.y.end());
+  if (right - left < 1 || bottom - top < 1)
+    return;
+
+  const double factor = std::sqrt((_width / _height) / ((right - left) / (bottom - top)));
+  for (std::size_t i = 0; i < level.size(); ++i) {
+    level.x[i] *= factor;
+    level.y[i] /= factor;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Pushes overlapping figures apart along the axis with the smaller overlap, until there's no overlap left
+ * (including a margin). If that doesn't work out within a number of passes the figures are too crowded,
+ * so the whole layout is spread a bit before trying again.
+ */
+void ForceLayouter::remove_overlaps() {
+  static const double margin = 20;
+  static const int max_passes = 50;
+  static const int max_rounds = 10;
+  static const double spread = 1.2;
+
+  const std::size_t count = _nodes.size();
+  double cell_size = 0;
+  for (auto &node : _nodes)
+    cell_size = std::max(cell_size, std::max(node.width, node.height) + margin);
+
+  std::vector<double> x(count), y(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    x[i] = _nodes[i].left + _nodes[i].width / 2;
+    y[i] = _nodes[i].top + _nodes[i].height / 2;
+  }
+
+  for (int round = 0; round < max_rounds; ++round) {
+    bool moved = true;
+    for (int pass = 0; moved && pass < max_passes; ++pass) {
+      moved = false;
+      NodeGrid grid(x, y, cell_size);
+      for (std::size_t i = 0; i < count; ++i) {
+        grid.for_each_near(x[i], y[i], [&](std::size_t j) {
+          if (j <= i)
+            return;
+          const double overlap_x = (_nodes[i].width + _nodes[j].width) / 2 + margin - std::fabs(x[j] - x[i]);
+          const double overlap_y = (_nodes[i].height + _nodes[j].height) / 2 + margin - std::fabs(y[j] - y[i]);
+          if (overlap_x < 0.5 || overlap_y < 0.5) // Ignore rounding errors of earlier pushes.
+            return;
+
+          if (overlap_x < overlap_y) {
+            const double shift = (x[j] >= x[i] ? overlap_x : -overlap_x) / 2;
+            x[i] -= shift;
+            x[j] += shift;
+          } else {
+            const double shift = (y[j] >= y[i] ? overlap_y : -overlap_y) / 2;
+            y[i] -= shift;
+            y[j] += shift;
+          }
+          moved = true;
+        });
+      }
+    }
+
+    if (!moved)
+      break;
+
+    double center_x = 0, center_y = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      center_x += x[i];
+      center_y += y[i];
+    }
+    center_x /= count;
+    center_y /= count;
+    for (std::size_t i = 0; i < count; ++i) {
+      x[i] = center_x + (x[i] - center_x) * spread;
+      y[i] = center_y + (y[i] - center_y) * spread;
+    }
+  }
+
+  for (std::size_t i = 0; i < count; ++i) {
+    _nodes[i].left = x[i] - _nodes[i].width / 2;
+    _nodes[i].top = y[i] - _nodes[i].height / 2;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Moves the layout to the top left corner of the layout area. If it is too large for the area it is compressed
+ * (as long as figures stay on the area) and overlaps are removed again.
+ */
+void ForceLayouter::fit_into_area() {
+  static const double margin = 20;
+
+  for (int round = 0; round < 2; ++round) {
+    double left = std::numeric_limits<double>::max(), top = left;
+    double right = -left, bottom = -left;
+    for (auto &node : _nodes) {
+      left = std::min(left, node.left);
+      top = std::min(top, node.top);
+      right = std::max(right, node.left + node.width);
+      bottom = std::max(bottom, node.top + node.height);
+    }
+
+    double scale_x = 1, scale_y = 1;
+    if (round == 0) {
+      if (right - left > _width - 2 * margin)
+        scale_x = std::max(0.0, _width - 2 * margin) / (right - left);
+      if (bottom - top > _height - 2 * margin)
+        scale_y = std::max(0.0, _height - 2 * margin) / (bottom - top);
+    }
+
+    for (auto &node : _nodes) {
+      node.left = margin + (node.left - left) * scale_x;
+      node.top = margin + (node.top - top) * scale_y;
+    }
+
+    if (scale_x == 1 && scale_y == 1)
+      break;
+    remove_overlaps();
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ForceLayouter::do_layout() {
+  if (_nodes.empty())
+    return;
+
+  std::vector<Level> levels(1);
+  Level &figures = levels[0];
+  for (auto &node : _nodes)
+    figures.radius.push_back(std::sqrt(node.width * node.height) / 2);
+
+  std::vector<std::pair<std::size_t, std::size_t>> edges(_edges);
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+  figures.links.resize(_nodes.size());
+  for (auto &edge : edges) {
+    figures.links[edge.first].push_back({ edge.second, 1.0 });
+    figures.links[edge.second].push_back({ edge.first, 1.0 });
+  }
+
+  coarsen(levels);
+
+  place_coarsest(levels.back());
+  run_forces(levels.back());
+  for (std::size_t i = levels.size() - 1; i > 0; --i) {
+    place_from_parent(levels[i], levels[i - 1]);
+    run_forces(levels[i - 1]);
+  }
+
+  match_aspect_ratio(levels[0]);
+  for (std::size_t i = 0; i < _nodes.size(); ++i) {
+    _nodes[i].left = levels[0].x[i] - _nodes[i].width / 2;
+    _nodes[i].top = levels[0].y[i] - _nodes[i].height / 2;
+  }
+
+  remove_overlaps();
+  fit_into_area();
+}
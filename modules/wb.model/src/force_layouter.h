@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include "wb_model_public_interface.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Force directed layout for EER diagrams, made for diagrams with hundreds or thousands of figures.
+ *
+ * The graph is repeatedly coarsened by merging connected figures, the smallest graph is laid out and each finer
+ * level starts from the positions of the level above. On each level figures repel their neighbours (found through
+ * a grid of buckets instead of comparing all pairs) and connected figures attract each other. Finally overlapping
+ * figures are pushed apart.
+ *
+ * Forces for all figures are computed on worker threads from the positions of the previous step, so the result
+ * only depends on the input and the seed, not on the number of threads.
+ */
+class WB_MODEL_WBM_PUBLIC_FUNC ForceLayouter {
+public:
+  struct Node {
+    double left;
+    double top;
+    double width;
+    double height;
+  };
+
+  ForceLayouter(double width, double height, unsigned int seed = 1);
+
+  std::size_t add_node(double width, double height);
+  void connect(std::size_t node1, std::size_t node2);
+
+  // 0 uses as many threads as there are processors, 1 runs everything on the calling thread.
+  void set_thread_count(unsigned int count);
+
+  void do_layout();
+
+  std::size_t node_count() const;
+  const Node &node(std::size_t index) const;
+
+private:
+  struct Level;
+
+  void coarsen(std::vector<Level> &levels);
+  void place_coarsest(Level &level);
+  void place_from_parent(const Level &parent, Level &level);
+  void run_forces(Level &level);
+  void match_aspect_ratio(Level &level);
+  void remove_overlaps();
+  void fit_into_area();
+
+  template <typename Function>
+  void for_each_node(std::size_t count, Function function);
+
+  double _width;
+  double _height;
+  unsigned int _seed;
+  unsigned int _thread_count;
+  double _min_dist; // Desired distance between figures.
+
+  std::vector<Node> _nodes;
+  std::vector<std::pair<std::size_t, std::size_t>> _edges;
+};
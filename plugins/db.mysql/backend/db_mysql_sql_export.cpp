@@ -57,6 +57,7 @@ DbMySQLSQLExport::DbMySQLSQLExport(db_mysql_CatalogRef catalog) : DbMySQLValidat
   _gen_doc_props = false;
   _gen_attached_scripts = false;
   _sortTablesAlphabetically = false;
+  _stream_output = false;
 
   if (!_catalog.is_valid())
     _catalog = get_model_catalog(); // call own version
@@ -121,6 +122,8 @@ void DbMySQLSQLExport::set_option(const std::string &name, bool value) {
     _gen_attached_scripts = value;
   else if (name.compare("SortTablesAlphabetically") == 0)
     _sortTablesAlphabetically = value;
+  else if (name.compare("StreamOutput") == 0)
+    _stream_output = value;
 }
 
 void DbMySQLSQLExport::set_option(const std::string &name, const std::string &value) {
@@ -266,7 +269,8 @@ void DbMySQLSQLExport::start_export(bool wait_finish) {
 void DbMySQLSQLExport::export_finished(grt::ValueRef res) {
   CatalogMap cmap;
   update_all_old_names(get_model_catalog(), false, cmap);
-  logInfo("%s\n", grt::StringRef::cast_from(res).c_str());
+  _export_result = grt::StringRef::cast_from(res);
+  logInfo("%s\n", _export_result.c_str());
   if (_task_finish_cb)
     _task_finish_cb();
 }
@@ -318,10 +322,21 @@ ValueRef DbMySQLSQLExport::export_task(grt::StringRef) {
 
     options.set("SortTablesAlphabetically", grt::IntegerRef(_sortTablesAlphabetically ? 1 : 0));
 
+    // Streaming writes the script straight to the output file, it's not kept for export_sql_script().
+    bool stream = _stream_output && !_output_filename.empty();
+    if (stream)
+      options.set("OutputFile", grt::StringRef(_output_filename));
+
     if (diffsql_module->makeSQLExportScript(_catalog, options, create_map, drop_map)) {
       return grt::StringRef("\nSQL Script Export Error: SQL Script Export Module Returned Error");
     }
 
+    if (stream) {
+      _export_sql_script.clear();
+      return StringRef(base::strfmt("\nSQL Script Export Completed (%s bytes written)",
+                                    std::to_string(options.get_int("OutputScriptSize")).c_str()));
+    }
+
     _export_sql_script = options.get_string("OutputScriptHeader") + options.get_string("OutputScript");
 
     if (!_output_filename.empty()) {
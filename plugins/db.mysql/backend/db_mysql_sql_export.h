@@ -54,6 +54,7 @@ class WBPLUGINDBMYSQLBE_PUBLIC_FUNC DbMySQLSQLExport : public DbMySQLValidationP
   bool _gen_doc_props;
   bool _gen_attached_scripts;
   bool _sortTablesAlphabetically;
+  bool _stream_output; // write the script directly to the output file instead of keeping it in memory
 
   std::shared_ptr<bec::GrtStringListModel> _users_model;
   std::shared_ptr<bec::GrtStringListModel> _users_exc_model;
@@ -122,11 +123,17 @@ public:
     return _export_sql_script;
   }
 
+  // Completion or error message of the last export, the only feedback there is when the script was streamed.
+  std::string export_result() {
+    return _export_result;
+  }
+
 private:
   // Validation_finished_cb _validation_finished_cb;
   // Validation_step_finished_cb _validation_step_finished_cb;
   Task_finish_cb _task_finish_cb;
   std::string _export_sql_script;
+  std::string _export_result;
 };
 
 grt::StringListRef convert_string_vector_to_grt_list(const std::vector<std::string> &v);
@@ -121,6 +121,11 @@ public:
     _triggers_after_inserts.set_text(_("Create triggers after inserts"));
     _options_box.add(&_triggers_after_inserts, false, true);
 
+    _stream_output_check.set_text(_("Write Script Directly to the Output File, Without Review"));
+    _stream_output_check.set_tooltip(
+      _("The script is not kept in memory for the review page. Use this for large models or INSERT data."));
+    _options_box.add(&_stream_output_check, false, true);
+
     add(&_options, false, true);
 
     _generate_drop_check.set_active(form->module()->document_int_data("generate_drop", false) != 0);
@@ -135,7 +140,9 @@ public:
     _no_view_placeholders.set_active(form->module()->document_int_data("no_vew_placeholders", false) != 0);
     _generate_insert_check.set_active(form->module()->document_int_data("generate_insert", false) != 0);
     _generate_use_check.set_active(form->module()->document_int_data("generate_use", false) != 0);
+    _stream_output_check.set_active(form->module()->document_int_data("stream_output", false) != 0);
     _generate_use_check.set_enabled(_omit_schema_qualifier_check.get_active());
+    _stream_output_check.set_enabled(!initial_value.empty());
     _skip_FK_indexes_check.set_enabled(_skip_foreign_keys_check.get_active());
   }
 
@@ -148,6 +155,8 @@ public:
   }
 
   void file_changed() {
+    // Streaming needs a file to write to.
+    _stream_output_check.set_enabled(!_file_selector->get_filename().empty());
     validate();
   }
 
@@ -184,6 +193,8 @@ public:
       values().gset("TriggersAfterInserts", _triggers_after_inserts.get_active());
       values().gset("OmitSchemata", _omit_schema_qualifier_check.get_active());
       values().gset("GenerateUse", _generate_use_check.get_active());
+      values().gset("StreamOutput",
+                    _stream_output_check.get_active() && !_file_selector->get_filename().empty());
 
       grt::Module *module = ((WizardPlugin *)_form)->module();
 
@@ -200,6 +211,7 @@ public:
       module->set_document_data("no_vew_placeholders", _no_view_placeholders.get_active());
       module->set_document_data("generate_insert", _generate_insert_check.get_active());
       module->set_document_data("generate_use", _generate_use_check.get_active());
+      module->set_document_data("stream_output", _stream_output_check.get_active());
     }
   }
 
@@ -230,6 +242,7 @@ protected:
   CheckBox _triggers_after_inserts;
   CheckBox _omit_schema_qualifier_check;
   CheckBox _sortTablesAlphabeticallyCheck;
+  CheckBox _stream_output_check;
 };
 
 //--------------------------------------------------------------------------------
@@ -323,6 +336,7 @@ protected:
     _export_be->set_option("OmitSchemata", values().get_int("OmitSchemata") != 0);
     _export_be->set_option("GenerateUse", values().get_int("GenerateUse") != 0);
     _export_be->set_option("SortTablesAlphabetically", values().get_int("SortTablesAlphabetically") != 0);
+    _export_be->set_option("StreamOutput", values().get_int("StreamOutput") != 0);
 
     _export_be->set_option("TablesAreSelected", _table_filter->get_active());
     _export_be->set_option("TriggersAreSelected", _trigger_filter->get_active());
@@ -371,7 +385,30 @@ public:
   }
 
   virtual void enter(bool advancing) {
-    if (advancing) {
+    if (advancing && values().get_int("StreamOutput") != 0) {
+      // The script goes straight to the output file, there's nothing to review.
+      _label.set_text(_("Writing the script to the output file."));
+      set_editable(false);
+      _save_button.show(false);
+
+      try {
+        _export_be->start_export(true);
+
+        std::string result = base::trim(_export_be->export_result());
+        set_text(result);
+        if (base::hasPrefix(result, "SQL Script Export Completed")) {
+          _label.set_text(_("The script was written to the output file. Press Finish to close the wizard."));
+          _form->clear_problem();
+        } else
+          _form->set_problem(_("Error generating script."));
+      } catch (std::exception &exc) {
+        set_text(std::string(_("Could not generate CREATE script.")).append("\n").append(exc.what()));
+        _form->set_problem(_("Error generating script."));
+      }
+    } else if (advancing) {
+      set_editable(true);
+      _save_button.show(true);
+
       if (_export_be->get_output_filename().empty())
         _label.set_text(_("Review the generated script."));
       else
@@ -393,7 +430,9 @@ public:
   virtual bool advance() {
     std::string path = values().get_string("OutputFileName");
     if (!path.empty()) {
-      save_text_to(path);
+      // A streamed script is already in the file, the page only shows the export result.
+      if (values().get_int("StreamOutput") == 0)
+        save_text_to(path);
 
       bec::GRTManager::get()->push_status_text(base::strfmt(_("Wrote CREATE Script to '%s'"), path.c_str()));
       grt::GRT::get()->send_info(base::strfmt(_("Wrote CREATE Script to '%s'"), path.c_str()));
@@ -35,7 +35,10 @@ public:
   }
 
   bool perform_fetch(bool source) {
-    execute_grt_task(std::bind(&FetchSchemaContentsSourceTargetProgressPage::do_fetch, this, source), false);
+    // Only uses the connection of one side, so it can run in the worker pool.
+    Db_plugin *dbplugin = source ? _source_dbplugin : _target_dbplugin;
+    execute_grt_task(std::bind(&FetchSchemaContentsSourceTargetProgressPage::do_fetch, this, source), false,
+                     base::strfmt("connection:%p", dbplugin->db_conn()));
     return true;
   }
 
@@ -46,7 +46,9 @@ public:
   }
 
   bool perform_fetch() {
-    execute_grt_task(std::bind(&FetchSchemaContentsProgressPage::do_fetch, this), false);
+    // Only uses the plugin's own connection, so it can run in the worker pool.
+    execute_grt_task(std::bind(&FetchSchemaContentsProgressPage::do_fetch, this), false,
+                     base::strfmt("connection:%p", _dbplugin->db_conn()));
     return true;
   }
 
@@ -51,11 +51,15 @@ public:
   }
 
 protected:
+  // The tasks only use the connection of one side, so they can run in the worker pool, one after the other.
+  std::string ordering_key(bool source) const {
+    return base::strfmt("connection:%p", source ? _source_dbconn : _target_dbconn);
+  }
+
   bool perform_connect(bool source) {
     DbConnection *dbc = source ? _source_dbconn : _target_dbconn;
-    db_mgmt_ConnectionRef conn = dbc->get_connection();
-
-    execute_grt_task(std::bind(&FetchSchemaNamesSourceTargetProgressPage::do_connect, this, dbc), false);
+    execute_grt_task(std::bind(&FetchSchemaNamesSourceTargetProgressPage::do_connect, this, dbc), false,
+                     ordering_key(source));
 
     return true;
   }
@@ -69,7 +73,8 @@ protected:
   }
 
   bool perform_fetch(bool source) {
-    execute_grt_task(std::bind(&FetchSchemaNamesSourceTargetProgressPage::do_fetch, this, source), false);
+    execute_grt_task(std::bind(&FetchSchemaNamesSourceTargetProgressPage::do_fetch, this, source), false,
+                     ordering_key(source));
     return true;
   }
 
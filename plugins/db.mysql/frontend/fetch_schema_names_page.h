@@ -61,10 +61,13 @@ public:
   }
 
 protected:
-  bool perform_connect() {
-    db_mgmt_ConnectionRef conn = _dbconn->get_connection();
+  // The tasks only use the wizard's own connection, so they can run in the worker pool, one after the other.
+  std::string ordering_key() const {
+    return base::strfmt("connection:%p", _dbconn);
+  }
 
-    execute_grt_task(std::bind(&FetchSchemaNamesProgressPage::do_connect, this), false);
+  bool perform_connect() {
+    execute_grt_task(std::bind(&FetchSchemaNamesProgressPage::do_connect, this), false, ordering_key());
 
     return true;
   }
@@ -78,7 +81,7 @@ protected:
   }
 
   bool perform_fetch() {
-    execute_grt_task(std::bind(&FetchSchemaNamesProgressPage::do_fetch, this), false);
+    execute_grt_task(std::bind(&FetchSchemaNamesProgressPage::do_fetch, this), false, ordering_key());
     return true;
   }
 
@@ -102,7 +105,7 @@ protected:
   }
 
   bool perform_check_case() {
-    execute_grt_task(std::bind(&FetchSchemaNamesProgressPage::do_check_case, this), false);
+    execute_grt_task(std::bind(&FetchSchemaNamesProgressPage::do_check_case, this), false, ordering_key());
     return true;
   }
 
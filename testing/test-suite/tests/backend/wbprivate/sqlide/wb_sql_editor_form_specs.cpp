@@ -110,6 +110,19 @@ public:
     perform_idle_tasks();
   }
 
+  // Number of column symbols loaded for the given table, -1 if there's no symbol for the table.
+  int column_symbol_count(const std::string &schema_name, const std::string &table_name) {
+    auto schemaSymbol = dynamic_cast<parsers::SchemaSymbol *>(_form->databaseSymbols()->resolve(schema_name, true));
+    if (schemaSymbol == nullptr)
+      return -1;
+
+    for (auto table : schemaSymbol->getSymbolsOfType<parsers::TableSymbol>()) {
+      if (table->name == table_name)
+        return (int)table->getSymbolsOfType<parsers::ColumnSymbol>().size();
+    }
+    return -1;
+  }
+
   void exec_sql(std::string &sql) {
     _form->exec_sql_returning_results(sql, false);
   }
@@ -674,6 +687,39 @@ $describe("SQL Editor Form") {
     $expect(pchildData->delete_rule).toEqual(4U, "TF006CHK005 : Unexpected foreign key delete rule");
     $expect(pchildData->referenced_table).toBe("language", "TF006CHK005 : Unexpected foreign key delete rule");
   });
+
+  $it("Loads column symbols only for schemas requested by an editor.", [&]() {
+    data->form->schemaListRefreshed(data->formTester->fetch_schema_list());
+
+    // The schema content brings in the tables, but not their columns.
+    data->formTester->_expectSchemaContentArrived = true;
+    data->formTester->_checkId = "TF007CHK001";
+    data->formTester->fetch_schema_contents("wb_sql_editor_form_test");
+    data->formTester->clean_and_reset();
+
+    $expect(data->formTester->column_symbol_count("wb_sql_editor_form_test", "film")).toBe(0);
+    $expect(data->form->column_symbols_wanted("wb_sql_editor_form_test")).toBeFalse();
+
+    // Table names from table.column references are reported as well, they are not schemas and must be ignored.
+    data->form->request_column_symbols({ "wb_sql_editor_form_test", "film" });
+    $expect(data->form->column_symbols_wanted("film")).toBeFalse();
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    data->formTester->perform_idle_tasks();
+
+    $expect(data->form->column_symbols_wanted("wb_sql_editor_form_test")).toBeFalse();
+    $expect(data->formTester->column_symbol_count("wb_sql_editor_form_test", "film")).toBe(13);
+    $expect(data->formTester->column_symbol_count("wb_sql_editor_form_test", "language")).toBe(3);
+
+    // A refresh of the schema content reloads the columns that were in use.
+    data->formTester->_expectSchemaContentArrived = true;
+    data->formTester->_checkId = "TF007CHK002";
+    data->formTester->fetch_schema_contents("wb_sql_editor_form_test");
+    data->formTester->clean_and_reset();
+
+    $expect(data->form->column_symbols_wanted("wb_sql_editor_form_test")).toBeFalse();
+    $expect(data->formTester->column_symbol_count("wb_sql_editor_form_test", "film")).toBe(13);
+  });
 }
 
 }
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "grts/structs.db.mysql.h"
+#include "model/wb_catalog_tree_view.h"
+#include "wb_model_diagram_form.h"
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+
+using namespace wb;
+using namespace grt;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::unique_ptr<WorkbenchTester> tester;
+  CatalogTreeView *tree = nullptr;
+  db_SchemaRef schema;
+
+  // Objects created by a test which are not part of the schema, the tree only gets to know them by notification.
+  std::vector<db_mysql_TableRef> tables;
+
+  mforms::TreeNodeRef group(int index) {
+    return tree->root_node()->get_child(0)->get_child(index);
+  }
+
+  std::string captions(mforms::TreeNodeRef node) {
+    std::string result;
+    for (int i = 0; i < node->count(); ++i) {
+      if (i > 0)
+        result += ",";
+      result += node->get_child(i)->get_string(0);
+    }
+    return result;
+  }
+
+  db_mysql_TableRef add_table(const std::string &name) {
+    db_mysql_TableRef table(grt::Initialized);
+    table->owner(schema);
+    table->name(name);
+    tables.push_back(table);
+
+    tree->add_update_node_caption(table);
+    return table;
+  }
+
+  void rename_table(db_mysql_TableRef table, const std::string &name) {
+    table->name(name);
+    tree->add_update_node_caption(table);
+  }
+};
+
+$describe("Catalog tree") {
+  $beforeAll([this]() {
+    data->tester.reset(new WorkbenchTester());
+    data->tester->initializeRuntime();
+
+    bool flag = data->tester->wb->open_document("data/workbench/test_model1.mwb");
+    $expect(flag).toBeTrue("open_document");
+
+    data->tester->openAllDiagrams();
+    data->tester->syncView();
+
+    ModelDiagramForm *form =
+      data->tester->wb->get_model_context()->get_diagram_form_for_diagram_id(data->tester->getPview().id());
+    $expect(form).Not.toBeNull("Diagram form is invalid");
+
+    data->schema = data->tester->getCatalog()->schemata()[0];
+    data->tree = form->get_catalog_tree();
+  });
+
+  $afterAll([this]() {
+    $expect(data->tester->closeDocument()).toBeTrue("Could not close document");
+    data->tester->wb->close_document_finish();
+  });
+
+  $beforeEach([this]() {
+    data->tables.clear();
+    data->tree->refill(true);
+  });
+
+  $it("Creates the object nodes of a group only when it is expanded", [this]() {
+    $expect(data->tree->root_node()->count()).toBe(1);
+    $expect(data->tree->root_node()->get_child(0)->get_string(0)).toBe("mydb");
+
+    // Only a placeholder, so the groups can be expanded.
+    mforms::TreeNodeRef tables = data->group(0);
+    $expect(tables->count()).toBe(1);
+    $expect(tables->get_child(0)->get_string(0)).toBe("");
+    $expect(tables->get_child(0)->get_data()).toBeNull();
+    $expect(data->group(1)->count()).toBe(1);
+    $expect(data->group(2)->count()).toBe(1);
+
+    data->tree->expand_toggle(tables, true);
+    $expect(data->captions(tables)).toBe("table1,table2");
+    $expect(tables->get_child(0)->get_tag()).toBe(data->schema->tables()[0]->id());
+    $expect(tables->get_child(0)->get_data()).Not.toBeNull();
+
+    // The other groups are not affected and a second expansion doesn't add anything.
+    $expect(data->group(1)->count()).toBe(1);
+    data->tree->expand_toggle(tables, false);
+    data->tree->expand_toggle(tables, true);
+    $expect(data->captions(tables)).toBe("table1,table2");
+
+    data->tree->expand_toggle(data->group(1), true);
+    $expect(data->captions(data->group(1))).toBe("view1");
+    data->tree->expand_toggle(data->group(2), true);
+    $expect(data->captions(data->group(2))).toBe("routines1");
+  });
+
+  $it("Keeps the placeholder for objects added to a group that was not expanded yet", [this]() {
+    mforms::TreeNodeRef tables = data->group(0);
+    data->add_table("table3");
+
+    $expect(tables->count()).toBe(1);
+    $expect(tables->get_child(0)->get_string(0)).toBe("");
+  });
+
+  $it("Inserts new objects at their sorted position", [this]() {
+    mforms::TreeNodeRef tables = data->group(0);
+    data->tree->expand_toggle(tables, true);
+
+    data->add_table("alpha");
+    $expect(data->captions(tables)).toBe("alpha,table1,table2");
+
+    data->add_table("zebra");
+    $expect(data->captions(tables)).toBe("alpha,table1,table2,zebra");
+
+    data->add_table("table15");
+    $expect(data->captions(tables)).toBe("alpha,table1,table15,table2,zebra");
+
+    // The sort order ignores case.
+    data->add_table("Table16");
+    $expect(data->captions(tables)).toBe("alpha,table1,table15,Table16,table2,zebra");
+  });
+
+  $it("Moves renamed objects to their sorted position", [this]() {
+    mforms::TreeNodeRef tables = data->group(0);
+    data->tree->expand_toggle(tables, true);
+
+    db_mysql_TableRef table = data->add_table("table15");
+    data->add_table("alpha");
+    data->add_table("zebra");
+    $expect(data->captions(tables)).toBe("alpha,table1,table15,table2,zebra");
+
+    // From the middle to the first position.
+    data->rename_table(table, "aardvark");
+    $expect(data->captions(tables)).toBe("aardvark,alpha,table1,table2,zebra");
+
+    // From the first to the last position.
+    data->rename_table(table, "zulu");
+    $expect(data->captions(tables)).toBe("alpha,table1,table2,zebra,zulu");
+
+    // From the last position back to the middle.
+    data->rename_table(table, "table10");
+    $expect(data->captions(tables)).toBe("alpha,table1,table10,table2,zebra");
+
+    // A rename which keeps the position.
+    data->rename_table(table, "table11");
+    $expect(data->captions(tables)).toBe("alpha,table1,table11,table2,zebra");
+    $expect(tables->get_child(2)->get_tag()).toBe(table->id());
+
+    data->tree->remove_node(table);
+    $expect(data->captions(tables)).toBe("alpha,table1,table2,zebra");
+  });
+}
+
+}
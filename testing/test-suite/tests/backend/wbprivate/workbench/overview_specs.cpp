@@ -29,6 +29,7 @@
 #include "grts/structs.workbench.h"
 #include "grts/structs.workbench.logical.h"
 #include "grts/structs.workbench.physical.h"
+#include "grts/structs.db.mysql.h"
 
 #include "casmine.h"
 
@@ -88,6 +89,63 @@ $describe("WB overview") {
 
     ensure_files_equal("initial overview state ", "output/overview_test2.txt", "data/be/overview_test2.txt");
   });
+
+  $it("Refreshing a schema section reuses the nodes of existing objects", [&]() {
+    wb::OverviewBE *overview = wb::WBContextUI::get()->get_physical_overview();
+    db_SchemaRef schema = data->tester->getCatalog()->schemata()[0];
+    bec::NodeId section = bec::NodeId(1).append(0).append(0); // mydb -> Tables
+
+    auto labels = [&]() {
+      std::string result;
+      for (size_t i = 0; i < overview->count_children(section); ++i) {
+        std::string label;
+        overview->get_field(overview->get_child(section, i), wb::OverviewBE::Label, label);
+        result += (i > 0 ? "," : "") + label;
+      }
+      return result;
+    };
+
+    // Index of the only selected node.
+    auto selected = [&]() {
+      std::list<int> children = overview->get_selected_children(section);
+      return children.size() == 1 ? children.front() : -1;
+    };
+
+    $expect(labels()).toBe("Add Table,table1,table2");
+
+    // The selection is stored in the nodes, it only survives a refresh if the node is kept.
+    overview->select_node(bec::NodeId(section).append(2));
+    $expect(selected()).toBe(2);
+
+    db_mysql_TableRef table(grt::Initialized);
+    table->owner(schema);
+    table->name("alpha");
+    schema->tables().insert(table);
+    overview->refresh_node(section, true);
+
+    $expect(labels()).toBe("Add Table,alpha,table1,table2");
+    $expect(selected()).toBe(3);
+
+    // Renames update the kept node and restore the order.
+    db_TableRef table1 = grt::find_named_object_in_list(schema->tables(), "table1");
+    table1->name("zebra");
+    overview->refresh_node(section, true);
+
+    $expect(labels()).toBe("Add Table,alpha,table2,zebra");
+    $expect(selected()).toBe(2);
+
+    // The node of a removed object goes away, the others stay.
+    schema->tables().remove_value(table);
+    overview->refresh_node(section, true);
+
+    $expect(labels()).toBe("Add Table,table2,zebra");
+    $expect(selected()).toBe(1);
+
+    table1->name("table1");
+    overview->refresh_node(section, true);
+    $expect(labels()).toBe("Add Table,table1,table2");
+    $expect(selected()).toBe(2);
+  });
 }
 
 }
@@ -27,6 +27,8 @@
 
 #include "SSHCommon.h"
 #include "SSHTunnelManager.h"
+#include "SSHTunnelHandler.h"
+#include "SSHSessionPool.h"
 #include "workbench/SSHSessionWrapper.h"
 #include "SSHSftp.h"
 #include "cdbc/src/driver_manager.h"
@@ -37,6 +39,8 @@
 #include <cppconn/statement.h>
 #include <cppconn/resultset.h>
 
+#include <chrono>
+
 #include "casmine.h"
 
 namespace {
@@ -254,6 +258,138 @@ $xdescribe("SSH testing") {
     manager->setStop();
     manager->pokeWakeupSocket();
   });
+
+  $it("Session pool shares one session per server, user and credentials", [this]() {
+    auto config = data->connectionConfig;
+    config.strictHostKeyCheck = false;
+    auto credentials = data->connectionCredentials;
+    credentials.auth = ssh::SSHAuthtype::PASSWORD;
+
+    ssh::SSHSessionPool *pool = ssh::SSHSessionPool::get();
+    pool->clear();
+    $expect(pool->acquire(config, credentials) == nullptr).toBe(true, "Pool should be empty");
+
+    auto session = ssh::SSHSession::createSession();
+    auto retVal = session->connect(config, credentials);
+    $expect(std::get<0>(retVal) == ssh::SSHReturnType::CONNECTED).toBe(true, "Connection failed");
+
+    auto stats = pool->getStats();
+    pool->add(session);
+
+    // A different tunnel target on the same server must get the same session.
+    auto otherTarget = config;
+    otherTarget.remotehost = "192.168.1.1";
+    otherTarget.remoteport = 3307;
+    auto shared = pool->acquire(otherTarget, credentials);
+    $expect(shared == session).toBe(true, "Session was not shared");
+    $expect(pool->getStats().reused).toBe(stats.reused + 1);
+
+    auto otherUser = credentials;
+    otherUser.username += "_other";
+    $expect(pool->acquire(config, otherUser) == nullptr).toBe(true, "Session must not be shared between users");
+
+    auto otherPassword = credentials;
+    otherPassword.password += "_wrong";
+    $expect(pool->acquire(config, otherPassword) == nullptr).toBe(true, "Session must not be shared without auth");
+
+    {
+      ssh::SSHSftp sftp(shared, 65535);
+      auto current = pool->getStats();
+      $expect(current.sessions.size()).toBe(1U);
+      $expect(current.sessions[0].leases).toBe(2U);
+      $expect(current.sessions[0].channels).toBe(1U, "The sftp channel should be counted");
+    }
+
+    pool->release(shared);
+    pool->release(session);
+    $expect(session->isConnected()).toBe(true, "Released sessions stay open for reuse");
+
+    pool->setIdleTimeout(0);
+    pool->maintain();
+    $expect(pool->getStats().sessions.empty()).toBe(true, "Idle session was not evicted");
+    $expect(session->isConnected()).toBe(false, "Evicted session is still connected");
+    pool->setIdleTimeout(300);
+  });
+
+  $it("Tunnel throughput and latency", [this]() {
+    // Runs against the sshd and MySQL server configured for this suite. A local sshd forwarding to a local server
+    // gives the most stable numbers, as then only the tunnel itself is measured.
+    auto config = data->connectionConfig;
+    config.remotehost = "127.0.0.1";
+    config.remoteport = data->context->getConfigurationIntValue("ssh/dbport", 3306);
+    config.strictHostKeyCheck = false;
+    auto credentials = data->connectionCredentials;
+    credentials.auth = ssh::SSHAuthtype::PASSWORD;
+
+    auto manager = std::unique_ptr<ssh::SSHTunnelManager>(new ssh::SSHTunnelManager());
+    manager->start();
+
+    auto session = ssh::SSHSession::createSession();
+    auto retVal = session->connect(config, credentials);
+    $expect(std::get<0>(retVal) == ssh::SSHReturnType::CONNECTED).toBe(true, "connection established");
+
+    try {
+      retVal = manager->createTunnel(session);
+    } catch (ssh::SSHTunnelException &exc) {
+      manager->setStop();
+      manager->pokeWakeupSocket();
+      $fail(std::string("Unable to create tunnel: ").append(exc.what()));
+      return;
+    }
+
+    db_mgmt_ConnectionRef connectionProperties = db_mgmt_ConnectionRef(grt::Initialized);
+    grt::DictRef conn_params(true);
+    conn_params.set("hostName", grt::StringRef(config.localhost));
+    conn_params.set("port", grt::IntegerRef(std::get<1>(retVal)));
+    conn_params.set("userName", grt::StringRef(data->context->getConfigurationStringValue("ssh/dbuser")));
+    conn_params.set("password", grt::StringRef(data->context->getConfigurationStringValue("ssh/dbpass")));
+    grt::replace_contents(connectionProperties->parameterValues(), conn_params);
+    db_mgmt_DriverRef driverProperties(grt::Initialized);
+    driverProperties->driverLibraryName(grt::StringRef("mysqlcppconn"));
+    connectionProperties->driver(driverProperties);
+
+    try {
+      sql::ConnectionWrapper wrapper = sql::DriverManager::getDriverManager()->getConnection(connectionProperties);
+      std::unique_ptr<sql::Statement> stmt(wrapper->createStatement());
+
+      // Latency: many small round trips.
+      const size_t roundTrips = 500;
+      auto start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < roundTrips; ++i) {
+        std::unique_ptr<sql::ResultSet> rset(stmt->executeQuery("SELECT 1"));
+        $expect(rset->next()).toBe(true, "Result set is empty");
+      }
+      auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count() / roundTrips;
+
+      // Throughput: a few large results, which fill up the tunnel buffers and the channel window.
+      const size_t blockSize = 4 * 1024 * 1024;
+      const size_t blockCount = 16;
+      start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < blockCount; ++i) {
+        std::unique_ptr<sql::ResultSet> rset(
+          stmt->executeQuery("SELECT REPEAT('x', " + std::to_string(blockSize) + ")"));
+        $expect(rset->next()).toBe(true, "Result set is empty");
+        $expect(rset->getString(1).length()).toBe(blockSize);
+      }
+      auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+      if (std::get<bool>(casmine::CasmineContext::get()->settings["verbose"])) {
+        std::cout << std::endl << "SSH tunnel latency: " << latency << " us per round trip" << std::endl;
+        std::cout << "SSH tunnel throughput: " << (blockSize * blockCount / 1024) / std::max<long long>(duration, 1)
+          << " KB/ms" << std::endl;
+      }
+    } catch (std::exception &exc) {
+      manager->setStop();
+      manager->pokeWakeupSocket();
+      $fail(std::string("Unable to run tunnel benchmark. ").append(exc.what()));
+      return;
+    }
+
+    manager->setStop();
+    manager->pokeWakeupSocket();
+  });
 }
 
 }
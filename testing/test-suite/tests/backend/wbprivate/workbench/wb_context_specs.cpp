@@ -24,10 +24,14 @@
 // High-level testing for Workbench
 // This tests WBContext, which will test the integration of all components.
 
+#include <atomic>
+#include <thread>
+
 #include "base/util_functions.h"
 
 #include "grtdb/db_helpers.h"
 #include "grtdb/db_object_helpers.h"
+#include "objimpl/db/db_ForeignKey_impl.h"
 
 #include "stub/stub_utilities.h"
 
@@ -605,6 +609,50 @@ $describe("Workbench model document integration tests") {
 
   //--------------------------------------------------------------------------------------------------------------------
 
+  $it("Foreign key back-references are tracked while keys change concurrently", []() {
+    db_mysql_TableRef target(grt::Initialized);
+    target->name("target");
+
+    const size_t threadCount = 4;
+    const size_t keysPerThread = 50;
+    std::vector<std::vector<db_mysql_ForeignKeyRef>> keys(threadCount);
+    std::atomic<size_t> invalidKeys(0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t) {
+      threads.emplace_back([&, t]() {
+        for (size_t i = 0; i < keysPerThread; ++i) {
+          db_mysql_TableRef table(grt::Initialized);
+          db_mysql_ForeignKeyRef fk(grt::Initialized);
+          fk->owner(table);
+          table->foreignKeys().insert(fk);
+          fk->referencedTable(target);
+          keys[t].push_back(fk);
+
+          // Lookups while other threads add keys must only ever return live keys.
+          for (auto &key : foreign_keys_referencing_table(target))
+            if (!key.is_valid())
+              ++invalidKeys;
+        }
+      });
+    }
+    for (auto &thread : threads)
+      thread.join();
+
+    $expect(invalidKeys.load()).toBe(0U);
+    $expect(foreign_keys_referencing_table(target).size()).toBe(threadCount * keysPerThread);
+    $expect(is_table_referenced(target)).toBeTrue();
+
+    // Pointing a key elsewhere or dropping it removes the back-reference.
+    keys[0][0]->referencedTable(db_mysql_TableRef(grt::Initialized));
+    keys[1].clear();
+    $expect(foreign_keys_referencing_table(target).size()).toBe((threadCount - 1) * keysPerThread - 1);
+
+    keys.clear();
+    $expect(is_table_referenced(target)).toBeFalse();
+  });
+
+  //--------------------------------------------------------------------------------------------------------------------
+
   $it("Layer size of a new document", [this]() {
     data->tester->wb->new_document();
     data->tester->addView();
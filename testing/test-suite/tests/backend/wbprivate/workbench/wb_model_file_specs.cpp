@@ -26,10 +26,14 @@
 #include "wb_test_helpers.h"
 
 #include "base/file_utilities.h"
+#include "base/util_functions.h"
 #include "base/utf8string.h"
 
 #include "casmine.h"
 
+#include <chrono>
+#include <thread>
+
 namespace {
 
 $ModuleEnvironment() {};
@@ -56,6 +60,13 @@ $TestData {
     $expect([&]() { mf.save_to(tempPath); mf.cleanup(); }).Not.toThrow();
     $expect([&]() { mf.open(tempPath); mf.cleanup(); }).Not.toThrow();
   }
+
+  // Autosaves are written in the background and renamed to their final name once complete.
+  bool waitForFile(const std::string &path) {
+    for (int i = 0; i < 1000 && !base::file_exists(path); ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return base::file_exists(path);
+  }
 };
 
 $describe("Tests for WB model file") {
@@ -139,6 +150,89 @@ $describe("Tests for WB model file") {
     data->testModelSavingAndLoading(data->tmpDataDir + data->UnicodeBaseModelFile);
   });
 
+  $it("Large documents are packed and unpacked in parallel", [this]() {
+    ModelFile mf(data->outputDir);
+    workbench_DocumentRef doc(grt::Initialized);
+
+    mf.create();
+    doc->name("large");
+    mf.store_document(doc);
+
+    // Enough data to go over the parallel threshold, in files large enough to be compressed separately.
+    std::vector<std::string> names = { "script1.sql", "script2.sql", "note1.txt", "note2.txt", "image1.png" };
+    std::vector<std::string> contents;
+    for (size_t i = 0; i < names.size(); ++i) {
+      std::string content;
+      for (size_t line = 0; content.size() < 3 * 1024 * 1024; ++line)
+        content += "INSERT INTO t" + std::to_string(i) + " VALUES (" + std::to_string(line * 7919 % 104729) + ");\n";
+      mf.set_file_contents(names[i], content);
+      contents.push_back(content);
+    }
+
+    std::string path = data->outputDir + "/large.mwb";
+    $expect([&]() { mf.save_to(path); }).Not.toThrow();
+    mf.cleanup();
+
+    ModelFile reopened(data->outputDir);
+    $expect([&]() { reopened.open(path); }).Not.toThrow();
+    $expect(*reopened.retrieve_document()->name()).toBe("large");
+    for (size_t i = 0; i < names.size(); ++i)
+      $expect(reopened.get_file_contents(names[i]) == contents[i]).toBeTrue(names[i]);
+    reopened.cleanup();
+
+    // Backups of saved files share the data with the original where possible.
+    ModelFile::link_or_copy_file(path, path + ".backup");
+    $expect(get_file_size((path + ".backup").c_str())).toBe(get_file_size(path.c_str()));
+  });
+
+  $it("Autosave writes a snapshot of the document in the background", [this]() {
+    ModelFile mf(data->outputDir);
+    workbench_DocumentRef doc(grt::Initialized);
+
+    mf.create();
+    doc->name("before");
+    mf.store_document_autosave(doc);
+
+    // Changes after the autosave started must not end up in the file.
+    doc->name("after");
+
+    std::string path = mf.get_path_for(MAIN_DOCUMENT_AUTOSAVE_NAME);
+    $expect(data->waitForFile(path)).toBeTrue();
+    $expect(base::file_exists(path + ".tmp")).toBeFalse();
+
+    workbench_DocumentRef saved(workbench_DocumentRef::cast_from(grt::GRT::get()->unserialize(path)));
+    $expect(*saved->name()).toBe("before");
+
+    mf.cleanup();
+  });
+
+  $it("A failed autosave write is reported and doesn't prevent the next autosave", [this]() {
+    ModelFile mf(data->outputDir);
+    workbench_DocumentRef doc(grt::Initialized);
+
+    mf.create();
+    std::string path = mf.get_path_for(MAIN_DOCUMENT_AUTOSAVE_NAME);
+
+    // A directory in place of the temporary file makes the writes fail.
+    base::create_directory(path + ".tmp", 0700);
+    doc->name("first");
+    $expect([&]() { mf.store_document_autosave(doc); }).Not.toThrow();
+
+    // The error of a write is thrown by the next autosave, which is still started.
+    doc->name("second");
+    $expect([&]() { mf.store_document_autosave(doc); }).toThrow();
+
+    base::remove(path + ".tmp");
+    doc->name("third");
+    $expect([&]() { mf.store_document_autosave(doc); }).toThrow();
+    $expect(data->waitForFile(path)).toBeTrue();
+
+    workbench_DocumentRef saved(workbench_DocumentRef::cast_from(grt::GRT::get()->unserialize(path)));
+    $expect(*saved->name()).toBe("third");
+
+    mf.cleanup();
+  });
+
 }
 
 }
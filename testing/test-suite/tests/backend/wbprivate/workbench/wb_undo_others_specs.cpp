@@ -404,6 +404,76 @@ $describe("General Undo/Redo") {
 
   //--------------------------------------------------------------------------------------------------------------------
 
+  $it("Compact undo history", [this]() {
+    db_TableRef table(data->tester->getCatalog()->schemata()[0]->tables()[0]);
+    std::string name = table->name();
+
+    // Repeated changes of the same member in a group are recorded only once.
+    data->resetUndoAccounting();
+    {
+      AutoUndo undo;
+      for (int i = 0; i < 100; ++i)
+        table->name(name + "_" + std::to_string(i));
+      undo.end("Rename table");
+    }
+    data->checkOnlyOneUndoAdded();
+
+    UndoGroup *group = dynamic_cast<UndoGroup *>(data->um->get_undo_stack().back());
+    $expect(group).Not.toBeNull("undo group");
+
+    size_t nameChanges = 0;
+    for (auto action : group->get_actions()) {
+      UndoObjectChangeAction *change = dynamic_cast<UndoObjectChangeAction *>(action);
+      if (change != nullptr && change->get_object() == table && change->get_member() == "name")
+        ++nameChanges;
+    }
+    $expect(nameChanges).toEqual(1U, "coalesced name changes");
+
+    // A coalesced action is not taken over by the group, the caller still owns (and deletes) it.
+    {
+      UndoGroup standalone;
+      UndoObjectChangeAction *first = new UndoObjectChangeAction(table, "comment");
+      UndoObjectChangeAction *second = new UndoObjectChangeAction(table, "comment");
+      $expect(standalone.add(first)).toBeTrue("first change added");
+      $expect(standalone.add(second)).toBeFalse("second change coalesced");
+      $expect(standalone.get_actions().size()).toEqual(1U, "group actions");
+      $expect(standalone.get_actions().back() == first).toBeTrue("kept the first change");
+      $expect(second->get_member()).toEqual("comment", "dropped action still valid");
+      delete second;
+    }
+
+    data->checkUndo();
+    $expect(*table->name()).toEqual(name, "name after undo");
+    data->checkRedo();
+    $expect(*table->name()).toEqual(name + "_99", "name after redo");
+    data->checkUndo();
+
+    // Old entries are dropped when the history gets too large.
+    size_t undoLimit = data->um->get_undo_limit();
+    data->um->set_undo_limit(0);
+    data->um->set_undo_memory_limit(1024 * 1024);
+
+    std::string comment = table->comment();
+    size_t stackSize = data->um->get_undo_stack().size();
+    for (int i = 0; i < 20; ++i) {
+      AutoUndo undo;
+      table->comment(std::string(200000, (char)('a' + i)));
+      undo.end("Change comment");
+    }
+    $expect(data->um->get_undo_stack().size()).toBeLessThan(stackSize + 20, "trimmed undo stack");
+    $expect(data->um->get_undo_memory_usage()).toBeLessThanOrEqual(1024U * 1024U, "undo memory usage");
+
+    data->um->set_undo_memory_limit(0);
+    data->um->set_undo_limit(undoLimit);
+
+    data->um->disable();
+    table->comment(comment);
+    data->um->enable();
+    data->um->reset();
+  });
+
+  //--------------------------------------------------------------------------------------------------------------------
+
   $it("Configuration: general settings", []() {
     $pending("not implemented");
   });
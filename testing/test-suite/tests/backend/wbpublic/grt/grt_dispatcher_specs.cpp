@@ -21,6 +21,9 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
  */
 
+#include <atomic>
+#include <mutex>
+
 #include "grt/grt_dispatcher.h"
 #include "grt/grt_manager.h"
 #include "wb_test_helpers.h"
@@ -90,6 +93,113 @@ $describe("GRT request dispatcher") {
     $expect(finish_called).toBeTrue();
   });
 
+  $it("Pooled tasks keep the order of their ordering key", [this]() {
+    GRTDispatcher::Ref dispatcher = GRTDispatcher::create_dispatcher(true, false);
+    dispatcher->set_pool_size(4);
+    dispatcher->start();
+
+    std::mutex orderMutex;
+    std::vector<int> editor1, editor2;
+    std::atomic<int> done(0);
+
+    for (int i = 0; i < 50; ++i) {
+      dispatcher->execute_pooled_function("editor1", [&, i]() {
+        g_usleep(100);
+        std::lock_guard<std::mutex> lock(orderMutex);
+        editor1.push_back(i);
+        ++done;
+        return grt::ValueRef();
+      }, "editor1");
+      dispatcher->execute_pooled_function("editor2", [&, i]() {
+        std::lock_guard<std::mutex> lock(orderMutex);
+        editor2.push_back(i);
+        ++done;
+        return grt::ValueRef();
+      }, "editor2");
+    }
+
+    gint64 timeout = g_get_monotonic_time() + 10 * G_USEC_PER_SEC;
+    while (done < 100 && g_get_monotonic_time() < timeout) {
+      dispatcher->flush_pending_callbacks();
+      g_usleep(1000);
+    }
+    $expect(done.load()).toBe(100);
+
+    for (int i = 0; i < 50; ++i) {
+      $expect(editor1[i]).toBe(i);
+      $expect(editor2[i]).toBe(i);
+    }
+
+    DispatcherStats stats = dispatcher->get_stats();
+    $expect(stats.pooled_tasks).toBe(100U);
+    $expect(stats.queued_tasks).toBe(0U);
+    $expect(stats.max_queue_depth > 0).toBeTrue();
+
+    dispatcher->shutdown();
+  });
+
+  $it("Pooled tasks not started at shutdown are failed", [this]() {
+    GRTDispatcher::Ref dispatcher = GRTDispatcher::create_dispatcher(true, false);
+    dispatcher->set_pool_size(1);
+    dispatcher->start();
+
+    std::atomic<bool> started(false);
+    GRTTask::Ref blocker = GRTTask::create_task("blocker", dispatcher, [&]() {
+      started = true;
+      g_usleep(200000);
+      return grt::ValueRef();
+    });
+    blocker->set_affinity(GRTTaskBase::AnyThread);
+    blocker->set_ordering_key("editor");
+    dispatcher->add_task(blocker);
+
+    std::vector<GRTTask::Ref> queued;
+    for (int i = 0; i < 5; ++i) {
+      GRTTask::Ref task = GRTTask::create_task("queued", dispatcher, std::bind(normal_test_function));
+      task->set_affinity(GRTTaskBase::AnyThread);
+      task->set_ordering_key("editor");
+      dispatcher->add_task(task);
+      queued.push_back(task);
+    }
+
+    while (!started)
+      g_usleep(1000);
+    dispatcher->shutdown();
+
+    $expect(blocker->get_error() == nullptr).toBeTrue();
+    for (auto &task : queued) {
+      $expect(task->is_finished()).toBeTrue();
+      $expect(task->get_error() != nullptr).toBeTrue();
+    }
+
+    // Tasks added after the shutdown don't run and don't block their waiters either.
+    GRTTask::Ref late = GRTTask::create_task("late", dispatcher, std::bind(normal_test_function));
+    late->set_affinity(GRTTaskBase::AnyThread);
+    dispatcher->add_task(late);
+    dispatcher->wait_task(late);
+    $expect(late->get_error() != nullptr).toBeTrue();
+    $expect(dispatcher->get_stats().queued_tasks).toBe(0U);
+  });
+
+  $it("Pooled tasks report errors thrown by pointer", [this]() {
+    GRTDispatcher::Ref dispatcher = GRTDispatcher::create_dispatcher(true, false);
+    dispatcher->set_pool_size(2);
+    dispatcher->start();
+
+    GRTTask::Ref task = GRTTask::create_task("failing", dispatcher, []() -> grt::ValueRef {
+      throw new std::runtime_error("thrown by pointer");
+    });
+    task->set_affinity(GRTTaskBase::AnyThread);
+    dispatcher->add_task(task);
+    dispatcher->wait_task(task);
+
+    $expect(task->get_error() != nullptr).toBeTrue();
+    $expect(std::string(task->get_error()->what())).toBe("thrown by pointer");
+    $expect(dispatcher->get_stats().queued_tasks).toBe(0U);
+
+    dispatcher->shutdown();
+  });
+
 }
 
 }
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "grt/validation_manager.h"
+#include "grts/structs.db.mysql.h"
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+
+#include <atomic>
+
+using namespace bec;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+// Complains about tables with "bad" in their name and counts how often it was asked.
+class TableNameValidator : public grt::Validator {
+public:
+  std::atomic<int> calls;
+
+  TableNameValidator() : calls(0) {
+  }
+
+  virtual int validate(const Tag &what, const grt::ObjectRef &obj) {
+    if (what != "test-names")
+      return 0;
+
+    ++calls;
+    std::string name = *db_TableRef::cast_from(obj)->name();
+    if (name.find("bad") == std::string::npos)
+      return 0;
+
+    ValidationManager::message(what, obj, "bad table name", grt::ErrorMsg);
+    return 1;
+  }
+};
+
+$TestData {
+  std::unique_ptr<WorkbenchTester> tester;
+  TableNameValidator validator; // Validators cannot be unregistered, so this one lives as long as the test data.
+  db_mysql_SchemaRef schema;
+};
+
+$describe("Validation Manager") {
+  $beforeAll([this]() {
+    data->tester.reset(new WorkbenchTester());
+    data->tester->initializeRuntime();
+    data->tester->createNewDocument();
+
+    ValidationManager::register_validator("db.mysql.Table", &data->validator);
+
+    data->schema = db_mysql_SchemaRef(grt::Initialized);
+    data->schema->owner(data->tester->getCatalog());
+    data->tester->getCatalog()->schemata().insert(data->schema);
+
+    for (int i = 0; i < 200; ++i) {
+      db_mysql_TableRef table(grt::Initialized);
+      table->owner(data->schema);
+      table->name(i == 7 ? "bad_table" : "table_" + std::to_string(i));
+      data->schema->tables().insert(table);
+    }
+  });
+
+  $it("Only changed objects are validated again", [this]() {
+    ValidationMessagesBE messages;
+    ValidationManager::clear();
+
+    $expect(ValidationManager::validate_tree(data->tester->getCatalog(), "test-names")).toBeFalse();
+    $expect(data->validator.calls.load()).toEqual(200);
+    $expect(messages.count()).toEqual(1U);
+
+    // Nothing changed, everything comes from the cache.
+    $expect(ValidationManager::validate_tree(data->tester->getCatalog(), "test-names")).toBeFalse();
+    $expect(data->validator.calls.load()).toEqual(200);
+    $expect(messages.count()).toEqual(1U);
+
+    // Member changes.
+    data->schema->tables()[3]->name("table_renamed");
+    ValidationManager::validate_tree(data->tester->getCatalog(), "test-names");
+    $expect(data->validator.calls.load()).toEqual(201);
+
+    // Changes of owned objects.
+    db_mysql_ColumnRef column(grt::Initialized);
+    column->owner(data->schema->tables()[5]);
+    column->name("id");
+    data->schema->tables()[5]->columns().insert(column);
+    ValidationManager::validate_tree(data->tester->getCatalog(), "test-names");
+    $expect(data->validator.calls.load()).toEqual(202);
+
+    column->name("other_id");
+    ValidationManager::validate_tree(data->tester->getCatalog(), "test-names");
+    $expect(data->validator.calls.load()).toEqual(203);
+
+    // Fixing the problem removes the message.
+    data->schema->tables()[7]->name("good_table");
+    $expect(ValidationManager::validate_tree(data->tester->getCatalog(), "test-names")).toBeTrue();
+    $expect(data->validator.calls.load()).toEqual(204);
+    $expect(messages.count()).toEqual(0U);
+
+    data->schema->tables()[7]->name("bad_table");
+    ValidationManager::clear();
+  });
+
+  $it("Parallel validation gives the same messages", [this]() {
+    ValidationMessagesBE messages;
+    ValidationManager::clear();
+    data->validator.calls = 0;
+
+    $expect(ValidationManager::validate_tree(data->tester->getCatalog(), "test-names", 4)).toBeFalse();
+    $expect(data->validator.calls.load()).toEqual(200);
+    $expect(messages.count()).toEqual(1U);
+
+    std::string text;
+    $expect(messages.get_field(NodeId(0), ValidationMessagesBE::Description, text)).toBeTrue();
+    $expect(text).toEqual("bad table name");
+
+    ValidationManager::clear();
+  });
+}
+
+}
@@ -21,12 +21,16 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
  */
 
+#include <chrono>
+#include <sstream>
+
 #include "casmine.h"
 #include "helpers.h"
 #include "wb_test_helpers.h"
 
 #include "base/file_utilities.h"
 
+#include "code-completion/CodeCompletionCore.h"
 #include "code-completion/mysql-code-completion.h"
 #include "mysql/MySQLRecognizerCommon.h"
 #include "mysql/MySQLLexer.h"
@@ -287,6 +291,131 @@ $describe("SQL code completion tests") {
     $expect(candidates[1].second).toBe("innodb", "Test 20.14");
     $expect(candidates[2].second).toBe("myisam", "Test 20.15");
   });
+
+  $it("Prefix and fuzzy symbol lookups", [this]() {
+    auto sakila = dynamic_cast<SchemaSymbol *>(data->mainSymbols.resolve("sakila"));
+    $expect(sakila).Not.toBe(nullptr, "Test 30.1");
+
+    auto tables = sakila->getSymbolsWithPrefix<TableSymbol>("C");
+    $expect(tables.size()).toBe(4U, "Test 30.2");
+    $expect(tables[0]->name).toBe("category", "Test 30.3");
+    $expect(tables[3]->name).toBe("custom", "Test 30.4");
+
+    $expect(sakila->getSymbolsWithPrefix<TableSymbol>("film").size()).toBe(1U, "Test 30.5");
+    $expect(sakila->getSymbolsWithPrefix<ViewSymbol>("sales_").size()).toBe(2U, "Test 30.6");
+    $expect(sakila->getSymbolsWithPrefix<Symbol>("xyz").empty()).toBeTrue("Test 30.7");
+
+    auto views = sakila->matchSymbols<ViewSymbol>("sbs");
+    $expect(views.size()).toBe(1U, "Test 30.8");
+    $expect(views[0]->name).toBe("sales_by_store", "Test 30.9");
+
+    // Prefix matches rank before scattered matches.
+    $expect(ScopedSymbol::matchScore("fil", "film_list")).toBeGreaterThan(ScopedSymbol::matchScore("fil", "fk_film_language"),
+                                                                           "Test 30.10");
+    $expect(ScopedSymbol::matchScore("xq", "film")).toBe(-1, "Test 30.11");
+
+    // The table lookup through the schema symbol uses the name index and is still correct after additions.
+    auto table = data->dbObjects.addNewSymbol<TableSymbol>(sakila, "Zebra");
+    $expect(sakila->resolve("Zebra")).toBe(table, "Test 30.12");
+    $expect(sakila->getSymbolsWithPrefix<TableSymbol>("zeb").size()).toBe(1U, "Test 30.13");
+  });
+
+  $it("Code completion only collects matching database objects", [this]() {
+    ANTLRInputStream input("SELECT * FROM ci");
+
+    MySQLLexer lexer(&input);
+    CommonTokenStream tokens(&lexer);
+    MySQLParser parser(&tokens);
+    lexer.serverVersion = 50717;
+    parser.serverVersion = 50717;
+    parser.setBuildParseTree(true);
+
+    auto hasEntry = [](std::vector<std::pair<int, std::string>> const &list, std::string const &name) {
+      return std::find_if(list.begin(), list.end(), [&](auto const &entry) { return entry.second == name; }) !=
+        list.end();
+    };
+
+    auto candidates = getCodeCompletionList(1, 16, "sakila", false, &parser, data->mainSymbols);
+    $expect(hasEntry(candidates, "city")).toBeTrue("Test 40.1");
+    $expect(hasEntry(candidates, "actor")).toBeTrue("Test 40.2");
+
+    candidates = getCodeCompletionList(1, 16, "sakila", false, &parser, data->mainSymbols, "ci");
+    $expect(hasEntry(candidates, "city")).toBeTrue("Test 40.3");
+    $expect(hasEntry(candidates, "actor")).toBeFalse("Test 40.4");
+
+    // Nothing starts with "ctgry", so the fuzzy matches come in.
+    candidates = getCodeCompletionList(1, 16, "sakila", false, &parser, data->mainSymbols, "ctgry");
+    $expect(hasEntry(candidates, "category")).toBeTrue("Test 40.5");
+    $expect(hasEntry(candidates, "city")).toBeFalse("Test 40.6");
+
+    // Large schemas: collecting candidates for a typed prefix must not depend on the number of tables.
+    SymbolTable bigSymbols;
+    auto big = bigSymbols.addNewSymbol<SchemaSymbol>(nullptr, "big");
+    for (size_t i = 0; i < 100000; ++i)
+      bigSymbols.addNewSymbol<TableSymbol>(big, "table_" + std::to_string(i));
+
+    auto start = std::chrono::steady_clock::now();
+    candidates = getCodeCompletionList(1, 16, "big", false, &parser, bigSymbols, "table_1234");
+    auto duration = std::chrono::steady_clock::now() - start;
+    $expect(hasEntry(candidates, "table_12345")).toBeTrue("Test 40.7");
+    $expect(hasEntry(candidates, "table_1235")).toBeFalse("Test 40.8");
+
+    if (std::get<bool>(casmine::CasmineContext::get()->settings["verbose"]))
+      std::cout << "Completion with 100000 tables: " << std::chrono::duration<double, std::milli>(duration).count()
+                << "ms" << std::endl;
+  });
+
+  $it("Follow sets are cached and can be persisted", [this]() {
+    ANTLRInputStream input("SELECT * FROM city WHERE ");
+
+    MySQLLexer lexer(&input);
+    CommonTokenStream tokens(&lexer);
+    MySQLParser parser(&tokens);
+    lexer.serverVersion = 50717;
+    parser.serverVersion = 50717;
+    parser.setBuildParseTree(true);
+
+    auto collect = [&]() {
+      auto start = std::chrono::steady_clock::now();
+      auto candidates = getCodeCompletionList(1, 25, "sakila", false, &parser, data->mainSymbols);
+      return std::make_pair(candidates, std::chrono::steady_clock::now() - start);
+    };
+
+    CodeCompletionCore::clearCaches();
+    auto first = collect();
+    auto second = collect();
+    $expect(first.first.empty()).toBeFalse("Test 50.1");
+    $expect(second.first == first.first).toBeTrue("Test 50.2");
+
+    // Round trip of the follow sets computed so far.
+    CodeCompletionCore c3(&parser);
+    c3.settingsKey = std::to_string(parser.serverVersion) + "_" + std::to_string(static_cast<int>(parser.sqlMode));
+    std::stringstream stream;
+    $expect(c3.saveFollowSets(stream)).toBeTrue("Test 50.3");
+
+    CodeCompletionCore::clearCaches();
+    std::stringstream copy(stream.str());
+    $expect(c3.loadFollowSets(copy)).toBeTrue("Test 50.4");
+
+    auto loaded = collect();
+    $expect(loaded.first == first.first).toBeTrue("Test 50.5");
+
+    // Data written for other settings must be rejected.
+    CodeCompletionCore other(&parser);
+    other.settingsKey = "80000_0";
+    std::stringstream otherCopy(stream.str());
+    $expect(other.loadFollowSets(otherCopy)).toBeFalse("Test 50.6");
+
+    // A damaged file must not be accepted either.
+    std::stringstream truncated(stream.str().substr(0, stream.str().size() / 2));
+    $expect(c3.loadFollowSets(truncated)).toBeFalse("Test 50.7");
+
+    if (std::get<bool>(casmine::CasmineContext::get()->settings["verbose"])) {
+      auto ms = [](auto duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+      std::cout << "First completion: " << ms(first.second) << "ms, unchanged tokens: " << ms(second.second)
+                << "ms, with loaded follow sets: " << ms(loaded.second) << "ms" << std::endl;
+    }
+  });
 }
   
 }
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+
+#include "base/file_utilities.h"
+
+#include "mforms/code_editor.h"
+#include "stub/stub_mforms.h"
+#include "stub/stub_codeeditor.h"
+
+#include "sqlide/sql_editor_be.h"
+#include "grtsqlparser/mysql_parser_services.h"
+
+#include <chrono>
+#include <fstream>
+
+using namespace parsers;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::unique_ptr<WorkbenchTester> tester;
+  MySQLEditor::Ref editor;
+  std::string fileName;
+  std::string content;
+};
+
+$describe("SQL editor large file mode") {
+
+  $beforeAll([this]() {
+    data->tester.reset(new WorkbenchTester());
+    data->tester->initializeRuntime();
+
+    GrtVersionRef version = data->tester->getRdbms()->version();
+    base::copyFile("../../res/wbdata/code_editor.xml", "data/code_editor.xml");
+
+    MySQLParserServices::Ref services = MySQLParserServices::get();
+    MySQLParserContext::Ref context =
+      services->createParserContext(data->tester->getRdbms()->characterSets(), version, "", false);
+    MySQLParserContext::Ref autocompleteContext =
+      services->createParserContext(data->tester->getRdbms()->characterSets(), version, "", false);
+    data->editor = MySQLEditor::create(context, autocompleteContext, {});
+
+    // A script just over the large file threshold. Each line contains a 3 byte UTF-8 character, so that page
+    // boundaries regularly end in the middle of a character.
+    std::string line = "INSERT INTO t1 (id, name) VALUES (1, 'n\xE2\x82\xACme'), (2, 'other name');\n";
+    data->content.reserve(MySQLEditor::LargeFileSize + line.size());
+    while (data->content.size() <= MySQLEditor::LargeFileSize)
+      data->content += line;
+
+    data->fileName = casmine::CasmineContext::get()->outputDir() + "/large_script.sql";
+    std::ofstream stream(data->fileName, std::ios::binary);
+    stream.write(data->content.data(), (std::streamsize)data->content.size());
+  });
+
+  $afterAll([this]() {
+    data->editor.reset();
+    base::tryRemove(data->fileName);
+  });
+
+  $it("Loads a large file page by page", [this]() {
+    data->editor->set_large_file_mode(true);
+    $expect(data->editor->is_large_file_mode()).toBeTrue();
+
+    auto start = std::chrono::steady_clock::now();
+    $expect(data->editor->load_file(data->fileName)).toBeTrue();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    mforms::CodeEditor *control = data->editor->get_editor_control();
+    std::pair<const char *, std::size_t> text = control->get_text_ptr();
+    $expect(text.second).toBe(data->content.size());
+    $expect(std::string(text.first, text.second) == data->content).toBeTrue("Loaded text differs from file");
+
+    // Memory target: the file is never held in memory as a whole, besides the editor's own buffer.
+    auto &document = mforms::stub::CodeEditorWrapper::documents()[control];
+    $expect(document.largestAppend).toBeLessThanOrEqual(MySQLEditor::LoadPageSize);
+
+    // Open time target: a large file must be available within a few seconds.
+    $expect(duration.count()).toBeLessThan(5000);
+  });
+
+  $it("Rejects files which are not valid UTF-8", [this]() {
+    std::string fileName = casmine::CasmineContext::get()->outputDir() + "/invalid_script.sql";
+    {
+      std::ofstream stream(fileName, std::ios::binary);
+      stream << "SELECT 'abc\xC3\x28';\n";
+    }
+
+    $expect(data->editor->load_file(fileName)).toBeFalse();
+    $expect(data->editor->get_editor_control()->get_text_ptr().second).toBe(0U);
+    base::tryRemove(fileName);
+
+    data->editor->set_large_file_mode(false);
+    $expect(data->editor->is_large_file_mode()).toBeFalse();
+  });
+}
+
+}
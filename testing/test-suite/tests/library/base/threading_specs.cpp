@@ -22,6 +22,7 @@
  */
 
 #include "base/threading.h"
+#include "base/threaded_timer.h"
 
 #include "casmine.h"
 
@@ -146,6 +147,38 @@ $describe("threading") {
       throw;
     }
   });
+
+  $it("Threaded timer triggers tasks by their deadline", [&]() {
+    base::refcount_t singleShotCount = 0;
+    base::refcount_t repeatCount = 0;
+
+    ThreadedTimer::add_task(TimerTimeSpan, 0.1, true, [&](int) {
+      g_atomic_int_inc(&singleShotCount);
+      return false;
+    });
+    int repeatId = ThreadedTimer::add_task(TimerFrequency, 20, false, [&](int) {
+      g_atomic_int_inc(&repeatCount);
+      return false;
+    });
+
+    g_usleep(500 * BASE_TIME);
+    ThreadedTimer::remove_task(repeatId);
+    g_usleep(100 * BASE_TIME);
+
+    $expect(g_atomic_int_get(&singleShotCount)).toEqual(1);
+
+    // 20 Hz for 500ms gives 10 runs, but allow for some scheduling jitter.
+    int runs = g_atomic_int_get(&repeatCount);
+    $expect(runs >= 7 && runs <= 11).toBeTrue();
+
+    // The task must not run anymore after it was removed.
+    g_usleep(200 * BASE_TIME);
+    $expect(g_atomic_int_get(&repeatCount)).toEqual(runs);
+
+    TimerStats stats = ThreadedTimer::get_stats();
+    $expect(stats.fired >= (size_t)(runs + 1)).toBeTrue();
+    $expect(stats.max_lateness >= 0).toBeTrue();
+  });
 }
 
 }
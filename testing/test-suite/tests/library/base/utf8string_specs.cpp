@@ -26,6 +26,8 @@
 
 #include "casmine.h"
 
+#include <chrono>
+
 namespace {
 
 $ModuleEnvironment() {};
@@ -405,6 +407,74 @@ $describe("utf8string") {
     --iter;
     $expect(*iter).toEqual(base::utf8string::utf8char("ć"));
   });
+
+  $it("Character access on long mixed texts", [this]() {
+    // Mix ASCII runs (which the character index skips in blocks) with multi byte text.
+    std::string text;
+    std::vector<size_t> offsets;
+    for (size_t i = 0; i < 50; ++i) {
+      for (auto &entry : data->languageStrings) {
+        const char *run = entry.second._text;
+        for (const char *p = run; *p != 0; p = g_utf8_next_char(p))
+          offsets.push_back(text.size() + (p - run));
+        text += run;
+      }
+      for (size_t j = 0; j < 70; ++j) {
+        offsets.push_back(text.size());
+        text += 'x';
+      }
+    }
+
+    base::utf8string str(text);
+    $expect(str.length()).toEqual(offsets.size());
+    $expect(str.size()).toEqual(offsets.size());
+    $expect(str.validate()).toBe(true);
+
+    for (size_t i = 0; i < offsets.size(); ++i) {
+      $expect(str.charIndexToByteOffset(i)).toEqual(offsets[i]);
+      $expect(str.byteOffsetToCharIndex(offsets[i])).toEqual(i);
+      $expect((uint32_t)str[i]).toEqual((uint32_t)g_utf8_get_char(text.c_str() + offsets[i]));
+    }
+    $expect(str.charIndexToByteOffset(offsets.size())).toEqual(text.size());
+
+    // Modifications must not use stale index data.
+    base::utf8string copy = str;
+    copy.erase(0, 3);
+    $expect(copy.length()).toEqual(offsets.size() - 3);
+    $expect((uint32_t)copy[0]).toEqual((uint32_t)str[3]);
+    copy += "ł";
+    $expect(copy.length()).toEqual(offsets.size() - 2);
+    $expect(copy[copy.length() - 1]).toEqual(base::utf8string::utf8char("ł"));
+    $expect(str.length()).toEqual(offsets.size());
+
+    $expect(str.substr(offsets.size() - 70, 3)).toEqual(base::utf8string("xxx"));
+    $expect(str.find("x", 1)).toEqual(offsets.size() / 50 - 70);
+
+    std::string invalid = text;
+    invalid[invalid.size() - 71] = (char)0xff;
+    $expect(base::utf8string(invalid).validate()).toBe(false);
+  });
+
+  $it("Character access performance", []() {
+    std::string text;
+    for (size_t i = 0; i < 20000; ++i)
+      text += (i % 3 == 0) ? "ą" : (i % 3 == 1) ? "我" : "a";
+    base::utf8string str(text);
+
+    auto start = std::chrono::steady_clock::now();
+    size_t length = str.length();
+    uint32_t checksum = 0;
+    for (size_t i = 0; i < length; ++i)
+      checksum += str[i];
+    for (size_t i = 0; i < length; i += 7)
+      checksum += (uint32_t)str.byteOffsetToCharIndex(str.charIndexToByteOffset(i));
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    $expect(length).toEqual(20000U);
+    $expect(checksum).Not.toEqual(0U);
+    if (std::get<bool>(casmine::CasmineContext::get()->settings["verbose"]))
+      std::cout << "Indexed access to " << length << " characters took " << duration.count() << "us" << std::endl;
+  });
 }
 
 }
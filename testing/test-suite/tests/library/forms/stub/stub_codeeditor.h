@@ -26,19 +26,48 @@
 
 #include "stub_view.h"
 
+#include <algorithm>
+#include <map>
+
 namespace mforms {
   namespace stub {
 
+    // Keeps the text of a code editor, so that loading and retrieving text can be tested.
+    struct CodeEditorDocument {
+      std::string text;
+      std::size_t largestAppend = 0; // Largest chunk ever added in one call.
+    };
+
     class CodeEditorWrapper : public ViewWrapper {
     protected:
       CodeEditorWrapper(::mforms::CodeEditor* self) : ViewWrapper(self) {
       }
 
       static bool create(CodeEditor* self, bool showInfo) {
+        documents().erase(self);
         return true;
       }
 
       static sptr_t send_editor(CodeEditor* self, unsigned int message, uptr_t wParam, sptr_t lParam) {
+        CodeEditorDocument& document = documents()[self];
+        switch (message) {
+          case SCI_SETTEXT:
+            document.text = reinterpret_cast<const char*>(lParam);
+            document.largestAppend = std::max(document.largestAppend, document.text.size());
+            break;
+          case SCI_CLEARALL:
+            document.text.clear();
+            break;
+          case SCI_APPENDTEXT:
+            document.text.append(reinterpret_cast<const char*>(lParam), wParam);
+            document.largestAppend = std::max(document.largestAppend, (std::size_t)wParam);
+            break;
+          case SCI_GETLENGTH:
+          case SCI_GETTEXTLENGTH:
+            return (sptr_t)document.text.size();
+          case SCI_GETCHARACTERPOINTER:
+            return reinterpret_cast<sptr_t>(document.text.c_str());
+        }
         return 0;
       }
 
@@ -46,6 +75,11 @@ namespace mforms {
       }
 
     public:
+      static std::map<CodeEditor*, CodeEditorDocument>& documents() {
+        static std::map<CodeEditor*, CodeEditorDocument> documents;
+        return documents;
+      }
+
       static void init() {
         ::mforms::ControlFactory* f = ::mforms::ControlFactory::get_instance();
 
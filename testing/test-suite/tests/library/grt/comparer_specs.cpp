@@ -156,6 +156,38 @@ $describe("Comparer tests") {
     $expect(change).toBeNull();
   });
 
+  $it("Structural hash skips identical subtrees and follows changes", []() {
+    casmine::SyntheticMySQLModel model1;
+    casmine::SyntheticMySQLModel model2;
+    grt::DbObjectMatchAlterOmf omf;
+    grt::NormalizedComparer normalizer(get_traits(true));
+    normalizer.init_omf(&omf);
+
+    uint64_t hash1 = 0, hash2 = 0;
+    $expect(grt::structural_hash(model1.catalog, &omf, hash1)).toBeTrue();
+    $expect(grt::structural_hash(model2.catalog, &omf, hash2)).toBeTrue();
+    $expect(hash1).toEqual(hash2);
+    $expect(diff_make(model1.catalog, model2.catalog, &omf)).toBeNull();
+
+    // A change deep down must reach the catalog hash, even though the catalog hash is cached by now.
+    std::string defaultValue = model2.column->defaultValue();
+    model2.column->defaultValue("42");
+    grt::structural_hash(model2.catalog, &omf, hash2);
+    $expect(hash1).Not.toEqual(hash2);
+    $expect(diff_make(model1.catalog, model2.catalog, &omf)).Not.toBeNull();
+
+    model2.column->defaultValue(defaultValue);
+    grt::structural_hash(model2.catalog, &omf, hash2);
+    $expect(hash1).toEqual(hash2);
+    $expect(diff_make(model1.catalog, model2.catalog, &omf)).toBeNull();
+
+    // Index columns are matched by the column they reference, which is not part of their own members.
+    model2.indexColumn->referencedColumn(model2.column2);
+    grt::structural_hash(model2.catalog, &omf, hash2);
+    $expect(hash1).Not.toEqual(hash2);
+    $expect(diff_make(model1.catalog, model2.catalog, &omf)).Not.toBeNull();
+  });
+
   $it("Name cases test", []() {
     std::vector<test_params> test_cases;
     test_cases.push_back(test_params(true, false, table_name_case, "Table Name Case"));
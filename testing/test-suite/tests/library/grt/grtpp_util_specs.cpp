@@ -33,6 +33,14 @@ using namespace grt;
 
 $ModuleEnvironment() {};
 
+// Changes its name without a change notification, so the list name index doesn't see it.
+class SilentAuthor : public test_Author {
+public:
+  void rename_silently(const std::string &name) {
+    _name = name;
+  }
+};
+
 $describe("GRT: util functions") {
 
   $beforeAll([&]() {
@@ -93,5 +101,83 @@ $describe("GRT: util functions") {
     $expect(book->publisher().id()).toBe(publisher.id());
   });
 
+  $it("Named object lookup through the list name index", []() {
+    test_BookRef book(grt::Initialized);
+    internal::OwnedList *list = dynamic_cast<internal::OwnedList *>(book->authors().valueptr());
+    $expect(list != nullptr).toBeTrue();
+
+    // The index is attached by the insert that reaches the threshold, never by a lookup.
+    for (size_t i = 0; i < 2 * internal::NAME_INDEX_THRESHOLD; ++i) {
+      test_AuthorRef author(grt::Initialized);
+      author->name("Author " + std::to_string(i));
+      book->authors().insert(author);
+      $expect(find_named_object_in_list(book->authors(), "Author 0").is_valid()).toBeTrue();
+      $expect(list->has_name_index()).toBe(i + 1 >= internal::NAME_INDEX_THRESHOLD);
+    }
+
+    test_AuthorRef author = find_named_object_in_list(book->authors(), "Author 10");
+    $expect(author.is_valid()).toBeTrue();
+    $expect(*author->name()).toBe("Author 10");
+    $expect(find_named_object_in_list(book->authors(), "author 10").is_valid()).toBeFalse();
+    $expect(find_named_object_in_list(book->authors(), "author 10", false) == author).toBeTrue();
+
+    // Renames are picked up through the change signal.
+    author->name("Renamed");
+    $expect(find_named_object_in_list(book->authors(), "Author 10").is_valid()).toBeFalse();
+    $expect(find_named_object_in_list(book->authors(), "RENAMED", false) == author).toBeTrue();
+
+    // Removal, insertion and replacement.
+    book->authors().remove_value(author);
+    $expect(find_named_object_in_list(book->authors(), "Renamed").is_valid()).toBeFalse();
+
+    test_AuthorRef other(grt::Initialized);
+    other->name("Renamed");
+    book->authors().insert(other, 0);
+    $expect(find_named_object_in_list(book->authors(), "Renamed") == other).toBeTrue();
+
+    book->authors().set(0, author);
+    $expect(find_named_object_in_list(book->authors(), "Renamed") == author).toBeTrue();
+
+    // Duplicate names resolve to the first one in list order, as without the index.
+    book->authors().insert(other);
+    $expect(find_named_object_in_list(book->authors(), "Renamed") == author).toBeTrue();
+    book->authors().remove(0);
+    $expect(find_named_object_in_list(book->authors(), "Renamed") == other).toBeTrue();
+
+    list->detach_name_index();
+    $expect(list->has_name_index()).toBeFalse();
+    $expect(find_named_object_in_list(book->authors(), "Author 11").is_valid()).toBeTrue();
+    $expect(list->has_name_index()).toBeFalse();
+  });
+
+  $it("Named object lookup misses are answered by the list name index alone", []() {
+    test_BookRef book(grt::Initialized);
+    internal::OwnedList *list = dynamic_cast<internal::OwnedList *>(book->authors().valueptr());
+    for (size_t i = 0; i < internal::NAME_INDEX_THRESHOLD; ++i) {
+      test_AuthorRef author(grt::Initialized);
+      author->name("Author " + std::to_string(i));
+      book->authors().insert(author);
+    }
+    $expect(list->has_name_index()).toBeTrue();
+
+    SilentAuthor *silent = new SilentAuthor();
+    test_AuthorRef author(silent);
+    author->name("Visible");
+    book->authors().insert(author);
+    silent->rename_silently("Hidden");
+
+    // Only a scan of the list could find the new name, the index still knows the old one.
+    $expect(find_named_object_in_list(book->authors(), "Hidden").is_valid()).toBeFalse();
+    $expect(find_named_object_in_list(book->authors(), "hidden", false).is_valid()).toBeFalse();
+    $expect(find_named_object_in_list(book->authors(), "Missing").is_valid()).toBeFalse();
+
+    // A stale hit is not returned.
+    $expect(find_named_object_in_list(book->authors(), "Visible").is_valid()).toBeFalse();
+
+    // Without the index the list is scanned.
+    list->detach_name_index();
+    $expect(find_named_object_in_list(book->authors(), "Hidden") == author).toBeTrue();
+  });
+
 }
 }
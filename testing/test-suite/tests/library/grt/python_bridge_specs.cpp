@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <chrono>
+
+#include "python_context.h"
+#include "grtpp_module_python.h"
+#include "grtpp_util.h"
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+
+namespace {
+
+using namespace grt;
+
+$ModuleEnvironment() {};
+
+$TestData {
+  PythonContext *context = nullptr;
+
+  // Returns the time in microseconds it took to run the given code the given number of times.
+  double measure(const std::string &code, size_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+      context->run_buffer(code);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count();
+  }
+
+  void report(const std::string &name, double microseconds, size_t iterations) {
+    if (std::get<bool>(casmine::CasmineContext::get()->settings["verbose"]))
+      std::cout << name << ": " << microseconds / iterations << "us per run" << std::endl;
+  }
+};
+
+$describe("GRT: Python bridge") {
+  $beforeAll([&]() {
+    WorkbenchTester::reinitGRT();
+    if (grt::GRT::get()->get_module_loader(LanguagePython) == nullptr)
+      grt::init_python_support("");
+
+    PythonModuleLoader *loader = dynamic_cast<PythonModuleLoader *>(grt::GRT::get()->get_module_loader(LanguagePython));
+    $expect(loader).Not.toBe(nullptr);
+    data->context = loader->get_python_context();
+  });
+
+  $afterAll([&]() {
+    WorkbenchTester::reinitGRT();
+  });
+
+  $it("Lists and dicts are passed to Python as proxies, not as copies", [&]() {
+    grt::StringListRef list(grt::Initialized);
+    list.insert("first");
+    grt::DictRef dict(true);
+    dict.set("key", grt::StringRef("value"));
+
+    {
+      WillEnterPython lock;
+      PyObject *pyList = data->context->from_grt(list);
+      PyObject *pyDict = data->context->from_grt(dict);
+      data->context->set_global("bridge_list", pyList);
+      data->context->set_global("bridge_dict", pyDict);
+      Py_XDECREF(pyList);
+      Py_XDECREF(pyDict);
+    }
+
+    $expect(data->context->run_buffer("bridge_list.append('second')")).toBe(0);
+    $expect(data->context->run_buffer("bridge_dict['other'] = 'value'")).toBe(0);
+
+    $expect(list.count()).toBe(2U);
+    $expect(*list[1]).toBe("second");
+    $expect(dict.has_key("other")).toBeTrue();
+
+    WillEnterPython lock;
+    PyObject *pyList = data->context->get_global("bridge_list");
+    ValueRef back = data->context->from_pyobject(pyList);
+    Py_XDECREF(pyList);
+    $expect(back.valueptr() == list.valueptr()).toBeTrue();
+  });
+
+  $it("Typed lists can be read through the buffer protocol", [&]() {
+    grt::IntegerListRef integers(grt::Initialized);
+    integers.insert(grt::IntegerRef(1));
+    integers.insert(grt::IntegerRef(2));
+    integers.insert(grt::IntegerRef(3));
+    grt::StringListRef strings(grt::Initialized);
+    strings.insert("ab");
+    strings.insert("c");
+
+    {
+      WillEnterPython lock;
+      PyObject *pyIntegers = data->context->from_grt(integers);
+      PyObject *pyStrings = data->context->from_grt(strings);
+      data->context->set_global("bridge_integers", pyIntegers);
+      data->context->set_global("bridge_strings", pyStrings);
+      Py_XDECREF(pyIntegers);
+      Py_XDECREF(pyStrings);
+    }
+
+    $expect(data->context->run_buffer(
+              "assert memoryview(bridge_integers).tolist() == [1, 2, 3]\n"
+              "assert memoryview(bridge_strings).tobytes() == 'ab\\0c\\0'\n"
+              "assert bridge_integers.tolist() == [1, 2, 3]\n"))
+      .toBe(0);
+  });
+
+  $it("Call overhead benchmark", [&]() {
+    grt::IntegerListRef integers(grt::Initialized);
+    for (ssize_t i = 0; i < 100000; ++i)
+      integers.insert(grt::IntegerRef(i));
+
+    {
+      WillEnterPython lock;
+      PyObject *pyIntegers = data->context->from_grt(integers);
+      data->context->set_global("bridge_integers", pyIntegers);
+      Py_XDECREF(pyIntegers);
+    }
+
+    const size_t iterations = 20;
+    data->report("item access", data->measure("for i in xrange(len(bridge_integers)): bridge_integers[i]", iterations),
+                 iterations);
+    data->report("bulk tolist()", data->measure("bridge_integers.tolist()", iterations), iterations);
+    data->report("buffer export", data->measure("memoryview(bridge_integers).tolist()", iterations), iterations);
+
+    double wrapTime;
+    {
+      WillEnterPython lock;
+      auto start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < 100000; ++i) {
+        PyObject *proxy = data->context->from_grt(integers);
+        Py_XDECREF(proxy);
+      }
+      auto end = std::chrono::steady_clock::now();
+      wrapTime = std::chrono::duration<double, std::micro>(end - start).count();
+    }
+    data->report("list proxy creation", wrapTime, 100000);
+    $expect(integers.count()).toBe(100000U);
+  });
+});
+
+}
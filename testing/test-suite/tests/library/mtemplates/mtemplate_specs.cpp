@@ -25,6 +25,7 @@
 #include "mtemplate/template.h"
 #include "base/string_utilities.h"
 #include <fstream>
+#include <algorithm>
 
 #include "casmine.h"
 
@@ -260,6 +261,109 @@ $describe("mtemplate") {
     $expect(compare_file_contents(data->dataDir + "/mtemplate/test_result.html", data->outputDir + "/test_result.html")).toBeTrue();
   });
 
+  $it("Data sources give the same output as dictionaries", [this]() {
+    // Serves a ROW section with one row per language and a FIELD section with 2 fields per row.
+    class LanguageSource : public mtemplate::DataSource {
+      class Fields : public mtemplate::DataSource {
+      public:
+        const std::pair<const std::string, base::utf8string> *row = nullptr;
+        size_t field = 0;
+        size_t valueSlot = 0;
+
+        bool value(size_t slot, std::string &result) override {
+          if (slot != valueSlot)
+            return false;
+          result += field == 1 ? row->first : row->second.to_string();
+          return true;
+        }
+        DataSource *section(size_t slot) override {
+          return nullptr;
+        }
+        bool next() override {
+          return ++field <= 2;
+        }
+        bool isLast() override {
+          return field == 2;
+        }
+      };
+
+      class Rows : public mtemplate::DataSource {
+      public:
+        const std::map<std::string, base::utf8string> *languages = nullptr;
+        std::map<std::string, base::utf8string>::const_iterator current;
+        bool started = false;
+        size_t fieldSlot = 0;
+        Fields fields;
+
+        bool value(size_t slot, std::string &result) override {
+          return false;
+        }
+        DataSource *section(size_t slot) override {
+          if (slot != fieldSlot)
+            return nullptr;
+          fields.row = &*current;
+          fields.field = 0;
+          return &fields;
+        }
+        bool next() override {
+          current = started ? std::next(current) : languages->begin();
+          started = true;
+          return current != languages->end();
+        }
+        bool isLast() override {
+          return std::next(current) == languages->end();
+        }
+      };
+
+    public:
+      Rows rows;
+      size_t rowSlot = 0;
+
+      void prepare(const std::vector<std::string> &variables, const std::vector<std::string> &sections) override {
+        rowSlot = std::find(sections.begin(), sections.end(), "ROW") - sections.begin();
+        rows.fieldSlot = std::find(sections.begin(), sections.end(), "FIELD") - sections.begin();
+        rows.fields.valueSlot = std::find(variables.begin(), variables.end(), "FIELD_VALUE") - variables.begin();
+      }
+      bool value(size_t slot, std::string &result) override {
+        return false;
+      }
+      DataSource *section(size_t slot) override {
+        if (slot != rowSlot)
+          return nullptr;
+        rows.started = false;
+        return &rows;
+      }
+    };
+
+    mtemplate::SetGlobalValue("TABLE_NAME", "some_table");
+    mtemplate::Modifier::addModifier<CSVTokenQuoteModifier>("csv_quote");
+    base::utf8string text = "INSERT INTO {{TABLE_NAME}} VALUES\n"
+                            "{{#ROW}}({{#FIELD}}{{FIELD_VALUE:csv_quote}}{{#FIELD_separator}}, {{/FIELD_separator}}"
+                            "{{/FIELD}}){{#ROW_separator}},\n{{/ROW_separator}}{{/ROW}};\n";
+
+    for (mtemplate::PARSE_TYPE type : { mtemplate::DO_NOT_STRIP, mtemplate::STRIP_BLANK_LINES }) {
+      mtemplate::Template tpl(mtemplate::parseTemplate(text, type));
+
+      std::unique_ptr<mtemplate::DictionaryInterface> dictionary(mtemplate::CreateMainDictionary());
+      for (auto &item : data->language_details_map) {
+        mtemplate::DictionaryInterface *row = dictionary->addSectionDictionary("ROW");
+        row->addSectionDictionary("FIELD")->setValue("FIELD_VALUE", item.first);
+        row->addSectionDictionary("FIELD")->setValue("FIELD_VALUE", item.second);
+      }
+      mtemplate::TemplateOutputString fromDictionary;
+      tpl.expand(dictionary.get(), &fromDictionary);
+
+      LanguageSource source;
+      source.rows.languages = &data->language_details_map;
+      mtemplate::TemplateOutputString fromSource;
+      tpl.expand(source, &fromSource);
+
+      $expect(fromSource.get().to_string()).toBe(fromDictionary.get().to_string());
+      $expect(fromSource.get().starts_with("INSERT INTO some_table VALUES\n(")).toBeTrue();
+      $expect(fromSource.get().ends_with(");\n")).toBeTrue();
+    }
+  });
+
 }
 
 }
@@ -32,6 +32,10 @@
 #include "mysql/MySQLParserBaseVisitor.h"
 
 #include "grtsqlparser/mysql_parser_services.h"
+#include "grtsqlparser/sql_script_reader.h"
+
+#include <chrono>
+#include <random>
 
 // This file contains unit tests for the statement splitter and the ANTLR based parser.
 // These are low level tests. There's another set of high level tests (see test_mysql_sqldata->parser.cpp).
@@ -361,6 +365,237 @@ static bool versionMatches(std::string &statement, unsigned long serverVersion)
 
 //----------------------------------------------------------------------------------------------------------------------
 
+static const unsigned char *referenceSkipWhitespace(const unsigned char *head, const unsigned char *tail) {
+  while (head < tail && *head <= ' ')
+    head++;
+  return head;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool referenceIsLineBreak(const unsigned char *head, const unsigned char *line_break) {
+  if (*line_break == '\0')
+    return false;
+
+  while (*head != '\0' && *line_break != '\0' && *head == *line_break) {
+    head++;
+    line_break++;
+  }
+  return *line_break == '\0';
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * The byte-at-a-time statement splitter, as it was before the SSE2 based skipping was added. Used as reference
+ * for MySQLParserServices::determineStatementRanges, which must always return exactly the same results.
+ */
+static size_t referenceStatementRanges(const char *sql, size_t length, const std::string &initialDelimiter,
+  std::vector<StatementRange> &ranges, const std::string &lineBreak, std::string *endDelimiter) {
+
+  static const unsigned char keyword[] = "delimiter";
+
+  std::string delimiter = initialDelimiter.empty() ? ";" : initialDelimiter;
+  const unsigned char *delimiterHead = reinterpret_cast<const unsigned char *>(delimiter.c_str());
+
+  const unsigned char *start = reinterpret_cast<const unsigned char *>(sql);
+  const unsigned char *head = start;
+  const unsigned char *tail = head;
+  const unsigned char *end = head + length;
+  const unsigned char *newLine = reinterpret_cast<const unsigned char *>(lineBreak.c_str());
+
+  size_t currentLine = 0;
+  size_t statementStart = 0;
+  size_t consumed = 0;
+  bool haveContent = false; // Set when anything else but comments were found for the current statement.
+
+  while (tail < end) {
+    switch (*tail) {
+      case '/': { // Possible multi line comment or hidden (conditional) command.
+        if (*(tail + 1) == '*') {
+          tail += 2;
+          bool isHiddenCommand = (*tail == '!');
+          while (true) {
+            while (tail < end && *tail != '*') {
+              if (referenceIsLineBreak(tail, newLine))
+                ++currentLine;
+              tail++;
+            }
+
+            if (tail == end) // Unfinished comment.
+              break;
+            else {
+              if (*++tail == '/') {
+                tail++; // Skip the slash too.
+                break;
+              }
+            }
+          }
+
+          if (isHiddenCommand)
+            haveContent = true;
+          if (!haveContent) {
+            head = tail; // Skip over the comment.
+            statementStart = currentLine;
+          }
+
+        } else
+          tail++;
+
+        break;
+      }
+
+      case '-': { // Possible single line comment.
+        const unsigned char *end_char = tail + 2;
+        if (*(tail + 1) == '-' && (*end_char == ' ' || *end_char == '\t' || referenceIsLineBreak(end_char, newLine))) {
+          // Skip everything until the end of the line.
+          tail += 2;
+          while (tail < end && !referenceIsLineBreak(tail, newLine))
+            tail++;
+
+          if (!haveContent) {
+            head = tail;
+            statementStart = currentLine;
+          }
+        } else
+          tail++;
+
+        break;
+      }
+
+      case '#': { // MySQL single line comment.
+        while (tail < end && !referenceIsLineBreak(tail, newLine))
+          tail++;
+
+        if (!haveContent) {
+          head = tail;
+          statementStart = currentLine;
+        }
+
+        break;
+      }
+
+      case '"':
+      case '\'':
+      case '`': { // Quoted string/id. Skip this in a local loop.
+        haveContent = true;
+        unsigned char quote = *tail++;
+        while (tail < end && *tail != quote) {
+          // Skip any escaped character too.
+          if (*tail == '\\' && tail + 1 < end)
+            tail++;
+          else if (referenceIsLineBreak(tail, newLine))
+            ++currentLine;
+          tail++;
+        }
+        if (*tail == quote)
+          tail++; // Skip trailing quote char if one was there.
+
+        break;
+      }
+
+      case 'd':
+      case 'D': {
+        haveContent = true;
+
+        // Possible start of the keyword DELIMITER. Must be at the start of the text or a character,
+        // which is not part of a regular MySQL identifier (0-9, A-Z, a-z, _, $, \u0080-\uffff).
+        unsigned char previous = tail > start ? *(tail - 1) : 0;
+        bool is_identifier_char = previous >= 0x80 || (previous >= '0' && previous <= '9') ||
+                                  ((previous | 0x20) >= 'a' && (previous | 0x20) <= 'z') || previous == '$' ||
+                                  previous == '_';
+        if (tail == start || !is_identifier_char) {
+          const unsigned char *run = tail + 1;
+          const unsigned char *kw = keyword + 1;
+          int count = 9;
+          while (count-- > 1 && (*run++ | 0x20) == *kw++)
+            ;
+          if (count == 0 && *run == ' ') {
+            // Delimiter keyword found. Get the new delimiter (everything until the end of the line).
+            tail = run++;
+            while (run < end && !referenceIsLineBreak(run, newLine))
+              ++run;
+            delimiter = base::trim(std::string(reinterpret_cast<const char *>(tail), run - tail));
+            delimiterHead = reinterpret_cast<const unsigned char *>(delimiter.c_str());
+
+            // Skip over the delimiter statement and any following line breaks.
+            while (referenceIsLineBreak(run, newLine)) {
+              ++currentLine;
+              ++run;
+            }
+            tail = run;
+            head = tail;
+            statementStart = currentLine;
+            consumed = tail - start;
+            haveContent = false;
+          } else
+            ++tail;
+        } else
+          ++tail;
+
+        break;
+      }
+
+      default:
+        if (referenceIsLineBreak(tail, newLine)) {
+          ++currentLine;
+          if (!haveContent)
+            ++statementStart;
+        }
+
+        if (*tail > ' ')
+          haveContent = true;
+        tail++;
+        break;
+    }
+
+    if (*tail == *delimiterHead) {
+      // Found possible start of the delimiter. Check if it really is.
+      size_t count = delimiter.size();
+      if (count == 1) {
+        // Most common case. Trim the statement and check if it is not empty before adding the range.
+        head = referenceSkipWhitespace(head, tail);
+        if (head < tail)
+          ranges.push_back({ statementStart, static_cast<size_t>(head - start), static_cast<size_t>(tail - head) });
+        head = ++tail;
+        statementStart = currentLine;
+        consumed = tail - start;
+        haveContent = false;
+      } else {
+        const unsigned char *run = tail + 1;
+        const unsigned char *del = delimiterHead + 1;
+        while (count-- > 1 && (*run++ == *del++))
+          ;
+
+        if (count == 0) {
+          // Multi char delimiter is complete. Tail still points to the start of the delimiter.
+          // Run points to the first character after the delimiter.
+          head = referenceSkipWhitespace(head, tail);
+          if (head < tail)
+            ranges.push_back({ statementStart, static_cast<size_t>(head - start), static_cast<size_t>(tail - head) });
+          tail = run;
+          head = run;
+          statementStart = currentLine;
+          consumed = tail - start;
+          haveContent = false;
+        }
+      }
+    }
+  }
+
+  // Add remaining text to the range list.
+  head = referenceSkipWhitespace(head, tail);
+  if (head < tail)
+    ranges.push_back({ statementStart, static_cast<size_t>(head - start), static_cast<size_t>(tail - head) });
+
+  if (endDelimiter != nullptr)
+    *endDelimiter = delimiter;
+
+  return consumed;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 class TestErrorListener : public BaseErrorListener {
 public:
   std::string lastErrors;
@@ -758,6 +993,113 @@ $describe("MySQL parser test suite (ANTLR)") {
 
   //--------------------------------------------------------------------------------------------------------------------
 
+  $it("Chunked statement splitting gives the same statements as splitting the entire script", [this]() {
+    // The schema script contains DELIMITER commands, the data script very long statements.
+    for (auto name : { "/db/sakila-db/sakila-schema.sql", "/db/sakila-db/sakila-data.sql" }) {
+      std::string filename = data->dataDir + name;
+
+      std::ifstream stream(filename, std::ios::binary);
+      $expect(stream.good()).toBeTrue("Error loading sql file");
+      std::string sql((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+      std::vector<StatementRange> ranges;
+      data->services->determineStatementRanges(sql.c_str(), sql.size(), ";", ranges);
+
+      for (size_t chunkSize : { 7, 100, 4096 }) {
+        SqlScriptReader reader(filename, ";", chunkSize);
+
+        std::string statement;
+        size_t line = 0;
+        size_t index = 0;
+        while (reader.next(statement, &line)) {
+          $expect(index).toBeLessThan(ranges.size(), "Too many statements returned from chunked splitting");
+          if (index >= ranges.size())
+            break;
+
+          $expect(statement).toBe(sql.substr(ranges[index].start, ranges[index].length));
+          $expect(line).toBe(ranges[index].line);
+          ++index;
+        }
+        $expect(index).toBe(ranges.size());
+        $expect(reader.offset()).toBe(reader.size());
+      }
+    }
+  });
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  $it("Statement splitter gives the same results as the byte-at-a-time reference", [this]() {
+    // Random scripts made of everything the splitter has to care about, in lengths which let special characters
+    // end up anywhere in the 16 byte blocks the splitter skips over.
+    static const std::vector<std::string> pieces = {
+      "select", " ", "\n", "\r\n", "\t", ";", "$$", "//", "/*", "*/", "/*!", "-- ", "--", "#", "'", "\"", "`", "\\",
+      "delimiter ", "DELIMITER $$\n", "DELIMITER ;\n", "d", "D", "abcdefghijklmnopqrstuvwxyz0123456789",
+      "\xE2\x82\xAC", "x", "-", "/", "*", "0"
+    };
+
+    std::mt19937 random(20201018);
+    for (size_t i = 0; i < 20000; ++i) {
+      std::string sql;
+      size_t count = random() % 60;
+      for (size_t j = 0; j < count; ++j)
+        sql += pieces[random() % pieces.size()];
+
+      for (auto delimiter : { ";", "$$" }) {
+        for (auto lineBreak : { "\n", "\r\n" }) {
+          std::vector<StatementRange> expected;
+          std::string expectedDelimiter;
+          size_t expectedConsumed = referenceStatementRanges(sql.c_str(), sql.size(), delimiter, expected, lineBreak,
+                                                             &expectedDelimiter);
+
+          std::vector<StatementRange> ranges;
+          std::string endDelimiter;
+          size_t consumed =
+            data->services->determineStatementRanges(sql.c_str(), sql.size(), delimiter, ranges, lineBreak, &endDelimiter);
+
+          bool same = consumed == expectedConsumed && endDelimiter == expectedDelimiter && ranges.size() == expected.size();
+          for (size_t j = 0; same && j < ranges.size(); ++j)
+            same = ranges[j].line == expected[j].line && ranges[j].start == expected[j].start &&
+                   ranges[j].length == expected[j].length;
+          $expect(same).toBeTrue("Statement ranges differ for: " + sql);
+          if (!same)
+            return;
+        }
+      }
+    }
+  });
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  $it("Statement splitter throughput", [this]() {
+    std::ifstream stream(data->dataDir + "/db/sakila-db/sakila-data.sql", std::ios::binary);
+    $expect(stream.good()).toBeTrue("Error loading sql file");
+    std::string script((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+    std::string sql;
+    while (sql.size() < 32 * 1024 * 1024)
+      sql += script;
+
+    auto measure = [&](std::function<void (std::vector<StatementRange> &)> split, const std::string &name) {
+      std::vector<StatementRange> ranges;
+      auto start = std::chrono::steady_clock::now();
+      split(ranges);
+      double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      if (std::get<bool>(casmine::CasmineContext::get()->settings["verbose"]))
+        std::cout << name << ": " << sql.size() / seconds / 1e9 << " GB/s" << std::endl;
+      return ranges.size();
+    };
+
+    size_t expected = measure([&](std::vector<StatementRange> &ranges) {
+      referenceStatementRanges(sql.c_str(), sql.size(), ";", ranges, "\n", nullptr);
+    }, "Byte-at-a-time splitter");
+    size_t count = measure([&](std::vector<StatementRange> &ranges) {
+      data->services->determineStatementRanges(sql.c_str(), sql.size(), ";", ranges);
+    }, "Statement splitter");
+    $expect(count).toBe(expected);
+  });
+
+  //--------------------------------------------------------------------------------------------------------------------
+
   $it("Parse a number of files with various statements", [this]() {
     std::size_t count = 0;
     for (auto entry : testFiles) {
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "SSHTunnelHandler.h"
+#include "SSHSessionPool.h"
+
+#include "casmine.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+// Parts of the SSH library which can be tested without an SSH server. The others are in ssh_specs.cpp.
+$describe("SSH library") {
+  $it("Tunnel buffer keeps data in order across wrap arounds", []() {
+    ssh::TunnelBuffer buffer(7);
+    std::string written, read;
+    char next = 'a';
+
+    // Alternate partial writes and reads of varying size, so the stored data wraps around the buffer end repeatedly.
+    for (std::size_t round = 0; round < 100; ++round) {
+      std::size_t length = 0;
+      char *target = buffer.writePointer(length);
+      length = std::min(length, round % 5 + 1);
+      for (std::size_t i = 0; i < length; ++i) {
+        target[i] = next;
+        written += next;
+        next = (next == 'z') ? 'a' : next + 1;
+      }
+      buffer.commit(length);
+      $expect(buffer.size() <= buffer.capacity()).toBeTrue();
+
+      const char *source = buffer.readPointer(length);
+      length = std::min(length, round % 3 + 1);
+      read.append(source, length);
+      buffer.consume(length);
+    }
+
+    while (!buffer.empty()) {
+      std::size_t length = 0;
+      const char *source = buffer.readPointer(length);
+      read.append(source, length);
+      buffer.consume(length);
+    }
+    $expect(read).toBe(written);
+
+    std::size_t length = 0;
+    buffer.writePointer(length);
+    $expect(length).toBe(7U, "An empty buffer must offer its full capacity");
+  });
+
+  $it("Session pool keys depend on the credentials", []() {
+    ssh::SSHConnectionConfig config;
+    config.remoteSSHhost = "db.example.com";
+    config.remoteSSHport = 22;
+
+    ssh::SSHConnectionCredentials credentials;
+    credentials.username = "admin";
+    credentials.password = "secret";
+    credentials.auth = ssh::SSHAuthtype::PASSWORD;
+    std::string key = ssh::SSHSessionPool::keyFor(config, credentials);
+
+    $expect(key.find("admin@db.example.com:22")).toBe(0U);
+    $expect(key.find("secret")).toBe(std::string::npos, "The key must not contain the password");
+
+    // Tunnels to other targets on the same server share the session.
+    auto otherTarget = config;
+    otherTarget.remotehost = "10.0.0.1";
+    otherTarget.remoteport = 3307;
+    $expect(ssh::SSHSessionPool::keyFor(otherTarget, credentials)).toBe(key);
+
+    auto otherPassword = credentials;
+    otherPassword.password = "guess";
+    $expect(ssh::SSHSessionPool::keyFor(config, otherPassword)).Not.toBe(key);
+
+    auto keyFile = credentials;
+    keyFile.auth = ssh::SSHAuthtype::KEYFILE;
+    keyFile.password = "";
+    keyFile.keyfile = "/home/admin/.ssh/id_rsa";
+    std::string keyFileKey = ssh::SSHSessionPool::keyFor(config, keyFile);
+    $expect(keyFileKey).Not.toBe(key);
+
+    keyFile.keyfile = "/home/admin/.ssh/other_key";
+    $expect(ssh::SSHSessionPool::keyFor(config, keyFile)).Not.toBe(keyFileKey);
+  });
+}
+
+}
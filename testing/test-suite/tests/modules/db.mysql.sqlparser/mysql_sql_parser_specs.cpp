@@ -226,6 +226,52 @@ $describe("High level MySQL parser tests") {
     data->testImportSQL(900, "test", "new_schema_name");
   });
 
+  $it("Parallel import gives the same catalog as sequential import", [this]() {
+    // Enough statements for several parse batches. Foreign keys point forward and backward and some statements
+    // depend on the order of execution (USE, DROP, CREATE INDEX), so any reordering would show up in the result.
+    std::string sql;
+    for (size_t schema = 0; schema < 3; ++schema) {
+      sql += "CREATE DATABASE s" + std::to_string(schema) + ";\nUSE s" + std::to_string(schema) + ";\n";
+      for (size_t i = 0; i < 300; ++i) {
+        std::string name = "t" + std::to_string(i);
+        std::string target = "t" + std::to_string((i * 7 + 3) % 300);
+        sql += "CREATE TABLE " + name + " (id INT PRIMARY KEY, ref_id INT, label VARCHAR(45), "
+          "CONSTRAINT fk_" + name + " FOREIGN KEY (ref_id) REFERENCES " + target + " (id));\n";
+        if (i % 50 == 0)
+          sql += "CREATE INDEX idx_label ON " + name + " (label);\n";
+        if (i % 75 == 0)
+          sql += "DROP TABLE " + name + ";\n";
+      }
+    }
+    sql += "CREATE TABLE s0.broken (id INT PRIMARY KEY,;\n";
+
+    auto parse = [&](size_t threads, size_t &errorCount) {
+      db_mysql_CatalogRef catalog(grt::Initialized);
+      catalog->version(bec::parse_version("5.7.10"));
+      grt::replace_contents(catalog->simpleDatatypes(), data->tester->getRdbms()->simpleDatatypes());
+
+      DictRef options(true);
+      options.set("gen_fk_names_when_empty", IntegerRef(0));
+      options.set("parse_threads", IntegerRef((ssize_t)threads));
+      options.set("errors", StringListRef(grt::Initialized));
+      errorCount = data->services->parseSQLIntoCatalog(data->context, catalog, sql, options);
+      return catalog;
+    };
+
+    size_t sequentialErrors = 0, parallelErrors = 0;
+    db_mysql_CatalogRef sequential = parse(1, sequentialErrors);
+    db_mysql_CatalogRef parallel = parse(4, parallelErrors);
+
+    $expect(sequentialErrors > 0).toBeTrue("The broken statement must be reported");
+    $expect(parallelErrors).toBe(sequentialErrors);
+    $expect(parallel->schemata().count()).toBe(sequential->schemata().count());
+    deepCompareGrtValues("Parallel import", parallel, sequential);
+
+    db_mysql_TableRef table = grt::find_named_object_in_list(parallel->schemata()[1]->tables(), "t1");
+    $expect(table.is_valid()).toBeTrue();
+    $expect(*table->foreignKeys()[0]->referencedTable()->name()).toBe("t10");
+  });
+
 }
 
 }
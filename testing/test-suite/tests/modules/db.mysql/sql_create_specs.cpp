@@ -519,6 +519,74 @@ $describe("SQL code generation") {
     data->tester->wb->close_document_finish();
   });
 
+  $it("Parallel diff and alter script generation give the same output as sequential", [this]() {
+    NormalizedComparer cmp;
+
+    data->tester->wb->open_document(data->dataDir + "/forward_engineer/sakila_full.mwb");
+    db_mysql_CatalogRef catalog = db_mysql_CatalogRef::cast_from(data->tester->getCatalog());
+    db_mysql_CatalogRef modified = copy_object(catalog);
+
+    // Touch every table, drop a foreign key from some so the drop pass has work too.
+    grt::ListRef<db_mysql_Table> tables = modified->schemata()[0]->tables();
+    $expect(tables.count()).toBeGreaterThan(8U);
+    for (size_t i = 0; i < tables.count(); ++i) {
+      db_mysql_TableRef table = tables[i];
+      table->comment("changed comment " + std::to_string(i));
+      table->columns()[0]->comment("changed column comment");
+      if (i % 2 == 0 && table->foreignKeys().count() > 0)
+        table->foreignKeys().remove(0);
+    }
+
+    // New triggers with the same timing and event on one table. The second one follows the first, which is
+    // created earlier in the same script, so it must keep its own definition instead of getting a FOLLOWS clause.
+    db_mysql_TableRef triggerTable = tables[0];
+    for (int i = 1; i <= 2; ++i) {
+      std::string name = "touch_" + std::to_string(i);
+      db_mysql_TriggerRef trigger(grt::Initialized);
+      trigger->owner(triggerTable);
+      trigger->name(name);
+      trigger->timing("BEFORE");
+      trigger->event("UPDATE");
+      trigger->sqlBody("SET NEW.last_update = NOW()");
+      trigger->sqlDefinition("CREATE TRIGGER `" + name + "` BEFORE UPDATE ON `" + *triggerTable->name() +
+                             "` FOR EACH ROW SET NEW.last_update = NOW()");
+      triggerTable->triggers().insert(trigger);
+    }
+
+    auto generate = [&](unsigned int threads) {
+      DbObjectMatchAlterOmf omf;
+      cmp.init_omf(&omf);
+      omf.threads = threads;
+      std::shared_ptr<DiffChange> alter_change = diff_make(catalog, modified, &omf);
+      $expect(alter_change).toBeValid();
+
+      StringListRef alter_list(grt::Initialized);
+      ListRef<GrtNamedObject> alter_object_list(true);
+      DictRef options(true);
+      options.set("UseFilteredLists", grt::IntegerRef(0));
+      options.set("OutputContainer", alter_list);
+      options.set("OutputObjectContainer", alter_object_list);
+      options.set("CaseSensitive", grt::IntegerRef(omf.case_sensitive));
+      options.set("GeneratorThreads", grt::IntegerRef(threads));
+      data->diffsqlModule->generateSQL(modified, options, alter_change);
+
+      std::string result;
+      for (size_t i = 0; i < alter_list.count(); ++i)
+        result += alter_object_list[i]->id() + "\n" + *alter_list[i] + "\n";
+      return result;
+    };
+
+    std::string sequential = generate(1);
+    $expect(sequential).Not.toEqual("");
+    $expect(sequential.find("CREATE TRIGGER `touch_2` BEFORE UPDATE")).Not.toBe(std::string::npos);
+    $expect(sequential.find("FOLLOWS `touch_1`")).toBe(std::string::npos);
+    $expect(generate(4)).toEqual(sequential);
+    $expect(generate(0)).toEqual(sequential);
+
+    data->tester->wb->close_document();
+    data->tester->wb->close_document_finish();
+  });
+
 }
 
 }
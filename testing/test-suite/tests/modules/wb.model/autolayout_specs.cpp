@@ -0,0 +1,575 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "casmine.h"
+
+#include "force_layouter.h"
+
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+#ifndef M_PI_2
+#define M_PI_2 1.57079632679489661923
+#endif
+
+#define PI_38 M_PI * 0.375
+#define PI_58 M_PI * 0.625
+
+namespace {
+
+$ModuleEnvironment() {};
+
+// A synthetic schema: modules of 5 to 40 tables, where tables reference up to 2 tables of their own module
+// and every 10th table references a table anywhere before it.
+struct Schema {
+  std::vector<std::pair<double, double>> sizes;
+  std::vector<std::pair<std::size_t, std::size_t>> references;
+  double width;
+  double height;
+
+  Schema(std::size_t count, unsigned int seed) {
+    std::mt19937 random(seed);
+    std::size_t module_start = 0, module_end = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      if (i == module_end) {
+        module_start = i;
+        module_end = i + 5 + random() % 36;
+      }
+      sizes.push_back({ 120.0 + random() % 100, 40.0 + 17.0 * (3 + random() % 13) });
+      if (i > module_start) {
+        for (std::size_t j = random() % 3; j > 0; --j)
+          references.push_back({ i, module_start + random() % (i - module_start) });
+      }
+      if (i > 0 && i % 10 == 0)
+        references.push_back({ i, random() % i });
+    }
+
+    // Diagram size as created for this number of objects by WbModelImpl (about 15 objects per page).
+    double pages = std::ceil(count / 15.0);
+    double rows = std::max(1.0, std::floor(std::sqrt(pages)));
+    width = std::ceil(pages / rows) * 1500;
+    height = rows * 2000;
+  }
+
+  template <typename Layouter>
+  void fill(Layouter &layouter) const {
+    for (auto &size : sizes)
+      layouter.add_node(size.first, size.second);
+    for (auto &reference : references)
+      layouter.connect(reference.first, reference.second);
+  }
+
+  // Number of overlapping pairs for the given top left corners.
+  std::size_t overlaps(const std::vector<std::pair<double, double>> &positions) const {
+    std::size_t result = 0;
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+      for (std::size_t j = i + 1; j < positions.size(); ++j) {
+        if (positions[i].first < positions[j].first + sizes[j].first &&
+            positions[j].first < positions[i].first + sizes[i].first &&
+            positions[i].second < positions[j].second + sizes[j].second &&
+            positions[j].second < positions[i].second + sizes[i].second)
+          ++result;
+      }
+    }
+    return result;
+  }
+
+  // Average distance between the centers of referencing tables.
+  double reference_length(const std::vector<std::pair<double, double>> &positions) const {
+    double length = 0;
+    for (auto &reference : references) {
+      std::size_t a = reference.first, b = reference.second;
+      length += std::hypot(positions[a].first + sizes[a].first / 2 - positions[b].first - sizes[b].first / 2,
+                           positions[a].second + sizes[a].second / 2 - positions[b].second - sizes[b].second / 2);
+    }
+    return references.empty() ? 0 : length / references.size();
+  }
+};
+
+static std::vector<std::pair<double, double>> positions(const ForceLayouter &layouter) {
+  std::vector<std::pair<double, double>> result;
+  for (std::size_t i = 0; i < layouter.node_count(); ++i)
+    result.push_back({ layouter.node(i).left, layouter.node(i).top });
+  return result;
+}
+
+static void report(const std::string &text) {
+  if (std::get<bool>(casmine::CasmineContext::get()->settings["verbose"]))
+    std::cout << text << std::endl;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// The random step layouter ForceLayouter replaced, working on plain rectangles. Used as benchmark baseline.
+class PreviousLayouter {
+public:
+  PreviousLayouter(double width, double height);
+  void add_node(double w, double h);
+  void connect(std::size_t n1, std::size_t n2);
+  int do_layout();
+
+  std::vector<std::pair<double, double>> positions; // Top left corners, in the order nodes were added.
+
+private:
+  struct Node;
+
+  static bool compare_node_links(const Node &n1, const Node &n2);
+
+  bool shuffle();
+  double calc_energy();
+  double calc_node_energy(const std::size_t i, const Node &n);
+  long distance_to_node(const std::size_t n1, const std::size_t n2, bool *is_horiz = NULL);
+  double calc_node_pair(const std::size_t i1, const std::size_t i2);
+  void prepare_layout_stages();
+
+  const double _w;
+  const double _h;
+
+  struct Node {
+    Node(long w, long h);
+    void move_by(const long dx, const long dy);
+    void move(const long x, const long y);
+    bool is_linked_to(const ssize_t node) const;
+
+    long w;
+    long h;
+    long x1;
+    long y1;
+    long x2;
+    long y2;
+    std::size_t index;
+    std::vector<ssize_t> linked;
+  };
+  typedef std::vector<Node> NodesList;
+  NodesList _figures;
+  long _min_dist; // desired dist between nodes
+  double _min_energy;
+  int _cell_w;
+  int _cell_h;
+};
+
+//------------------------------------------------------------------------------
+PreviousLayouter::Node::Node(long w, long h) : w(w), h(h), x1(0), y1(0), x2(w), y2(h), index(0) {
+}
+
+//------------------------------------------------------------------------------
+void PreviousLayouter::Node::move(const long x, const long y) {
+  x1 = x;
+  y1 = y;
+  x2 = x1 + w;
+  y2 = y1 + h;
+}
+
+//------------------------------------------------------------------------------
+void PreviousLayouter::Node::move_by(const long dx, const long dy) {
+  x1 += dx;
+  y1 += dy;
+  x2 += dx;
+  y2 += dy;
+}
+
+//------------------------------------------------------------------------------
+bool PreviousLayouter::Node::is_linked_to(const ssize_t node) const {
+  bool found = false;
+
+  for (ssize_t i = linked.size() - 1; i >= 0; --i) {
+    if (linked[i] == node) {
+      found = true;
+      break;
+    }
+  }
+
+  return found;
+}
+
+//------------------------------------------------------------------------------
+PreviousLayouter::PreviousLayouter(double width, double height)
+  : _w(width), _h(height), _min_dist(80), _min_energy(0), _cell_w(0), _cell_h(0) {
+}
+
+//------------------------------------------------------------------------------
+void PreviousLayouter::add_node(double w, double h) {
+  _figures.push_back(Node((long)w, (long)h));
+  _figures.back().index = _figures.size() - 1;
+}
+
+//------------------------------------------------------------------------------
+void PreviousLayouter::connect(std::size_t n1, std::size_t n2) {
+  _figures[n1].linked.push_back(n2);
+  _figures[n2].linked.push_back(n1);
+}
+
+//------------------------------------------------------------------------------
+long PreviousLayouter::distance_to_node(const std::size_t i1, const std::size_t i2, bool *is_horiz) {
+  const Node &n1 = _figures[i1];
+  const Node &n2 = _figures[i2];
+  const long x11 = n1.x1;
+  const long y11 = n1.y1;
+  const long x12 = n1.x2;
+  const long y12 = n1.y2;
+
+  const long x21 = n2.x1;
+  const long y21 = n2.y1;
+  const long x22 = n2.x2;
+  const long y22 = n2.y2;
+
+  const long cx1 = x11 + (x12 - x11) / 2;
+  const long cy1 = y11 + (y12 - y11) / 2;
+  const long cx2 = x21 + (x22 - x21) / 2;
+  const long cy2 = y21 + (y22 - y21) / 2;
+  const long dcx = cx2 - cx1;
+  const double qr = atan2((double)dcx, (double)(cy2 - cy1));
+
+  double dx = 0;
+  double dy = 0;
+  double l1 = 0;
+  double l2 = 0;
+  if (qr > M_PI_2) {
+    dy = y11 - y22;
+    dx = x21 - x12;
+    l1 = dy ? ::fabs(dy / cos(qr)) : ::fabs(dx);
+    l2 = dx ? ::fabs(dx / sin(qr)) : ::fabs(dy);
+  } else if (0.0 < qr && qr <= M_PI_2) {
+    dy = y21 - y12;
+    dx = x21 - x12;
+    if (dy > dx)
+      l1 = l2 = dy ? ::fabs(dy / cos(qr)) : ::fabs(dx);
+    else
+      l1 = l2 = dx ? ::fabs(dx / sin(qr)) : ::fabs(dy);
+  } else if (qr < -M_PI_2) {
+    dy = y11 - y22;
+    dx = -(x22 - x11);
+    if (dy > dx)
+      l1 = l2 = dy ? ::fabs(dy / cos(qr)) : ::fabs(dx);
+    else
+      l1 = l2 = dx ? ::fabs(dx / sin(qr)) : ::fabs(dy);
+  } else {
+    dy = y21 - y12;
+    if (abs(dcx) > (x12 - x11) / 2)
+      dx = x11 - x22;
+    else
+      dx = dcx;
+    if (dy > dx)
+      l1 = l2 = dy ? ::fabs(dy / cos(qr)) : ::fabs(dx);
+    else
+      l1 = l2 = (dx && qr != 0.0) ? ::fabs(dx / sin(qr)) : ::fabs(dy);
+  }
+
+  // printf("qr %f (cos(qr) = %f, sin(rq) = %f), l1 %li, l2 %li, dy %li, dx %li\n", qr, cos(qr), sin(qr), l1, l2, dy,
+  // dx);
+
+  const double aqr = ::fabs(qr);
+  if (is_horiz)
+    *is_horiz = PI_38 < aqr && aqr < PI_58;
+  return l1 < l2 ? (long)l1 : (long)l2;
+}
+
+//------------------------------------------------------------------------------
+inline double line_len2(long x1, long y1, long x2, long y2) {
+  return sqrt(pow((double)(x2 - x1), 2) + pow((double)(y2 - y1), 2));
+}
+
+//------------------------------------------------------------------------------
+double PreviousLayouter::calc_node_pair(const std::size_t i1, const std::size_t i2) {
+  const Node *n1 = &(_figures[i1]);
+  const Node *n2 = &(_figures[i2]);
+  const bool is_linked = n1->is_linked_to(i2) || n2->is_linked_to(i1);
+
+  long S1 = n1->w * n1->h;
+  long S2 = n2->w * n2->h;
+  if (S1 > S2) {
+    std::swap(n1, n2);
+    std::swap(S1, S2);
+  }
+
+  const long x11 = n1->x1;
+  const long y11 = n1->y1;
+  const long x12 = n1->x2;
+  const long y12 = n1->y2;
+
+  const long x21 = n2->x1;
+  const long y21 = n2->y1;
+  const long x22 = n2->x2;
+  const long y22 = n2->y2;
+
+  const long cx1 = x11 + (x12 - x11) / 2;
+  const long cy1 = y11 + (y12 - y11) / 2;
+  const long cx2 = x21 + (x22 - x21) / 2;
+  const long cy2 = y21 + (y22 - y21) / 2;
+
+  // Detect if nodes overlap
+  const bool is_overlap = ((x12 >= x21) && (x22 >= x11) && (y12 >= y21) && (y22 >= y11));
+
+  static const double overlap_quot = 1000.0;
+
+  double e = 0.0;
+  double distance = 0;
+  if (is_overlap) {
+    distance = line_len2(cx1, cy1, cx2, cy2);
+
+    // calc area of overlap
+    const long sx1 = x11 > x21 ? x11 : x21;
+    const long sy1 = y11 > y21 ? y11 : y21;
+    const long sx2 = x12 < x22 ? x12 : x22;
+    const long sy2 = y12 < y22 ? y12 : y22;
+    const long dsx = sx2 - sx1;
+    const long dsy = sy2 - sy1;
+
+    const long Sov = dsx * dsy;
+
+    if (distance == 0.0)
+      distance = 0.0000001;
+
+    e = _min_dist * 1 / distance * 100 + Sov;
+    e *= overlap_quot;
+  } else {
+    bool is_horiz = false;
+    distance = distance_to_node(i1, i2, &is_horiz);
+
+    if (distance <= _min_dist) {
+      if (distance != 0) {
+        if (is_linked)
+          e += _min_dist + overlap_quot * 1 / distance;
+        else
+          e += _min_dist + overlap_quot * _min_dist / distance;
+      } else {
+        e += overlap_quot;
+      }
+    } else {
+      e += distance;
+      if (is_linked)
+        e += distance * distance;
+    }
+  }
+
+  return e;
+}
+
+//------------------------------------------------------------------------------
+double PreviousLayouter::calc_energy() {
+  double e = 0.0;
+
+  std::size_t size = _figures.size();
+  for (std::size_t i = 0; i < size; ++i) {
+    const Node &node = _figures[i];
+    if ((node.x1 < 0) || (node.y1 < 0) || (node.x2 + 20 > _w) || (node.y2 + 20 > _h))
+      e += 1000000000000.0;
+
+    for (std::size_t j = i + 1; j < size; ++j) {
+      if (j >= size)
+        break;
+      e += calc_node_pair(i, j);
+    }
+  }
+
+  return e;
+}
+
+//------------------------------------------------------------------------------
+double PreviousLayouter::calc_node_energy(const std::size_t node_i, const Node &node) {
+  double e = 0.0;
+
+  if ((node.x1 < 0) || (node.y1 < 0) || (node.x2 + 20 > _w) || (node.y2 + 20 > _h))
+    e += 1000000000000.0;
+
+  for (std::size_t i = 0; i < _figures.size(); ++i) {
+    if (node_i != i)
+      e += calc_node_pair(node_i, i);
+  }
+
+  return e;
+}
+
+//------------------------------------------------------------------------------
+bool PreviousLayouter::shuffle() {
+  bool found_smaller_energy = false;
+  const int step = (rand() % 5) + 1;
+
+  for (std::size_t i = 0; i < _figures.size(); ++i) {
+    Node &n = _figures[i];
+    const int wstep = _cell_w * step;
+    const int hstep = _cell_w * step;
+    double node_energy = calc_node_energy(i, n);
+
+    const int wsteps[] = {wstep, -wstep, 0, 0};
+    const int hsteps[] = {0, 0, hstep, -hstep};
+    for (int ns = sizeof(wsteps) / sizeof(int) - 1; ns >= 0; --ns) {
+      n.move_by(wsteps[ns], hsteps[ns]);
+      const double energy = calc_node_energy(i, n);
+      if (energy < node_energy) {
+        node_energy = energy;
+        found_smaller_energy = true;
+      } else
+        n.move_by(-wsteps[ns], -hsteps[ns]);
+    }
+  }
+
+  if (found_smaller_energy)
+    _min_energy = calc_energy();
+
+  return found_smaller_energy;
+}
+
+//------------------------------------------------------------------------------
+bool PreviousLayouter::compare_node_links(const Node &n1, const Node &n2) {
+  return n1.linked.size() > n2.linked.size();
+}
+
+//------------------------------------------------------------------------------
+void PreviousLayouter::prepare_layout_stages() {
+  double total_w = 0;
+  double total_h = 0;
+  std::sort(_figures.begin(), _figures.end(), compare_node_links);
+
+  // reset layout
+  for (size_t i = 0; i < _figures.size(); ++i) {
+    Node &n = _figures[i];
+    // place all tables in some initial position
+    n.move((long)_w / 4, (long)_h / 4);
+
+    // Calculate total dimensions and find max cell size.
+    total_w += n.w;
+    total_h += n.h;
+    if (_cell_w < n.w)
+      _cell_w = (int)n.w;
+    if (_cell_h < n.h)
+      _cell_h = (int)n.h;
+  }
+  _cell_w = (int)(1.1 * _cell_w);
+}
+
+//------------------------------------------------------------------------------
+int PreviousLayouter::do_layout() {
+  prepare_layout_stages();
+
+  _min_energy = calc_energy();
+  int de0_count = 10; // de=0 count
+  double de = 1;      // energy delta
+  double prev_energy = 0;
+  while (de0_count > 0) {
+    shuffle();
+    de = prev_energy - _min_energy;
+    prev_energy = _min_energy;
+    if (de == 0)
+      --de0_count;
+    else
+      de0_count = 10;
+  }
+
+  // update actual figures with new coords
+  positions.resize(_figures.size());
+  for (std::size_t i = 0; i < _figures.size(); ++i)
+    positions[_figures[i].index] = { (double)_figures[i].x1, (double)_figures[i].y1 };
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------------------------------------
+
+$describe("EER diagram autolayout") {
+
+  $it("Layouts depend only on the seed, not on the number of threads", []() {
+    Schema schema(600, 1);
+    std::vector<std::vector<std::pair<double, double>>> results;
+    for (unsigned int threads : { 1, 2, 4, 0 }) {
+      ForceLayouter layouter(schema.width, schema.height, 42);
+      layouter.set_thread_count(threads);
+      schema.fill(layouter);
+      layouter.do_layout();
+      results.push_back(positions(layouter));
+    }
+
+    for (std::size_t i = 1; i < results.size(); ++i)
+      $expect(results[i] == results[0]).toBeTrue("Layout differs for another thread count");
+
+    ForceLayouter other(schema.width, schema.height, 43);
+    schema.fill(other);
+    other.do_layout();
+    $expect(positions(other) == results[0]).toBeFalse("Different seeds should give different layouts");
+  });
+
+  $it("Figures don't overlap and stay on the layer", []() {
+    for (std::size_t count : { 1, 2, 20, 300 }) {
+      Schema schema(count, 2);
+      ForceLayouter layouter(schema.width, schema.height);
+      schema.fill(layouter);
+      layouter.do_layout();
+
+      $expect(schema.overlaps(positions(layouter))).toBe(0U, "Overlapping figures for " + std::to_string(count));
+      for (std::size_t i = 0; i < count; ++i) {
+        const ForceLayouter::Node &node = layouter.node(i);
+        $expect(node.left >= 0 && node.top >= 0).toBeTrue();
+        $expect(node.left + node.width <= schema.width && node.top + node.height <= schema.height).toBeTrue();
+      }
+    }
+  });
+
+  $it("Large diagrams", []() {
+    Schema schema(1500, 3);
+    ForceLayouter layouter(schema.width, schema.height);
+    schema.fill(layouter);
+
+    auto start = std::chrono::steady_clock::now();
+    layouter.do_layout();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report("Layout of 1500 tables: " + std::to_string(seconds) + "s");
+
+    $expect(schema.overlaps(positions(layouter))).toBe(0U);
+    $expect(seconds).toBeLessThan(30.0);
+  });
+
+  $it("Benchmark against the previous layouter", []() {
+    for (std::size_t count : { 50, 100, 200 }) {
+      Schema schema(count, 4);
+
+      PreviousLayouter previous(schema.width, schema.height);
+      schema.fill(previous);
+      srand(1);
+      auto start = std::chrono::steady_clock::now();
+      previous.do_layout();
+      double previous_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      ForceLayouter layouter(schema.width, schema.height);
+      schema.fill(layouter);
+      start = std::chrono::steady_clock::now();
+      layouter.do_layout();
+      double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      report(std::to_string(count) + " tables: previous " + std::to_string(previous_seconds) + "s, " +
+             std::to_string(schema.overlaps(previous.positions)) + " overlaps, reference length " +
+             std::to_string((int)schema.reference_length(previous.positions)) + "; new " + std::to_string(seconds) +
+             "s, " + std::to_string(schema.overlaps(positions(layouter))) + " overlaps, reference length " +
+             std::to_string((int)schema.reference_length(positions(layouter))));
+
+      $expect(schema.overlaps(positions(layouter))).toBeLessThanOrEqual(schema.overlaps(previous.positions));
+      $expect(schema.reference_length(positions(layouter))).toBeLessThan(schema.reference_length(previous.positions));
+    }
+  });
+}
+
+}
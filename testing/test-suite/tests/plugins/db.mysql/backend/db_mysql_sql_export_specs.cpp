@@ -44,7 +44,8 @@ $TestData {
 
   std::string dataDir;
 
-  void doForwardEngineering(std::string &modelfile, std::string &expectedFileName, std::map<std::string, bool> &fwd_opts) {
+  void doForwardEngineering(std::string &modelfile, std::string &expectedFileName, std::map<std::string, bool> &fwd_opts,
+                            const std::string &streamFileName = "") {
     $expect(base::file_exists(modelfile)).toBeTrue("Model file not found");
 
     tester->wb->open_document(modelfile);
@@ -77,9 +78,20 @@ $TestData {
     for (it = fwd_opts.begin(); it != fwd_opts.end(); ++it)
       exp.set_option(it->first, it->second);
 
+    if (!streamFileName.empty()) {
+      exp.set_option("OutputFileName", streamFileName);
+      exp.set_option("StreamOutput", true);
+    }
+
     exp.start_export(true);
 
     std::string output = exp.export_sql_script();
+    if (!streamFileName.empty()) {
+      $expect(output).toEqual("");
+      $expect(exp.export_result()).toStartWith("\nSQL Script Export Completed");
+      $expect(base::file_exists(streamFileName + ".tmp")).toBeFalse("temporary script file left behind");
+      output = base::getTextFileContent(streamFileName);
+    }
     $expect(output).toEqualContentOfFile(expectedFileName);
 
     tester->wb->close_document();
@@ -181,6 +193,36 @@ $describe("Forward Engineer") {
     data->doForwardEngineering(modelfile, expectedFileName, opts);
   });
 
+  $it("Streaming forward engineering output to a file", [this]() {
+    std::map<std::string, bool> opts;
+    std::string modelfile = data->dataDir + "/forward_engineer/schema_rename.mwb";
+    std::string expectedFileName = data->dataDir + "/forward_engineer/schema_rename.expected.sql";
+
+    opts["GenerateDrops"] = true;
+    opts["GenerateSchemaDrops"] = true;
+    opts["SkipForeignKeys"] = true;
+    opts["SkipFKIndexes"] = true;
+    opts["GenerateWarnings"] = true;
+    opts["GenerateCreateIndex"] = true;
+    opts["NoUsersJustPrivileges"] = true;
+    opts["NoViewPlaceholders"] = true;
+    opts["GenerateInserts"] = true;
+    opts["NoFKForInserts"] = true;
+    opts["TriggersAfterInserts"] = true;
+    opts["OmitSchemata"] = true;
+    opts["GenerateUse"] = true;
+
+    opts["TablesAreSelected"] = true;
+    opts["TriggersAreSelected"] = true;
+    opts["RoutinesAreSelected"] = true;
+    opts["ViewsAreSelected"] = true;
+    opts["UsersAreSelected"] = true;
+    opts["GenerateDocumentProperties"] = false;
+
+    data->doForwardEngineering(modelfile, expectedFileName, opts,
+                               casmine::CasmineContext::get()->outputDir() + "/schema_rename_streamed.sql");
+  });
+
 }
 
 }